@@ -5,6 +5,8 @@
 
 #include <CL/opencl.h> //standard OpenCL header
 
+#include "helper_program_cache.h" //buildProgramWithCache()
+
 // global variables
 const int iNumberOfArrayElements = 5;
 
@@ -45,6 +47,7 @@ int main(void)
     // local variable declaration
     int size = iNumberOfArrayElements * sizeof(float);
     cl_int result;
+    cl_bool bProgramFromCache = CL_FALSE;
 
     // code
     // host memory allocation
@@ -121,17 +124,15 @@ int main(void)
         exit(EXIT_FAILURE);
     }
 
-    // create OpenCL program from .cl
-    oclProgram = clCreateProgramWithSource(oclContext, 1, (const char **)&openclSourceCode, NULL, &result);
-    if (result != CL_SUCCESS)
+    // create and build OpenCL program, from the binary of an earlier run when it is still valid
+    oclProgram = buildProgramWithCache(oclContext, oclDeviceID, openclSourceCode, NULL, &result, &bProgramFromCache);
+    if (oclProgram == NULL)
     {
         printf("error>> clCreateProgramWithSource() Failed : %d. Terminating Now ...\n", result);
         cleanup();
         exit(EXIT_FAILURE);
     }
 
-    // build OpenCL program
-    result = clBuildProgram(oclProgram, 0, NULL, NULL, NULL, NULL);
     if (result != CL_SUCCESS)
     {
 
@@ -145,6 +146,9 @@ int main(void)
         exit(EXIT_FAILURE);
     }
 
+    if (bProgramFromCache == CL_TRUE)
+        printf("info>> OpenCL Program Loaded From The Binary Cache (%s).\n", programCacheDirectory());
+
     // create OpenCL kernel by passing kernel function name that we used in .cl file
     oclKernel = clCreateKernel(oclProgram, "vecAddGPU", &result);
     if (result != CL_SUCCESS)
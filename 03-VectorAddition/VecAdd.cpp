@@ -3,14 +3,23 @@
 #include <stdlib.h> //exit()
 #include <string.h> //strlen()
 #include <math.h>   //fabs()
+#include <limits.h> //INT_MAX
 
 #include <CL/opencl.h> //standard OpenCL header
 
 #include "helper_timer.h"
+#include "helper_parallel.h"
+#include "helper_random.h"
+#include "helper_profile.h"
+#include "helper_program_cache.h"
+#include "helper_specialize.h"
+#include "helper_trace.h"
+#include "helper_tune.h"
+#include "helper_verify.h"
 
 // global OpenCL variables
 // const int iNumberOfArrayElements = 5;
-const int iNumberOfArrayElements = 11444777;
+size_t iNumberOfArrayElements = 11444777;
 
 cl_platform_id oclPlatformID;
 cl_device_id oclDeviceID;
@@ -21,68 +30,374 @@ cl_command_queue oclCommandQueue;
 cl_program oclProgram;
 cl_kernel oclKernel;
 
+// input generation : Philox streams 0 and 1 of randomSeed, generated in place on the device with -devicefill
+cl_ulong randomSeed = 2021;
+bool bDeviceFill = false;
+
+// -randomtest : every distribution of helper_random.h generated on host and device and compared
+#define RANDOM_NORMAL_MAX_ULP 16
+bool bRandomTest = false;
+
+cl_program oclRandomProgram;
+cl_kernel oclRandomKernel;
+
 float *hostInput1 = NULL;
 float *hostInput2 = NULL;
 float *hostOutput = NULL;
 float *gold = NULL;
+float *goldParallel = NULL; // the threaded SIMD result, checked against the scalar gold
 
 cl_mem deviceInput1 = NULL;
 cl_mem deviceInput2 = NULL;
 cl_mem deviceOutput = NULL;
 
+// streaming pipeline : 0 => upload queue, 1 => kernel queue, 2 => readback queue
+#define MAX_STREAM_BUFFERS 3
+
+cl_command_queue oclStreamQueues[3] = {NULL, NULL, NULL};
+
+cl_mem deviceStreamInput1[MAX_STREAM_BUFFERS] = {NULL, NULL, NULL};
+cl_mem deviceStreamInput2[MAX_STREAM_BUFFERS] = {NULL, NULL, NULL};
+cl_mem deviceStreamOutput[MAX_STREAM_BUFFERS] = {NULL, NULL, NULL};
+
+cl_event oclStreamWriteEvents[MAX_STREAM_BUFFERS] = {NULL, NULL, NULL};
+cl_event oclStreamKernelEvents[MAX_STREAM_BUFFERS] = {NULL, NULL, NULL};
+cl_event oclStreamReadEvents[MAX_STREAM_BUFFERS] = {NULL, NULL, NULL};
+
+// device timestamps of every write, kernel and read of the run
+ProfileLog profileLog;
+
+// host phases and device commands on one timeline, written with -trace
+TraceLog traceLog;
+
+// host memory modes
+#define HOST_MEMORY_COPY 0           // malloc() host arrays, explicit write / read of device buffers
+#define HOST_MEMORY_ALLOC_HOST_PTR 1 // host arrays are mapped CL_MEM_ALLOC_HOST_PTR buffers
+#define HOST_MEMORY_USE_HOST_PTR 2   // page aligned host arrays wrapped by CL_MEM_USE_HOST_PTR buffers
+
+int hostMemoryMode = HOST_MEMORY_COPY;
+bool bDeviceBuffersMapped = false;
+
 float timeOnCPU = 0.0f;
+float timeOnCPUParallel = 0.0f;
 float timeOnGPU = 0.0f;
-
-// OpenCL kernel
-char *oclSourceCode =
-    "__kernel void vecAddGPU(__global float *input1, __global float *input2, __global float *output, int length)        \n"
-    "{                                                                                                                  \n"
-    "    int index = get_global_id(0);                                                                                  \n"
-    "    if(index < length)                                                                                             \n"
-    "    {                                                                                                              \n"
-    "        output[index] = input1[index] + input2[index];                                                             \n"
-    "    }                                                                                                              \n"
-    "}                                                                                                                  \n";
+float timeOnGPUWithTransfers = 0.0f;
+float timeToFillOnCPU = 0.0f;
+float timeToFillOnGPU = 0.0f;
+
+// kernel variants
+#define NUMBER_OF_KERNEL_VARIANTS 6
+#define KERNEL_VARIANT_AUTO -1 // preferred vector width of the device unless another variant measures faster
+
+const char *kernelVariantNames[NUMBER_OF_KERNEL_VARIANTS] = {"vecAddGPU", "vecAddGPUStride", "vecAddGPU2", "vecAddGPU4", "vecAddGPU8", "vecAddGPU16"};
+const char *kernelVariantOptions[NUMBER_OF_KERNEL_VARIANTS] = {"scalar", "stride", "float2", "float4", "float8", "float16"};
+const size_t kernelVariantWidths[NUMBER_OF_KERNEL_VARIANTS] = {1, 1, 2, 4, 8, 16};
+
+int kernelVariant = KERNEL_VARIANT_AUTO;
+size_t vectorsPerWorkItem = 4; // grid-stride variants only
+
+// work-group size : 0 => autotuned, the result is kept in TUNE_CACHE_FILE
+size_t requestedLocalWorkSize = 0;
+bool bRetune = false;
+
+// specialized builds of the chosen variant, one per launch shape (elements, global and local size),
+// -specialize off keeps the generic kernel that reads length at run time
+SpecializationCache specializationCache;
+bool bSpecialize = true;
+
+// host backend
+#define HOST_PAGE_ELEMENTS 1024 // floats per 4 KB page, the partitioning grain of the threaded host loops
+
+unsigned int numberOfCPUThreads = 0; // 0 => all hardware threads
+int cpuSimdLevel = CPU_SIMD_NONE;
+
+// OpenCL kernels
+// vecAddGPU handles one float per work-item, the other variants walk the arrays with a grid-stride loop
+// (vecAddGPUN loads N floats at a time and finishes the last length % N floats with a scalar tail).
+// -D FIXED_LENGTH, FIXED_GLOBAL_SIZE and FIXED_LOCAL_SIZE bake one launch into a specialized build, the
+// bounds and grid-stride trip counts become constants, without them the length argument is used
+const char *oclSourceCode =
+    "#ifdef FIXED_LENGTH                                                                                                                    \n"
+    "#define LENGTH FIXED_LENGTH                                                                                                            \n"
+    "#else                                                                                                                                  \n"
+    "#define LENGTH length                                                                                                                  \n"
+    "#endif                                                                                                                                 \n"
+    "#ifdef FIXED_GLOBAL_SIZE                                                                                                               \n"
+    "#define GLOBAL_SIZE FIXED_GLOBAL_SIZE                                                                                                  \n"
+    "#else                                                                                                                                  \n"
+    "#define GLOBAL_SIZE get_global_size(0)                                                                                                 \n"
+    "#endif                                                                                                                                 \n"
+    "#ifdef FIXED_LOCAL_SIZE                                                                                                                \n"
+    "#define KERNEL_ATTRIBUTES __attribute__((reqd_work_group_size(FIXED_LOCAL_SIZE, 1, 1)))                                                \n"
+    "#else                                                                                                                                  \n"
+    "#define KERNEL_ATTRIBUTES                                                                                                              \n"
+    "#endif                                                                                                                                 \n"
+    "                                                                                                                                       \n"
+    "__kernel KERNEL_ATTRIBUTES void vecAddGPU(__global float *input1, __global float *input2, __global float *output, int length)          \n"
+    "{                                                                                                                                      \n"
+    "    int index = get_global_id(0);                                                                                                      \n"
+    "#if !defined(FIXED_GLOBAL_SIZE) || (FIXED_GLOBAL_SIZE != FIXED_LENGTH)                                                                 \n"
+    "    if(index < LENGTH)                                                                                                                 \n"
+    "#endif                                                                                                                                 \n"
+    "    {                                                                                                                                  \n"
+    "        output[index] = input1[index] + input2[index];                                                                                 \n"
+    "    }                                                                                                                                  \n"
+    "}                                                                                                                                      \n"
+    "                                                                                                                                       \n"
+    "__kernel KERNEL_ATTRIBUTES void vecAddGPUStride(__global float *input1, __global float *input2, __global float *output, int length)    \n"
+    "{                                                                                                                                      \n"
+    "    for(int index = get_global_id(0); index < LENGTH; index += GLOBAL_SIZE)                                                            \n"
+    "    {                                                                                                                                  \n"
+    "        output[index] = input1[index] + input2[index];                                                                                 \n"
+    "    }                                                                                                                                  \n"
+    "}                                                                                                                                      \n"
+    "                                                                                                                                       \n"
+    "__kernel KERNEL_ATTRIBUTES void vecAddGPU2(__global float *input1, __global float *input2, __global float *output, int length)         \n"
+    "{                                                                                                                                      \n"
+    "    int numberOfVectors = LENGTH / 2;                                                                                                  \n"
+    "    for(int index = get_global_id(0); index < numberOfVectors; index += GLOBAL_SIZE)                                                   \n"
+    "    {                                                                                                                                  \n"
+    "        vstore2(vload2(index, input1) + vload2(index, input2), index, output);                                                         \n"
+    "    }                                                                                                                                  \n"
+    "                                                                                                                                       \n"
+    "    int tailIndex = numberOfVectors * 2 + get_global_id(0);                                                                            \n"
+    "    if(tailIndex < LENGTH)                                                                                                             \n"
+    "    {                                                                                                                                  \n"
+    "        output[tailIndex] = input1[tailIndex] + input2[tailIndex];                                                                     \n"
+    "    }                                                                                                                                  \n"
+    "}                                                                                                                                      \n"
+    "                                                                                                                                       \n"
+    "__kernel KERNEL_ATTRIBUTES void vecAddGPU4(__global float *input1, __global float *input2, __global float *output, int length)         \n"
+    "{                                                                                                                                      \n"
+    "    int numberOfVectors = LENGTH / 4;                                                                                                  \n"
+    "    for(int index = get_global_id(0); index < numberOfVectors; index += GLOBAL_SIZE)                                                   \n"
+    "    {                                                                                                                                  \n"
+    "        vstore4(vload4(index, input1) + vload4(index, input2), index, output);                                                         \n"
+    "    }                                                                                                                                  \n"
+    "                                                                                                                                       \n"
+    "    int tailIndex = numberOfVectors * 4 + get_global_id(0);                                                                            \n"
+    "    if(tailIndex < LENGTH)                                                                                                             \n"
+    "    {                                                                                                                                  \n"
+    "        output[tailIndex] = input1[tailIndex] + input2[tailIndex];                                                                     \n"
+    "    }                                                                                                                                  \n"
+    "}                                                                                                                                      \n"
+    "                                                                                                                                       \n"
+    "__kernel KERNEL_ATTRIBUTES void vecAddGPU8(__global float *input1, __global float *input2, __global float *output, int length)         \n"
+    "{                                                                                                                                      \n"
+    "    int numberOfVectors = LENGTH / 8;                                                                                                  \n"
+    "    for(int index = get_global_id(0); index < numberOfVectors; index += GLOBAL_SIZE)                                                   \n"
+    "    {                                                                                                                                  \n"
+    "        vstore8(vload8(index, input1) + vload8(index, input2), index, output);                                                         \n"
+    "    }                                                                                                                                  \n"
+    "                                                                                                                                       \n"
+    "    int tailIndex = numberOfVectors * 8 + get_global_id(0);                                                                            \n"
+    "    if(tailIndex < LENGTH)                                                                                                             \n"
+    "    {                                                                                                                                  \n"
+    "        output[tailIndex] = input1[tailIndex] + input2[tailIndex];                                                                     \n"
+    "    }                                                                                                                                  \n"
+    "}                                                                                                                                      \n"
+    "                                                                                                                                       \n"
+    "__kernel KERNEL_ATTRIBUTES void vecAddGPU16(__global float *input1, __global float *input2, __global float *output, int length)        \n"
+    "{                                                                                                                                      \n"
+    "    int numberOfVectors = LENGTH / 16;                                                                                                 \n"
+    "    for(int index = get_global_id(0); index < numberOfVectors; index += GLOBAL_SIZE)                                                   \n"
+    "    {                                                                                                                                  \n"
+    "        vstore16(vload16(index, input1) + vload16(index, input2), index, output);                                                      \n"
+    "    }                                                                                                                                  \n"
+    "                                                                                                                                       \n"
+    "    int tailIndex = numberOfVectors * 16 + get_global_id(0);                                                                           \n"
+    "    if(tailIndex < LENGTH)                                                                                                             \n"
+    "    {                                                                                                                                  \n"
+    "        output[tailIndex] = input1[tailIndex] + input2[tailIndex];                                                                     \n"
+    "    }                                                                                                                                  \n"
+    "}                                                                                                                                      \n";
 
 // main() definition
-int main(void)
+int main(int argc, char *argv[])
 {
     // local function declaration
-    void fillArrayWithRandomNumbers(float *, int);
-    size_t roundGlobalSizeToNearestMultipleOfLocalSize(int, unsigned int);
-    void vecAddCPU(const float *, const float *, float *, int);
+    void fillHostInputs(void);
+    void buildRandomProgram(void);
+    void fillDeviceInputs(void);
+    void checkRandomStreams(void);
+    size_t globalWorkSizeForKernelVariant(int, size_t, size_t);
+    int selectKernelVariant(size_t);
+    size_t tuneLocalWorkSize(size_t);
+    cl_kernel specializeKernelVariant(size_t, size_t);
+    void vecAddCPU(const float *, const float *, float *, size_t);
+    void vecAddCPUParallel(const float *, const float *, float *, size_t);
+    void firstTouchHostArray(void *, size_t);
+    size_t clampStreamChunkElements(size_t, int);
+    void vecAddGPUStreaming(size_t, int, size_t);
+    void vecAddGPUZeroCopy(size_t, size_t);
+    void *allocateHostArray(size_t);
     void cleanup(void);
 
     // local variable declaration
-    int size = iNumberOfArrayElements * sizeof(float);
+    bool bStreaming = false;
+    size_t streamChunkElements = 1048576;
+    int streamBufferCount = MAX_STREAM_BUFFERS;
+    size_t size;
     cl_int result;
 
     // code
-    // host memory allocation
-    hostInput1 = (float *)malloc(size);
-    if (hostInput1 == NULL)
+    // parse command line
+    for (int argIndex = 1; argIndex < argc; argIndex++)
     {
-        printf("error>> Host Memory Allocation Failed For hostInput1 Array. Terminating Now...\n");
-        cleanup();
+        if (strcmp(argv[argIndex], "-stream") == 0)
+        {
+            bStreaming = true;
+        }
+        else if ((strcmp(argv[argIndex], "-chunk") == 0) && (argIndex + 1 < argc))
+        {
+            streamChunkElements = (size_t)strtoull(argv[++argIndex], NULL, 10);
+        }
+        else if ((strcmp(argv[argIndex], "-buffers") == 0) && (argIndex + 1 < argc))
+        {
+            streamBufferCount = atoi(argv[++argIndex]);
+        }
+        else if ((strcmp(argv[argIndex], "-zerocopy") == 0) && (argIndex + 1 < argc))
+        {
+            argIndex++;
+            if (strcmp(argv[argIndex], "alloc") == 0)
+                hostMemoryMode = HOST_MEMORY_ALLOC_HOST_PTR;
+            else if (strcmp(argv[argIndex], "usehost") == 0)
+                hostMemoryMode = HOST_MEMORY_USE_HOST_PTR;
+            else
+                hostMemoryMode = -1;
+        }
+        else if ((strcmp(argv[argIndex], "-n") == 0) && (argIndex + 1 < argc))
+        {
+            iNumberOfArrayElements = (size_t)strtoull(argv[++argIndex], NULL, 10);
+        }
+        else if ((strcmp(argv[argIndex], "-variant") == 0) && (argIndex + 1 < argc))
+        {
+            argIndex++;
+            kernelVariant = -2;
+            if (strcmp(argv[argIndex], "auto") == 0)
+                kernelVariant = KERNEL_VARIANT_AUTO;
+            for (int variant = 0; variant < NUMBER_OF_KERNEL_VARIANTS; variant++)
+            {
+                if (strcmp(argv[argIndex], kernelVariantOptions[variant]) == 0)
+                    kernelVariant = variant;
+            }
+        }
+        else if ((strcmp(argv[argIndex], "-items") == 0) && (argIndex + 1 < argc))
+        {
+            vectorsPerWorkItem = (size_t)strtoull(argv[++argIndex], NULL, 10);
+        }
+        else if ((strcmp(argv[argIndex], "-threads") == 0) && (argIndex + 1 < argc))
+        {
+            numberOfCPUThreads = (unsigned int)atoi(argv[++argIndex]);
+        }
+        else if ((strcmp(argv[argIndex], "-seed") == 0) && (argIndex + 1 < argc))
+        {
+            randomSeed = (cl_ulong)strtoull(argv[++argIndex], NULL, 10);
+        }
+        else if (strcmp(argv[argIndex], "-devicefill") == 0)
+        {
+            bDeviceFill = true;
+        }
+        else if (strcmp(argv[argIndex], "-randomtest") == 0)
+        {
+            bRandomTest = true;
+        }
+        else if ((strcmp(argv[argIndex], "-local") == 0) && (argIndex + 1 < argc))
+        {
+            requestedLocalWorkSize = (size_t)strtoull(argv[++argIndex], NULL, 10);
+        }
+        else if (strcmp(argv[argIndex], "-retune") == 0)
+        {
+            bRetune = true;
+        }
+        else if ((strcmp(argv[argIndex], "-trace") == 0) && (argIndex + 1 < argc))
+        {
+            traceLog.path = argv[++argIndex];
+        }
+        else if ((strcmp(argv[argIndex], "-specialize") == 0) && (argIndex + 1 < argc) && ((strcmp(argv[argIndex + 1], "on") == 0) || (strcmp(argv[argIndex + 1], "off") == 0)))
+        {
+            bSpecialize = (strcmp(argv[++argIndex], "on") == 0);
+        }
+        else
+        {
+            printf("usage : %s [-n elements] [-variant auto|scalar|stride|float2|float4|float8|float16] [-items vectors] [-local size] [-retune] [-specialize on|off] [-threads count] [-seed value] [-randomtest] [-trace file.json] [-stream [-chunk elements] [-buffers 2|3] | -zerocopy alloc|usehost | -devicefill]\n", argv[0]);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    if ((iNumberOfArrayElements == 0) || (streamChunkElements == 0) || (streamBufferCount < 2) || (streamBufferCount > MAX_STREAM_BUFFERS))
+    {
+        printf("error>> Invalid Element Count, Chunk Size Or Buffer Count. Terminating Now...\n");
         exit(EXIT_FAILURE);
     }
 
-    hostInput2 = (float *)malloc(size);
-    if (hostInput2 == NULL)
+    if ((kernelVariant < KERNEL_VARIANT_AUTO) || (vectorsPerWorkItem == 0))
     {
-        printf("error>> Host Memory Allocation Failed For hostInput2 Array. Terminating Now...\n");
-        cleanup();
+        printf("error>> -variant Takes auto, scalar, stride, float2, float4, float8 Or float16 And -items Must Be At Least 1. Terminating Now...\n");
         exit(EXIT_FAILURE);
     }
 
-    hostOutput = (float *)malloc(size);
-    if (hostOutput == NULL)
+    if ((hostMemoryMode < HOST_MEMORY_COPY) || ((bStreaming == true) && (hostMemoryMode != HOST_MEMORY_COPY)))
     {
-        printf("error>> Host Memory Allocation Failed For hostOutput Array. Terminating Now...\n");
-        cleanup();
+        printf("error>> -zerocopy Takes alloc Or usehost And Cannot Be Combined With -stream. Terminating Now...\n");
+        exit(EXIT_FAILURE);
+    }
+
+    if ((bDeviceFill == true) && ((bStreaming == true) || (hostMemoryMode != HOST_MEMORY_COPY)))
+    {
+        printf("error>> -devicefill Needs Whole Arrays In Device Buffers And Cannot Be Combined With -stream Or -zerocopy. Terminating Now...\n");
+        exit(EXIT_FAILURE);
+    }
+
+    if ((bStreaming == false) && (iNumberOfArrayElements > INT_MAX))
+    {
+        printf("error>> %zu Elements Do Not Fit In A Single Kernel Launch, Use -stream. Terminating Now...\n", iNumberOfArrayElements);
         exit(EXIT_FAILURE);
     }
 
+    size = iNumberOfArrayElements * sizeof(float);
+
+    // host backend configuration, needed before the first host array is touched
+    if (numberOfCPUThreads == 0)
+        numberOfCPUThreads = getNumberOfCPUThreads();
+    cpuSimdLevel = getCPUSimdLevel();
+
+    // host memory allocation
+    // (with CL_MEM_ALLOC_HOST_PTR the host arrays are mapped from the device buffers later)
+    int traceSlice = traceBegin(&traceLog, "Host Allocation", "host");
+    if (hostMemoryMode != HOST_MEMORY_ALLOC_HOST_PTR)
+    {
+        hostInput1 = (float *)allocateHostArray(size);
+        if (hostInput1 == NULL)
+        {
+            printf("error>> Host Memory Allocation Failed For hostInput1 Array. Terminating Now...\n");
+            cleanup();
+            exit(EXIT_FAILURE);
+        }
+
+        hostInput2 = (float *)allocateHostArray(size);
+        if (hostInput2 == NULL)
+        {
+            printf("error>> Host Memory Allocation Failed For hostInput2 Array. Terminating Now...\n");
+            cleanup();
+            exit(EXIT_FAILURE);
+        }
+
+        hostOutput = (float *)allocateHostArray(size);
+        if (hostOutput == NULL)
+        {
+            printf("error>> Host Memory Allocation Failed For hostOutput Array. Terminating Now...\n");
+            cleanup();
+            exit(EXIT_FAILURE);
+        }
+
+        traceEnd(&traceLog, traceSlice);
+
+        // filling values into host arrays
+        fillHostInputs();
+        traceSlice = traceBegin(&traceLog, "Host Allocation", "host");
+    }
+
     gold = (float *)malloc(size);
     if (gold == NULL)
     {
@@ -90,12 +405,20 @@ int main(void)
         cleanup();
         exit(EXIT_FAILURE);
     }
+    firstTouchHostArray(gold, size);
 
-    // filling values into host arrays
-    fillArrayWithRandomNumbers(hostInput1, iNumberOfArrayElements);
-    fillArrayWithRandomNumbers(hostInput2, iNumberOfArrayElements);
+    goldParallel = (float *)malloc(size);
+    if (goldParallel == NULL)
+    {
+        printf("error>> Host Memory Allocation Failed For goldParallel Array. Terminating Now...\n");
+        cleanup();
+        exit(EXIT_FAILURE);
+    }
+    firstTouchHostArray(goldParallel, size);
+    traceEnd(&traceLog, traceSlice);
 
     // get OpenCL supporting platform's ID
+    traceSlice = traceBegin(&traceLog, "Platform Discovery", "setup");
     result = clGetPlatformIDs(1, &oclPlatformID, NULL);
     if (result != CL_SUCCESS)
     {
@@ -123,7 +446,7 @@ int main(void)
     }
 
     // create command queue
-    oclCommandQueue = clCreateCommandQueue(oclContext, oclDeviceID, 0, &result);
+    oclCommandQueue = clCreateCommandQueue(oclContext, oclDeviceID, CL_QUEUE_PROFILING_ENABLE, &result);
     if (result != CL_SUCCESS)
     {
         printf("error>> clCreateCommandQueue() Failed : %d. Terminating Now ...\n", result);
@@ -131,17 +454,19 @@ int main(void)
         exit(EXIT_FAILURE);
     }
 
-    // create OpenCL program from .cl
-    oclProgram = clCreateProgramWithSource(oclContext, 1, (const char **)&oclSourceCode, NULL, &result);
-    if (result != CL_SUCCESS)
+    traceEnd(&traceLog, traceSlice);
+
+    // create and build OpenCL program, from the binary of an earlier run when it is still valid
+    traceSlice = traceBegin(&traceLog, "clBuildProgram", "setup");
+    cl_bool bProgramFromCache = CL_FALSE;
+    oclProgram = buildProgramWithCache(oclContext, oclDeviceID, oclSourceCode, NULL, &result, &bProgramFromCache);
+    if (oclProgram == NULL)
     {
         printf("error>> clCreateProgramWithSource() Failed : %d. Terminating Now ...\n", result);
         cleanup();
         exit(EXIT_FAILURE);
     }
 
-    // build OpenCL program
-    result = clBuildProgram(oclProgram, 0, NULL, NULL, NULL, NULL);
     if (result != CL_SUCCESS)
     {
         printf("error>> clBuildProgram() Failed : %d. Terminating Now ...\n", result);
@@ -155,157 +480,237 @@ int main(void)
         exit(EXIT_FAILURE);
     }
 
-    // create OpenCL kernel by passing kernel function name that we used in .cl file
-    oclKernel = clCreateKernel(oclProgram, "vecAddGPU", &result);
-    if (result != CL_SUCCESS)
-    {
-        printf("error>> clCreateKernel() Failed : %d. Terminating Now ...\n", result);
-        cleanup();
-        exit(EXIT_FAILURE);
-    }
+    if (bProgramFromCache == CL_TRUE)
+        printf("info>> OpenCL Program Loaded From The Binary Cache (%s).\n", programCacheDirectory());
+    traceEnd(&traceLog, traceSlice);
 
-    // allocate device memory
-    size = iNumberOfArrayElements * sizeof(cl_float);
-    deviceInput1 = clCreateBuffer(oclContext, CL_MEM_READ_ONLY, size, NULL, &result);
-    if (result != CL_SUCCESS)
-    {
-        printf("error>> clCreateBuffer() Failed For 1st Input Array : %d. Terminating Now ...\n", result);
-        cleanup();
-        exit(EXIT_FAILURE);
-    }
+    if ((bDeviceFill == true) || (bRandomTest == true))
+        buildRandomProgram();
 
-    deviceInput2 = clCreateBuffer(oclContext, CL_MEM_READ_ONLY, size, NULL, &result);
-    if (result != CL_SUCCESS)
+    if (bRandomTest == true)
     {
-        printf("error>> clCreateBuffer() Failed For 2nd Input Array : %d. Terminating Now ...\n", result);
+        // the stream check replaces the vector addition
+        checkRandomStreams();
         cleanup();
-        exit(EXIT_FAILURE);
+        return (0);
     }
 
-    deviceOutput = clCreateBuffer(oclContext, CL_MEM_WRITE_ONLY, size, NULL, &result);
-    if (result != CL_SUCCESS)
-    {
-        printf("error>> clCreateBuffer() Failed For Output Array : %d. Terminating Now ...\n", result);
-        cleanup();
-        exit(EXIT_FAILURE);
-    }
+    // kernel configuration
+    // size_t localWorkSize = 5;
+    size_t localWorkSize = 256;
+    size_t globalWorkSize;
 
-    // set 0 based 0th argument i.e deviceInput
-    result = clSetKernelArg(oclKernel, 0, sizeof(cl_mem), (void *)&deviceInput1);
+    // pick the vecAddGPU variant
+    traceSlice = traceBegin(&traceLog, "selectKernelVariant", "setup");
+    kernelVariant = selectKernelVariant(localWorkSize);
+    traceEnd(&traceLog, traceSlice);
+
+    // create OpenCL kernel by passing kernel function name that we used in .cl file
+    oclKernel = clCreateKernel(oclProgram, kernelVariantNames[kernelVariant], &result);
     if (result != CL_SUCCESS)
     {
-        printf("error>> clSetKernelArg() Failed For 1st Argument : %d. Terminating Now ...\n", result);
+        printf("error>> clCreateKernel() Failed : %d. Terminating Now ...\n", result);
         cleanup();
         exit(EXIT_FAILURE);
     }
 
-    // set 0 based 1st argument i.e deviceInpu2
-    result = clSetKernelArg(oclKernel, 1, sizeof(cl_mem), (void *)&deviceInput2);
-    if (result != CL_SUCCESS)
+    // the compiled kernel may not allow 256 work-items per work-group
+    size_t kernelWorkGroupSize = localWorkSize;
+    clGetKernelWorkGroupInfo(oclKernel, oclDeviceID, CL_KERNEL_WORK_GROUP_SIZE, sizeof(kernelWorkGroupSize), &kernelWorkGroupSize, NULL);
+    if (localWorkSize > kernelWorkGroupSize)
+        localWorkSize = kernelWorkGroupSize;
+
+    // the chunk must fit device memory before the tuner benchmarks it, so the tuned size is the launched one
+    if (bStreaming == true)
+        streamChunkElements = clampStreamChunkElements(streamChunkElements, streamBufferCount);
+
+    // tune the work-group size of the chosen variant for the elements one launch sees, unless -local gave it
+    if (requestedLocalWorkSize == 0)
     {
-        printf("error>> clSetKernelArg() Failed For 2nd Argument : %d. Terminating Now ...\n", result);
-        cleanup();
-        exit(EXIT_FAILURE);
+        traceSlice = traceBegin(&traceLog, "tuneLocalWorkSize", "setup");
+        localWorkSize = tuneLocalWorkSize((bStreaming == true) ? streamChunkElements : iNumberOfArrayElements);
+        traceEnd(&traceLog, traceSlice);
     }
-
-    // set 0 based 2nd argument i.e deviceOutput
-    result = clSetKernelArg(oclKernel, 2, sizeof(cl_mem), (void *)&deviceOutput);
-    if (result != CL_SUCCESS)
+    else
     {
-        printf("error>> clSetKernelArg() Failed For 3rd Argument : %d. Terminating Now ...\n", result);
-        cleanup();
-        exit(EXIT_FAILURE);
+        localWorkSize = (requestedLocalWorkSize > kernelWorkGroupSize) ? kernelWorkGroupSize : requestedLocalWorkSize;
     }
 
-    // set 0 based 3rd argument i.e length
-    result = clSetKernelArg(oclKernel, 3, sizeof(cl_int), (void *)&iNumberOfArrayElements);
-    if (result != CL_SUCCESS)
+    // the whole array is one launch, so its shape can be baked into the build (the stream specializes per chunk)
+    if ((bStreaming == false) && (bSpecialize == true))
     {
-        printf("error>> clSetKernelArg() Failed For 4th Argument : %d. Terminating Now ...\n", result);
-        cleanup();
-        exit(EXIT_FAILURE);
+        cl_kernel specializedVariant = specializeKernelVariant(iNumberOfArrayElements, localWorkSize);
+        if (specializedVariant != NULL)
+        {
+            // oclKernel holds its own reference, the cache keeps the other one
+            clRetainKernel(specializedVariant);
+            clReleaseKernel(oclKernel);
+            oclKernel = specializedVariant;
+        }
     }
 
-    // write above "input" device buffer to device memory
-    result = clEnqueueWriteBuffer(oclCommandQueue, deviceInput1, CL_FALSE, 0, size, hostInput1, 0, NULL, NULL);
-    if (result != CL_SUCCESS)
+    if (bStreaming == true)
     {
-        printf("error>> clEnqueueWriteBuffer() Failed For 1st Input Device Buffer : %d. Terminating Now ...\n", result);
-        cleanup();
-        exit(EXIT_FAILURE);
+        // chunked pipeline, device memory only holds streamBufferCount chunks at a time
+        vecAddGPUStreaming(streamChunkElements, streamBufferCount, localWorkSize);
+        globalWorkSize = globalWorkSizeForKernelVariant(kernelVariant, localWorkSize, streamChunkElements);
     }
-
-    result = clEnqueueWriteBuffer(oclCommandQueue, deviceInput2, CL_FALSE, 0, size, hostInput2, 0, NULL, NULL);
-    if (result != CL_SUCCESS)
+    else if (hostMemoryMode != HOST_MEMORY_COPY)
     {
-        printf("error>> clEnqueueWriteBuffer() Failed For 2nd Input Device Buffer : %d. Terminating Now ...\n", result);
-        cleanup();
-        exit(EXIT_FAILURE);
+        // mapped buffers, no explicit host <-> device copies
+        globalWorkSize = globalWorkSizeForKernelVariant(kernelVariant, localWorkSize, iNumberOfArrayElements);
+        vecAddGPUZeroCopy(globalWorkSize, localWorkSize);
     }
+    else
+    {
+        // allocate device memory
+        traceSlice = traceBegin(&traceLog, "Device Allocation", "setup");
+        size = iNumberOfArrayElements * sizeof(cl_float);
+        deviceInput1 = clCreateBuffer(oclContext, CL_MEM_READ_ONLY, size, NULL, &result);
+        if (result != CL_SUCCESS)
+        {
+            printf("error>> clCreateBuffer() Failed For 1st Input Array : %d. Terminating Now ...\n", result);
+            cleanup();
+            exit(EXIT_FAILURE);
+        }
 
-    // kernel configuration
-    // size_t localWorkSize = 5;
-    size_t localWorkSize = 256;
-    size_t globalWorkSize;
+        deviceInput2 = clCreateBuffer(oclContext, CL_MEM_READ_ONLY, size, NULL, &result);
+        if (result != CL_SUCCESS)
+        {
+            printf("error>> clCreateBuffer() Failed For 2nd Input Array : %d. Terminating Now ...\n", result);
+            cleanup();
+            exit(EXIT_FAILURE);
+        }
 
-    globalWorkSize = roundGlobalSizeToNearestMultipleOfLocalSize(localWorkSize, iNumberOfArrayElements);
+        deviceOutput = clCreateBuffer(oclContext, CL_MEM_WRITE_ONLY, size, NULL, &result);
+        if (result != CL_SUCCESS)
+        {
+            printf("error>> clCreateBuffer() Failed For Output Array : %d. Terminating Now ...\n", result);
+            cleanup();
+            exit(EXIT_FAILURE);
+        }
+        traceEnd(&traceLog, traceSlice);
 
-    // start timer
-    StopWatchInterface *timer = NULL;
-    sdkCreateTimer(&timer);
-    sdkStartTimer(&timer);
+        // set 0 based 0th argument i.e deviceInput
+        result = clSetKernelArg(oclKernel, 0, sizeof(cl_mem), (void *)&deviceInput1);
+        if (result != CL_SUCCESS)
+        {
+            printf("error>> clSetKernelArg() Failed For 1st Argument : %d. Terminating Now ...\n", result);
+            cleanup();
+            exit(EXIT_FAILURE);
+        }
 
-    result = clEnqueueNDRangeKernel(oclCommandQueue, oclKernel, 1, NULL, &globalWorkSize, &localWorkSize, 0, NULL, NULL);
-    if (result != CL_SUCCESS)
-    {
-        printf("error>> clEnqueueNDRangeKernel() Failed : %d. Terminating Now ...\n", result);
-        cleanup();
-        exit(EXIT_FAILURE);
-    }
+        // set 0 based 1st argument i.e deviceInpu2
+        result = clSetKernelArg(oclKernel, 1, sizeof(cl_mem), (void *)&deviceInput2);
+        if (result != CL_SUCCESS)
+        {
+            printf("error>> clSetKernelArg() Failed For 2nd Argument : %d. Terminating Now ...\n", result);
+            cleanup();
+            exit(EXIT_FAILURE);
+        }
 
-    // finish OpenCL command queue
-    clFinish(oclCommandQueue);
+        // set 0 based 2nd argument i.e deviceOutput
+        result = clSetKernelArg(oclKernel, 2, sizeof(cl_mem), (void *)&deviceOutput);
+        if (result != CL_SUCCESS)
+        {
+            printf("error>> clSetKernelArg() Failed For 3rd Argument : %d. Terminating Now ...\n", result);
+            cleanup();
+            exit(EXIT_FAILURE);
+        }
 
-    // stop timer
-    sdkStopTimer(&timer);
-    timeOnGPU = sdkGetTimerValue(&timer);
-    sdkDeleteTimer(&timer);
-    timer = NULL;
+        // set 0 based 3rd argument i.e length
+        cl_int length = (cl_int)iNumberOfArrayElements;
+        result = clSetKernelArg(oclKernel, 3, sizeof(cl_int), (void *)&length);
+        if (result != CL_SUCCESS)
+        {
+            printf("error>> clSetKernelArg() Failed For 4th Argument : %d. Terminating Now ...\n", result);
+            cleanup();
+            exit(EXIT_FAILURE);
+        }
 
-    // read back result from the device (i.e from deviceOutput) into cpu variable (i.e hostOutput)
-    result = clEnqueueReadBuffer(oclCommandQueue, deviceOutput, CL_TRUE, 0, size, hostOutput, 0, NULL, NULL);
-    if (result != CL_SUCCESS)
-    {
-        printf("error>> clEnqueueReadBuffer() Failed : %d. Terminating Now ...\n", result);
-        cleanup();
-        exit(EXIT_FAILURE);
+        // start timer covering the transfers too
+        traceSlice = traceBegin(&traceLog, "GPU Vector Addition", "gpu");
+        StopWatchInterface *transferTimer = NULL;
+        sdkCreateTimer(&transferTimer);
+        sdkStartTimer(&transferTimer);
+
+        if (bDeviceFill == true)
+        {
+            // generate the same streams in place on the device instead of uploading them
+            fillDeviceInputs();
+        }
+        else
+        {
+            // write above "input" device buffer to device memory
+            result = clEnqueueWriteBuffer(oclCommandQueue, deviceInput1, CL_FALSE, 0, size, hostInput1, 0, NULL, profileEvent(&profileLog, "Write Input1", PROFILE_PHASE_H2D));
+            if (result != CL_SUCCESS)
+            {
+                printf("error>> clEnqueueWriteBuffer() Failed For 1st Input Device Buffer : %d. Terminating Now ...\n", result);
+                cleanup();
+                exit(EXIT_FAILURE);
+            }
+
+            result = clEnqueueWriteBuffer(oclCommandQueue, deviceInput2, CL_FALSE, 0, size, hostInput2, 0, NULL, profileEvent(&profileLog, "Write Input2", PROFILE_PHASE_H2D));
+            if (result != CL_SUCCESS)
+            {
+                printf("error>> clEnqueueWriteBuffer() Failed For 2nd Input Device Buffer : %d. Terminating Now ...\n", result);
+                cleanup();
+                exit(EXIT_FAILURE);
+            }
+        }
+
+        globalWorkSize = globalWorkSizeForKernelVariant(kernelVariant, localWorkSize, iNumberOfArrayElements);
+
+        // the kernel time is START -> END of its event, without the host enqueue overhead
+        cl_event *kernelEvent = profileEvent(&profileLog, kernelVariantNames[kernelVariant], PROFILE_PHASE_KERNEL);
+        result = clEnqueueNDRangeKernel(oclCommandQueue, oclKernel, 1, NULL, &globalWorkSize, &localWorkSize, 0, NULL, kernelEvent);
+        if (result != CL_SUCCESS)
+        {
+            printf("error>> clEnqueueNDRangeKernel() Failed : %d. Terminating Now ...\n", result);
+            cleanup();
+            exit(EXIT_FAILURE);
+        }
+
+        // read back result from the device (i.e from deviceOutput) into cpu variable (i.e hostOutput)
+        result = clEnqueueReadBuffer(oclCommandQueue, deviceOutput, CL_TRUE, 0, size, hostOutput, 0, NULL, profileEvent(&profileLog, "Read Output", PROFILE_PHASE_D2H));
+        if (result != CL_SUCCESS)
+        {
+            printf("error>> clEnqueueReadBuffer() Failed : %d. Terminating Now ...\n", result);
+            cleanup();
+            exit(EXIT_FAILURE);
+        }
+
+        // stop timer
+        sdkStopTimer(&transferTimer);
+        traceEnd(&traceLog, traceSlice);
+        timeOnGPUWithTransfers = sdkGetTimerValue(&transferTimer);
+        sdkDeleteTimer(&transferTimer);
+        transferTimer = NULL;
+
+        timeOnGPU = (kernelEvent != NULL) ? profileEventTime(*kernelEvent) : 0.0f;
     }
 
     // vector addition on host
     vecAddCPU(hostInput1, hostInput2, gold, iNumberOfArrayElements);
+    vecAddCPUParallel(hostInput1, hostInput2, goldParallel, iNumberOfArrayElements);
 
-    // comparison
+    // comparison on all host threads, the first mismatches are reported with their indices
+    // (one rounded addition per element either way, so the SIMD path must match the scalar one exactly)
     const float epsilon = 0.000001f;
-    int breakValue = -1;
-    bool bAccuracy = true;
-    int index;
-    for (index = 0; index < iNumberOfArrayElements; index++)
+    traceSlice = traceBegin(&traceLog, "verifyArrays", "host");
+    VerifyReport parallelReport = verifyArrays(goldParallel, gold, iNumberOfArrayElements, 0.0f, 0, numberOfCPUThreads);
+    VerifyReport verifyReport = verifyArrays(hostOutput, gold, iNumberOfArrayElements, epsilon, 0, numberOfCPUThreads);
+    traceEnd(&traceLog, traceSlice);
+    bool bAccuracy = ((verifyReport.numberOfMismatches == 0) && (parallelReport.numberOfMismatches == 0));
+
+    char stringMessage[160];
+    if (parallelReport.numberOfMismatches != 0)
     {
-        float val1 = gold[index];
-        float val2 = hostOutput[index];
-
-        if (fabs(val1 - val2) > epsilon)
-        {
-            bAccuracy = false;
-            breakValue = index;
-            break;
-        }
+        sprintf(stringMessage, "# Scalar And %u Thread %s CPU Vector Addition Differ At Array Index %zu", numberOfCPUThreads, getCPUSimdName(cpuSimdLevel), parallelReport.mismatchIndices[0]);
     }
-
-    char stringMessage[125];
-    if (bAccuracy == false)
+    else if (bAccuracy == false)
     {
-        sprintf(stringMessage, "%s", "# Comparison Of CPU And GPU Vector Addition Is Not With Accuracy Of Limit Of 0.000001 At Array Index %d", breakValue);
+        sprintf(stringMessage, "# Comparison Of CPU And GPU Vector Addition Is Not With Accuracy Of Limit Of 0.000001 At Array Index %zu", verifyReport.mismatchIndices[0]);
     }
     else
     {
@@ -316,12 +721,50 @@ int main(void)
     printf("+ DISPLAYING THE RESULT OF ADDITION FROM DEVICE TO HOST +\n");
     printf("==================================================================================\n");
 
-    printf("- Array1 Begins From 0th Index %0.6f To %dth Index %0.6f\n", hostInput1[0], (iNumberOfArrayElements - 1), hostInput1[iNumberOfArrayElements - 1]);
-    printf("- Array2 Begins From 0th Index %0.6f To %dth Index %0.6f\n\n", hostInput2[0], (iNumberOfArrayElements - 1), hostInput2[iNumberOfArrayElements - 1]);
-    printf("- OpenCL Kernel Global Work Size = %zu And Local Work Size = %zu\n\n", globalWorkSize, localWorkSize);
-    printf("- Output Array Begins From 0th Index %0.6f To %dth Index %0.6f\n\n", hostOutput[0], (iNumberOfArrayElements - 1), hostOutput[iNumberOfArrayElements - 1]);
+    printf("- Array1 Begins From 0th Index %0.6f To %zuth Index %0.6f\n", hostInput1[0], (iNumberOfArrayElements - 1), hostInput1[iNumberOfArrayElements - 1]);
+    printf("- Array2 Begins From 0th Index %0.6f To %zuth Index %0.6f\n\n", hostInput2[0], (iNumberOfArrayElements - 1), hostInput2[iNumberOfArrayElements - 1]);
+    printf("- OpenCL Kernel %s%s Global Work Size = %zu And Local Work Size = %zu\n", kernelVariantNames[kernelVariant], (bSpecialize == true) ? " (Specialized)" : "", globalWorkSize, localWorkSize);
+    if (bSpecialize == true)
+        printf("- Specialized Builds : %zu (%zu Loaded From The Binary Cache), %zu Kernels Cached\n", specializationCache.numberOfBuilds, specializationCache.numberOfBinaryHits, specializationCache.kernels.size());
+    printf("\n");
+    printf("- Output Array Begins From 0th Index %0.6f To %zuth Index %0.6f\n\n", hostOutput[0], (iNumberOfArrayElements - 1), hostOutput[iNumberOfArrayElements - 1]);
+    printf("- The Time Taken To Generate Both Input Arrays On CPU With %u Threads (Philox, Seed %llu) = %0.6f (ms)\n", numberOfCPUThreads, (unsigned long long)randomSeed, timeToFillOnCPU);
+    if (bDeviceFill == true)
+        printf("- The Time Taken To Generate Both Input Arrays In Place On GPU = %0.6f (ms)\n", timeToFillOnGPU);
     printf("- The Time Taken To Do Above Addition On CPU = %0.6f (ms)\n", timeOnCPU);
-    printf("- The Time Taken To Do Above Addition On GPU = %0.6f (ms)\n", timeOnGPU);
+    printf("- The Time Taken To Do Above Addition On CPU With %u Threads (%s) = %0.6f (ms), %zu Of %zu Elements Differ From The Scalar Result\n", numberOfCPUThreads, getCPUSimdName(cpuSimdLevel), timeOnCPUParallel,
+           parallelReport.numberOfMismatches, iNumberOfArrayElements);
+    if (bStreaming == true)
+    {
+        // 2 arrays up, 1 array down
+        double streamedGigaBytes = (3.0 * (double)iNumberOfArrayElements * sizeof(cl_float)) / 1.0e9;
+
+        printf("- Streamed In %zu Chunks Of %zu Elements Through %d Buffer Sets On 3 Command Queues\n", (iNumberOfArrayElements + streamChunkElements - 1) / streamChunkElements, streamChunkElements, streamBufferCount);
+        printf("- The Time Taken To Do Above Addition On GPU (Upload + Kernel + Readback) = %0.6f (ms)\n", timeOnGPU);
+        printf("- End-To-End Throughput = %0.3f (GB/s), %0.3f (Million Elements/s)\n", streamedGigaBytes / (timeOnGPU / 1000.0), ((double)iNumberOfArrayElements / 1.0e6) / (timeOnGPU / 1000.0));
+    }
+    else
+    {
+        const char *hostMemoryModeName[] = {"Explicit Copies", "Mapped CL_MEM_ALLOC_HOST_PTR", "Mapped CL_MEM_USE_HOST_PTR"};
+
+        printf("- The Time Taken To Do Above Addition On GPU (Kernel START -> END) = %0.6f (ms)\n", timeOnGPU);
+        if (bDeviceFill == true)
+            printf("- The Time Taken To Do Above Addition On GPU Including Input Generation And Readback = %0.6f (ms)\n", timeOnGPUWithTransfers);
+        else
+            printf("- The Time Taken To Do Above Addition On GPU Including Host <-> Device Transfers (%s) = %0.6f (ms)\n", hostMemoryModeName[hostMemoryMode], timeOnGPUWithTransfers);
+    }
+    printf("- GPU Speedup Over Scalar CPU = %0.2fx, Over %u Thread %s CPU = %0.2fx\n\n", timeOnCPU / timeOnGPU, numberOfCPUThreads, getCPUSimdName(cpuSimdLevel), timeOnCPUParallel / timeOnGPU);
+    printProfileLog(&profileLog);
+    if (traceLog.path != NULL)
+    {
+        traceAddProfileLog(&traceLog, &profileLog);
+        if (writeTrace(&traceLog, "VecAdd") == true)
+            printf("- Trace Written To %s (Open In ui.perfetto.dev Or chrome://tracing)\n", traceLog.path);
+        else
+            printf("- Trace Could Not Be Written To %s\n", traceLog.path);
+    }
+    printf("\n");
+    printVerifyReport(&verifyReport, hostOutput, gold);
     printf("%s\n", stringMessage);
     printf("==================================================================================\n");
 
@@ -334,14 +777,93 @@ int main(void)
 // cleanup() definition
 void cleanup(void)
 {
+    // local function declaration
+    void freeHostArray(void *);
+
     // code
     // OpenCL cleanup
-    if (oclSourceCode)
+    releaseProfileLog(&profileLog);
+
+    if (bDeviceBuffersMapped == true)
+    {
+        // hand the zero-copy host arrays back before their buffers go away
+        clEnqueueUnmapMemObject(oclCommandQueue, deviceInput1, hostInput1, 0, NULL, NULL);
+        clEnqueueUnmapMemObject(oclCommandQueue, deviceInput2, hostInput2, 0, NULL, NULL);
+        clEnqueueUnmapMemObject(oclCommandQueue, deviceOutput, hostOutput, 0, NULL, NULL);
+        clFinish(oclCommandQueue);
+        bDeviceBuffersMapped = false;
+    }
+
+    if (hostMemoryMode == HOST_MEMORY_ALLOC_HOST_PTR)
+    {
+        // these were mapped pointers owned by the OpenCL runtime
+        hostInput1 = NULL;
+        hostInput2 = NULL;
+        hostOutput = NULL;
+    }
+
+    for (int slot = 0; slot < MAX_STREAM_BUFFERS; slot++)
+    {
+        if (oclStreamReadEvents[slot])
+        {
+            clReleaseEvent(oclStreamReadEvents[slot]);
+            oclStreamReadEvents[slot] = NULL;
+        }
+
+        if (oclStreamKernelEvents[slot])
+        {
+            clReleaseEvent(oclStreamKernelEvents[slot]);
+            oclStreamKernelEvents[slot] = NULL;
+        }
+
+        if (oclStreamWriteEvents[slot])
+        {
+            clReleaseEvent(oclStreamWriteEvents[slot]);
+            oclStreamWriteEvents[slot] = NULL;
+        }
+
+        if (deviceStreamOutput[slot])
+        {
+            clReleaseMemObject(deviceStreamOutput[slot]);
+            deviceStreamOutput[slot] = NULL;
+        }
+
+        if (deviceStreamInput2[slot])
+        {
+            clReleaseMemObject(deviceStreamInput2[slot]);
+            deviceStreamInput2[slot] = NULL;
+        }
+
+        if (deviceStreamInput1[slot])
+        {
+            clReleaseMemObject(deviceStreamInput1[slot]);
+            deviceStreamInput1[slot] = NULL;
+        }
+    }
+
+    for (int queueIndex = 0; queueIndex < 3; queueIndex++)
+    {
+        if (oclStreamQueues[queueIndex])
+        {
+            clReleaseCommandQueue(oclStreamQueues[queueIndex]);
+            oclStreamQueues[queueIndex] = NULL;
+        }
+    }
+
+    if (oclRandomKernel)
+    {
+        clReleaseKernel(oclRandomKernel);
+        oclRandomKernel = NULL;
+    }
+
+    if (oclRandomProgram)
     {
-        free((void *)oclSourceCode);
-        oclSourceCode = NULL;
+        clReleaseProgram(oclRandomProgram);
+        oclRandomProgram = NULL;
     }
 
+    releaseSpecializationCache(&specializationCache);
+
     if (oclKernel)
     {
         clReleaseKernel(oclKernel);
@@ -386,6 +908,12 @@ void cleanup(void)
     }
 
     // free allocated host memory
+    if (goldParallel)
+    {
+        free(goldParallel);
+        goldParallel = NULL;
+    }
+
     if (gold)
     {
         free(gold);
@@ -394,53 +922,572 @@ void cleanup(void)
 
     if (hostOutput)
     {
-        free(hostOutput);
+        freeHostArray(hostOutput);
         hostOutput = NULL;
     }
 
     if (hostInput2)
     {
-        free(hostInput2);
+        freeHostArray(hostInput2);
         hostInput2 = NULL;
     }
 
     if (hostInput1)
     {
-        free(hostInput1);
+        freeHostArray(hostInput1);
         hostInput1 = NULL;
     }
 }
 
-// fillArrayWithRandomNumbers() definition
-void fillArrayWithRandomNumbers(float *pFloatArray, int iSize)
+// allocateHostArray() definition
+void *allocateHostArray(size_t size)
 {
+    // local function declaration
+    void firstTouchHostArray(void *, size_t);
+
+    // local variable declaration
+    void *ptr = NULL;
+
     // code
-    int index;
-    const float fScale = 1.0f / (float)RAND_MAX;
-    for (index = 0; index < iSize; index++)
+    if (hostMemoryMode == HOST_MEMORY_USE_HOST_PTR)
+    {
+        // zero-copy wrapping needs a page aligned pointer and a size in whole cache lines
+        size_t alignedSize = (size + 63) & ~(size_t)63;
+#if defined(WIN32) || defined(_WIN32) || defined(WIN64) || defined(_WIN64)
+        ptr = _aligned_malloc(alignedSize, 4096);
+#else
+        if (posix_memalign(&ptr, 4096, alignedSize) != 0)
+            ptr = NULL;
+#endif
+    }
+    else
     {
-        pFloatArray[index] = fScale * rand();
+        ptr = malloc(size);
     }
+
+    if (ptr != NULL)
+        firstTouchHostArray(ptr, size);
+
+    return (ptr);
 }
 
-// roundGlobalSizeToNearestMultipleOfLocalSize() definition
-size_t roundGlobalSizeToNearestMultipleOfLocalSize(int local_size, unsigned int global_size)
+// firstTouchHostArray() definition
+void firstTouchHostArray(void *ptr, size_t size)
 {
     // code
-    unsigned int r = global_size % local_size;
-
-    if (r == 0)
-        return (global_size);
-    else
-        return (global_size + local_size - r);
+    // the OS places a page on the NUMA node of the processor that first writes it, and parallelFor() runs
+    // range i on a worker pinned to processor i, so touch the array with the same partitioning
+    // vecAddCPUParallel() uses for its part of the work
+    char *bytes = (char *)ptr;
+    parallelFor(size / sizeof(float), HOST_PAGE_ELEMENTS, numberOfCPUThreads, [bytes](size_t begin, size_t end, unsigned int) {
+        memset(bytes + begin * sizeof(float), 0, (end - begin) * sizeof(float));
+    });
+    memset(bytes + (size / sizeof(float)) * sizeof(float), 0, size % sizeof(float));
+}
+
+// freeHostArray() definition
+void freeHostArray(void *ptr)
+{
+    // code
+#if defined(WIN32) || defined(_WIN32) || defined(WIN64) || defined(_WIN64)
+    if (hostMemoryMode == HOST_MEMORY_USE_HOST_PTR)
+    {
+        _aligned_free(ptr);
+        return;
+    }
+#endif
+    free(ptr);
+}
+
+// fillHostInputs() definition
+void fillHostInputs(void)
+{
+    // code
+    // counter-based, so every thread generates its own part of the arrays with the same
+    // partitioning as vecAddCPUParallel(), and -devicefill reproduces the values on the device
+    int traceSlice = traceBegin(&traceLog, "fillHostInputs", "host");
+    StopWatchInterface *timer = NULL;
+    sdkCreateTimer(&timer);
+    sdkStartTimer(&timer);
+
+    fillRandomUniformCPU(hostInput1, iNumberOfArrayElements, randomSeed, 0, 0.0f, 1.0f, numberOfCPUThreads);
+    fillRandomUniformCPU(hostInput2, iNumberOfArrayElements, randomSeed, 1, 0.0f, 1.0f, numberOfCPUThreads);
+
+    sdkStopTimer(&timer);
+    traceEnd(&traceLog, traceSlice);
+    timeToFillOnCPU = sdkGetTimerValue(&timer);
+    sdkDeleteTimer(&timer);
+    timer = NULL;
+}
+
+// buildRandomProgram() definition
+void buildRandomProgram(void)
+{
+    // local function declaration
+    void cleanup(void);
+
+    // local variable declaration
+    cl_int result;
+
+    // code
+    int traceSlice = traceBegin(&traceLog, "clBuildProgram Random", "setup");
+    oclRandomProgram = buildProgramWithCache(oclContext, oclDeviceID, oclRandomSourceCode, NULL, &result, NULL);
+    if (oclRandomProgram == NULL)
+    {
+        printf("error>> clCreateProgramWithSource() Failed For Random Program : %d. Terminating Now ...\n", result);
+        cleanup();
+        exit(EXIT_FAILURE);
+    }
+
+    if (result != CL_SUCCESS)
+    {
+        size_t len;
+        char buffer[2048];
+        clGetProgramBuildInfo(oclRandomProgram, oclDeviceID, CL_PROGRAM_BUILD_LOG, sizeof(buffer), buffer, &len);
+        printf("OpenCL Program Build Log : %s\n", buffer);
+        printf("error>> clBuildProgram() Failed For Random Program : %d. Terminating Now ...\n", result);
+        cleanup();
+        exit(EXIT_FAILURE);
+    }
+
+    oclRandomKernel = clCreateKernel(oclRandomProgram, "fillRandomUniformGPU", &result);
+    if (result != CL_SUCCESS)
+    {
+        printf("error>> clCreateKernel() Failed For fillRandomUniformGPU : %d. Terminating Now ...\n", result);
+        cleanup();
+        exit(EXIT_FAILURE);
+    }
+    traceEnd(&traceLog, traceSlice);
+}
+
+// fillDeviceInputs() definition
+void fillDeviceInputs(void)
+{
+    // local function declaration
+    void cleanup(void);
+
+    // local variable declaration
+    const cl_float low = 0.0f;
+    const cl_float high = 1.0f;
+    cl_int result;
+
+    // code
+    int traceSlice = traceBegin(&traceLog, "fillDeviceInputs", "gpu");
+    StopWatchInterface *timer = NULL;
+    sdkCreateTimer(&timer);
+    sdkStartTimer(&timer);
+
+    result = enqueueFillRandomGPU(oclCommandQueue, oclRandomKernel, deviceInput1, iNumberOfArrayElements, randomSeed, 0, &low, &high, sizeof(cl_float),
+                                  profileEvent(&profileLog, "fillRandomUniformGPU Input1", PROFILE_PHASE_KERNEL));
+    if (result == CL_SUCCESS)
+        result = enqueueFillRandomGPU(oclCommandQueue, oclRandomKernel, deviceInput2, iNumberOfArrayElements, randomSeed, 1, &low, &high, sizeof(cl_float),
+                                      profileEvent(&profileLog, "fillRandomUniformGPU Input2", PROFILE_PHASE_KERNEL));
+    if (result != CL_SUCCESS)
+    {
+        printf("error>> enqueueFillRandomGPU() Failed : %d. Terminating Now ...\n", result);
+        cleanup();
+        exit(EXIT_FAILURE);
+    }
+    clFinish(oclCommandQueue);
+
+    sdkStopTimer(&timer);
+    traceEnd(&traceLog, traceSlice);
+    timeToFillOnGPU = sdkGetTimerValue(&timer);
+    sdkDeleteTimer(&timer);
+    timer = NULL;
+}
+
+// checkRandomStreams() definition
+void checkRandomStreams(void)
+{
+    // local function declaration
+    void cleanup(void);
+
+    // local variable declaration
+    // every distribution the generators offer, on streams of its own so no two rows share values
+    const char *distributionNames[] = {"Uniform [-1, 1)", "Normal (0, 1)", "Integer [-1000, 1000]", "Integer [INT_MIN, INT_MAX - 1]"};
+    const char *kernelNames[] = {"fillRandomUniformGPU", "fillRandomNormalGPU", "fillRandomIntegerGPU", "fillRandomIntegerGPU"};
+    const cl_float floatParameters[][2] = {{-1.0f, 1.0f}, {0.0f, 1.0f}, {0.0f, 0.0f}, {0.0f, 0.0f}};
+    const cl_int integerParameters[][2] = {{0, 0}, {0, 0}, {-1000, 1000}, {INT_MIN, INT_MAX - 1}};
+    const size_t count = iNumberOfArrayElements;
+    size_t totalMismatches = 0;
+    cl_int result = CL_SUCCESS;
+
+    // code
+    // 4 byte elements either way, float or cl_int
+    cl_uint *hostValues = (cl_uint *)malloc(count * sizeof(cl_uint));
+    cl_uint *deviceValues = (cl_uint *)malloc(count * sizeof(cl_uint));
+    cl_mem deviceRandom = clCreateBuffer(oclContext, CL_MEM_WRITE_ONLY, count * sizeof(cl_uint), NULL, &result);
+    if ((hostValues == NULL) || (deviceValues == NULL) || (result != CL_SUCCESS))
+    {
+        printf("error>> Memory Allocation Failed For The Random Stream Check : %d. Terminating Now ...\n", result);
+        if (deviceRandom)
+            clReleaseMemObject(deviceRandom);
+        free(deviceValues);
+        free(hostValues);
+        cleanup();
+        exit(EXIT_FAILURE);
+    }
+
+    printf("\n==================================================================================\n");
+    printf("+ HOST AND DEVICE PHILOX STREAMS OF SEED %llu, %zu ELEMENTS EACH +\n", (unsigned long long)randomSeed, count);
+    printf("==================================================================================\n");
+    printf("  %-32s %-22s %12s   %s\n", "Distribution", "Kernel", "Mismatched", "Largest Difference");
+
+    for (int row = 0; row < 4; row++)
+    {
+        cl_uint stream = 2 + row; // VecAdd's inputs are streams 0 and 1
+        bool bNormal = (row == 1);
+        bool bInteger = (row >= 2);
+
+        if (bInteger == true)
+            fillRandomIntegerCPU((cl_int *)hostValues, count, randomSeed, stream, integerParameters[row][0], integerParameters[row][1], numberOfCPUThreads);
+        else if (bNormal == true)
+            fillRandomNormalCPU((float *)hostValues, count, randomSeed, stream, floatParameters[row][0], floatParameters[row][1], numberOfCPUThreads);
+        else
+            fillRandomUniformCPU((float *)hostValues, count, randomSeed, stream, floatParameters[row][0], floatParameters[row][1], numberOfCPUThreads);
+
+        cl_kernel kernel = clCreateKernel(oclRandomProgram, kernelNames[row], &result);
+        if (result == CL_SUCCESS)
+        {
+            if (bInteger == true)
+                result = enqueueFillRandomGPU(oclCommandQueue, kernel, deviceRandom, count, randomSeed, stream, &integerParameters[row][0], &integerParameters[row][1], sizeof(cl_int), NULL);
+            else
+                result = enqueueFillRandomGPU(oclCommandQueue, kernel, deviceRandom, count, randomSeed, stream, &floatParameters[row][0], &floatParameters[row][1], sizeof(cl_float), NULL);
+            clReleaseKernel(kernel);
+        }
+        if (result == CL_SUCCESS)
+            result = clEnqueueReadBuffer(oclCommandQueue, deviceRandom, CL_TRUE, 0, count * sizeof(cl_uint), deviceValues, 0, NULL, NULL);
+        if (result != CL_SUCCESS)
+        {
+            printf("error>> %s Failed : %d. Terminating Now ...\n", kernelNames[row], result);
+            clReleaseMemObject(deviceRandom);
+            free(deviceValues);
+            free(hostValues);
+            cleanup();
+            exit(EXIT_FAILURE);
+        }
+
+        // uniform and integer values must be bit identical, normal values may differ by the precision of the
+        // device's log / sin / cos, counted in ulp of the larger of the value and the standard deviation
+        // (values next to the mean come out of cancellation, where the ulp of the value itself means nothing)
+        size_t mismatches = 0;
+        double largestDifference = 0.0;
+        for (size_t index = 0; index < count; index++)
+        {
+            if (bNormal == false)
+            {
+                if (hostValues[index] != deviceValues[index])
+                    mismatches++;
+                continue;
+            }
+
+            float hostValue = ((float *)hostValues)[index];
+            float deviceValue = ((float *)deviceValues)[index];
+            float scale = (fabsf(hostValue) > floatParameters[row][1]) ? fabsf(hostValue) : floatParameters[row][1];
+            double ulps = fabs((double)hostValue - (double)deviceValue) / (double)(nextafterf(scale, INFINITY) - scale);
+            if ((ulps > RANDOM_NORMAL_MAX_ULP) || (ulps != ulps))
+                mismatches++;
+            if (ulps > largestDifference)
+                largestDifference = ulps;
+        }
+        totalMismatches += mismatches;
+
+        if (bNormal == true)
+            printf("  %-32s %-22s %12zu   %.1f ulp (Limit %d)\n", distributionNames[row], kernelNames[row], mismatches, largestDifference, RANDOM_NORMAL_MAX_ULP);
+        else
+            printf("  %-32s %-22s %12zu   Bitwise\n", distributionNames[row], kernelNames[row], mismatches);
+    }
+
+    printf("\n%s\n", (totalMismatches == 0) ? "# Host And Device Streams Are Identical." : "# Host And Device Streams Differ.");
+    printf("==================================================================================\n");
+
+    clReleaseMemObject(deviceRandom);
+    free(deviceValues);
+    free(hostValues);
+}
+
+// tuneLocalWorkSize() definition
+size_t tuneLocalWorkSize(size_t problemElements)
+{
+    // local function declaration
+    size_t globalWorkSizeForKernelVariant(int, size_t, size_t);
+    void cleanup(void);
+
+    // local variable declaration
+    char key[TUNE_KEY_LENGTH];
+    size_t local[3];
+    cl_mem sampleBuffers[3] = {NULL, NULL, NULL};
+    cl_int result;
+
+    // code
+    // time the candidates on a sample of the launch, large enough to be bandwidth bound
+    size_t sampleElements = problemElements;
+    if (sampleElements > 4194304)
+        sampleElements = 4194304;
+    size_t sampleSize = sampleElements * sizeof(cl_float);
+    cl_int length = (cl_int)sampleElements;
+    cl_float zero = 0.0f;
+
+    for (int bufferIndex = 0; bufferIndex < 3; bufferIndex++)
+    {
+        sampleBuffers[bufferIndex] = clCreateBuffer(oclContext, CL_MEM_READ_WRITE, sampleSize, NULL, &result);
+        if (result == CL_SUCCESS)
+            result = clEnqueueFillBuffer(oclCommandQueue, sampleBuffers[bufferIndex], &zero, sizeof(zero), 0, sampleSize, 0, NULL, NULL);
+        if (result != CL_SUCCESS)
+        {
+            printf("error>> Creating Work-Group Tuning Sample Buffers Failed : %d. Terminating Now ...\n", result);
+            for (int index = 0; index < 3; index++)
+            {
+                if (sampleBuffers[index])
+                    clReleaseMemObject(sampleBuffers[index]);
+            }
+            cleanup();
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    result = clSetKernelArg(oclKernel, 0, sizeof(cl_mem), (void *)&sampleBuffers[0]);
+    result |= clSetKernelArg(oclKernel, 1, sizeof(cl_mem), (void *)&sampleBuffers[1]);
+    result |= clSetKernelArg(oclKernel, 2, sizeof(cl_mem), (void *)&sampleBuffers[2]);
+    result |= clSetKernelArg(oclKernel, 3, sizeof(cl_int), (void *)&length);
+    if (result != CL_SUCCESS)
+    {
+        printf("error>> clSetKernelArg() Failed For Work-Group Tuning : %d. Terminating Now ...\n", result);
+        for (int index = 0; index < 3; index++)
+            clReleaseMemObject(sampleBuffers[index]);
+        cleanup();
+        exit(EXIT_FAILURE);
+    }
+
+    // the key covers the whole program source, so editing any variant invalidates the entries
+    tuneCacheKey(oclDeviceID, oclSourceCode, NULL, kernelVariantNames[kernelVariant], problemElements, key);
+
+    // the grid-stride variants need an explicit local size to size the grid, so the runtime's choice is skipped
+    bool bCached = autotuneWorkGroupSize(TUNE_CACHE_FILE, bRetune, key, oclCommandQueue, oclDeviceID, oclKernel, 1,
+                                         [=](const size_t *candidateLocal, size_t *global) {
+                                             if (candidateLocal[0] == 0)
+                                                 return (false);
+                                             global[0] = globalWorkSizeForKernelVariant(kernelVariant, candidateLocal[0], sampleElements);
+                                             return (true);
+                                         },
+                                         local);
+
+    for (int bufferIndex = 0; bufferIndex < 3; bufferIndex++)
+        clReleaseMemObject(sampleBuffers[bufferIndex]);
+
+    if (local[0] == 0)
+    {
+        printf("error>> No Work-Group Size Could Be Launched For %s. Terminating Now ...\n", kernelVariantNames[kernelVariant]);
+        cleanup();
+        exit(EXIT_FAILURE);
+    }
+
+    if (bCached == true)
+        printf("info>> Work-Group Size %zu From %s\n", local[0], TUNE_CACHE_FILE);
+    else
+        printf("info>> Using Work-Group Size %zu, Stored In %s\n", local[0], TUNE_CACHE_FILE);
+
+    return (local[0]);
+}
+
+// specializeKernelVariant() definition
+cl_kernel specializeKernelVariant(size_t elements, size_t localWorkSize)
+{
+    // local function declaration
+    size_t globalWorkSizeForKernelVariant(int, size_t, size_t);
+
+    // local variable declaration
+    char options[SPECIALIZE_OPTIONS_LENGTH] = "";
+    bool bBuilt = false;
+    cl_int result;
+
+    // code
+    if (bSpecialize == false)
+        return (NULL);
+
+    // the launch of elements with this local size, the same shape reuses the build
+    size_t globalWorkSize = globalWorkSizeForKernelVariant(kernelVariant, localWorkSize, elements);
+    specializeDefine(options, "FIXED_LENGTH", (long long)elements);
+    specializeDefine(options, "FIXED_GLOBAL_SIZE", (long long)globalWorkSize);
+    specializeDefine(options, "FIXED_LOCAL_SIZE", (long long)localWorkSize);
+
+    int traceSlice = traceBegin(&traceLog, "specializeKernelVariant", "setup");
+    cl_kernel kernel = specializedKernel(&specializationCache, oclContext, oclDeviceID, oclSourceCode, kernelVariantNames[kernelVariant], options, &result, &bBuilt);
+    traceEnd(&traceLog, traceSlice);
+
+    if (kernel == NULL)
+    {
+        // not fatal, the generic kernel runs every shape
+        printf("info>> Specialized %s Could Not Be Built : %d, Using The Generic Kernel.\n", kernelVariantNames[kernelVariant], result);
+        bSpecialize = false;
+        return (NULL);
+    }
+
+    if (bBuilt == true)
+        printf("info>> Specialized %s Built With %s\n", kernelVariantNames[kernelVariant], options);
+
+    return (kernel);
+}
+
+// roundGlobalSizeToNearestMultipleOfLocalSize() definition
+size_t roundGlobalSizeToNearestMultipleOfLocalSize(int local_size, size_t global_size)
+{
+    // code
+    size_t r = global_size % local_size;
+
+    if (r == 0)
+        return (global_size);
+    else
+        return (global_size + local_size - r);
+}
+
+// globalWorkSizeForKernelVariant() definition
+size_t globalWorkSizeForKernelVariant(int variant, size_t localWorkSize, size_t elements)
+{
+    // local function declaration
+    size_t roundGlobalSizeToNearestMultipleOfLocalSize(int, size_t);
+
+    // code
+    if (variant == 0)
+        return (roundGlobalSizeToNearestMultipleOfLocalSize((int)localWorkSize, elements));
+
+    // each work-item strides over vectorsPerWorkItem vectors, at least one work-item per tail element
+    size_t workItems = elements / kernelVariantWidths[variant];
+    workItems = (workItems + vectorsPerWorkItem - 1) / vectorsPerWorkItem;
+    if (workItems < kernelVariantWidths[variant])
+        workItems = kernelVariantWidths[variant];
+
+    return (roundGlobalSizeToNearestMultipleOfLocalSize((int)localWorkSize, workItems));
+}
+
+// selectKernelVariant() definition
+int selectKernelVariant(size_t localWorkSize)
+{
+    // local function declaration
+    size_t globalWorkSizeForKernelVariant(int, size_t, size_t);
+    void cleanup(void);
+
+    // local variable declaration
+    cl_uint preferredVectorWidth = 1;
+    int preferredVariant = 1;
+    int bestVariant = 0;
+    double throughput[NUMBER_OF_KERNEL_VARIANTS] = {0.0};
+    cl_mem sampleBuffers[3] = {NULL, NULL, NULL};
+    const int numberOfRuns = 10;
+    cl_int result;
+
+    // code
+    if (kernelVariant != KERNEL_VARIANT_AUTO)
+        return (kernelVariant);
+
+    clGetDeviceInfo(oclDeviceID, CL_DEVICE_PREFERRED_VECTOR_WIDTH_FLOAT, sizeof(preferredVectorWidth), &preferredVectorWidth, NULL);
+    for (int variant = 1; variant < NUMBER_OF_KERNEL_VARIANTS; variant++)
+    {
+        if (kernelVariantWidths[variant] == preferredVectorWidth)
+            preferredVariant = variant;
+    }
+
+    // time every variant on the same sample, large enough to be bandwidth bound
+    size_t sampleElements = iNumberOfArrayElements;
+    if (sampleElements > 4194304)
+        sampleElements = 4194304;
+    size_t sampleSize = sampleElements * sizeof(cl_float);
+    cl_int length = (cl_int)sampleElements;
+    cl_float zero = 0.0f;
+
+    for (int bufferIndex = 0; bufferIndex < 3; bufferIndex++)
+    {
+        sampleBuffers[bufferIndex] = clCreateBuffer(oclContext, CL_MEM_READ_WRITE, sampleSize, NULL, &result);
+        if (result == CL_SUCCESS)
+            result = clEnqueueFillBuffer(oclCommandQueue, sampleBuffers[bufferIndex], &zero, sizeof(zero), 0, sampleSize, 0, NULL, NULL);
+        if (result != CL_SUCCESS)
+        {
+            printf("error>> Creating Kernel Variant Sample Buffers Failed : %d. Terminating Now ...\n", result);
+            for (int index = 0; index < 3; index++)
+            {
+                if (sampleBuffers[index])
+                    clReleaseMemObject(sampleBuffers[index]);
+            }
+            cleanup();
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    printf("info>> Preferred Float Vector Width Of Device = %u, Timing vecAddGPU Variants On %zu Elements :\n", preferredVectorWidth, sampleElements);
+
+    for (int variant = 0; variant < NUMBER_OF_KERNEL_VARIANTS; variant++)
+    {
+        cl_kernel kernel = clCreateKernel(oclProgram, kernelVariantNames[variant], &result);
+        if (result != CL_SUCCESS)
+        {
+            printf("info>> %-16s : clCreateKernel() Failed : %d\n", kernelVariantNames[variant], result);
+            continue;
+        }
+
+        size_t kernelWorkGroupSize = localWorkSize;
+        clGetKernelWorkGroupInfo(kernel, oclDeviceID, CL_KERNEL_WORK_GROUP_SIZE, sizeof(kernelWorkGroupSize), &kernelWorkGroupSize, NULL);
+        size_t variantLocalWorkSize = (localWorkSize > kernelWorkGroupSize) ? kernelWorkGroupSize : localWorkSize;
+        size_t variantGlobalWorkSize = globalWorkSizeForKernelVariant(variant, variantLocalWorkSize, sampleElements);
+
+        result = clSetKernelArg(kernel, 0, sizeof(cl_mem), (void *)&sampleBuffers[0]);
+        result |= clSetKernelArg(kernel, 1, sizeof(cl_mem), (void *)&sampleBuffers[1]);
+        result |= clSetKernelArg(kernel, 2, sizeof(cl_mem), (void *)&sampleBuffers[2]);
+        result |= clSetKernelArg(kernel, 3, sizeof(cl_int), (void *)&length);
+
+        // one warm-up launch outside the timer
+        if (result == CL_SUCCESS)
+            result = clEnqueueNDRangeKernel(oclCommandQueue, kernel, 1, NULL, &variantGlobalWorkSize, &variantLocalWorkSize, 0, NULL, NULL);
+        clFinish(oclCommandQueue);
+
+        StopWatchInterface *timer = NULL;
+        sdkCreateTimer(&timer);
+        sdkStartTimer(&timer);
+
+        for (int run = 0; (run < numberOfRuns) && (result == CL_SUCCESS); run++)
+            result = clEnqueueNDRangeKernel(oclCommandQueue, kernel, 1, NULL, &variantGlobalWorkSize, &variantLocalWorkSize, 0, NULL, NULL);
+        clFinish(oclCommandQueue);
+
+        sdkStopTimer(&timer);
+        float timeOnVariant = sdkGetTimerValue(&timer);
+        sdkDeleteTimer(&timer);
+        timer = NULL;
+
+        clReleaseKernel(kernel);
+
+        if (result != CL_SUCCESS)
+        {
+            printf("info>> %-16s : clEnqueueNDRangeKernel() Failed : %d\n", kernelVariantNames[variant], result);
+            continue;
+        }
+
+        // 2 arrays read, 1 array written
+        throughput[variant] = (3.0 * (double)sampleSize * numberOfRuns / 1.0e9) / (timeOnVariant / 1000.0);
+        printf("info>> %-16s : %0.3f (GB/s)\n", kernelVariantNames[variant], throughput[variant]);
+
+        if (throughput[variant] > throughput[bestVariant])
+            bestVariant = variant;
+    }
+
+    // the preferred width wins unless another variant is clearly faster
+    if (throughput[preferredVariant] * 1.05 >= throughput[bestVariant])
+        bestVariant = preferredVariant;
+
+    for (int bufferIndex = 0; bufferIndex < 3; bufferIndex++)
+        clReleaseMemObject(sampleBuffers[bufferIndex]);
+
+    printf("info>> Using %s\n", kernelVariantNames[bestVariant]);
+
+    return (bestVariant);
 }
 
 // vecAddCPU() definition
-void vecAddCPU(const float *in1, const float *in2, float *out, int iNumElements)
+void vecAddCPU(const float *in1, const float *in2, float *out, size_t iNumElements)
 {
-    int index;
+    size_t index;
 
     // start timer
+    int traceSlice = traceBegin(&traceLog, "vecAddCPU", "host");
     StopWatchInterface *timer = NULL;
     sdkCreateTimer(&timer);
     sdkStartTimer(&timer);
@@ -452,7 +1499,437 @@ void vecAddCPU(const float *in1, const float *in2, float *out, int iNumElements)
 
     // stop timer
     sdkStopTimer(&timer);
+    traceEnd(&traceLog, traceSlice);
     timeOnCPU = sdkGetTimerValue(&timer);
     sdkDeleteTimer(&timer);
     timer = NULL;
 }
+
+// vecAddRangeScalar() definition
+void vecAddRangeScalar(const float *in1, const float *in2, float *out, size_t begin, size_t end)
+{
+    // code
+    for (size_t index = begin; index < end; index++)
+    {
+        out[index] = in1[index] + in2[index];
+    }
+}
+
+#if defined(HELPER_PARALLEL_X86)
+// vecAddRangeAVX2() definition
+TARGET_AVX2 void vecAddRangeAVX2(const float *in1, const float *in2, float *out, size_t begin, size_t end)
+{
+    // code
+    size_t index = begin;
+    for (; index + 8 <= end; index += 8)
+    {
+        _mm256_storeu_ps(out + index, _mm256_add_ps(_mm256_loadu_ps(in1 + index), _mm256_loadu_ps(in2 + index)));
+    }
+
+    for (; index < end; index++)
+    {
+        out[index] = in1[index] + in2[index];
+    }
+}
+
+// vecAddRangeAVX512() definition
+TARGET_AVX512 void vecAddRangeAVX512(const float *in1, const float *in2, float *out, size_t begin, size_t end)
+{
+    // code
+    size_t index = begin;
+    for (; index + 16 <= end; index += 16)
+    {
+        _mm512_storeu_ps(out + index, _mm512_add_ps(_mm512_loadu_ps(in1 + index), _mm512_loadu_ps(in2 + index)));
+    }
+
+    for (; index < end; index++)
+    {
+        out[index] = in1[index] + in2[index];
+    }
+}
+#endif
+
+// vecAddCPUParallel() definition
+void vecAddCPUParallel(const float *in1, const float *in2, float *out, size_t iNumElements)
+{
+    // local function declaration
+    void vecAddRangeScalar(const float *, const float *, float *, size_t, size_t);
+#if defined(HELPER_PARALLEL_X86)
+    void vecAddRangeAVX2(const float *, const float *, float *, size_t, size_t);
+    void vecAddRangeAVX512(const float *, const float *, float *, size_t, size_t);
+#endif
+
+    // local variable declaration
+    void (*vecAddRange)(const float *, const float *, float *, size_t, size_t) = vecAddRangeScalar;
+
+    // code
+#if defined(HELPER_PARALLEL_X86)
+    if (cpuSimdLevel == CPU_SIMD_AVX512)
+        vecAddRange = vecAddRangeAVX512;
+    else if (cpuSimdLevel == CPU_SIMD_AVX2)
+        vecAddRange = vecAddRangeAVX2;
+#endif
+
+    // start timer
+    int traceSlice = traceBegin(&traceLog, "vecAddCPUParallel", "host");
+    StopWatchInterface *timer = NULL;
+    sdkCreateTimer(&timer);
+    sdkStartTimer(&timer);
+
+    // static page aligned ranges, the pinned worker of range i works on the pages it touched first
+    parallelFor(iNumElements, HOST_PAGE_ELEMENTS, numberOfCPUThreads, [=](size_t begin, size_t end, unsigned int) {
+        vecAddRange(in1, in2, out, begin, end);
+    });
+
+    // stop timer
+    sdkStopTimer(&timer);
+    traceEnd(&traceLog, traceSlice);
+    timeOnCPUParallel = sdkGetTimerValue(&timer);
+    sdkDeleteTimer(&timer);
+    timer = NULL;
+}
+
+// clampStreamChunkElements() definition
+size_t clampStreamChunkElements(size_t requestedElements, int bufferCount)
+{
+    // local variable declaration
+    cl_ulong maxMemAllocSize = 0;
+    cl_ulong globalMemSize = 0;
+
+    // code
+    // keep every resident chunk within one allocation and all buffer sets within half of global memory
+    clGetDeviceInfo(oclDeviceID, CL_DEVICE_MAX_MEM_ALLOC_SIZE, sizeof(maxMemAllocSize), &maxMemAllocSize, NULL);
+    clGetDeviceInfo(oclDeviceID, CL_DEVICE_GLOBAL_MEM_SIZE, sizeof(globalMemSize), &globalMemSize, NULL);
+
+    cl_ulong maxChunkSize = (globalMemSize / 2) / (3 * bufferCount);
+    if (maxMemAllocSize < maxChunkSize)
+        maxChunkSize = maxMemAllocSize;
+
+    size_t chunkElements = requestedElements;
+    if (chunkElements > iNumberOfArrayElements)
+        chunkElements = iNumberOfArrayElements;
+    if (chunkElements > (size_t)(maxChunkSize / sizeof(cl_float)))
+        chunkElements = (size_t)(maxChunkSize / sizeof(cl_float));
+    if (chunkElements > INT_MAX)
+        chunkElements = INT_MAX;
+    if (chunkElements != requestedElements)
+        printf("info>> Stream Chunk Clamped To %zu Elements To Fit Device Memory.\n", chunkElements);
+
+    return (chunkElements);
+}
+
+// vecAddGPUStreaming() definition
+void vecAddGPUStreaming(size_t chunkElements, int bufferCount, size_t localWorkSize)
+{
+    // local function declaration
+    size_t globalWorkSizeForKernelVariant(int, size_t, size_t);
+    cl_kernel specializeKernelVariant(size_t, size_t);
+    void cleanup(void);
+
+    // local variable declaration
+    cl_int result;
+
+    // code
+    // chunkElements was clamped to device memory by clampStreamChunkElements()
+    size_t chunkSize = chunkElements * sizeof(cl_float);
+    size_t numberOfChunks = (iNumberOfArrayElements + chunkElements - 1) / chunkElements;
+
+    // one in-order queue per pipeline stage, so upload, kernel and readback of different chunks can overlap
+    int traceSlice = traceBegin(&traceLog, "Device Allocation", "setup");
+    for (int queueIndex = 0; queueIndex < 3; queueIndex++)
+    {
+        oclStreamQueues[queueIndex] = clCreateCommandQueue(oclContext, oclDeviceID, CL_QUEUE_PROFILING_ENABLE, &result);
+        if (result != CL_SUCCESS)
+        {
+            printf("error>> clCreateCommandQueue() Failed For Stream Queue %d : %d. Terminating Now ...\n", queueIndex, result);
+            cleanup();
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    // allocate one set of chunk buffers per pipeline slot
+    for (int slot = 0; slot < bufferCount; slot++)
+    {
+        deviceStreamInput1[slot] = clCreateBuffer(oclContext, CL_MEM_READ_ONLY, chunkSize, NULL, &result);
+        if (result != CL_SUCCESS)
+        {
+            printf("error>> clCreateBuffer() Failed For 1st Input Chunk Of Slot %d : %d. Terminating Now ...\n", slot, result);
+            cleanup();
+            exit(EXIT_FAILURE);
+        }
+
+        deviceStreamInput2[slot] = clCreateBuffer(oclContext, CL_MEM_READ_ONLY, chunkSize, NULL, &result);
+        if (result != CL_SUCCESS)
+        {
+            printf("error>> clCreateBuffer() Failed For 2nd Input Chunk Of Slot %d : %d. Terminating Now ...\n", slot, result);
+            cleanup();
+            exit(EXIT_FAILURE);
+        }
+
+        deviceStreamOutput[slot] = clCreateBuffer(oclContext, CL_MEM_WRITE_ONLY, chunkSize, NULL, &result);
+        if (result != CL_SUCCESS)
+        {
+            printf("error>> clCreateBuffer() Failed For Output Chunk Of Slot %d : %d. Terminating Now ...\n", slot, result);
+            cleanup();
+            exit(EXIT_FAILURE);
+        }
+    }
+    traceEnd(&traceLog, traceSlice);
+
+    // every chunk but the last has the same shape, so at most two specialized builds, made before the pipeline starts
+    specializeKernelVariant(chunkElements, localWorkSize);
+    if (iNumberOfArrayElements % chunkElements != 0)
+        specializeKernelVariant(iNumberOfArrayElements % chunkElements, localWorkSize);
+
+    // start timer
+    traceSlice = traceBegin(&traceLog, "vecAddGPUStreaming", "gpu");
+    StopWatchInterface *timer = NULL;
+    sdkCreateTimer(&timer);
+    sdkStartTimer(&timer);
+
+    for (size_t chunk = 0; chunk < numberOfChunks; chunk++)
+    {
+        int slot = (int)(chunk % bufferCount);
+        size_t offset = chunk * chunkElements;
+        size_t elements = iNumberOfArrayElements - offset;
+        if (elements > chunkElements)
+            elements = chunkElements;
+        size_t bytes = elements * sizeof(cl_float);
+        cl_int length = (cl_int)elements;
+        cl_event waitEvents[2];
+        cl_uint numberOfWaitEvents;
+        char eventName[PROFILE_NAME_LENGTH];
+
+        // upload : the inputs of this slot are free once the kernel of its previous chunk is done
+        numberOfWaitEvents = 0;
+        if (oclStreamKernelEvents[slot])
+            waitEvents[numberOfWaitEvents++] = oclStreamKernelEvents[slot];
+
+        sprintf(eventName, "Write Input1 Chunk %zu", chunk);
+        result = clEnqueueWriteBuffer(oclStreamQueues[0], deviceStreamInput1[slot], CL_FALSE, 0, bytes, hostInput1 + offset, numberOfWaitEvents, numberOfWaitEvents ? waitEvents : NULL,
+                                      profileEvent(&profileLog, eventName, PROFILE_PHASE_H2D));
+        if (result != CL_SUCCESS)
+        {
+            printf("error>> clEnqueueWriteBuffer() Failed For 1st Input Chunk %zu : %d. Terminating Now ...\n", chunk, result);
+            cleanup();
+            exit(EXIT_FAILURE);
+        }
+
+        if (oclStreamWriteEvents[slot])
+        {
+            clReleaseEvent(oclStreamWriteEvents[slot]);
+            oclStreamWriteEvents[slot] = NULL;
+        }
+
+        // the upload queue is in-order, so the 2nd write's event covers both inputs
+        result = clEnqueueWriteBuffer(oclStreamQueues[0], deviceStreamInput2[slot], CL_FALSE, 0, bytes, hostInput2 + offset, 0, NULL, &oclStreamWriteEvents[slot]);
+        if (result != CL_SUCCESS)
+        {
+            printf("error>> clEnqueueWriteBuffer() Failed For 2nd Input Chunk %zu : %d. Terminating Now ...\n", chunk, result);
+            cleanup();
+            exit(EXIT_FAILURE);
+        }
+        sprintf(eventName, "Write Input2 Chunk %zu", chunk);
+        profileRetainEvent(&profileLog, eventName, PROFILE_PHASE_H2D, oclStreamWriteEvents[slot]);
+
+        // kernel : needs this chunk's inputs and the readback of the slot's previous output
+        numberOfWaitEvents = 0;
+        waitEvents[numberOfWaitEvents++] = oclStreamWriteEvents[slot];
+        if (oclStreamReadEvents[slot])
+            waitEvents[numberOfWaitEvents++] = oclStreamReadEvents[slot];
+
+        // the specialized build of this chunk's shape, found in the cache after the builds above
+        cl_kernel kernel = specializeKernelVariant(elements, localWorkSize);
+        if (kernel == NULL)
+            kernel = oclKernel;
+
+        result = clSetKernelArg(kernel, 0, sizeof(cl_mem), (void *)&deviceStreamInput1[slot]);
+        result |= clSetKernelArg(kernel, 1, sizeof(cl_mem), (void *)&deviceStreamInput2[slot]);
+        result |= clSetKernelArg(kernel, 2, sizeof(cl_mem), (void *)&deviceStreamOutput[slot]);
+        result |= clSetKernelArg(kernel, 3, sizeof(cl_int), (void *)&length);
+        if (result != CL_SUCCESS)
+        {
+            printf("error>> clSetKernelArg() Failed For Chunk %zu : %d. Terminating Now ...\n", chunk, result);
+            cleanup();
+            exit(EXIT_FAILURE);
+        }
+
+        if (oclStreamKernelEvents[slot])
+        {
+            clReleaseEvent(oclStreamKernelEvents[slot]);
+            oclStreamKernelEvents[slot] = NULL;
+        }
+
+        size_t globalWorkSize = globalWorkSizeForKernelVariant(kernelVariant, localWorkSize, elements);
+        result = clEnqueueNDRangeKernel(oclStreamQueues[1], kernel, 1, NULL, &globalWorkSize, &localWorkSize, numberOfWaitEvents, waitEvents, &oclStreamKernelEvents[slot]);
+        if (result != CL_SUCCESS)
+        {
+            printf("error>> clEnqueueNDRangeKernel() Failed For Chunk %zu : %d. Terminating Now ...\n", chunk, result);
+            cleanup();
+            exit(EXIT_FAILURE);
+        }
+        sprintf(eventName, "%s Chunk %zu", kernelVariantNames[kernelVariant], chunk);
+        profileRetainEvent(&profileLog, eventName, PROFILE_PHASE_KERNEL, oclStreamKernelEvents[slot]);
+
+        // readback : straight into the chunk's place in hostOutput
+        if (oclStreamReadEvents[slot])
+        {
+            clReleaseEvent(oclStreamReadEvents[slot]);
+            oclStreamReadEvents[slot] = NULL;
+        }
+
+        result = clEnqueueReadBuffer(oclStreamQueues[2], deviceStreamOutput[slot], CL_FALSE, 0, bytes, hostOutput + offset, 1, &oclStreamKernelEvents[slot], &oclStreamReadEvents[slot]);
+        if (result != CL_SUCCESS)
+        {
+            printf("error>> clEnqueueReadBuffer() Failed For Chunk %zu : %d. Terminating Now ...\n", chunk, result);
+            cleanup();
+            exit(EXIT_FAILURE);
+        }
+        sprintf(eventName, "Read Output Chunk %zu", chunk);
+        profileRetainEvent(&profileLog, eventName, PROFILE_PHASE_D2H, oclStreamReadEvents[slot]);
+
+        // submit now so the device starts on this chunk while the next one is being enqueued
+        clFlush(oclStreamQueues[0]);
+        clFlush(oclStreamQueues[1]);
+        clFlush(oclStreamQueues[2]);
+    }
+
+    // the readback queue finishes last
+    clFinish(oclStreamQueues[0]);
+    clFinish(oclStreamQueues[1]);
+    clFinish(oclStreamQueues[2]);
+
+    // stop timer
+    sdkStopTimer(&timer);
+    traceEnd(&traceLog, traceSlice);
+    timeOnGPU = sdkGetTimerValue(&timer);
+    sdkDeleteTimer(&timer);
+    timer = NULL;
+}
+
+// vecAddGPUZeroCopy() definition
+void vecAddGPUZeroCopy(size_t globalWorkSize, size_t localWorkSize)
+{
+    // local function declaration
+    void fillHostInputs(void);
+    void cleanup(void);
+
+    // local variable declaration
+    size_t size = iNumberOfArrayElements * sizeof(cl_float);
+    cl_mem_flags hostMemoryFlag = (hostMemoryMode == HOST_MEMORY_ALLOC_HOST_PTR) ? CL_MEM_ALLOC_HOST_PTR : CL_MEM_USE_HOST_PTR;
+    cl_bool bHostUnifiedMemory = CL_FALSE;
+    cl_int length = (cl_int)iNumberOfArrayElements;
+    cl_int result;
+
+    // code
+    clGetDeviceInfo(oclDeviceID, CL_DEVICE_HOST_UNIFIED_MEMORY, sizeof(bHostUnifiedMemory), &bHostUnifiedMemory, NULL);
+    if (bHostUnifiedMemory == CL_FALSE)
+        printf("info>> Device Does Not Share Memory With The Host, Mapped Buffers May Still Be Copied By The Driver.\n");
+
+    // allocate device memory on top of host visible memory
+    int traceSlice = traceBegin(&traceLog, "Device Allocation", "setup");
+    deviceInput1 = clCreateBuffer(oclContext, CL_MEM_READ_ONLY | hostMemoryFlag, size, (hostMemoryMode == HOST_MEMORY_USE_HOST_PTR) ? hostInput1 : NULL, &result);
+    if (result != CL_SUCCESS)
+    {
+        printf("error>> clCreateBuffer() Failed For 1st Zero-Copy Input Array : %d. Terminating Now ...\n", result);
+        cleanup();
+        exit(EXIT_FAILURE);
+    }
+
+    deviceInput2 = clCreateBuffer(oclContext, CL_MEM_READ_ONLY | hostMemoryFlag, size, (hostMemoryMode == HOST_MEMORY_USE_HOST_PTR) ? hostInput2 : NULL, &result);
+    if (result != CL_SUCCESS)
+    {
+        printf("error>> clCreateBuffer() Failed For 2nd Zero-Copy Input Array : %d. Terminating Now ...\n", result);
+        cleanup();
+        exit(EXIT_FAILURE);
+    }
+
+    deviceOutput = clCreateBuffer(oclContext, CL_MEM_WRITE_ONLY | hostMemoryFlag, size, (hostMemoryMode == HOST_MEMORY_USE_HOST_PTR) ? hostOutput : NULL, &result);
+    if (result != CL_SUCCESS)
+    {
+        printf("error>> clCreateBuffer() Failed For Zero-Copy Output Array : %d. Terminating Now ...\n", result);
+        cleanup();
+        exit(EXIT_FAILURE);
+    }
+    traceEnd(&traceLog, traceSlice);
+
+    if (hostMemoryMode == HOST_MEMORY_ALLOC_HOST_PTR)
+    {
+        // the runtime owns the memory, so fill the inputs through a write mapping
+        hostInput1 = (float *)clEnqueueMapBuffer(oclCommandQueue, deviceInput1, CL_TRUE, CL_MAP_WRITE_INVALIDATE_REGION, 0, size, 0, NULL, profileEvent(&profileLog, "Map Input1 For Write", PROFILE_PHASE_MAP), &result);
+        if (result != CL_SUCCESS)
+        {
+            printf("error>> clEnqueueMapBuffer() Failed For 1st Zero-Copy Input Array : %d. Terminating Now ...\n", result);
+            cleanup();
+            exit(EXIT_FAILURE);
+        }
+
+        hostInput2 = (float *)clEnqueueMapBuffer(oclCommandQueue, deviceInput2, CL_TRUE, CL_MAP_WRITE_INVALIDATE_REGION, 0, size, 0, NULL, profileEvent(&profileLog, "Map Input2 For Write", PROFILE_PHASE_MAP), &result);
+        if (result != CL_SUCCESS)
+        {
+            printf("error>> clEnqueueMapBuffer() Failed For 2nd Zero-Copy Input Array : %d. Terminating Now ...\n", result);
+            cleanup();
+            exit(EXIT_FAILURE);
+        }
+
+        fillHostInputs();
+    }
+
+    result = clSetKernelArg(oclKernel, 0, sizeof(cl_mem), (void *)&deviceInput1);
+    result |= clSetKernelArg(oclKernel, 1, sizeof(cl_mem), (void *)&deviceInput2);
+    result |= clSetKernelArg(oclKernel, 2, sizeof(cl_mem), (void *)&deviceOutput);
+    result |= clSetKernelArg(oclKernel, 3, sizeof(cl_int), (void *)&length);
+    if (result != CL_SUCCESS)
+    {
+        printf("error>> clSetKernelArg() Failed For Zero-Copy Buffers : %d. Terminating Now ...\n", result);
+        cleanup();
+        exit(EXIT_FAILURE);
+    }
+
+    // start timer covering the hand-over to and from the device
+    traceSlice = traceBegin(&traceLog, "vecAddGPUZeroCopy", "gpu");
+    StopWatchInterface *transferTimer = NULL;
+    sdkCreateTimer(&transferTimer);
+    sdkStartTimer(&transferTimer);
+
+    if (hostMemoryMode == HOST_MEMORY_ALLOC_HOST_PTR)
+    {
+        // unmapping replaces clEnqueueWriteBuffer()
+        clEnqueueUnmapMemObject(oclCommandQueue, deviceInput1, hostInput1, 0, NULL, profileEvent(&profileLog, "Unmap Input1", PROFILE_PHASE_MAP));
+        clEnqueueUnmapMemObject(oclCommandQueue, deviceInput2, hostInput2, 0, NULL, profileEvent(&profileLog, "Unmap Input2", PROFILE_PHASE_MAP));
+        hostInput1 = NULL;
+        hostInput2 = NULL;
+    }
+
+    cl_event *kernelEvent = profileEvent(&profileLog, kernelVariantNames[kernelVariant], PROFILE_PHASE_KERNEL);
+    result = clEnqueueNDRangeKernel(oclCommandQueue, oclKernel, 1, NULL, &globalWorkSize, &localWorkSize, 0, NULL, kernelEvent);
+    if (result != CL_SUCCESS)
+    {
+        printf("error>> clEnqueueNDRangeKernel() Failed : %d. Terminating Now ...\n", result);
+        cleanup();
+        exit(EXIT_FAILURE);
+    }
+
+    // mapping for read replaces clEnqueueReadBuffer(), the inputs are mapped again for the host comparison
+    hostInput1 = (float *)clEnqueueMapBuffer(oclCommandQueue, deviceInput1, CL_FALSE, CL_MAP_READ, 0, size, 0, NULL, profileEvent(&profileLog, "Map Input1", PROFILE_PHASE_MAP), &result);
+    if (result == CL_SUCCESS)
+        hostInput2 = (float *)clEnqueueMapBuffer(oclCommandQueue, deviceInput2, CL_FALSE, CL_MAP_READ, 0, size, 0, NULL, profileEvent(&profileLog, "Map Input2", PROFILE_PHASE_MAP), &result);
+    if (result == CL_SUCCESS)
+        hostOutput = (float *)clEnqueueMapBuffer(oclCommandQueue, deviceOutput, CL_TRUE, CL_MAP_READ, 0, size, 0, NULL, profileEvent(&profileLog, "Map Output", PROFILE_PHASE_MAP), &result);
+    if (result != CL_SUCCESS)
+    {
+        printf("error>> clEnqueueMapBuffer() Failed For Zero-Copy Results : %d. Terminating Now ...\n", result);
+        cleanup();
+        exit(EXIT_FAILURE);
+    }
+    bDeviceBuffersMapped = true;
+
+    // stop timer
+    sdkStopTimer(&transferTimer);
+    traceEnd(&traceLog, traceSlice);
+    timeOnGPUWithTransfers = sdkGetTimerValue(&transferTimer);
+    sdkDeleteTimer(&transferTimer);
+    transferTimer = NULL;
+
+    timeOnGPU = (kernelEvent != NULL) ? profileEventTime(*kernelEvent) : 0.0f;
+}
@@ -0,0 +1,270 @@
+// helper_random.h
+// counter-based random numbers (Philox4x32-10) generated by parallel host loops or by OpenCL kernels,
+// both sides produce the same stream for the same seed and stream number
+
+#ifndef HELPER_RANDOM_H
+#define HELPER_RANDOM_H
+
+#include <math.h>
+#include <stddef.h>
+
+#include <CL/opencl.h>
+
+#include "helper_parallel.h"
+
+// element i of a stream is word i % 4 of philox4x32(counter = {i / 4 (low, high), stream, 0}, key = seed)
+#define PHILOX_M0 0xD2511F53u
+#define PHILOX_M1 0xCD9E8D57u
+#define PHILOX_W0 0x9E3779B9u
+#define PHILOX_W1 0xBB67AE85u
+#define PHILOX_ROUNDS 10
+
+#define RANDOM_GRAIN 1024 // elements per partitioning grain of the host loops, a multiple of 4
+
+////////////////////////////////////////////////////////////////////////////////
+//! Philox4x32-10 block function, counter and key are 4 and 2 words
+////////////////////////////////////////////////////////////////////////////////
+inline void philox4x32(const cl_uint counter[4], const cl_uint key[2], cl_uint result[4])
+{
+    cl_uint c0 = counter[0], c1 = counter[1], c2 = counter[2], c3 = counter[3];
+    cl_uint k0 = key[0], k1 = key[1];
+
+    for (int round = 0; round < PHILOX_ROUNDS; round++)
+    {
+        cl_ulong product0 = (cl_ulong)PHILOX_M0 * c0;
+        cl_ulong product1 = (cl_ulong)PHILOX_M1 * c2;
+
+        c0 = (cl_uint)(product1 >> 32) ^ c1 ^ k0;
+        c1 = (cl_uint)product1;
+        c2 = (cl_uint)(product0 >> 32) ^ c3 ^ k1;
+        c3 = (cl_uint)product0;
+
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+
+    result[0] = c0;
+    result[1] = c1;
+    result[2] = c2;
+    result[3] = c3;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! The four words of block number block of a stream
+////////////////////////////////////////////////////////////////////////////////
+inline void philoxBlock(cl_ulong seed, cl_uint stream, cl_ulong block, cl_uint result[4])
+{
+    cl_uint counter[4] = {(cl_uint)block, (cl_uint)(block >> 32), stream, 0};
+    cl_uint key[2] = {(cl_uint)seed, (cl_uint)(seed >> 32)};
+
+    philox4x32(counter, key, result);
+}
+
+// word to value conversions, kept exactly as in the kernels below
+// uniform and integer values are bit identical on host and device, normal values go through log / sin / cos
+// whose precision is up to the OpenCL implementation, so they match to a few ulp
+
+inline float randomWordToUniform(cl_uint word, float low, float high)
+{
+    float unit = (float)(word >> 8) * (1.0f / 16777216.0f); // [0, 1) in steps of 2^-24
+    return (low + unit * (high - low));
+}
+
+inline cl_int randomWordToInteger(cl_uint word, cl_int low, cl_int high)
+{
+    // multiply-shift into [low, high], the bias is below range / 2^32, all in unsigned arithmetic
+    // because high - low and low + offset overflow cl_int for ranges wider than INT_MAX
+    cl_uint range = (cl_uint)high - (cl_uint)low + 1u;
+    if (range == 0)
+        return ((cl_int)word);
+    return ((cl_int)((cl_uint)low + (cl_uint)(((cl_ulong)word * range) >> 32)));
+}
+
+inline void randomWordsToNormal(cl_uint word0, cl_uint word1, float mean, float standardDeviation, float *normal0, float *normal1)
+{
+    // Box-Muller, the first uniform is in (0, 1] so its log is finite
+    float u0 = (float)((word0 >> 8) + 1) * (1.0f / 16777216.0f);
+    float u1 = (float)(word1 >> 8) * (1.0f / 16777216.0f);
+    float radius = sqrtf(-2.0f * logf(u0));
+    float angle = 6.283185307179586f * u1;
+
+    *normal0 = mean + standardDeviation * (radius * cosf(angle));
+    *normal1 = mean + standardDeviation * (radius * sinf(angle));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Host generators, every thread produces its own range of the stream
+////////////////////////////////////////////////////////////////////////////////
+inline void fillRandomUniformCPU(float *array, size_t count, cl_ulong seed, cl_uint stream, float low, float high, unsigned int numberOfThreads)
+{
+    parallelFor(count, RANDOM_GRAIN, numberOfThreads, [=](size_t begin, size_t end, unsigned int) {
+        cl_uint words[4];
+        for (size_t index = begin; index < end; index += 4)
+        {
+            philoxBlock(seed, stream, index / 4, words);
+            for (size_t word = 0; (word < 4) && (index + word < end); word++)
+                array[index + word] = randomWordToUniform(words[word], low, high);
+        }
+    });
+}
+
+inline void fillRandomNormalCPU(float *array, size_t count, cl_ulong seed, cl_uint stream, float mean, float standardDeviation, unsigned int numberOfThreads)
+{
+    parallelFor(count, RANDOM_GRAIN, numberOfThreads, [=](size_t begin, size_t end, unsigned int) {
+        cl_uint words[4];
+        float normals[4];
+        for (size_t index = begin; index < end; index += 4)
+        {
+            philoxBlock(seed, stream, index / 4, words);
+            randomWordsToNormal(words[0], words[1], mean, standardDeviation, &normals[0], &normals[1]);
+            randomWordsToNormal(words[2], words[3], mean, standardDeviation, &normals[2], &normals[3]);
+            for (size_t word = 0; (word < 4) && (index + word < end); word++)
+                array[index + word] = normals[word];
+        }
+    });
+}
+
+inline void fillRandomIntegerCPU(cl_int *array, size_t count, cl_ulong seed, cl_uint stream, cl_int low, cl_int high, unsigned int numberOfThreads)
+{
+    parallelFor(count, RANDOM_GRAIN, numberOfThreads, [=](size_t begin, size_t end, unsigned int) {
+        cl_uint words[4];
+        for (size_t index = begin; index < end; index += 4)
+        {
+            philoxBlock(seed, stream, index / 4, words);
+            for (size_t word = 0; (word < 4) && (index + word < end); word++)
+                array[index + word] = randomWordToInteger(words[word], low, high);
+        }
+    });
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Device generators, one Philox block (4 elements) per work-item
+////////////////////////////////////////////////////////////////////////////////
+static const char *const oclRandomSourceCode =
+    "// contraction into fma would round differently from the host                                                               \n"
+    "#pragma OPENCL FP_CONTRACT OFF                                                                                              \n"
+    "                                                                                                                            \n"
+    "#define PHILOX_M0 0xD2511F53u                                                                                               \n"
+    "#define PHILOX_M1 0xCD9E8D57u                                                                                               \n"
+    "#define PHILOX_W0 0x9E3779B9u                                                                                               \n"
+    "#define PHILOX_W1 0xBB67AE85u                                                                                               \n"
+    "                                                                                                                            \n"
+    "uint4 philoxBlock(uint seedLow, uint seedHigh, uint stream, ulong block)                                                    \n"
+    "{                                                                                                                           \n"
+    "    uint4 counter = (uint4)((uint)block, (uint)(block >> 32), stream, 0);                                                   \n"
+    "    uint2 key = (uint2)(seedLow, seedHigh);                                                                                 \n"
+    "                                                                                                                            \n"
+    "    for(int round = 0; round < 10; round++)                                                                                 \n"
+    "    {                                                                                                                       \n"
+    "        uint high0 = mul_hi(PHILOX_M0, counter.x);                                                                          \n"
+    "        uint low0 = PHILOX_M0 * counter.x;                                                                                  \n"
+    "        uint high1 = mul_hi(PHILOX_M1, counter.z);                                                                          \n"
+    "        uint low1 = PHILOX_M1 * counter.z;                                                                                  \n"
+    "                                                                                                                            \n"
+    "        counter = (uint4)(high1 ^ counter.y ^ key.x, low1, high0 ^ counter.w ^ key.y, low0);                                \n"
+    "        key += (uint2)(PHILOX_W0, PHILOX_W1);                                                                               \n"
+    "    }                                                                                                                       \n"
+    "                                                                                                                            \n"
+    "    return (counter);                                                                                                       \n"
+    "}                                                                                                                           \n"
+    "                                                                                                                            \n"
+    "float4 wordsToUniform(uint4 words, float low, float high)                                                                   \n"
+    "{                                                                                                                           \n"
+    "    float4 unit = convert_float4(words >> 8) * (1.0f / 16777216.0f);                                                        \n"
+    "    return (low + unit * (high - low));                                                                                     \n"
+    "}                                                                                                                           \n"
+    "                                                                                                                            \n"
+    "int4 wordsToInteger(uint4 words, int low, int high)                                                                         \n"
+    "{                                                                                                                           \n"
+    "    uint range = (uint)high - (uint)low + 1u;                                                                               \n"
+    "    if(range == 0)                                                                                                          \n"
+    "    {                                                                                                                       \n"
+    "        return (as_int4(words));                                                                                            \n"
+    "    }                                                                                                                       \n"
+    "    return (as_int4((uint4)low + mul_hi(words, (uint4)range)));                                                             \n"
+    "}                                                                                                                           \n"
+    "                                                                                                                            \n"
+    "float2 wordsToNormal(uint word0, uint word1, float mean, float standardDeviation)                                           \n"
+    "{                                                                                                                           \n"
+    "    float u0 = (float)((word0 >> 8) + 1) * (1.0f / 16777216.0f);                                                            \n"
+    "    float u1 = (float)(word1 >> 8) * (1.0f / 16777216.0f);                                                                  \n"
+    "    float radius = sqrt(-2.0f * log(u0));                                                                                   \n"
+    "    float angle = 6.283185307179586f * u1;                                                                                  \n"
+    "    return (mean + standardDeviation * (radius * (float2)(cos(angle), sin(angle))));                                        \n"
+    "}                                                                                                                           \n"
+    "                                                                                                                            \n"
+    "// the last work-item stores only the elements below length                                                                 \n"
+    "#define STORE_BLOCK(output, values, length)                                                                               \\\n"
+    "    {                                                                                                                     \\\n"
+    "        ulong first = get_global_id(0) * 4;                                                                               \\\n"
+    "        if(first + 4 <= length)                                                                                           \\\n"
+    "        {                                                                                                                 \\\n"
+    "            vstore4(values, get_global_id(0), output);                                                                    \\\n"
+    "        }                                                                                                                 \\\n"
+    "        else                                                                                                              \\\n"
+    "        {                                                                                                                 \\\n"
+    "            if(first < length) output[first] = values.x;                                                                  \\\n"
+    "            if(first + 1 < length) output[first + 1] = values.y;                                                          \\\n"
+    "            if(first + 2 < length) output[first + 2] = values.z;                                                          \\\n"
+    "        }                                                                                                                 \\\n"
+    "    }                                                                                                                       \n"
+    "                                                                                                                            \n"
+    "__kernel void fillRandomUniformGPU(__global float *output, ulong length, uint seedLow, uint seedHigh, uint stream,          \n"
+    "                                   float low, float high)                                                                   \n"
+    "{                                                                                                                           \n"
+    "    float4 values = wordsToUniform(philoxBlock(seedLow, seedHigh, stream, get_global_id(0)), low, high);                    \n"
+    "    STORE_BLOCK(output, values, length);                                                                                    \n"
+    "}                                                                                                                           \n"
+    "                                                                                                                            \n"
+    "__kernel void fillRandomNormalGPU(__global float *output, ulong length, uint seedLow, uint seedHigh, uint stream,           \n"
+    "                                  float mean, float standardDeviation)                                                      \n"
+    "{                                                                                                                           \n"
+    "    uint4 words = philoxBlock(seedLow, seedHigh, stream, get_global_id(0));                                                 \n"
+    "    float4 values = (float4)(wordsToNormal(words.x, words.y, mean, standardDeviation),                                      \n"
+    "                             wordsToNormal(words.z, words.w, mean, standardDeviation));                                     \n"
+    "    STORE_BLOCK(output, values, length);                                                                                    \n"
+    "}                                                                                                                           \n"
+    "                                                                                                                            \n"
+    "__kernel void fillRandomIntegerGPU(__global int *output, ulong length, uint seedLow, uint seedHigh, uint stream,            \n"
+    "                                   int low, int high)                                                                       \n"
+    "{                                                                                                                           \n"
+    "    int4 values = wordsToInteger(philoxBlock(seedLow, seedHigh, stream, get_global_id(0)), low, high);                      \n"
+    "    STORE_BLOCK(output, values, length);                                                                                    \n"
+    "}                                                                                                                           \n";
+
+////////////////////////////////////////////////////////////////////////////////
+//! Enqueue one of the kernels above to generate count elements in place in buffer,
+//! parameter0 / parameter1 are low / high or mean / standard deviation (cl_float),
+//! or low / high (cl_int) for fillRandomIntegerGPU, parameterSize is their size, event may be NULL
+////////////////////////////////////////////////////////////////////////////////
+inline cl_int enqueueFillRandomGPU(cl_command_queue queue, cl_kernel kernel, cl_mem buffer, size_t count, cl_ulong seed, cl_uint stream,
+                                   const void *parameter0, const void *parameter1, size_t parameterSize, cl_event *event)
+{
+    cl_ulong length = count;
+    cl_uint seedLow = (cl_uint)seed;
+    cl_uint seedHigh = (cl_uint)(seed >> 32);
+    size_t globalWorkSize = (count + 3) / 4;
+    cl_int result;
+
+    if (count == 0)
+    {
+        if (event != NULL)
+            *event = NULL;
+        return (CL_SUCCESS);
+    }
+
+    result = clSetKernelArg(kernel, 0, sizeof(cl_mem), (void *)&buffer);
+    result |= clSetKernelArg(kernel, 1, sizeof(cl_ulong), (void *)&length);
+    result |= clSetKernelArg(kernel, 2, sizeof(cl_uint), (void *)&seedLow);
+    result |= clSetKernelArg(kernel, 3, sizeof(cl_uint), (void *)&seedHigh);
+    result |= clSetKernelArg(kernel, 4, sizeof(cl_uint), (void *)&stream);
+    result |= clSetKernelArg(kernel, 5, parameterSize, parameter0);
+    result |= clSetKernelArg(kernel, 6, parameterSize, parameter1);
+    if (result != CL_SUCCESS)
+        return (result);
+
+    // the runtime picks the work-group size, so any count works
+    return (clEnqueueNDRangeKernel(queue, kernel, 1, NULL, &globalWorkSize, NULL, 0, NULL, event));
+}
+
+#endif // HELPER_RANDOM_H
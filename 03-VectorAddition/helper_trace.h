@@ -0,0 +1,180 @@
+// helper_trace.h
+// host phases and the device commands of a ProfileLog on one timeline, written as Chrome trace
+// JSON (open with ui.perfetto.dev or chrome://tracing)
+
+#ifndef HELPER_TRACE_H
+#define HELPER_TRACE_H
+
+#include <stdio.h>
+#include <vector>
+
+#include <CL/opencl.h>
+
+#include "helper_profile.h"
+
+#define TRACE_NAME_LENGTH 64
+
+// trace processes and threads
+#define TRACE_HOST_PID 1   // host phases, tid 1 is the main thread
+#define TRACE_DEVICE_PID 2 // device commands, one thread per profile phase
+
+typedef struct TraceSlice
+{
+    char name[TRACE_NAME_LENGTH];
+    const char *category;
+    int pid;
+    int tid;
+    long long begin;      // host clock (ns)
+    long long duration;   // ns, -1 for an instant
+    long long queueDelay; // device commands only : QUEUED -> START (ns)
+} TraceSlice;
+
+typedef struct TraceLog
+{
+    const char *path; // NULL => tracing off, every call below returns straight away
+    std::vector<TraceSlice> slices;
+} TraceLog;
+
+////////////////////////////////////////////////////////////////////////////////
+//! Open a host slice, returns its index for traceEnd() (-1 when tracing is off)
+////////////////////////////////////////////////////////////////////////////////
+inline int traceBegin(TraceLog *trace, const char *name, const char *category)
+{
+    if (trace->path == NULL)
+        return (-1);
+
+    TraceSlice slice;
+    snprintf(slice.name, TRACE_NAME_LENGTH, "%s", name);
+    slice.category = category;
+    slice.pid = TRACE_HOST_PID;
+    slice.tid = 1;
+    slice.begin = (long long)profileHostTime();
+    slice.duration = 0;
+    slice.queueDelay = -1;
+    trace->slices.push_back(slice);
+    return ((int)trace->slices.size() - 1);
+}
+
+inline void traceEnd(TraceLog *trace, int slice)
+{
+    if (trace->path == NULL || slice < 0)
+        return;
+
+    trace->slices[slice].duration = (long long)profileHostTime() - trace->slices[slice].begin;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Add the completed commands of a profile log : the device slices go on one thread per phase,
+//! the enqueues become instants on the host thread. Device timestamps are moved to the host clock
+//! with the smallest QUEUED - enqueue time seen, the best bound OpenCL 1.2 offers without
+//! clGetDeviceAndHostTimer()
+////////////////////////////////////////////////////////////////////////////////
+inline void traceAddProfileLog(TraceLog *trace, const ProfileLog *log)
+{
+    std::vector<ProfileTimestamps> timestamps(log->numberOfEvents);
+    std::vector<bool> profiled(log->numberOfEvents, false);
+    long long deviceToHost = 0;
+    bool bAligned = false;
+
+    if (trace->path == NULL)
+        return;
+
+    for (size_t index = 0; index < log->numberOfEvents; index++)
+    {
+        if (log->events[index] == NULL || profileTimestamps(log->events[index], &timestamps[index]) != CL_SUCCESS)
+            continue;
+
+        profiled[index] = true;
+        long long offset = (long long)timestamps[index].queued - (long long)log->hostTimes[index];
+        if (bAligned == false || offset < deviceToHost)
+            deviceToHost = offset;
+        bAligned = true;
+    }
+
+    for (size_t index = 0; index < log->numberOfEvents; index++)
+    {
+        if (profiled[index] == false)
+            continue;
+
+        TraceSlice slice;
+        snprintf(slice.name, TRACE_NAME_LENGTH, "%s", log->names[index]);
+        slice.category = profilePhaseNames[log->phases[index]];
+        slice.pid = TRACE_DEVICE_PID;
+        slice.tid = log->phases[index] + 1;
+        slice.begin = (long long)timestamps[index].start - deviceToHost;
+        slice.duration = (long long)(timestamps[index].end - timestamps[index].start);
+        slice.queueDelay = (long long)(timestamps[index].start - timestamps[index].queued);
+        trace->slices.push_back(slice);
+
+        snprintf(slice.name, TRACE_NAME_LENGTH, "enqueue %s", log->names[index]);
+        slice.category = "enqueue";
+        slice.pid = TRACE_HOST_PID;
+        slice.tid = 1;
+        slice.begin = (long long)log->hostTimes[index];
+        slice.duration = -1;
+        slice.queueDelay = -1;
+        trace->slices.push_back(slice);
+    }
+}
+
+inline void traceWriteString(FILE *file, const char *string)
+{
+    fputc('"', file);
+    for (; *string; string++)
+    {
+        if (*string == '"' || *string == '\\')
+            fputc('\\', file);
+        if ((unsigned char)*string >= 0x20)
+            fputc(*string, file);
+    }
+    fputc('"', file);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Write the slices to trace->path, timestamps in us from the earliest slice
+////////////////////////////////////////////////////////////////////////////////
+inline bool writeTrace(const TraceLog *trace, const char *processName)
+{
+    if (trace->path == NULL || trace->slices.empty())
+        return (false);
+
+    FILE *file = fopen(trace->path, "w");
+    if (file == NULL)
+        return (false);
+
+    long long origin = trace->slices[0].begin;
+    for (size_t index = 1; index < trace->slices.size(); index++)
+    {
+        if (trace->slices[index].begin < origin)
+            origin = trace->slices[index].begin;
+    }
+
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    fprintf(file, "{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":%d,\"tid\":0,\"args\":{\"name\":", TRACE_HOST_PID);
+    traceWriteString(file, processName);
+    fprintf(file, "}},\n");
+    fprintf(file, "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":%d,\"tid\":1,\"args\":{\"name\":\"main\"}},\n", TRACE_HOST_PID);
+    fprintf(file, "{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":%d,\"tid\":0,\"args\":{\"name\":\"OpenCL Device\"}}", TRACE_DEVICE_PID);
+    for (int phase = 0; phase < PROFILE_PHASES; phase++)
+        fprintf(file, ",\n{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"%s\"}}", TRACE_DEVICE_PID, phase + 1, profilePhaseNames[phase]);
+
+    for (size_t index = 0; index < trace->slices.size(); index++)
+    {
+        const TraceSlice *slice = &trace->slices[index];
+
+        fprintf(file, ",\n{\"name\":");
+        traceWriteString(file, slice->name);
+        fprintf(file, ",\"cat\":\"%s\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f", slice->category, slice->pid, slice->tid, (double)(slice->begin - origin) * 1.0e-3);
+        if (slice->duration < 0)
+            fprintf(file, ",\"ph\":\"i\",\"s\":\"t\"}");
+        else if (slice->queueDelay < 0)
+            fprintf(file, ",\"ph\":\"X\",\"dur\":%.3f}", (double)slice->duration * 1.0e-3);
+        else
+            fprintf(file, ",\"ph\":\"X\",\"dur\":%.3f,\"args\":{\"queue delay (us)\":%.3f}}", (double)slice->duration * 1.0e-3, (double)slice->queueDelay * 1.0e-3);
+    }
+    fprintf(file, "\n]}\n");
+
+    return (fclose(file) == 0);
+}
+
+#endif // HELPER_TRACE_H
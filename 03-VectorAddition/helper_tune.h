@@ -0,0 +1,242 @@
+// helper_tune.h
+// work-group size autotuning : every candidate local size within CL_KERNEL_WORK_GROUP_SIZE is timed
+// through profiling events and the fastest is kept in an on-disk cache, keyed by device name, driver
+// version, kernel hash and problem size bucket, so later runs start already tuned
+
+#ifndef HELPER_TUNE_H
+#define HELPER_TUNE_H
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include <CL/opencl.h>
+
+// include after helper_profile.h, the command queue needs CL_QUEUE_PROFILING_ENABLE
+#define TUNE_CACHE_FILE "oclTuneCache.txt"
+#define TUNE_KEY_LENGTH 512
+#define TUNE_RUNS 5 // timed launches per candidate after one warm-up launch, the fastest counts
+
+////////////////////////////////////////////////////////////////////////////////
+//! 64-bit FNV-1a, chained through hash
+////////////////////////////////////////////////////////////////////////////////
+inline cl_ulong tuneHash(const char *text, cl_ulong hash)
+{
+    for (; *text; text++)
+    {
+        hash ^= (unsigned char)*text;
+        hash *= 0x100000001B3ull;
+    }
+    return (hash);
+}
+
+inline void tuneCopyKeyField(char *field, size_t fieldSize, const char *text)
+{
+    // the cache is tab and line separated, so those characters may not appear in a key
+    snprintf(field, fieldSize, "%s", text);
+    for (char *character = field; *character; character++)
+    {
+        if (*character == '\t' || *character == '\n' || *character == '\r' || *character == '|')
+            *character = '_';
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Cache key of a kernel : device name | driver version | hash of source, build options and
+//! kernel name | problem size bucket (floor(log2(problemSize)))
+////////////////////////////////////////////////////////////////////////////////
+inline void tuneCacheKey(cl_device_id device, const char *source, const char *buildOptions, const char *kernelName, size_t problemSize, char *key)
+{
+    char deviceName[128] = "";
+    char driverVersion[128] = "";
+    char text[128];
+    int bucket = 0;
+
+    clGetDeviceInfo(device, CL_DEVICE_NAME, sizeof(text), text, NULL);
+    text[sizeof(text) - 1] = '\0';
+    tuneCopyKeyField(deviceName, sizeof(deviceName), text);
+    clGetDeviceInfo(device, CL_DRIVER_VERSION, sizeof(text), text, NULL);
+    text[sizeof(text) - 1] = '\0';
+    tuneCopyKeyField(driverVersion, sizeof(driverVersion), text);
+
+    cl_ulong hash = tuneHash(source, 0xCBF29CE484222325ull);
+    hash = tuneHash("\n", hash);
+    hash = tuneHash((buildOptions != NULL) ? buildOptions : "", hash);
+    hash = tuneHash("\n", hash);
+    hash = tuneHash(kernelName, hash);
+
+    while ((problemSize >>= 1) != 0)
+        bucket++;
+
+    snprintf(key, TUNE_KEY_LENGTH, "%s|%s|%016llx|%d", deviceName, driverVersion, (unsigned long long)hash, bucket);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Last entry of key in the cache file, local[0] == 0 means the runtime's choice (NULL local size)
+////////////////////////////////////////////////////////////////////////////////
+inline bool tuneCacheLookup(const char *path, const char *key, size_t local[3])
+{
+    FILE *file = fopen(path, "r");
+    char line[TUNE_KEY_LENGTH + 128];
+    size_t keyLength = strlen(key);
+    bool bFound = false;
+
+    if (file == NULL)
+        return (false);
+
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        unsigned long long local0, local1, local2;
+        if (strncmp(line, key, keyLength) != 0 || line[keyLength] != '\t')
+            continue;
+        if (sscanf(line + keyLength + 1, "%llu %llu %llu", &local0, &local1, &local2) != 3)
+            continue;
+
+        local[0] = (size_t)local0;
+        local[1] = (size_t)local1;
+        local[2] = (size_t)local2;
+        bFound = true;
+    }
+
+    fclose(file);
+    return (bFound);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Append an entry, one short write in append mode so concurrent runs do not interleave lines,
+//! the newest entry of a key wins on lookup
+////////////////////////////////////////////////////////////////////////////////
+inline bool tuneCacheStore(const char *path, const char *key, const size_t local[3], float time)
+{
+    char line[TUNE_KEY_LENGTH + 128];
+    int length = snprintf(line, sizeof(line), "%s\t%llu %llu %llu\t%0.6f\n", key, (unsigned long long)local[0], (unsigned long long)local[1], (unsigned long long)local[2], time);
+
+    FILE *file = fopen(path, "a");
+    if (file == NULL)
+        return (false);
+
+    bool bWritten = (fwrite(line, 1, (size_t)length, file) == (size_t)length);
+    return ((fclose(file) == 0) && bWritten);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Fastest launch of kernel with the given sizes (ms), negative if it cannot be launched
+////////////////////////////////////////////////////////////////////////////////
+inline float tuneTimeLaunch(cl_command_queue queue, cl_kernel kernel, cl_uint workDim, const size_t *global, const size_t *local)
+{
+    float bestTime = -1.0f;
+
+    if (clEnqueueNDRangeKernel(queue, kernel, workDim, NULL, global, local, 0, NULL, NULL) != CL_SUCCESS)
+        return (-1.0f);
+    clFinish(queue);
+
+    for (int run = 0; run < TUNE_RUNS; run++)
+    {
+        cl_event event = NULL;
+        if (clEnqueueNDRangeKernel(queue, kernel, workDim, NULL, global, local, 0, NULL, &event) != CL_SUCCESS)
+            return (-1.0f);
+        clWaitForEvents(1, &event);
+
+        float time = profileEventTime(event);
+        clReleaseEvent(event);
+        if (bestTime < 0.0f || time < bestTime)
+            bestTime = time;
+    }
+
+    return (bestTime);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Local size of kernel (workDim 1 or 2) from the cache, or timed over the candidates and stored :
+//! powers of two per dimension whose product is a multiple of CL_KERNEL_PREFERRED_WORK_GROUP_SIZE_MULTIPLE
+//! and at most CL_KERNEL_WORK_GROUP_SIZE, plus the runtime's choice (local[0] == 0).
+//! globalSizeFor(local, global) fills the global size for a candidate and returns false to skip it,
+//! the kernel arguments must be set. bRetune skips the lookup, the new result is stored anyway.
+//! Returns true if the size came from the cache
+////////////////////////////////////////////////////////////////////////////////
+template <typename GlobalSizeFunction>
+inline bool autotuneWorkGroupSize(const char *cachePath, bool bRetune, const char *key, cl_command_queue queue, cl_device_id device, cl_kernel kernel,
+                                  cl_uint workDim, GlobalSizeFunction globalSizeFor, size_t local[3])
+{
+    size_t kernelWorkGroupSize = 1;
+    size_t preferredMultiple = 1;
+    size_t maxWorkItemSizes[3] = {1, 1, 1};
+    std::vector<size_t> candidates; // workDim sizes per candidate
+    float bestTime = -1.0f;
+
+    local[0] = 0;
+    local[1] = 1;
+    local[2] = 1;
+
+    if (cachePath != NULL && bRetune == false && tuneCacheLookup(cachePath, key, local) == true)
+        return (true);
+
+    clGetKernelWorkGroupInfo(kernel, device, CL_KERNEL_WORK_GROUP_SIZE, sizeof(kernelWorkGroupSize), &kernelWorkGroupSize, NULL);
+    clGetKernelWorkGroupInfo(kernel, device, CL_KERNEL_PREFERRED_WORK_GROUP_SIZE_MULTIPLE, sizeof(preferredMultiple), &preferredMultiple, NULL);
+    clGetDeviceInfo(device, CL_DEVICE_MAX_WORK_ITEM_SIZES, sizeof(maxWorkItemSizes), maxWorkItemSizes, NULL);
+    if (preferredMultiple == 0 || preferredMultiple > kernelWorkGroupSize)
+        preferredMultiple = 1;
+
+    // the runtime's choice first, so a candidate has to beat it
+    candidates.push_back(0);
+    if (workDim == 2)
+        candidates.push_back(0);
+
+    if (workDim == 1)
+    {
+        // power of two multiples of the preferred multiple, then the largest size the kernel allows
+        for (size_t x = preferredMultiple; x <= kernelWorkGroupSize && x <= maxWorkItemSizes[0]; x *= 2)
+            candidates.push_back(x);
+        if (kernelWorkGroupSize <= maxWorkItemSizes[0] && candidates.back() != kernelWorkGroupSize)
+            candidates.push_back(kernelWorkGroupSize);
+    }
+    else
+    {
+        for (size_t x = 1; x <= kernelWorkGroupSize && x <= maxWorkItemSizes[0]; x *= 2)
+        {
+            for (size_t y = 1; x * y <= kernelWorkGroupSize && y <= maxWorkItemSizes[1]; y *= 2)
+            {
+                if ((x * y) % preferredMultiple == 0)
+                {
+                    candidates.push_back(x);
+                    candidates.push_back(y);
+                }
+            }
+        }
+    }
+
+    for (size_t candidate = 0; candidate < candidates.size(); candidate += workDim)
+    {
+        size_t candidateLocal[3] = {candidates[candidate], (workDim == 2) ? candidates[candidate + 1] : 1, 1};
+        size_t global[3] = {0, 1, 1};
+
+        if (globalSizeFor((const size_t *)candidateLocal, global) == false)
+            continue;
+
+        float time = tuneTimeLaunch(queue, kernel, workDim, global, (candidateLocal[0] == 0) ? NULL : candidateLocal);
+        if (time < 0.0f)
+            continue;
+
+        if (candidateLocal[0] == 0)
+            printf("info>> Work-Group Size %-9s : %0.6f (ms)\n", "runtime", time);
+        else if (workDim == 1)
+            printf("info>> Work-Group Size %-9zu : %0.6f (ms)\n", candidateLocal[0], time);
+        else
+            printf("info>> Work-Group Size %4zu x %-4zu : %0.6f (ms)\n", candidateLocal[0], candidateLocal[1], time);
+
+        // a later candidate has to be clearly faster, so timing noise does not flip the choice
+        if (bestTime < 0.0f || time < bestTime * 0.98f)
+        {
+            bestTime = time;
+            local[0] = candidateLocal[0];
+            local[1] = candidateLocal[1];
+        }
+    }
+
+    if (cachePath != NULL && bestTime >= 0.0f && tuneCacheStore(cachePath, key, local, bestTime) == false)
+        printf("info>> Tuning Cache %s Could Not Be Written.\n", cachePath);
+
+    return (false);
+}
+
+#endif // HELPER_TUNE_H
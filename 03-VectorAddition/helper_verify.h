@@ -0,0 +1,389 @@
+// helper_verify.h
+// comparison of a device result with its host reference on all CPU threads with AVX2 / AVX-512,
+// reporting absolute errors, the ulp distance distribution and the first mismatches
+
+#ifndef HELPER_VERIFY_H
+#define HELPER_VERIFY_H
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <type_traits>
+#include <vector>
+
+// include after helper_timer.h, which has no include guard
+#include "helper_parallel.h"
+
+#define VERIFY_MAX_REPORTED_MISMATCHES 10 // first mismatches kept with their indices
+#define VERIFY_BLOCK_ELEMENTS 4096        // float accumulators are flushed into doubles after every block
+
+// ulp distance buckets : 0, 1, 2-3, 4-15, 16-255, 256-65535, more
+#define VERIFY_ULP_BUCKETS 7
+static const unsigned int verifyUlpBucketLimits[VERIFY_ULP_BUCKETS - 1] = {0, 1, 3, 15, 255, 65535};
+static const char *const verifyUlpBucketNames[VERIFY_ULP_BUCKETS] = {"0", "1", "2-3", "4-15", "16-255", "256-65535", ">65535"};
+
+typedef struct VerifyReport
+{
+    size_t numberOfElements;
+    size_t numberOfMismatches;
+    double maxAbsoluteError;
+    double sumAbsoluteError;
+    double meanAbsoluteError;
+    unsigned int maxUlpDistance;
+    size_t ulpHistogram[VERIFY_ULP_BUCKETS];
+    size_t numberOfReportedMismatches;
+    size_t mismatchIndices[VERIFY_MAX_REPORTED_MISMATCHES];
+    float timeToVerify; // ms
+} VerifyReport;
+
+////////////////////////////////////////////////////////////////////////////////
+//! Integer whose order matches the order of the floats, so that the ulp distance
+//! of two floats is the difference of their keys (ints are their own keys)
+////////////////////////////////////////////////////////////////////////////////
+inline int verifyOrderedKey(float value)
+{
+    int bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return ((bits < 0) ? (int)(0x80000000u - (unsigned int)bits) : bits);
+}
+
+inline int verifyOrderedKey(int value)
+{
+    return (value);
+}
+
+inline unsigned int verifyPopCount(unsigned int mask)
+{
+    mask = mask - ((mask >> 1) & 0x55555555u);
+    mask = (mask & 0x33333333u) + ((mask >> 2) & 0x33333333u);
+    return ((((mask + (mask >> 4)) & 0x0f0f0f0fu) * 0x01010101u) >> 24);
+}
+
+inline void verifyRecordMismatch(VerifyReport *report, size_t index)
+{
+    if (report->numberOfReportedMismatches < VERIFY_MAX_REPORTED_MISMATCHES)
+        report->mismatchIndices[report->numberOfReportedMismatches++] = index;
+    report->numberOfMismatches++;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Scalar check of [begin, end), the reference for the SIMD versions below.
+//! Floats match within absoluteTolerance or within ulpTolerance ulps (NaN never matches),
+//! ints match within ulpTolerance and their absolute error is their distance
+////////////////////////////////////////////////////////////////////////////////
+template <typename T>
+inline void verifyRangeScalar(const T *result, const T *expected, size_t begin, size_t end, float absoluteTolerance, unsigned int ulpTolerance, VerifyReport *report)
+{
+    for (size_t index = begin; index < end; index++)
+    {
+        int resultKey = verifyOrderedKey(result[index]);
+        int expectedKey = verifyOrderedKey(expected[index]);
+        unsigned int ulpDistance = (resultKey > expectedKey) ? (unsigned int)resultKey - (unsigned int)expectedKey : (unsigned int)expectedKey - (unsigned int)resultKey;
+        float absoluteError;
+        bool bMatch;
+
+        if (std::is_same<T, float>::value)
+        {
+            bool bOrdered = (result[index] == result[index]) && (expected[index] == expected[index]);
+            absoluteError = fabsf((float)result[index] - (float)expected[index]);
+            bMatch = (absoluteError <= absoluteTolerance) || ((ulpDistance <= ulpTolerance) && bOrdered);
+            if (absoluteError == absoluteError)
+                report->sumAbsoluteError += absoluteError;
+        }
+        else
+        {
+            absoluteError = (float)ulpDistance;
+            bMatch = (ulpDistance <= ulpTolerance);
+            report->sumAbsoluteError += absoluteError;
+        }
+
+        if (absoluteError > report->maxAbsoluteError)
+            report->maxAbsoluteError = absoluteError;
+        if (ulpDistance > report->maxUlpDistance)
+            report->maxUlpDistance = ulpDistance;
+
+        int bucket = 0;
+        while ((bucket < VERIFY_ULP_BUCKETS - 1) && (ulpDistance > verifyUlpBucketLimits[bucket]))
+            bucket++;
+        report->ulpHistogram[bucket]++;
+
+        if (bMatch == false)
+            verifyRecordMismatch(report, index);
+    }
+}
+
+#if defined(HELPER_PARALLEL_X86)
+
+////////////////////////////////////////////////////////////////////////////////
+//! 8 lanes at a time, the tail goes to verifyRangeScalar()
+////////////////////////////////////////////////////////////////////////////////
+template <typename T>
+TARGET_AVX2 void verifyRangeAVX2(const T *result, const T *expected, size_t begin, size_t end, float absoluteTolerance, unsigned int ulpTolerance, VerifyReport *report)
+{
+    const bool bFloat = std::is_same<T, float>::value;
+    const __m256i signBit = _mm256_set1_epi32((int)0x80000000u);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256 absoluteMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+    const __m256 absoluteToleranceVector = _mm256_set1_ps(absoluteTolerance);
+    const __m256i ulpToleranceVector = _mm256_set1_epi32((int)ulpTolerance);
+
+    __m256 sumAbsoluteError = _mm256_setzero_ps();
+    __m256 maxAbsoluteError = _mm256_setzero_ps();
+    __m256i maxUlpDistance = _mm256_setzero_si256();
+    size_t atMostLimit[VERIFY_ULP_BUCKETS - 1] = {0};
+    size_t index = begin;
+
+    for (; index + 8 <= end; index += 8)
+    {
+        __m256i resultKey = _mm256_loadu_si256((const __m256i *)(result + index));
+        __m256i expectedKey = _mm256_loadu_si256((const __m256i *)(expected + index));
+        if (bFloat)
+        {
+            resultKey = _mm256_blendv_epi8(resultKey, _mm256_sub_epi32(signBit, resultKey), _mm256_cmpgt_epi32(zero, resultKey));
+            expectedKey = _mm256_blendv_epi8(expectedKey, _mm256_sub_epi32(signBit, expectedKey), _mm256_cmpgt_epi32(zero, expectedKey));
+        }
+        __m256i ulpDistance = _mm256_sub_epi32(_mm256_max_epi32(resultKey, expectedKey), _mm256_min_epi32(resultKey, expectedKey));
+        __m256 ulpMatch = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_min_epu32(ulpDistance, ulpToleranceVector), ulpDistance));
+
+        __m256 absoluteError;
+        __m256 match;
+        if (bFloat)
+        {
+            __m256 resultValue = _mm256_loadu_ps((const float *)(result + index));
+            __m256 expectedValue = _mm256_loadu_ps((const float *)(expected + index));
+            __m256 ordered = _mm256_cmp_ps(resultValue, expectedValue, _CMP_ORD_Q);
+            absoluteError = _mm256_and_ps(_mm256_sub_ps(resultValue, expectedValue), absoluteMask);
+            match = _mm256_or_ps(_mm256_cmp_ps(absoluteError, absoluteToleranceVector, _CMP_LE_OQ), _mm256_and_ps(ulpMatch, ordered));
+            sumAbsoluteError = _mm256_add_ps(sumAbsoluteError, _mm256_and_ps(absoluteError, _mm256_cmp_ps(absoluteError, absoluteError, _CMP_ORD_Q)));
+        }
+        else
+        {
+            // unsigned to float in two exact halves, rounded once by the add like (float)ulpDistance
+            __m256 high = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(ulpDistance, 16)), _mm256_set1_ps(65536.0f));
+            absoluteError = _mm256_add_ps(high, _mm256_cvtepi32_ps(_mm256_and_si256(ulpDistance, _mm256_set1_epi32(0xffff))));
+            match = ulpMatch;
+            sumAbsoluteError = _mm256_add_ps(sumAbsoluteError, absoluteError);
+        }
+
+        maxAbsoluteError = _mm256_max_ps(absoluteError, maxAbsoluteError);
+        maxUlpDistance = _mm256_max_epu32(maxUlpDistance, ulpDistance);
+
+        for (int limit = 0; limit < VERIFY_ULP_BUCKETS - 1; limit++)
+        {
+            __m256i limitVector = _mm256_set1_epi32((int)verifyUlpBucketLimits[limit]);
+            __m256i atMost = _mm256_cmpeq_epi32(_mm256_min_epu32(ulpDistance, limitVector), ulpDistance);
+            atMostLimit[limit] += verifyPopCount((unsigned int)_mm256_movemask_ps(_mm256_castsi256_ps(atMost)));
+        }
+
+        unsigned int mismatchMask = (~(unsigned int)_mm256_movemask_ps(match)) & 0xffu;
+        for (int lane = 0; (mismatchMask != 0) && (lane < 8); lane++)
+        {
+            if (mismatchMask & (1u << lane))
+                verifyRecordMismatch(report, index + lane);
+        }
+    }
+
+    float sums[8], maxima[8];
+    unsigned int ulpMaxima[8];
+    _mm256_storeu_ps(sums, sumAbsoluteError);
+    _mm256_storeu_ps(maxima, maxAbsoluteError);
+    _mm256_storeu_si256((__m256i *)ulpMaxima, maxUlpDistance);
+    for (int lane = 0; lane < 8; lane++)
+    {
+        report->sumAbsoluteError += sums[lane];
+        if (maxima[lane] > report->maxAbsoluteError)
+            report->maxAbsoluteError = maxima[lane];
+        if (ulpMaxima[lane] > report->maxUlpDistance)
+            report->maxUlpDistance = ulpMaxima[lane];
+    }
+
+    size_t previous = 0;
+    for (int limit = 0; limit < VERIFY_ULP_BUCKETS - 1; limit++)
+    {
+        report->ulpHistogram[limit] += atMostLimit[limit] - previous;
+        previous = atMostLimit[limit];
+    }
+    report->ulpHistogram[VERIFY_ULP_BUCKETS - 1] += (index - begin) - previous;
+
+    verifyRangeScalar(result, expected, index, end, absoluteTolerance, ulpTolerance, report);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! 16 lanes at a time with mask registers, the tail goes to verifyRangeScalar()
+////////////////////////////////////////////////////////////////////////////////
+template <typename T>
+TARGET_AVX512 void verifyRangeAVX512(const T *result, const T *expected, size_t begin, size_t end, float absoluteTolerance, unsigned int ulpTolerance, VerifyReport *report)
+{
+    const bool bFloat = std::is_same<T, float>::value;
+    const __m512i signBit = _mm512_set1_epi32((int)0x80000000u);
+    const __m512i zero = _mm512_setzero_si512();
+    const __m512 absoluteToleranceVector = _mm512_set1_ps(absoluteTolerance);
+    const __m512i ulpToleranceVector = _mm512_set1_epi32((int)ulpTolerance);
+
+    __m512 sumAbsoluteError = _mm512_setzero_ps();
+    __m512 maxAbsoluteError = _mm512_setzero_ps();
+    __m512i maxUlpDistance = _mm512_setzero_si512();
+    size_t atMostLimit[VERIFY_ULP_BUCKETS - 1] = {0};
+    size_t index = begin;
+
+    for (; index + 16 <= end; index += 16)
+    {
+        __m512i resultKey = _mm512_loadu_si512((const void *)(result + index));
+        __m512i expectedKey = _mm512_loadu_si512((const void *)(expected + index));
+        if (bFloat)
+        {
+            resultKey = _mm512_mask_sub_epi32(resultKey, _mm512_cmplt_epi32_mask(resultKey, zero), signBit, resultKey);
+            expectedKey = _mm512_mask_sub_epi32(expectedKey, _mm512_cmplt_epi32_mask(expectedKey, zero), signBit, expectedKey);
+        }
+        __m512i ulpDistance = _mm512_sub_epi32(_mm512_max_epi32(resultKey, expectedKey), _mm512_min_epi32(resultKey, expectedKey));
+        __mmask16 ulpMatch = _mm512_cmple_epu32_mask(ulpDistance, ulpToleranceVector);
+
+        __m512 absoluteError;
+        __mmask16 match;
+        if (bFloat)
+        {
+            __m512 resultValue = _mm512_loadu_ps((const void *)(result + index));
+            __m512 expectedValue = _mm512_loadu_ps((const void *)(expected + index));
+            __mmask16 ordered = _mm512_cmp_ps_mask(resultValue, expectedValue, _CMP_ORD_Q);
+            absoluteError = _mm512_abs_ps(_mm512_sub_ps(resultValue, expectedValue));
+            match = _mm512_cmp_ps_mask(absoluteError, absoluteToleranceVector, _CMP_LE_OQ) | (ulpMatch & ordered);
+            sumAbsoluteError = _mm512_mask_add_ps(sumAbsoluteError, _mm512_cmp_ps_mask(absoluteError, absoluteError, _CMP_ORD_Q), sumAbsoluteError, absoluteError);
+        }
+        else
+        {
+            absoluteError = _mm512_cvtepu32_ps(ulpDistance);
+            match = ulpMatch;
+            sumAbsoluteError = _mm512_add_ps(sumAbsoluteError, absoluteError);
+        }
+
+        maxAbsoluteError = _mm512_max_ps(absoluteError, maxAbsoluteError);
+        maxUlpDistance = _mm512_max_epu32(maxUlpDistance, ulpDistance);
+
+        for (int limit = 0; limit < VERIFY_ULP_BUCKETS - 1; limit++)
+            atMostLimit[limit] += verifyPopCount((unsigned int)_mm512_cmple_epu32_mask(ulpDistance, _mm512_set1_epi32((int)verifyUlpBucketLimits[limit])));
+
+        unsigned int mismatchMask = (~(unsigned int)match) & 0xffffu;
+        for (int lane = 0; (mismatchMask != 0) && (lane < 16); lane++)
+        {
+            if (mismatchMask & (1u << lane))
+                verifyRecordMismatch(report, index + lane);
+        }
+    }
+
+    float sums[16], maxima[16];
+    unsigned int ulpMaxima[16];
+    _mm512_storeu_ps(sums, sumAbsoluteError);
+    _mm512_storeu_ps(maxima, maxAbsoluteError);
+    _mm512_storeu_si512((void *)ulpMaxima, maxUlpDistance);
+    for (int lane = 0; lane < 16; lane++)
+    {
+        report->sumAbsoluteError += sums[lane];
+        if (maxima[lane] > report->maxAbsoluteError)
+            report->maxAbsoluteError = maxima[lane];
+        if (ulpMaxima[lane] > report->maxUlpDistance)
+            report->maxUlpDistance = ulpMaxima[lane];
+    }
+
+    size_t previous = 0;
+    for (int limit = 0; limit < VERIFY_ULP_BUCKETS - 1; limit++)
+    {
+        report->ulpHistogram[limit] += atMostLimit[limit] - previous;
+        previous = atMostLimit[limit];
+    }
+    report->ulpHistogram[VERIFY_ULP_BUCKETS - 1] += (index - begin) - previous;
+
+    verifyRangeScalar(result, expected, index, end, absoluteTolerance, ulpTolerance, report);
+}
+
+#endif // HELPER_PARALLEL_X86
+
+////////////////////////////////////////////////////////////////////////////////
+//! Compare count elements of result against expected (float or int) on numberOfThreads threads
+//! (0 => all) with the widest SIMD the CPU supports, see verifyRangeScalar() for the tolerances
+////////////////////////////////////////////////////////////////////////////////
+template <typename T>
+VerifyReport verifyArrays(const T *result, const T *expected, size_t count, float absoluteTolerance, unsigned int ulpTolerance, unsigned int numberOfThreads)
+{
+    static_assert(std::is_same<T, float>::value || std::is_same<T, int>::value, "verifyArrays() compares float or int arrays");
+
+    typedef void (*VerifyRangeFunction)(const T *, const T *, size_t, size_t, float, unsigned int, VerifyReport *);
+
+    VerifyRangeFunction verifyRange = verifyRangeScalar<T>;
+#if defined(HELPER_PARALLEL_X86)
+    int simdLevel = getCPUSimdLevel();
+    if (simdLevel == CPU_SIMD_AVX512)
+        verifyRange = verifyRangeAVX512<T>;
+    else if (simdLevel == CPU_SIMD_AVX2)
+        verifyRange = verifyRangeAVX2<T>;
+#endif
+
+    if (numberOfThreads == 0)
+        numberOfThreads = getNumberOfCPUThreads();
+
+    StopWatchInterface *timer = NULL;
+    sdkCreateTimer(&timer);
+    sdkStartTimer(&timer);
+
+    // one partial report per thread, merged in range order so the first mismatches stay first
+    std::vector<VerifyReport> partialReports(numberOfThreads);
+    memset(partialReports.data(), 0, numberOfThreads * sizeof(VerifyReport));
+
+    parallelFor(count, VERIFY_BLOCK_ELEMENTS, numberOfThreads, [&](size_t begin, size_t end, unsigned int threadIndex) {
+        for (size_t blockBegin = begin; blockBegin < end; blockBegin += VERIFY_BLOCK_ELEMENTS)
+        {
+            size_t blockEnd = (blockBegin + VERIFY_BLOCK_ELEMENTS < end) ? blockBegin + VERIFY_BLOCK_ELEMENTS : end;
+            verifyRange(result, expected, blockBegin, blockEnd, absoluteTolerance, ulpTolerance, &partialReports[threadIndex]);
+        }
+    });
+
+    VerifyReport report;
+    memset(&report, 0, sizeof(report));
+    report.numberOfElements = count;
+
+    for (unsigned int threadIndex = 0; threadIndex < numberOfThreads; threadIndex++)
+    {
+        const VerifyReport *partial = &partialReports[threadIndex];
+
+        report.numberOfMismatches += partial->numberOfMismatches;
+        report.sumAbsoluteError += partial->sumAbsoluteError;
+        if (partial->maxAbsoluteError > report.maxAbsoluteError)
+            report.maxAbsoluteError = partial->maxAbsoluteError;
+        if (partial->maxUlpDistance > report.maxUlpDistance)
+            report.maxUlpDistance = partial->maxUlpDistance;
+        for (int bucket = 0; bucket < VERIFY_ULP_BUCKETS; bucket++)
+            report.ulpHistogram[bucket] += partial->ulpHistogram[bucket];
+        for (size_t mismatch = 0; (mismatch < partial->numberOfReportedMismatches) && (report.numberOfReportedMismatches < VERIFY_MAX_REPORTED_MISMATCHES); mismatch++)
+            report.mismatchIndices[report.numberOfReportedMismatches++] = partial->mismatchIndices[mismatch];
+    }
+    report.meanAbsoluteError = (count > 0) ? report.sumAbsoluteError / (double)count : 0.0;
+
+    sdkStopTimer(&timer);
+    report.timeToVerify = sdkGetTimerValue(&timer);
+    sdkDeleteTimer(&timer);
+    timer = NULL;
+
+    return (report);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Print the statistics and the reported mismatches of verifyArrays()
+////////////////////////////////////////////////////////////////////////////////
+template <typename T>
+void printVerifyReport(const VerifyReport *report, const T *result, const T *expected)
+{
+    printf("- Verified %zu Elements In %0.6f (ms) : %zu Mismatches, Max Absolute Error = %g, Mean Absolute Error = %g, Max ULP Distance = %u\n",
+           report->numberOfElements, report->timeToVerify, report->numberOfMismatches, report->maxAbsoluteError, report->meanAbsoluteError, report->maxUlpDistance);
+
+    printf("- ULP Distance Distribution :");
+    for (int bucket = 0; bucket < VERIFY_ULP_BUCKETS; bucket++)
+        printf(" [%s] %zu", verifyUlpBucketNames[bucket], report->ulpHistogram[bucket]);
+    printf("\n");
+
+    for (size_t mismatch = 0; mismatch < report->numberOfReportedMismatches; mismatch++)
+    {
+        size_t index = report->mismatchIndices[mismatch];
+        printf("  Mismatch At Index %zu : Result = %.9g, Expected = %.9g\n", index, (double)result[index], (double)expected[index]);
+    }
+}
+
+#endif // HELPER_VERIFY_H
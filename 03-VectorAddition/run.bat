@@ -6,5 +6,13 @@ cl.exe VecAdd.cpp /c /EHsc /Fo".\VecAdd.obj" /I "C:\Program Files\NVIDIA GPU Com
 link.exe VecAdd.obj opencl.lib /LIBPATH:"C:\Program Files\NVIDIA GPU Computing Toolkit\CUDA\v11.1\lib\x64"
 
 VecAdd.exe
+VecAdd.exe -variant scalar
+VecAdd.exe -stream
+VecAdd.exe -zerocopy alloc
+VecAdd.exe -zerocopy usehost
+VecAdd.exe -devicefill
+VecAdd.exe -randomtest
+VecAdd.exe -trace VecAdd.json
+VecAdd.exe -specialize off
 
 del VecAdd.obj
@@ -1,14 +1,24 @@
 // headers
 #include <stdio.h>
 #include <stdlib.h> // exit()
+#include <string.h> // strcmp()
 #include <math.h>   // fabs()
 
 #include <CL/opencl.h> // standard OpenCL header
 
 #include "helper_timer.h"
+#include "helper_verify.h"
+#include "helper_gemm.h"
+#include "helper_sparse.h"
+#include "helper_profile.h"
+#include "helper_program_cache.h"
+#include "helper_specialize.h"
+#include "helper_trace.h"
+#include "helper_tune.h"
 
 // macros
 #define BLOCK_WIDTH 64
+#define SPECIALIZE_MAX_DEPTH 256 // deepest inner loop a specialized build unrolls, deeper shapes keep the generic kernel
 
 // global variables declaration
 cl_platform_id oclPlatformID;
@@ -20,44 +30,490 @@ cl_command_queue oclCommandQueue;
 cl_program oclProgram;
 cl_kernel oclKernel;
 
-int *hostA = NULL;
-int *hostB = NULL;
-int *hostC = NULL;
-int *gold = NULL;
+void *hostA = NULL; // matrices of the -type element type
+void *hostB = NULL;
+void *hostC = NULL;
+void *gold = NULL;
 
 cl_mem deviceA = NULL;
 cl_mem deviceB = NULL;
 cl_mem deviceC = NULL;
+cl_mem devicePackedB = NULL; // B repacked for matrixMultiplyPackedGPU
+
+// host memory modes
+#define HOST_MEMORY_COPY 0           // malloc() host matrices, explicit write / read of device buffers
+#define HOST_MEMORY_ALLOC_HOST_PTR 1 // host matrices are mapped CL_MEM_ALLOC_HOST_PTR buffers
+#define HOST_MEMORY_USE_HOST_PTR 2   // page aligned host matrices wrapped by CL_MEM_USE_HOST_PTR buffers
+
+int hostMemoryMode = HOST_MEMORY_COPY;
+bool bDeviceBuffersMapped = false;
+bool bHostMatricesFromRuntime = false; // hostA / hostB / hostC are mappings of CL_MEM_ALLOC_HOST_PTR buffers, not allocateHostMatrix()
 
 float timeOnCPU = 0.0f;
 float timeOnGPU = 0.0f;
-
-// OpenCL kernel
-char *oclSourceCode =
-    " __kernel void matrixMultiplyGPU(__global int *A, __global int *B, __global int *C, int numberOfARows, int numberOfAColumns, int numberOfBColumns, int numberOfCColumns)       \n"
-    "{                                                                                                                                                                              \n"
-    "   int rowIndex = get_global_id(0);                                                                                                                                            \n"
-    "   int columnIndex = get_global_id(1);                                                                                                                                         \n"
-    "   if ((rowIndex < numberOfARows) && (columnIndex < numberOfBColumns))                                                                                                         \n"
-    "   {                                                                                                                                                                           \n"
-    "       float value = 0.0f;                                                                                                                                                     \n"
-    "       for (int depth = 0; depth < numberOfAColumns; depth++)                                                                                                                  \n"
-    "       {                                                                                                                                                                       \n"
-    "           int a = A[rowIndex * numberOfAColumns + depth];                                                                                                                     \n"
-    "           int b = B[depth * numberOfBColumns + columnIndex];                                                                                                                  \n"
-    "           value += (a * b);                                                                                                                                                   \n"
-    "       }                                                                                                                                                                       \n"
-    "       C[rowIndex * numberOfCColumns + columnIndex] = value;                                                                                                                   \n"
-    "   }                                                                                                                                                                           \n"
-    "}                                                                                                                                                                              \n";
+float timeOnGPUWithTransfers = 0.0f;
+
+// host product : the cache-blocked SIMD GEMM of helper_host_gemm.h for the types that have one (-cpu naive keeps
+// the reference loop), on every hardware thread unless -threads says otherwise
+bool bBlockedCPU = true;
+unsigned int numberOfCPUThreads = 0;
+int cpuSimdLevel = CPU_SIMD_NONE;
+
+// device timestamps of every write, kernel and read of the run
+ProfileLog profileLog;
+
+// host phases and device commands on one timeline, written with -trace
+TraceLog traceLog;
+
+// work-group size : {0, 0} => autotuned, the result is kept in TUNE_CACHE_FILE, local[0] == 0 from
+// the tuner leaves the choice to the runtime
+size_t localWorkSize[2] = {0, 0};
+bool bRetune = false;
+
+// specialized builds of matrixMultiplyGPU, one per shape and work-group size, -specialize off keeps the
+// generic kernel that reads the dimensions at run time
+SpecializationCache specializationCache;
+bool bSpecialize = true;
+
+// element types : A and B hold ELEMENT_TYPE, C holds RESULT_TYPE and every sum is accumulated in ACCUMULATOR_TYPE
+#define MATMUL_TYPE_FLOAT 0
+#define MATMUL_TYPE_DOUBLE 1
+#define MATMUL_TYPE_HALF 2
+#define MATMUL_TYPE_INT32 3
+#define MATMUL_TYPE_INT8 4
+#define NUMBER_OF_MATMUL_TYPES 5
+
+typedef struct MatMulType
+{
+    const char *option;          // -type
+    const char *elementType;     // ELEMENT_TYPE of the kernels
+    const char *resultType;      // RESULT_TYPE
+    const char *accumulatorType; // ACCUMULATOR_TYPE
+    const char *extension;       // device extension the kernels need, NULL for none
+    GemmHostType host;           // the same product on the host
+} MatMulType;
+
+const MatMulType matMulTypes[NUMBER_OF_MATMUL_TYPES] = {
+    {"float", "float", "float", "float", NULL, gemmHostType<cl_float, cl_float, cl_float>()},
+    {"double", "double", "double", "double", "cl_khr_fp64", gemmHostType<cl_double, cl_double, cl_double>()},
+    {"half", "half", "half", "float", "cl_khr_fp16", gemmHostType<cl_half, cl_half, cl_float>()},
+    {"int32", "int", "int", "long", NULL, gemmHostType<cl_int, cl_int, cl_long>()},
+    {"int8", "char", "int", "int", NULL, gemmHostType<cl_char, cl_int, cl_int>()}};
+
+int matMulType = MATMUL_TYPE_INT32;
+
+// kernels
+#define MATMUL_KERNEL_NAIVE 0 // one element of C per work-item, straight from global memory
+#define MATMUL_KERNEL_TILED 1   // local memory tiles of A and B
+#define MATMUL_KERNEL_BLOCKED 2 // MICRO_M x MICRO_N block of C per work-item, in registers
+#define MATMUL_KERNEL_PACKED 3  // the blocked kernel reading a packed copy of B
+#define NUMBER_OF_MATMUL_KERNELS 4
+#define MAX_TILE_SIZE 32
+#define MAX_MICRO_TILE_ROWS 8
+
+const char *matMulKernelNames[NUMBER_OF_MATMUL_KERNELS] = {"matrixMultiplyGPU", "matrixMultiplyTiledGPU", "matrixMultiplyBlockedGPU", "matrixMultiplyPackedGPU"};
+const char *matMulKernelOptions[NUMBER_OF_MATMUL_KERNELS] = {"naive", "tiled", "blocked", "packed"};
+
+int matMulKernel = MATMUL_KERNEL_NAIVE;
+int tileSize = 16;                                 // TILE_SIZE of the tiled kernel
+int microTileRows = 4;                             // MICRO_M of the blocked kernels
+int microTileColumns = 4;                          // MICRO_N of the blocked kernels, 4 or 8
+char buildOptions[SPECIALIZE_OPTIONS_LENGTH] = ""; // -D types / TILE_SIZE / MICRO_M / MICRO_N, the base of every build
+
+cl_kernel oclPackKernel = NULL; // packMatrixB
+
+// GFLOP/s sweep of every kernel over square matrices, SWEEP_MIN_SIZE doubling up to sweepMaxSize
+#define SWEEP_MIN_SIZE 64
+#define SWEEP_MAX_SIZE 8192
+#define SWEEP_SAMPLES 256 // elements of C checked against the host per size and kernel
+
+bool bSweep = false;
+int sweepMaxSize = SWEEP_MAX_SIZE;
+
+// conformance of enqueueGemm() (helper_gemm.h) over shapes x transposes x alpha / beta on sub-matrices of padded
+// buffers, then its GFLOP/s per transpose at gemmTestSize
+#define GEMM_TEST_SIZE 1024
+
+bool bGemmTest = false;
+int gemmTestSize = GEMM_TEST_SIZE;
+
+// out-of-core product of outOfCoreSize x outOfCoreSize matrices through blocks that fit outOfCoreMemoryCap bytes
+// of the device (0 => half of CL_DEVICE_GLOBAL_MEM_SIZE). Blocks of A and B stay cached in pools of device
+// buffers and are uploaded again only once evicted, C tiles are double-buffered
+#define OUT_OF_CORE_QUEUES 3 // 0 => block uploads, 1 => multiply-accumulates, 2 => C tile writebacks
+#define OUT_OF_CORE_C_TILES 2
+#define OUT_OF_CORE_MIN_BLOCK 16
+#define OUT_OF_CORE_SAMPLES 4096
+
+typedef struct OutOfCoreBlock
+{
+    cl_mem buffer;
+    long long key;            // block row * blocks + block column of the block it holds, -1 when empty
+    cl_event written;         // its upload
+    cl_event lastUse;         // the last multiply-accumulate reading it, the next upload into it waits for it
+    unsigned long long touch; // least recently used is evicted first
+} OutOfCoreBlock;
+
+bool bOutOfCore = false;
+int outOfCoreSize = 0;
+cl_ulong outOfCoreMemoryCap = 0;
+
+cl_command_queue oclOutOfCoreQueues[OUT_OF_CORE_QUEUES] = {NULL, NULL, NULL};
+std::vector<OutOfCoreBlock> outOfCorePoolA;
+std::vector<OutOfCoreBlock> outOfCorePoolB;
+std::vector<OutOfCoreBlock> outOfCoreTilesC; // written is unused, lastUse is the writeback of the tile
+std::vector<cl_event> outOfCoreEvents[OUT_OF_CORE_QUEUES]; // every command, for the busy times
+
+// multi-device product of multiDeviceSize x multiDeviceSize matrices : row-major ranges of the MULTI_DEVICE_BLOCK x
+// MULTI_DEVICE_BLOCK blocks of C go to every device of multiDeviceType on every platform, sized by the GFLOP/s each
+// device measured on one block. Devices of one platform share a context, so a panel of A or B is uploaded into a
+// context once and migrated to its other devices, devices of other platforms upload their own copy
+#define MULTI_DEVICE_BLOCK 256
+#define MULTI_DEVICE_MAX 16 // devices per platform
+#define MULTI_DEVICE_SAMPLES 4096
+
+typedef struct MultiDeviceContext
+{
+    cl_platform_id platform;
+    cl_context context;
+    std::vector<cl_mem> panelsA;    // row panel i of A, NULL until a device of the context needs it
+    std::vector<cl_mem> panelsB;    // column panel j of B, packed at its own width
+    std::vector<cl_event> writtenA; // the upload of the panel, owned by the events of the device that uploaded it
+    std::vector<cl_event> writtenB;
+} MultiDeviceContext;
+
+typedef struct MultiDevice
+{
+    cl_device_id device;
+    size_t contextIndex;
+    char name[128];
+    cl_command_queue queue;
+    SpecializationCache kernelCache; // gemmGPU is built for every device, specializationCache keys on the options only
+    cl_kernel kernel;
+    cl_mem tileC;
+    double gflops;        // measured on one block, the weight of the device
+    size_t firstBlock;    // its range of blocks of C
+    size_t numberOfBlocks;
+    size_t uploads;       // panels it wrote from host memory
+    size_t migrations;    // panels another device of its context uploaded
+    std::vector<char> bHasA; // panels already on the device
+    std::vector<char> bHasB;
+    std::vector<cl_event> events; // every command, released by releaseMultiDevice()
+} MultiDevice;
+
+bool bMultiDevice = false;
+int multiDeviceSize = 0;
+cl_device_type multiDeviceType = CL_DEVICE_TYPE_ALL;
+
+std::vector<MultiDeviceContext> multiDeviceContexts;
+std::vector<MultiDevice> multiDevices;
+
+// sparse products of a sparseRows x sparseRows power-law CSR matrix with about sparseNonzerosPerRow nonzeros
+// per row (helper_sparse.h) : SpMV in every format and kernel, SpMM with SPARSE_VECTORS dense columns, float only
+#define SPARSE_NONZEROS_PER_ROW 16
+#define SPARSE_VECTORS 16      // dividing SPARSE_GROUP_SIZE
+#define SPARSE_GROUP_SIZE 128  // work-group of every sparse kernel
+#define SPARSE_MERGE_ITEMS 16  // merge path steps per work-item
+#define SPARSE_SLICE_HEIGHT 32 // C of SELL-C-sigma
+#define SPARSE_SIGMA 4096      // rows sorted by length within windows of this many, a multiple of SPARSE_SLICE_HEIGHT
+#define SPARSE_MAX_PADDING 16  // ELL / SELL holding more than this many entries per nonzero are skipped
+
+bool bSparse = false;
+int sparseRows = 0;
+int sparseNonzerosPerRow = SPARSE_NONZEROS_PER_ROW;
+std::vector<cl_mem> sparseBuffers; // released by cleanup()
+
+// matrix-vector products of a gemvRows x gemvColumns matrix (helper_gemm.h) against the dense kernel with a one
+// column B, in GB/s against gemvPeakBandwidth (0 => measured with a device to device copy)
+#define GEMV_MAX_GROUP_SIZE 256
+#define GEMV_COLUMNS 32                  // columns per work-group of gemvTransposedGPU
+#define GEMV_MAX_COPY_BYTES (256 << 20) // of the copy measuring the peak
+
+bool bGemv = false;
+int gemvRows = 0;
+int gemvColumns = 0;
+double gemvPeakBandwidth = 0.0; // GB/s
+
+// device : the first platform with a device of this type, -device cpu runs on a CPU OpenCL device
+cl_device_type oclDeviceType = CL_DEVICE_TYPE_GPU;
+
+// OpenCL kernels
+// matrixMultiplyGPU reads A and B from global memory for every multiply-add, matrixMultiplyTiledGPU stages
+// TILE_SIZE x TILE_SIZE blocks of both in local memory (work-group of TILE_SIZE x TILE_SIZE, dimension 0 runs
+// along the columns of C, partial tiles are padded with 0), matrixMultiplyBlockedGPU / PackedGPU accumulate a
+// MICRO_M x MICRO_N block of C per work-item in registers, the packed one from B repacked by packMatrixB.
+// -D FIXED_A_ROWS / A_COLUMNS / B_COLUMNS / C_COLUMNS bake the dimensions into a specialized build (the depth loop
+// is unrolled), FIXED_LOCAL_SIZE_X / Y the work-group size, EXACT_GRID drops the bounds check when the grid
+// matches C exactly and ELEMENT_TYPE (A, B) / RESULT_TYPE (C) / ACCUMULATOR_TYPE the types, without them the
+// arguments are used
+const char *oclSourceCode =
+    "#if defined(cl_khr_fp64)                                                                                                                                                          \n"
+    "#pragma OPENCL EXTENSION cl_khr_fp64 : enable                                                                                                                                     \n"
+    "#endif                                                                                                                                                                            \n"
+    "#if defined(cl_khr_fp16)                                                                                                                                                          \n"
+    "#pragma OPENCL EXTENSION cl_khr_fp16 : enable                                                                                                                                     \n"
+    "#endif                                                                                                                                                                            \n"
+    "#ifndef ELEMENT_TYPE                                                                                                                                                              \n"
+    "#define ELEMENT_TYPE int                                                                                                                                                          \n"
+    "#endif                                                                                                                                                                            \n"
+    "#ifndef ACCUMULATOR_TYPE                                                                                                                                                          \n"
+    "#define ACCUMULATOR_TYPE long                                                                                                                                                     \n"
+    "#endif                                                                                                                                                                            \n"
+    "#ifndef RESULT_TYPE                                                                                                                                                               \n"
+    "#define RESULT_TYPE ELEMENT_TYPE                                                                                                                                                  \n"
+    "#endif                                                                                                                                                                            \n"
+    "#ifdef FIXED_A_ROWS                                                                                                                                                               \n"
+    "#define A_ROWS FIXED_A_ROWS                                                                                                                                                       \n"
+    "#define A_COLUMNS FIXED_A_COLUMNS                                                                                                                                                 \n"
+    "#define B_COLUMNS FIXED_B_COLUMNS                                                                                                                                                 \n"
+    "#define C_COLUMNS FIXED_C_COLUMNS                                                                                                                                                 \n"
+    "#else                                                                                                                                                                             \n"
+    "#define A_ROWS numberOfARows                                                                                                                                                      \n"
+    "#define A_COLUMNS numberOfAColumns                                                                                                                                                \n"
+    "#define B_COLUMNS numberOfBColumns                                                                                                                                                \n"
+    "#define C_COLUMNS numberOfCColumns                                                                                                                                                \n"
+    "#endif                                                                                                                                                                            \n"
+    "#ifdef FIXED_LOCAL_SIZE_X                                                                                                                                                         \n"
+    "#define KERNEL_ATTRIBUTES __attribute__((reqd_work_group_size(FIXED_LOCAL_SIZE_X, FIXED_LOCAL_SIZE_Y, 1)))                                                                        \n"
+    "#else                                                                                                                                                                             \n"
+    "#define KERNEL_ATTRIBUTES                                                                                                                                                         \n"
+    "#endif                                                                                                                                                                            \n"
+    "                                                                                                                                                                                  \n"
+    "__kernel KERNEL_ATTRIBUTES void matrixMultiplyGPU(__global ELEMENT_TYPE *A, __global ELEMENT_TYPE *B, __global RESULT_TYPE *C,                                                    \n"
+    "                                                  int numberOfARows, int numberOfAColumns, int numberOfBColumns, int numberOfCColumns)                                            \n"
+    "{                                                                                                                                                                                 \n"
+    "   int rowIndex = get_global_id(0);                                                                                                                                               \n"
+    "   int columnIndex = get_global_id(1);                                                                                                                                            \n"
+    "#ifndef EXACT_GRID                                                                                                                                                                \n"
+    "   if ((rowIndex < A_ROWS) && (columnIndex < B_COLUMNS))                                                                                                                          \n"
+    "#endif                                                                                                                                                                            \n"
+    "   {                                                                                                                                                                              \n"
+    "       ACCUMULATOR_TYPE value = 0;                                                                                                                                                \n"
+    "#ifdef FIXED_A_COLUMNS                                                                                                                                                            \n"
+    "#pragma unroll                                                                                                                                                                    \n"
+    "#endif                                                                                                                                                                            \n"
+    "       for (int depth = 0; depth < A_COLUMNS; depth++)                                                                                                                            \n"
+    "       {                                                                                                                                                                          \n"
+    "           ELEMENT_TYPE a = A[rowIndex * A_COLUMNS + depth];                                                                                                                      \n"
+    "           ELEMENT_TYPE b = B[depth * B_COLUMNS + columnIndex];                                                                                                                   \n"
+    "           value += ((ACCUMULATOR_TYPE)a * b);                                                                                                                                    \n"
+    "       }                                                                                                                                                                          \n"
+    "       C[rowIndex * C_COLUMNS + columnIndex] = value;                                                                                                                             \n"
+    "   }                                                                                                                                                                              \n"
+    "}                                                                                                                                                                                 \n"
+    "                                                                                                                                                                                  \n"
+    "#ifndef TILE_SIZE                                                                                                                                                                 \n"
+    "#define TILE_SIZE 16                                                                                                                                                              \n"
+    "#endif                                                                                                                                                                            \n"
+    "#if defined(FIXED_A_ROWS) && (FIXED_A_ROWS % TILE_SIZE == 0) && (FIXED_A_COLUMNS % TILE_SIZE == 0) && (FIXED_B_COLUMNS % TILE_SIZE == 0)                                          \n"
+    "#define TILES_EXACT                                                                                                                                                               \n"
+    "#endif                                                                                                                                                                            \n"
+    "                                                                                                                                                                                  \n"
+    "__kernel __attribute__((reqd_work_group_size(TILE_SIZE, TILE_SIZE, 1)))                                                                                                           \n"
+    "void matrixMultiplyTiledGPU(__global ELEMENT_TYPE *A, __global ELEMENT_TYPE *B, __global RESULT_TYPE *C,                                                                          \n"
+    "                            int numberOfARows, int numberOfAColumns, int numberOfBColumns, int numberOfCColumns)                                                                  \n"
+    "{                                                                                                                                                                                 \n"
+    "   __local ELEMENT_TYPE tileA[TILE_SIZE][TILE_SIZE];                                                                                                                              \n"
+    "   __local ELEMENT_TYPE tileB[TILE_SIZE][TILE_SIZE];                                                                                                                              \n"
+    "                                                                                                                                                                                  \n"
+    "   int localColumn = get_local_id(0);                                                                                                                                             \n"
+    "   int localRow = get_local_id(1);                                                                                                                                                \n"
+    "   int columnIndex = get_global_id(0);                                                                                                                                            \n"
+    "   int rowIndex = get_global_id(1);                                                                                                                                               \n"
+    "   int numberOfTiles = (A_COLUMNS + TILE_SIZE - 1) / TILE_SIZE;                                                                                                                   \n"
+    "                                                                                                                                                                                  \n"
+    "   ACCUMULATOR_TYPE value = 0;                                                                                                                                                    \n"
+    "   for (int tile = 0; tile < numberOfTiles; tile++)                                                                                                                               \n"
+    "   {                                                                                                                                                                              \n"
+    "       // every work-item stages one element of A and one of B, outside the matrices the tiles are padded with 0                                                                  \n"
+    "       int aColumn = tile * TILE_SIZE + localColumn;                                                                                                                              \n"
+    "       int bRow = tile * TILE_SIZE + localRow;                                                                                                                                    \n"
+    "#ifdef TILES_EXACT                                                                                                                                                                \n"
+    "       tileA[localRow][localColumn] = A[rowIndex * A_COLUMNS + aColumn];                                                                                                          \n"
+    "       tileB[localRow][localColumn] = B[bRow * B_COLUMNS + columnIndex];                                                                                                          \n"
+    "#else                                                                                                                                                                             \n"
+    "       tileA[localRow][localColumn] = ((rowIndex < A_ROWS) && (aColumn < A_COLUMNS)) ? A[rowIndex * A_COLUMNS + aColumn] : 0;                                                     \n"
+    "       tileB[localRow][localColumn] = ((bRow < A_COLUMNS) && (columnIndex < B_COLUMNS)) ? B[bRow * B_COLUMNS + columnIndex] : 0;                                                  \n"
+    "#endif                                                                                                                                                                            \n"
+    "       barrier(CLK_LOCAL_MEM_FENCE);                                                                                                                                              \n"
+    "                                                                                                                                                                                  \n"
+    "#pragma unroll                                                                                                                                                                    \n"
+    "       for (int depth = 0; depth < TILE_SIZE; depth++)                                                                                                                            \n"
+    "       {                                                                                                                                                                          \n"
+    "           value += ((ACCUMULATOR_TYPE)tileA[localRow][depth] * tileB[depth][localColumn]);                                                                                       \n"
+    "       }                                                                                                                                                                          \n"
+    "       barrier(CLK_LOCAL_MEM_FENCE);                                                                                                                                              \n"
+    "   }                                                                                                                                                                              \n"
+    "                                                                                                                                                                                  \n"
+    "#ifndef TILES_EXACT                                                                                                                                                               \n"
+    "   if ((rowIndex < A_ROWS) && (columnIndex < B_COLUMNS))                                                                                                                          \n"
+    "#endif                                                                                                                                                                            \n"
+    "   {                                                                                                                                                                              \n"
+    "       C[rowIndex * C_COLUMNS + columnIndex] = value;                                                                                                                             \n"
+    "   }                                                                                                                                                                              \n"
+    "}                                                                                                                                                                                 \n"
+    "                                                                                                                                                                                  \n"
+    "#ifndef MICRO_M                                                                                                                                                                   \n"
+    "#define MICRO_M 4                                                                                                                                                                 \n"
+    "#endif                                                                                                                                                                            \n"
+    "#ifndef MICRO_N                                                                                                                                                                   \n"
+    "#define MICRO_N 4                                                                                                                                                                 \n"
+    "#endif                                                                                                                                                                            \n"
+    "#define VECTOR4_(type) type##4                                                                                                                                                    \n"
+    "#define VECTOR4(type) VECTOR4_(type)                                                                                                                                              \n"
+    "#define CONVERT4_(type) convert_##type##4                                                                                                                                         \n"
+    "#define CONVERT4(type) CONVERT4_(type)                                                                                                                                            \n"
+    "#define ACCUMULATOR4 VECTOR4(ACCUMULATOR_TYPE)                                                                                                                                    \n"
+    "#define LOAD4(pointer) CONVERT4(ACCUMULATOR_TYPE)(vload4(0, (pointer)))                                                                                                           \n"
+    "#define NUMBER_OF_PANELS ((B_COLUMNS + MICRO_N - 1) / MICRO_N)                                                                                                                    \n"
+    "#define PANEL_STRIDE (NUMBER_OF_PANELS * 4 * MICRO_N)                                                                                                                             \n"
+    "                                                                                                                                                                                  \n"
+    "// 4 columns of one row of B as accumulators, clamped scalar loads across the right edge (those columns are never stored)                                                         \n"
+    "inline ACCUMULATOR4 loadRowOfB4(__global const ELEMENT_TYPE *rowOfB, int column, int numberOfBColumns)                                                                            \n"
+    "{                                                                                                                                                                                 \n"
+    "   if (column + 4 <= B_COLUMNS)                                                                                                                                                   \n"
+    "       return (LOAD4(rowOfB + column));                                                                                                                                           \n"
+    "                                                                                                                                                                                  \n"
+    "   ELEMENT_TYPE edge[4];                                                                                                                                                          \n"
+    "   for (int element = 0; element < 4; element++)                                                                                                                                  \n"
+    "       edge[element] = rowOfB[min(column + element, B_COLUMNS - 1)];                                                                                                              \n"
+    "   return (LOAD4(edge));                                                                                                                                                          \n"
+    "}                                                                                                                                                                                 \n"
+    "                                                                                                                                                                                  \n"
+    "// one MICRO_M x MICRO_N block of C per work-item, accumulated in registers from vload4 loads of A and B (MICRO_N is a multiple of 4).                                            \n"
+    "// packed B is stored in 4 x MICRO_N blocks, one per 4 depths and MICRO_N columns, zero padded, so its loads never need a check                                                   \n"
+    "inline void multiplyMicroTile(__global const ELEMENT_TYPE *A, __global const ELEMENT_TYPE *B, __global RESULT_TYPE *C,                                                            \n"
+    "                              int numberOfARows, int numberOfAColumns, int numberOfBColumns, int numberOfCColumns, int bPackedB)                                                  \n"
+    "{                                                                                                                                                                                 \n"
+    "   int columnBase = get_global_id(0) * MICRO_N;                                                                                                                                   \n"
+    "   int rowBase = get_global_id(1) * MICRO_M;                                                                                                                                      \n"
+    "   if ((rowBase >= A_ROWS) || (columnBase >= B_COLUMNS))                                                                                                                          \n"
+    "       return;                                                                                                                                                                    \n"
+    "                                                                                                                                                                                  \n"
+    "   // rows below the bottom edge repeat the last row of A, their results are never stored                                                                                         \n"
+    "   __global const ELEMENT_TYPE *rowOfA[MICRO_M];                                                                                                                                  \n"
+    "   ACCUMULATOR4 accumulator[MICRO_M][MICRO_N / 4];                                                                                                                                \n"
+    "#pragma unroll                                                                                                                                                                    \n"
+    "   for (int row = 0; row < MICRO_M; row++)                                                                                                                                        \n"
+    "   {                                                                                                                                                                              \n"
+    "       rowOfA[row] = A + min(rowBase + row, A_ROWS - 1) * A_COLUMNS;                                                                                                              \n"
+    "#pragma unroll                                                                                                                                                                    \n"
+    "       for (int vector = 0; vector < MICRO_N / 4; vector++)                                                                                                                       \n"
+    "           accumulator[row][vector] = (ACCUMULATOR4)(0);                                                                                                                          \n"
+    "   }                                                                                                                                                                              \n"
+    "   __global const ELEMENT_TYPE *panelOfB = B + (columnBase / MICRO_N) * (4 * MICRO_N);                                                                                            \n"
+    "                                                                                                                                                                                  \n"
+    "   int depth = 0;                                                                                                                                                                 \n"
+    "   for (; depth + 4 <= A_COLUMNS; depth += 4)                                                                                                                                     \n"
+    "   {                                                                                                                                                                              \n"
+    "       ACCUMULATOR4 b[4][MICRO_N / 4];                                                                                                                                            \n"
+    "#pragma unroll                                                                                                                                                                    \n"
+    "       for (int step = 0; step < 4; step++)                                                                                                                                       \n"
+    "       {                                                                                                                                                                          \n"
+    "#pragma unroll                                                                                                                                                                    \n"
+    "           for (int vector = 0; vector < MICRO_N / 4; vector++)                                                                                                                   \n"
+    "               b[step][vector] = bPackedB ? LOAD4(panelOfB + (depth / 4) * PANEL_STRIDE + step * MICRO_N + vector * 4)                                                            \n"
+    "                                          : loadRowOfB4(B + (depth + step) * B_COLUMNS, columnBase + vector * 4, numberOfBColumns);                                               \n"
+    "       }                                                                                                                                                                          \n"
+    "                                                                                                                                                                                  \n"
+    "#pragma unroll                                                                                                                                                                    \n"
+    "       for (int row = 0; row < MICRO_M; row++)                                                                                                                                    \n"
+    "       {                                                                                                                                                                          \n"
+    "           ACCUMULATOR4 a = LOAD4(rowOfA[row] + depth);                                                                                                                           \n"
+    "#pragma unroll                                                                                                                                                                    \n"
+    "           for (int vector = 0; vector < MICRO_N / 4; vector++)                                                                                                                   \n"
+    "           {                                                                                                                                                                      \n"
+    "               // one depth at a time, the same order of additions as the host reference                                                                                          \n"
+    "               accumulator[row][vector] += a.s0 * b[0][vector];                                                                                                                   \n"
+    "               accumulator[row][vector] += a.s1 * b[1][vector];                                                                                                                   \n"
+    "               accumulator[row][vector] += a.s2 * b[2][vector];                                                                                                                   \n"
+    "               accumulator[row][vector] += a.s3 * b[3][vector];                                                                                                                   \n"
+    "           }                                                                                                                                                                      \n"
+    "       }                                                                                                                                                                          \n"
+    "   }                                                                                                                                                                              \n"
+    "                                                                                                                                                                                  \n"
+    "   // the last 1 to 3 depths when A_COLUMNS is not a multiple of 4                                                                                                                \n"
+    "   for (; depth < A_COLUMNS; depth++)                                                                                                                                             \n"
+    "   {                                                                                                                                                                              \n"
+    "#pragma unroll                                                                                                                                                                    \n"
+    "       for (int vector = 0; vector < MICRO_N / 4; vector++)                                                                                                                       \n"
+    "       {                                                                                                                                                                          \n"
+    "           ACCUMULATOR4 b = bPackedB ? LOAD4(panelOfB + (depth / 4) * PANEL_STRIDE + (depth % 4) * MICRO_N + vector * 4)                                                          \n"
+    "                                     : loadRowOfB4(B + depth * B_COLUMNS, columnBase + vector * 4, numberOfBColumns);                                                             \n"
+    "#pragma unroll                                                                                                                                                                    \n"
+    "           for (int row = 0; row < MICRO_M; row++)                                                                                                                                \n"
+    "               accumulator[row][vector] += (ACCUMULATOR_TYPE)rowOfA[row][depth] * b;                                                                                              \n"
+    "       }                                                                                                                                                                          \n"
+    "   }                                                                                                                                                                              \n"
+    "                                                                                                                                                                                  \n"
+    "#pragma unroll                                                                                                                                                                    \n"
+    "   for (int row = 0; row < MICRO_M; row++)                                                                                                                                        \n"
+    "   {                                                                                                                                                                              \n"
+    "       if (rowBase + row >= A_ROWS)                                                                                                                                               \n"
+    "           break;                                                                                                                                                                 \n"
+    "       __global RESULT_TYPE *rowOfC = C + (rowBase + row) * C_COLUMNS;                                                                                                            \n"
+    "#pragma unroll                                                                                                                                                                    \n"
+    "       for (int vector = 0; vector < MICRO_N / 4; vector++)                                                                                                                       \n"
+    "       {                                                                                                                                                                          \n"
+    "           int column = columnBase + vector * 4;                                                                                                                                  \n"
+    "           if (column + 4 <= B_COLUMNS)                                                                                                                                           \n"
+    "           {                                                                                                                                                                      \n"
+    "               vstore4(CONVERT4(RESULT_TYPE)(accumulator[row][vector]), 0, rowOfC + column);                                                                                      \n"
+    "           }                                                                                                                                                                      \n"
+    "           else                                                                                                                                                                   \n"
+    "           {                                                                                                                                                                      \n"
+    "               ACCUMULATOR_TYPE edge[4];                                                                                                                                          \n"
+    "               vstore4(accumulator[row][vector], 0, edge);                                                                                                                        \n"
+    "               for (int element = 0; (element < 4) && (column + element < B_COLUMNS); element++)                                                                                  \n"
+    "                   rowOfC[column + element] = edge[element];                                                                                                                      \n"
+    "           }                                                                                                                                                                      \n"
+    "       }                                                                                                                                                                          \n"
+    "   }                                                                                                                                                                              \n"
+    "}                                                                                                                                                                                 \n"
+    "                                                                                                                                                                                  \n"
+    "__kernel KERNEL_ATTRIBUTES void matrixMultiplyBlockedGPU(__global ELEMENT_TYPE *A, __global ELEMENT_TYPE *B, __global RESULT_TYPE *C,                                             \n"
+    "                                                         int numberOfARows, int numberOfAColumns, int numberOfBColumns, int numberOfCColumns)                                     \n"
+    "{                                                                                                                                                                                 \n"
+    "   multiplyMicroTile(A, B, C, numberOfARows, numberOfAColumns, numberOfBColumns, numberOfCColumns, 0);                                                                            \n"
+    "}                                                                                                                                                                                 \n"
+    "                                                                                                                                                                                  \n"
+    "__kernel KERNEL_ATTRIBUTES void matrixMultiplyPackedGPU(__global ELEMENT_TYPE *A, __global ELEMENT_TYPE *packedB, __global RESULT_TYPE *C,                                        \n"
+    "                                                        int numberOfARows, int numberOfAColumns, int numberOfBColumns, int numberOfCColumns)                                      \n"
+    "{                                                                                                                                                                                 \n"
+    "   multiplyMicroTile(A, packedB, C, numberOfARows, numberOfAColumns, numberOfBColumns, numberOfCColumns, 1);                                                                      \n"
+    "}                                                                                                                                                                                 \n"
+    "                                                                                                                                                                                  \n"
+    "// B (A_COLUMNS x B_COLUMNS) into the packed layout, one work-item per packed element, depths padded to a multiple of 4                                                           \n"
+    "__kernel void packMatrixB(__global ELEMENT_TYPE *B, __global ELEMENT_TYPE *packedB, int numberOfAColumns, int numberOfBColumns)                                                   \n"
+    "{                                                                                                                                                                                 \n"
+    "   int column = get_global_id(0);                                                                                                                                                 \n"
+    "   int depth = get_global_id(1);                                                                                                                                                  \n"
+    "   if ((column >= NUMBER_OF_PANELS * MICRO_N) || (depth >= (A_COLUMNS + 3) / 4 * 4))                                                                                              \n"
+    "       return;                                                                                                                                                                    \n"
+    "   packedB[(depth / 4) * PANEL_STRIDE + (column / MICRO_N) * (4 * MICRO_N) + (depth % 4) * MICRO_N + column % MICRO_N] =                                                          \n"
+    "       ((depth < A_COLUMNS) && (column < B_COLUMNS)) ? B[depth * B_COLUMNS + column] : 0;                                                                                         \n"
+    "}                                                                                                                                                                                 \n";
 
 // main() definition
-int main(void)
+int main(int argc, char *argv[])
 {
     // local function declaration
     void InitA(int *data, int, int);
     void InitB(int *data, int, int);
-    void matMulCPU(int *, int *, int *, int, int, int, int);
+    void fillSourceMatrices(int, int, int, int);
+    void matMulCPU(const void *, const void *, void *, int, int, int, int);
+    void *allocateHostMatrix(size_t);
+    void tuneLocalWorkSize(int, int, int, int);
+    cl_kernel specializeMatrixMultiply(int, int, int, int);
+    void matMulGlobalWorkSize(int, int, int, const size_t *, size_t[2]);
+    size_t packedMatrixBSize(int, int);
+    void enqueuePackMatrixB(cl_mem, int, int, cl_event *);
+    void matMulSweep(void);
+    void gemmTestMatrix(void);
+    void matMulOutOfCore(void);
+    void matMulMultiDevice(void);
+    void matMulSparse(void);
+    void matMulGemv(void);
     void cleanup(void);
 
     // local variable declaration
@@ -75,43 +531,236 @@ int main(void)
     cl_int result;
 
     // code
-    int sizeA = (numberOfARows * numberOfAColumns * sizeof(int));
-    int sizeB = (numberOfBRows * numberOfBColumns * sizeof(int));
-    int sizeC = (numberOfCRows * numberOfCColumns * sizeof(int));
-    int sizeGold = (numberOfGoldRows * numberOfGoldColumns * sizeof(int));
+    // parse command line
+    for (int argIndex = 1; argIndex < argc; argIndex++)
+    {
+        if ((strcmp(argv[argIndex], "-zerocopy") == 0) && (argIndex + 1 < argc))
+        {
+            argIndex++;
+            if (strcmp(argv[argIndex], "alloc") == 0)
+                hostMemoryMode = HOST_MEMORY_ALLOC_HOST_PTR;
+            else if (strcmp(argv[argIndex], "usehost") == 0)
+                hostMemoryMode = HOST_MEMORY_USE_HOST_PTR;
+            else
+                hostMemoryMode = -1;
+        }
+        else if ((strcmp(argv[argIndex], "-trace") == 0) && (argIndex + 1 < argc))
+        {
+            traceLog.path = argv[++argIndex];
+        }
+        else if ((strcmp(argv[argIndex], "-local") == 0) && (argIndex + 1 < argc))
+        {
+            if ((sscanf(argv[++argIndex], "%zux%zu", &localWorkSize[0], &localWorkSize[1]) != 2) || (localWorkSize[0] == 0) || (localWorkSize[1] == 0) ||
+                (BLOCK_WIDTH % localWorkSize[0] != 0) || (BLOCK_WIDTH % localWorkSize[1] != 0))
+                hostMemoryMode = -1;
+        }
+        else if (strcmp(argv[argIndex], "-retune") == 0)
+        {
+            bRetune = true;
+        }
+        else if ((strcmp(argv[argIndex], "-kernel") == 0) && (argIndex + 1 < argc))
+        {
+            argIndex++;
+            matMulKernel = -1;
+            for (int kernel = 0; kernel < NUMBER_OF_MATMUL_KERNELS; kernel++)
+            {
+                if (strcmp(argv[argIndex], matMulKernelOptions[kernel]) == 0)
+                    matMulKernel = kernel;
+            }
+            if (matMulKernel < 0)
+                hostMemoryMode = -1;
+        }
+        else if ((strcmp(argv[argIndex], "-type") == 0) && (argIndex + 1 < argc))
+        {
+            argIndex++;
+            matMulType = -1;
+            for (int type = 0; type < NUMBER_OF_MATMUL_TYPES; type++)
+            {
+                if (strcmp(argv[argIndex], matMulTypes[type].option) == 0)
+                    matMulType = type;
+            }
+            if (matMulType < 0)
+                hostMemoryMode = -1;
+        }
+        else if ((strcmp(argv[argIndex], "-tile") == 0) && (argIndex + 1 < argc))
+        {
+            tileSize = atoi(argv[++argIndex]);
+            if ((tileSize < 1) || (tileSize > MAX_TILE_SIZE))
+                hostMemoryMode = -1;
+        }
+        else if ((strcmp(argv[argIndex], "-micro") == 0) && (argIndex + 1 < argc))
+        {
+            if ((sscanf(argv[++argIndex], "%dx%d", &microTileRows, &microTileColumns) != 2) || (microTileRows < 1) || (microTileRows > MAX_MICRO_TILE_ROWS) ||
+                ((microTileColumns != 4) && (microTileColumns != 8)))
+                hostMemoryMode = -1;
+        }
+        else if (strcmp(argv[argIndex], "-sweep") == 0)
+        {
+            bSweep = true;
+        }
+        else if ((strcmp(argv[argIndex], "-sweepmax") == 0) && (argIndex + 1 < argc))
+        {
+            bSweep = true;
+            sweepMaxSize = atoi(argv[++argIndex]);
+            if (sweepMaxSize < SWEEP_MIN_SIZE)
+                hostMemoryMode = -1;
+        }
+        else if (strcmp(argv[argIndex], "-gemmtest") == 0)
+        {
+            bGemmTest = true;
+        }
+        else if ((strcmp(argv[argIndex], "-gemmsize") == 0) && (argIndex + 1 < argc))
+        {
+            bGemmTest = true;
+            gemmTestSize = atoi(argv[++argIndex]);
+            if (gemmTestSize < 1)
+                hostMemoryMode = -1;
+        }
+        else if ((strcmp(argv[argIndex], "-outofcore") == 0) && (argIndex + 1 < argc))
+        {
+            bOutOfCore = true;
+            outOfCoreSize = atoi(argv[++argIndex]);
+            if (outOfCoreSize < 1)
+                hostMemoryMode = -1;
+        }
+        else if ((strcmp(argv[argIndex], "-memcap") == 0) && (argIndex + 1 < argc))
+        {
+            outOfCoreMemoryCap = (cl_ulong)strtoull(argv[++argIndex], NULL, 10) << 20;
+            if (outOfCoreMemoryCap == 0)
+                hostMemoryMode = -1;
+        }
+        else if ((strcmp(argv[argIndex], "-multidevice") == 0) && (argIndex + 1 < argc))
+        {
+            bMultiDevice = true;
+            multiDeviceSize = atoi(argv[++argIndex]);
+            if (multiDeviceSize < 1)
+                hostMemoryMode = -1;
+        }
+        else if ((strcmp(argv[argIndex], "-devices") == 0) && (argIndex + 1 < argc) &&
+                 ((strcmp(argv[argIndex + 1], "all") == 0) || (strcmp(argv[argIndex + 1], "gpu") == 0) || (strcmp(argv[argIndex + 1], "cpu") == 0)))
+        {
+            argIndex++;
+            if (strcmp(argv[argIndex], "all") == 0)
+                multiDeviceType = CL_DEVICE_TYPE_ALL;
+            else
+                multiDeviceType = (strcmp(argv[argIndex], "gpu") == 0) ? CL_DEVICE_TYPE_GPU : CL_DEVICE_TYPE_CPU;
+        }
+        else if ((strcmp(argv[argIndex], "-sparse") == 0) && (argIndex + 1 < argc))
+        {
+            bSparse = true;
+            sparseRows = atoi(argv[++argIndex]);
+            if (sparseRows < 1)
+                hostMemoryMode = -1;
+        }
+        else if ((strcmp(argv[argIndex], "-nnzperrow") == 0) && (argIndex + 1 < argc))
+        {
+            sparseNonzerosPerRow = atoi(argv[++argIndex]);
+            if (sparseNonzerosPerRow < 1)
+                hostMemoryMode = -1;
+        }
+        else if ((strcmp(argv[argIndex], "-gemv") == 0) && (argIndex + 1 < argc))
+        {
+            bGemv = true;
+            if ((sscanf(argv[++argIndex], "%dx%d", &gemvRows, &gemvColumns) != 2) || (gemvRows < 1) || (gemvColumns < 1))
+                hostMemoryMode = -1;
+        }
+        else if ((strcmp(argv[argIndex], "-peakbw") == 0) && (argIndex + 1 < argc))
+        {
+            gemvPeakBandwidth = atof(argv[++argIndex]);
+            if (gemvPeakBandwidth <= 0.0)
+                hostMemoryMode = -1;
+        }
+        else if ((strcmp(argv[argIndex], "-device") == 0) && (argIndex + 1 < argc) && ((strcmp(argv[argIndex + 1], "gpu") == 0) || (strcmp(argv[argIndex + 1], "cpu") == 0)))
+        {
+            oclDeviceType = (strcmp(argv[++argIndex], "gpu") == 0) ? CL_DEVICE_TYPE_GPU : CL_DEVICE_TYPE_CPU;
+        }
+        else if ((strcmp(argv[argIndex], "-cpu") == 0) && (argIndex + 1 < argc) && ((strcmp(argv[argIndex + 1], "naive") == 0) || (strcmp(argv[argIndex + 1], "blocked") == 0)))
+        {
+            bBlockedCPU = (strcmp(argv[++argIndex], "blocked") == 0);
+        }
+        else if ((strcmp(argv[argIndex], "-threads") == 0) && (argIndex + 1 < argc))
+        {
+            numberOfCPUThreads = (unsigned int)atoi(argv[++argIndex]);
+        }
+        else if ((strcmp(argv[argIndex], "-specialize") == 0) && (argIndex + 1 < argc) && ((strcmp(argv[argIndex + 1], "on") == 0) || (strcmp(argv[argIndex + 1], "off") == 0)))
+        {
+            bSpecialize = (strcmp(argv[++argIndex], "on") == 0);
+        }
+        else
+        {
+            hostMemoryMode = -1;
+        }
 
-    // host memory allocation
-    hostA = (int *)malloc(sizeA);
-    if (hostA == NULL)
+        if (hostMemoryMode < HOST_MEMORY_COPY)
+        {
+            printf("usage : %s [-type float|double|half|int32|int8] [-kernel naive|tiled|blocked|packed] [-tile size (1 To %d)] [-micro rowsxcolumns (1 To %d x 4|8)] [-zerocopy alloc|usehost] [-local rowsxcolumns (dividing %d)] [-retune] [-specialize on|off] [-sweep] [-sweepmax size] [-gemmtest] [-gemmsize size] [-outofcore size] [-memcap MB] [-device gpu|cpu] [-multidevice size] [-devices all|gpu|cpu] [-sparse rows] [-nnzperrow n] [-gemv rowsxcolumns] [-peakbw GB/s] [-cpu naive|blocked] [-threads count] [-trace file.json]\n",
+                   argv[0], MAX_TILE_SIZE, MAX_MICRO_TILE_ROWS, BLOCK_WIDTH);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    if (((bSweep == true) || (bGemmTest == true) || (bOutOfCore == true) || (bMultiDevice == true) || (bSparse == true) || (bGemv == true)) && (hostMemoryMode != HOST_MEMORY_COPY))
     {
-        printf("error>> Host Memory Allocation Failed For hostA Matrix. Terminating Now...\n");
-        cleanup();
+        printf("error>> -sweep / -gemmtest / -outofcore / -multidevice / -sparse / -gemv Use Explicit Copies And Cannot Be Combined With -zerocopy. Terminating Now...\n");
         exit(EXIT_FAILURE);
     }
 
-    hostB = (int *)malloc(sizeB);
-    if (hostB == NULL)
+    if ((bOutOfCore == true) && (matMulType == MATMUL_TYPE_HALF))
     {
-        printf("error>> Host Memory Allocation Failed For hostB Matrix. Terminating Now...\n");
-        cleanup();
+        // partial sums of the depth blocks are kept in C, half would round every one of them
+        printf("error>> -outofcore Accumulates Depth Blocks In C, Which -type half Cannot Hold Exactly. Terminating Now...\n");
         exit(EXIT_FAILURE);
     }
 
-    hostC = (int *)malloc(sizeC);
-    if (hostC == NULL)
+    // host product configuration
+    if (numberOfCPUThreads == 0)
+        numberOfCPUThreads = getNumberOfCPUThreads();
+    cpuSimdLevel = getCPUSimdLevel();
+
+    const MatMulType *type = &matMulTypes[matMulType];
+    int sizeA = (numberOfARows * numberOfAColumns * type->host.elementSize);
+    int sizeB = (numberOfBRows * numberOfBColumns * type->host.elementSize);
+    int sizeC = (numberOfCRows * numberOfCColumns * type->host.resultSize);
+    int sizeGold = (numberOfGoldRows * numberOfGoldColumns * type->host.resultSize);
+
+    // host memory allocation
+    // (with CL_MEM_ALLOC_HOST_PTR the host matrices are mapped from the device buffers later)
+    int traceSlice = traceBegin(&traceLog, "Host Allocation", "host");
+    if (hostMemoryMode != HOST_MEMORY_ALLOC_HOST_PTR)
     {
-        printf("error>> Host Memory Allocation Failed For hostC Matrix. Terminating Now...\n");
-        cleanup();
-        exit(EXIT_FAILURE);
+        hostA = allocateHostMatrix(sizeA);
+        if (hostA == NULL)
+        {
+            printf("error>> Host Memory Allocation Failed For hostA Matrix. Terminating Now...\n");
+            cleanup();
+            exit(EXIT_FAILURE);
+        }
+
+        hostB = allocateHostMatrix(sizeB);
+        if (hostB == NULL)
+        {
+            printf("error>> Host Memory Allocation Failed For hostB Matrix. Terminating Now...\n");
+            cleanup();
+            exit(EXIT_FAILURE);
+        }
+
+        hostC = allocateHostMatrix(sizeC);
+        if (hostC == NULL)
+        {
+            printf("error>> Host Memory Allocation Failed For hostC Matrix. Terminating Now...\n");
+            cleanup();
+            exit(EXIT_FAILURE);
+        }
     }
 
-    gold = (int *)malloc(sizeGold);
+    gold = malloc(sizeGold);
     if (gold == NULL)
     {
         printf("error>> Host Memory Allocation Failed For gold Matrix. Terminating Now...\n");
         cleanup();
         exit(EXIT_FAILURE);
     }
+    traceEnd(&traceLog, traceSlice);
 
     // print matrix dimensions and sizes
     printf("\n==============================================================================================\n");
@@ -130,11 +779,18 @@ int main(void)
     printf("  Size Of Matrix 'gold'                : %d\n\n", sizeGold);
 
     // fill source matrices
-    InitA(hostA, numberOfARows, numberOfAColumns);
-    InitA(hostB, numberOfBRows, numberOfBColumns);
+    if (hostMemoryMode != HOST_MEMORY_ALLOC_HOST_PTR)
+    {
+        traceSlice = traceBegin(&traceLog, "Fill Source Matrices", "host");
+        fillSourceMatrices(numberOfARows, numberOfAColumns, numberOfBRows, numberOfBColumns);
+        traceEnd(&traceLog, traceSlice);
+    }
 
-    // get OpenCL supporting platform's ID
-    result = clGetPlatformIDs(1, &oclPlatformID, NULL);
+    // get OpenCL supporting platforms' IDs
+    traceSlice = traceBegin(&traceLog, "Platform Discovery", "setup");
+    cl_platform_id platformIDs[16];
+    cl_uint numberOfPlatforms = 0;
+    result = clGetPlatformIDs(16, platformIDs, &numberOfPlatforms);
     if (result != CL_SUCCESS)
     {
         printf("error>> clGetPlatformIDs() Failed : %d. Terminating Now ...\n", result);
@@ -142,8 +798,13 @@ int main(void)
         exit(EXIT_FAILURE);
     }
 
-    // get OpenCL supporting GPU device's ID
-    result = clGetDeviceIDs(oclPlatformID, CL_DEVICE_TYPE_GPU, 1, &oclComputeDeviceID, NULL);
+    // get the first OpenCL supporting device of the -device type (GPU by default)
+    result = CL_DEVICE_NOT_FOUND;
+    for (cl_uint platform = 0; (platform < numberOfPlatforms) && (platform < 16) && (result != CL_SUCCESS); platform++)
+    {
+        oclPlatformID = platformIDs[platform];
+        result = clGetDeviceIDs(oclPlatformID, oclDeviceType, 1, &oclComputeDeviceID, NULL);
+    }
     if (result != CL_SUCCESS)
     {
         printf("error>> clGetDeviceIDs() Failed : %d. Terminating Now ...\n", result);
@@ -151,6 +812,19 @@ int main(void)
         exit(EXIT_FAILURE);
     }
 
+    // double and half kernels need the device extension for the type
+    if (type->extension != NULL)
+    {
+        char deviceExtensions[4096] = "";
+        clGetDeviceInfo(oclComputeDeviceID, CL_DEVICE_EXTENSIONS, sizeof(deviceExtensions) - 1, deviceExtensions, NULL);
+        if (strstr(deviceExtensions, type->extension) == NULL)
+        {
+            printf("error>> The Device Does Not Support %s, Needed By -type %s. Terminating Now ...\n", type->extension, type->option);
+            cleanup();
+            exit(EXIT_FAILURE);
+        }
+    }
+
     // create OpenCL compute context
     oclContext = clCreateContext(NULL, 1, &oclComputeDeviceID, NULL, NULL, &result);
     if (result != CL_SUCCESS)
@@ -161,7 +835,7 @@ int main(void)
     }
 
     // create command queue
-    oclCommandQueue = clCreateCommandQueue(oclContext, oclComputeDeviceID, 0, &result);
+    oclCommandQueue = clCreateCommandQueue(oclContext, oclComputeDeviceID, CL_QUEUE_PROFILING_ENABLE, &result);
     if (result != CL_SUCCESS)
     {
         printf("error>> clCreateCommandQueue() Failed : %d. Terminating Now ...\n", result);
@@ -169,17 +843,25 @@ int main(void)
         exit(EXIT_FAILURE);
     }
 
-    // create OpenCL program from .cl
-    oclProgram = clCreateProgramWithSource(oclContext, 1, (const char **)&oclSourceCode, NULL, &result);
-    if (result != CL_SUCCESS)
+    traceEnd(&traceLog, traceSlice);
+
+    // create and build OpenCL program, from the binary of an earlier run when it is still valid
+    traceSlice = traceBegin(&traceLog, "clBuildProgram", "setup");
+    cl_bool bProgramFromCache = CL_FALSE;
+    specializeDefineText(buildOptions, "ELEMENT_TYPE", type->elementType);
+    specializeDefineText(buildOptions, "RESULT_TYPE", type->resultType);
+    specializeDefineText(buildOptions, "ACCUMULATOR_TYPE", type->accumulatorType);
+    specializeDefine(buildOptions, "TILE_SIZE", tileSize);
+    specializeDefine(buildOptions, "MICRO_M", microTileRows);
+    specializeDefine(buildOptions, "MICRO_N", microTileColumns);
+    oclProgram = buildProgramWithCache(oclContext, oclComputeDeviceID, oclSourceCode, buildOptions, &result, &bProgramFromCache);
+    if (oclProgram == NULL)
     {
         printf("error>> clCreateProgramWithSource() Failed : %d. Terminating Now ...\n", result);
         cleanup();
         exit(EXIT_FAILURE);
     }
 
-    // build OpenCL program
-    result = clBuildProgram(oclProgram, 0, NULL, NULL, NULL, NULL);
     if (result != CL_SUCCESS)
     {
         size_t len;
@@ -192,8 +874,11 @@ int main(void)
         exit(EXIT_FAILURE);
     }
 
+    if (bProgramFromCache == CL_TRUE)
+        printf("info>> OpenCL Program Loaded From The Binary Cache (%s).\n", programCacheDirectory());
+
     // create OpenCL kernel by passing kernel function name that we used in .cl file
-    oclKernel = clCreateKernel(oclProgram, "matrixMultiplyGPU", &result);
+    oclKernel = clCreateKernel(oclProgram, matMulKernelNames[matMulKernel], &result);
     if (result != CL_SUCCESS)
     {
         printf("error>> clCreateKernel() Failed : %d. Terminating Now ...\n", result);
@@ -201,8 +886,83 @@ int main(void)
         exit(EXIT_FAILURE);
     }
 
-    // device memory allocation
-    deviceA = clCreateBuffer(oclContext, CL_MEM_READ_ONLY, sizeA, NULL, &result);
+    // repacks B for the packed kernel, the layout only depends on MICRO_N so the generic build serves every shape
+    oclPackKernel = clCreateKernel(oclProgram, "packMatrixB", &result);
+    if (result != CL_SUCCESS)
+    {
+        printf("error>> clCreateKernel() Failed For packMatrixB : %d. Terminating Now ...\n", result);
+        cleanup();
+        exit(EXIT_FAILURE);
+    }
+    traceEnd(&traceLog, traceSlice);
+
+    if (matMulKernel == MATMUL_KERNEL_TILED)
+    {
+        // the tiled kernel is compiled for TILE_SIZE x TILE_SIZE work-groups
+        size_t kernelWorkGroupSize = 0;
+        clGetKernelWorkGroupInfo(oclKernel, oclComputeDeviceID, CL_KERNEL_WORK_GROUP_SIZE, sizeof(kernelWorkGroupSize), &kernelWorkGroupSize, NULL);
+        if ((size_t)tileSize * tileSize > kernelWorkGroupSize)
+        {
+            printf("error>> Tiles Of %d x %d Exceed CL_KERNEL_WORK_GROUP_SIZE Of %zu. Terminating Now ...\n", tileSize, tileSize, kernelWorkGroupSize);
+            cleanup();
+            exit(EXIT_FAILURE);
+        }
+        localWorkSize[0] = tileSize;
+        localWorkSize[1] = tileSize;
+    }
+
+    // tune the work-group size unless -local gave it
+    if (localWorkSize[0] == 0)
+    {
+        traceSlice = traceBegin(&traceLog, "tuneLocalWorkSize", "setup");
+        tuneLocalWorkSize(numberOfARows, numberOfAColumns, numberOfBColumns, numberOfCColumns);
+        traceEnd(&traceLog, traceSlice);
+    }
+
+    if ((bSweep == true) || (bGemmTest == true) || (bOutOfCore == true) || (bMultiDevice == true) || (bSparse == true) || (bGemv == true))
+    {
+        // the sweep, the GEMM test matrix, the out-of-core, multi-device, sparse and matrix-vector products replace the single BLOCK_WIDTH x BLOCK_WIDTH run
+        if (bSweep == true)
+            matMulSweep();
+        if (bGemmTest == true)
+            gemmTestMatrix();
+        if (bOutOfCore == true)
+            matMulOutOfCore();
+        if (bMultiDevice == true)
+            matMulMultiDevice();
+        if (bSparse == true)
+            matMulSparse();
+        if (bGemv == true)
+            matMulGemv();
+        cleanup();
+        return (0);
+    }
+
+    // hot shapes get a build with the dimensions and work-group size baked in, generic shapes keep the generic kernel
+    if (numberOfAColumns > SPECIALIZE_MAX_DEPTH)
+        bSpecialize = false;
+
+    if (bSpecialize == true)
+    {
+        cl_kernel specializedVariant = specializeMatrixMultiply(numberOfARows, numberOfAColumns, numberOfBColumns, numberOfCColumns);
+        if (specializedVariant != NULL)
+        {
+            // oclKernel holds its own reference, the cache keeps the other one
+            clRetainKernel(specializedVariant);
+            clReleaseKernel(oclKernel);
+            oclKernel = specializedVariant;
+        }
+    }
+
+    // device memory allocation (zero-copy modes put the buffers on host visible memory)
+    traceSlice = traceBegin(&traceLog, "Device Allocation", "setup");
+    cl_mem_flags hostMemoryFlag = 0;
+    if (hostMemoryMode == HOST_MEMORY_ALLOC_HOST_PTR)
+        hostMemoryFlag = CL_MEM_ALLOC_HOST_PTR;
+    else if (hostMemoryMode == HOST_MEMORY_USE_HOST_PTR)
+        hostMemoryFlag = CL_MEM_USE_HOST_PTR;
+
+    deviceA = clCreateBuffer(oclContext, CL_MEM_READ_ONLY | hostMemoryFlag, sizeA, (hostMemoryMode == HOST_MEMORY_USE_HOST_PTR) ? hostA : NULL, &result);
     if (result != CL_SUCCESS)
     {
         printf("error>> clCreateBuffer() Failed For 1st Input Array : %d. Terminating Now ...\n", result);
@@ -210,7 +970,7 @@ int main(void)
         exit(EXIT_FAILURE);
     }
 
-    deviceB = clCreateBuffer(oclContext, CL_MEM_READ_ONLY, sizeB, NULL, &result);
+    deviceB = clCreateBuffer(oclContext, CL_MEM_READ_ONLY | hostMemoryFlag, sizeB, (hostMemoryMode == HOST_MEMORY_USE_HOST_PTR) ? hostB : NULL, &result);
     if (result != CL_SUCCESS)
     {
         printf("error>> clCreateBuffer() Failed For 2nd Input Array : %d. Terminating Now ...\n", result);
@@ -218,7 +978,7 @@ int main(void)
         exit(EXIT_FAILURE);
     }
 
-    deviceC = clCreateBuffer(oclContext, CL_MEM_WRITE_ONLY, sizeC, NULL, &result);
+    deviceC = clCreateBuffer(oclContext, CL_MEM_WRITE_ONLY | hostMemoryFlag, sizeC, (hostMemoryMode == HOST_MEMORY_USE_HOST_PTR) ? hostC : NULL, &result);
     if (result != CL_SUCCESS)
     {
         printf("error>> clCreateBuffer() Failed For Output Array : %d. Terminating Now ...\n", result);
@@ -226,6 +986,41 @@ int main(void)
         exit(EXIT_FAILURE);
     }
 
+    if (matMulKernel == MATMUL_KERNEL_PACKED)
+    {
+        devicePackedB = clCreateBuffer(oclContext, CL_MEM_READ_WRITE, packedMatrixBSize(numberOfAColumns, numberOfBColumns), NULL, &result);
+        if (result != CL_SUCCESS)
+        {
+            printf("error>> clCreateBuffer() Failed For Packed 2nd Input Array : %d. Terminating Now ...\n", result);
+            cleanup();
+            exit(EXIT_FAILURE);
+        }
+    }
+    traceEnd(&traceLog, traceSlice);
+
+    if (hostMemoryMode == HOST_MEMORY_ALLOC_HOST_PTR)
+    {
+        // the runtime owns the memory, so fill the source matrices through a write mapping
+        bHostMatricesFromRuntime = true;
+        hostA = clEnqueueMapBuffer(oclCommandQueue, deviceA, CL_TRUE, CL_MAP_WRITE_INVALIDATE_REGION, 0, sizeA, 0, NULL, profileEvent(&profileLog, "Map A For Write", PROFILE_PHASE_MAP), &result);
+        if (result != CL_SUCCESS)
+        {
+            printf("error>> clEnqueueMapBuffer() Failed For 1st Input Array : %d. Terminating Now ...\n", result);
+            cleanup();
+            exit(EXIT_FAILURE);
+        }
+
+        hostB = clEnqueueMapBuffer(oclCommandQueue, deviceB, CL_TRUE, CL_MAP_WRITE_INVALIDATE_REGION, 0, sizeB, 0, NULL, profileEvent(&profileLog, "Map B For Write", PROFILE_PHASE_MAP), &result);
+        if (result != CL_SUCCESS)
+        {
+            printf("error>> clEnqueueMapBuffer() Failed For 2nd Input Array : %d. Terminating Now ...\n", result);
+            cleanup();
+            exit(EXIT_FAILURE);
+        }
+
+        fillSourceMatrices(numberOfARows, numberOfAColumns, numberOfBRows, numberOfBColumns);
+    }
+
     // set 0 based 0th argument i.e deviceA
     result = clSetKernelArg(oclKernel, 0, sizeof(cl_mem), (void *)&deviceA);
     if (result != CL_SUCCESS)
@@ -235,8 +1030,8 @@ int main(void)
         exit(EXIT_FAILURE);
     }
 
-    // set 0 based 1st argument i.e deviceB
-    result = clSetKernelArg(oclKernel, 1, sizeof(cl_mem), (void *)&deviceB);
+    // set 0 based 1st argument i.e deviceB (its packed copy for the packed kernel)
+    result = clSetKernelArg(oclKernel, 1, sizeof(cl_mem), (matMulKernel == MATMUL_KERNEL_PACKED) ? (void *)&devicePackedB : (void *)&deviceB);
     if (result != CL_SUCCESS)
     {
         printf("error>> clSetKernelArg() Failed For 2nd Argument : %d. Terminating Now ...\n", result);
@@ -289,34 +1084,52 @@ int main(void)
         exit(EXIT_FAILURE);
     }
 
-    // write above "input" device buffer to device memory
-    result = clEnqueueWriteBuffer(oclCommandQueue, deviceA, CL_FALSE, 0, sizeA, hostA, 0, NULL, NULL);
-    if (result != CL_SUCCESS)
+    // start timer covering the transfers too
+    traceSlice = traceBegin(&traceLog, "GPU Matrix Multiplication", "gpu");
+    StopWatchInterface *transferTimer = NULL;
+    sdkCreateTimer(&transferTimer);
+    sdkStartTimer(&transferTimer);
+
+    if (hostMemoryMode == HOST_MEMORY_COPY)
     {
-        printf("error>> clEnqueueWriteBuffer() Failed For 1st Input Device Buffer : %d. Terminating Now ...\n", result);
-        cleanup();
-        exit(EXIT_FAILURE);
-    }
+        // write above "input" device buffer to device memory
+        result = clEnqueueWriteBuffer(oclCommandQueue, deviceA, CL_FALSE, 0, sizeA, hostA, 0, NULL, profileEvent(&profileLog, "Write A", PROFILE_PHASE_H2D));
+        if (result != CL_SUCCESS)
+        {
+            printf("error>> clEnqueueWriteBuffer() Failed For 1st Input Device Buffer : %d. Terminating Now ...\n", result);
+            cleanup();
+            exit(EXIT_FAILURE);
+        }
 
-    result = clEnqueueWriteBuffer(oclCommandQueue, deviceB, CL_FALSE, 0, sizeB, hostB, 0, NULL, NULL);
-    if (result != CL_SUCCESS)
+        result = clEnqueueWriteBuffer(oclCommandQueue, deviceB, CL_FALSE, 0, sizeB, hostB, 0, NULL, profileEvent(&profileLog, "Write B", PROFILE_PHASE_H2D));
+        if (result != CL_SUCCESS)
+        {
+            printf("error>> clEnqueueWriteBuffer() Failed For 2nd Input Device Buffer : %d. Terminating Now ...\n", result);
+            cleanup();
+            exit(EXIT_FAILURE);
+        }
+    }
+    else if (hostMemoryMode == HOST_MEMORY_ALLOC_HOST_PTR)
     {
-        printf("error>> clEnqueueWriteBuffer() Failed For 2nd Input Device Buffer : %d. Terminating Now ...\n", result);
-        cleanup();
-        exit(EXIT_FAILURE);
+        // unmapping replaces clEnqueueWriteBuffer()
+        clEnqueueUnmapMemObject(oclCommandQueue, deviceA, hostA, 0, NULL, profileEvent(&profileLog, "Unmap A", PROFILE_PHASE_MAP));
+        clEnqueueUnmapMemObject(oclCommandQueue, deviceB, hostB, 0, NULL, profileEvent(&profileLog, "Unmap B", PROFILE_PHASE_MAP));
+        hostA = NULL;
+        hostB = NULL;
+        bHostMatricesFromRuntime = false;
     }
 
+    // packing is part of the run, it is timed as a kernel of its own
+    if (matMulKernel == MATMUL_KERNEL_PACKED)
+        enqueuePackMatrixB(deviceB, numberOfAColumns, numberOfBColumns, profileEvent(&profileLog, "packMatrixB", PROFILE_PHASE_KERNEL));
+
     // run the kernel
     size_t globalWorkSize[2];
-    globalWorkSize[0] = BLOCK_WIDTH;
-    globalWorkSize[1] = BLOCK_WIDTH;
-
-    // start timer
-    StopWatchInterface *timer = NULL;
-    sdkCreateTimer(&timer);
-    sdkStartTimer(&timer);
+    matMulGlobalWorkSize(matMulKernel, numberOfCRows, numberOfCColumns, (localWorkSize[0] == 0) ? NULL : localWorkSize, globalWorkSize);
 
-    result = clEnqueueNDRangeKernel(oclCommandQueue, oclKernel, 2, NULL, globalWorkSize, NULL, 0, NULL, NULL);
+    // the kernel time is START -> END of its event, without the host enqueue overhead
+    cl_event *kernelEvent = profileEvent(&profileLog, matMulKernelNames[matMulKernel], PROFILE_PHASE_KERNEL);
+    result = clEnqueueNDRangeKernel(oclCommandQueue, oclKernel, 2, NULL, globalWorkSize, (localWorkSize[0] == 0) ? NULL : localWorkSize, 0, NULL, kernelEvent);
     if (result != CL_SUCCESS)
     {
         printf("error>> clEnqueueNDRangeKernel() Failed : %d. Terminating Now ...\n", result);
@@ -324,65 +1137,97 @@ int main(void)
         exit(EXIT_FAILURE);
     }
 
-    // finish OpenCL command queue
-    clFinish(oclCommandQueue);
-
-    // stop timer
-    sdkStopTimer(&timer);
-    timeOnGPU = sdkGetTimerValue(&timer);
-    sdkDeleteTimer(&timer);
-    timer = NULL;
-
-    // read back result from the device (i.e from deviceOutput) intp cpu vairiable (i.e hostOutput)
-    result = clEnqueueReadBuffer(oclCommandQueue, deviceC, CL_TRUE, 0, sizeC, hostC, 0, NULL, NULL);
-    if (result != CL_SUCCESS)
+    if (hostMemoryMode == HOST_MEMORY_COPY)
     {
-        printf("error>> clEnqueueReadBuffer() Failed : %d. Terminating Now ...\n", result);
-        cleanup();
-        exit(EXIT_FAILURE);
+        // read back result from the device (i.e from deviceOutput) intp cpu vairiable (i.e hostOutput)
+        result = clEnqueueReadBuffer(oclCommandQueue, deviceC, CL_TRUE, 0, sizeC, hostC, 0, NULL, profileEvent(&profileLog, "Read C", PROFILE_PHASE_D2H));
+        if (result != CL_SUCCESS)
+        {
+            printf("error>> clEnqueueReadBuffer() Failed : %d. Terminating Now ...\n", result);
+            cleanup();
+            exit(EXIT_FAILURE);
+        }
     }
-
-    // matrix multiplication on host
-    matMulCPU(hostA, hostB, gold, numberOfARows, numberOfAColumns, numberOfBColumns, numberOfCColumns);
-
-    // comparison
-    int breakValue = -1;
-    bool bAccuracy = true;
-    int index;
-    for (index = 0; index < (numberOfARows * numberOfAColumns); index++)
+    else
     {
-        float val1 = gold[index];
-        float val2 = hostC[index];
-
-        if (val1 != val2)
+        // mapping for read replaces clEnqueueReadBuffer(), the sources are mapped again for the host comparison
+        // (mappings of CL_MEM_USE_HOST_PTR buffers are derived from the host matrices, which stay ours to free)
+        bHostMatricesFromRuntime = (hostMemoryMode == HOST_MEMORY_ALLOC_HOST_PTR);
+        hostA = clEnqueueMapBuffer(oclCommandQueue, deviceA, CL_FALSE, CL_MAP_READ, 0, sizeA, 0, NULL, profileEvent(&profileLog, "Map A", PROFILE_PHASE_MAP), &result);
+        if (result == CL_SUCCESS)
+            hostB = clEnqueueMapBuffer(oclCommandQueue, deviceB, CL_FALSE, CL_MAP_READ, 0, sizeB, 0, NULL, profileEvent(&profileLog, "Map B", PROFILE_PHASE_MAP), &result);
+        if (result == CL_SUCCESS)
+            hostC = clEnqueueMapBuffer(oclCommandQueue, deviceC, CL_TRUE, CL_MAP_READ, 0, sizeC, 0, NULL, profileEvent(&profileLog, "Map C", PROFILE_PHASE_MAP), &result);
+        if (result != CL_SUCCESS)
         {
-            bAccuracy = false;
-            breakValue = index;
-            break;
+            printf("error>> clEnqueueMapBuffer() Failed : %d. Terminating Now ...\n", result);
+            cleanup();
+            exit(EXIT_FAILURE);
         }
+        bDeviceBuffersMapped = true;
     }
 
-    if (bAccuracy == false)
-    {
-        printf("Break Value = %d\n", breakValue);
-    }
+    // stop timer
+    sdkStopTimer(&transferTimer);
+    traceEnd(&traceLog, traceSlice);
+    timeOnGPUWithTransfers = sdkGetTimerValue(&transferTimer);
+    sdkDeleteTimer(&transferTimer);
+    transferTimer = NULL;
+
+    timeOnGPU = (kernelEvent != NULL) ? profileEventTime(*kernelEvent) : 0.0f;
 
-    char stringMessage[125];
+    // matrix multiplication on host
+    matMulCPU(hostA, hostB, gold, numberOfARows, numberOfAColumns, numberOfBColumns, numberOfCColumns);
+
+    // comparison on all host threads, exact for every type : the reference sums in the same type and order, the
+    // blocked product reorders the sums but the small integer inputs keep every one of them exact
+    traceSlice = traceBegin(&traceLog, "verifyArrays", "host");
+    VerifyReport verifyReport = type->host.verify(hostC, gold, (size_t)numberOfCRows * numberOfCColumns);
+    traceEnd(&traceLog, traceSlice);
+    bool bAccuracy = (verifyReport.numberOfMismatches == 0);
+
+    char stringMessage[160];
     if (bAccuracy == false)
     {
-        sprintf(stringMessage, "%s", "# Comparison Of CPU And GPU Matrix Multiplication Is Not Accurate At Array %d", breakValue);
+        sprintf(stringMessage, "# Comparison Of CPU And GPU Matrix Multiplication Is Not Accurate At Array Index %zu", verifyReport.mismatchIndices[0]);
     }
     else
     {
-        sprintf(stringMessage, "%s", "# Comparison Of CPU And GPU Matrix Multiplication Is Not Accurate At Array.");
+        sprintf(stringMessage, "%s", "# Comparison Of CPU And GPU Matrix Multiplication Is Accurate.");
     }
 
+    const char *hostMemoryModeName[] = {"Explicit Copies", "Mapped CL_MEM_ALLOC_HOST_PTR", "Mapped CL_MEM_USE_HOST_PTR"};
+
     printf("\n==============================================================================================\n");
     printf("+ DISPLAYING THE RESULT OF ADDITION FROM DEVICE TO HOST +\n");
     printf("==============================================================================================\n");
 
-    printf("- The Time Taken To Do Above Calculations On CPU = %0.6f (ms)\n", timeOnCPU);
-    printf("- The Time Taken To Do Above Calculations On GPU = %0.6f (ms)\n", timeOnGPU);
+    const char *kernelBuildName = (bSpecialize == true) ? " (Specialized)" : "";
+    printf("- Element Type %s (A, B), %s (C), Accumulated In %s\n", type->elementType, type->resultType, type->accumulatorType);
+    if (localWorkSize[0] == 0)
+        printf("- OpenCL Kernel %s%s Global Work Size = %zu x %zu And Local Work Size Chosen By The Runtime\n\n", matMulKernelNames[matMulKernel], kernelBuildName, globalWorkSize[0], globalWorkSize[1]);
+    else
+        printf("- OpenCL Kernel %s%s Global Work Size = %zu x %zu And Local Work Size = %zu x %zu\n\n", matMulKernelNames[matMulKernel], kernelBuildName, globalWorkSize[0], globalWorkSize[1], localWorkSize[0], localWorkSize[1]);
+    if ((bBlockedCPU == true) && (type->host.blocked != NULL))
+        printf("- The Time Taken To Do Above Calculations On CPU (Blocked %s, %u Threads) = %0.6f (ms), %0.3f (GFLOP/s)\n", getCPUSimdName(cpuSimdLevel), numberOfCPUThreads,
+               timeOnCPU, (timeOnCPU > 0.0f) ? (2.0 * numberOfARows * numberOfAColumns * numberOfBColumns) / (timeOnCPU * 1.0e6) : 0.0);
+    else
+        printf("- The Time Taken To Do Above Calculations On CPU (Reference Loop) = %0.6f (ms), %0.3f (GFLOP/s)\n", timeOnCPU,
+               (timeOnCPU > 0.0f) ? (2.0 * numberOfARows * numberOfAColumns * numberOfBColumns) / (timeOnCPU * 1.0e6) : 0.0);
+    printf("- The Time Taken To Do Above Calculations On GPU (Kernel START -> END) = %0.6f (ms), %0.3f (GFLOP/s)\n", timeOnGPU,
+           (timeOnGPU > 0.0f) ? (2.0 * numberOfARows * numberOfAColumns * numberOfBColumns) / (timeOnGPU * 1.0e6) : 0.0);
+    printf("- The Time Taken To Do Above Calculations On GPU Including Host <-> Device Transfers (%s) = %0.6f (ms)\n\n", hostMemoryModeName[hostMemoryMode], timeOnGPUWithTransfers);
+    printProfileLog(&profileLog);
+    if (traceLog.path != NULL)
+    {
+        traceAddProfileLog(&traceLog, &profileLog);
+        if (writeTrace(&traceLog, "MatMul") == true)
+            printf("- Trace Written To %s (Open In ui.perfetto.dev Or chrome://tracing)\n", traceLog.path);
+        else
+            printf("- Trace Could Not Be Written To %s\n", traceLog.path);
+    }
+    printf("\n");
+    type->host.printVerifyReport(&verifyReport, hostC, gold);
     printf("%s\n", stringMessage);
     printf("==============================================================================================\n");
 
@@ -430,69 +1275,1948 @@ void InitB(int *data, int row, int column)
     }
 }
 
-// matMulCPU() definition
-void matMulCPU(int *A, int *B, int *C, int iARows, int iAColumns, int iBColumns, int iCColumns)
+// fillSourceMatrices() definition
+void fillSourceMatrices(int iARows, int iAColumns, int iBRows, int iBColumns)
 {
-    // local variable declaration
-    int index;
-    int column;
-    int depth;
+    // code
+    if (matMulType == MATMUL_TYPE_INT32)
+    {
+        // sums far beyond 2^24, exact with the int64 accumulator
+        InitA((int *)hostA, iARows, iAColumns);
+        InitA((int *)hostB, iBRows, iBColumns);
+    }
+    else
+    {
+        // small values, every sum is exact in the accumulator (and 64 x 64 results in half)
+        matMulTypes[matMulType].host.fill(hostA, (size_t)iARows * iAColumns, 5);
+        matMulTypes[matMulType].host.fill(hostB, (size_t)iBRows * iBColumns, 7);
+    }
+}
 
+// matMulCPU() definition
+void matMulCPU(const void *A, const void *B, void *C, int iARows, int iAColumns, int iBColumns, int iCColumns)
+{
     // start timer
+    int traceSlice = traceBegin(&traceLog, "matMulCPU", "host");
     StopWatchInterface *timer = NULL;
     sdkCreateTimer(&timer);
     sdkStartTimer(&timer);
 
-    for (index = 0; index < iARows; index++)
-    {
-        for (column = 0; column < iBColumns; column++)
-        {
-            float value = 0.0f;
-            for (depth = 0; depth < iAColumns; depth++)
-            {
-                float a = A[index * iAColumns + depth];
-                float b = B[depth * iCColumns + column];
-
-                value += a * b;
-            }
-
-            C[index * iCColumns + column] = value;
-        }
-    }
+    // element, result and accumulator types of the kernel, blocked when the type has a blocked product
+    const GemmHostType *host = &matMulTypes[matMulType].host;
+    if ((bBlockedCPU == true) && (host->blocked != NULL))
+        host->blocked(A, B, C, iARows, iAColumns, iBColumns, iCColumns, cpuSimdLevel, numberOfCPUThreads);
+    else
+        host->reference(A, B, C, iARows, iAColumns, iBColumns, iCColumns);
 
     // stop timer
     sdkStopTimer(&timer);
+    traceEnd(&traceLog, traceSlice);
     timeOnCPU = sdkGetTimerValue(&timer);
     sdkDeleteTimer(&timer);
     timer = NULL;
 }
 
-// cleanup() definition
-void cleanup(void)
+// allocateHostMatrix() definition
+void *allocateHostMatrix(size_t size)
 {
     // code
-    if (oclSourceCode)
+    if (hostMemoryMode == HOST_MEMORY_USE_HOST_PTR)
     {
-        free((void *)oclSourceCode);
-        oclSourceCode = NULL;
+        // zero-copy wrapping needs a page aligned pointer and a size in whole cache lines
+        size = (size + 63) & ~(size_t)63;
+#if defined(WIN32) || defined(_WIN32) || defined(WIN64) || defined(_WIN64)
+        return (_aligned_malloc(size, 4096));
+#else
+        void *ptr = NULL;
+        if (posix_memalign(&ptr, 4096, size) != 0)
+            return (NULL);
+        return (ptr);
+#endif
     }
 
-    if (deviceC)
+    return (malloc(size));
+}
+
+// freeHostMatrix() definition
+void freeHostMatrix(void *ptr)
+{
+    // code
+#if defined(WIN32) || defined(_WIN32) || defined(WIN64) || defined(_WIN64)
+    if (hostMemoryMode == HOST_MEMORY_USE_HOST_PTR)
     {
-        clReleaseMemObject(deviceC);
-        deviceC = NULL;
+        _aligned_free(ptr);
+        return;
     }
+#endif
+    free(ptr);
+}
 
-    if (deviceB)
+// tuneLocalWorkSize() definition
+void tuneLocalWorkSize(int iARows, int iAColumns, int iBColumns, int iCColumns)
+{
+    // local function declaration
+    void matMulGlobalWorkSize(int, int, int, const size_t *, size_t[2]);
+    size_t packedMatrixBSize(int, int);
+    void cleanup(void);
+
+    // local variable declaration
+    char key[TUNE_KEY_LENGTH];
+    size_t local[3];
+    cl_mem scratchA = NULL;
+    cl_mem scratchB = NULL;
+    cl_mem scratchC = NULL;
+    size_t sizeA = (size_t)iARows * iAColumns * matMulTypes[matMulType].host.elementSize;
+    size_t sizeB = (matMulKernel == MATMUL_KERNEL_PACKED) ? packedMatrixBSize(iAColumns, iBColumns) : (size_t)iAColumns * iBColumns * matMulTypes[matMulType].host.elementSize;
+    size_t sizeC = (size_t)iARows * iCColumns * matMulTypes[matMulType].host.resultSize;
+    cl_int result;
+
+    // code
+    // scratch matrices, the real buffers may still be mapped by the host
+    scratchA = clCreateBuffer(oclContext, CL_MEM_READ_ONLY, sizeA, NULL, &result);
+    if (result == CL_SUCCESS)
+        scratchB = clCreateBuffer(oclContext, CL_MEM_READ_ONLY, sizeB, NULL, &result);
+    if (result == CL_SUCCESS)
+        scratchC = clCreateBuffer(oclContext, CL_MEM_WRITE_ONLY, sizeC, NULL, &result);
+    if (result == CL_SUCCESS)
     {
-        clReleaseMemObject(deviceB);
-        deviceB = NULL;
+        result = clSetKernelArg(oclKernel, 0, sizeof(cl_mem), (void *)&scratchA);
+        result |= clSetKernelArg(oclKernel, 1, sizeof(cl_mem), (void *)&scratchB);
+        result |= clSetKernelArg(oclKernel, 2, sizeof(cl_mem), (void *)&scratchC);
+        result |= clSetKernelArg(oclKernel, 3, sizeof(cl_int), (void *)&iARows);
+        result |= clSetKernelArg(oclKernel, 4, sizeof(cl_int), (void *)&iAColumns);
+        result |= clSetKernelArg(oclKernel, 5, sizeof(cl_int), (void *)&iBColumns);
+        result |= clSetKernelArg(oclKernel, 6, sizeof(cl_int), (void *)&iCColumns);
+    }
+    if (result != CL_SUCCESS)
+    {
+        printf("error>> Creating Work-Group Tuning Scratch Matrices Failed : %d. Terminating Now ...\n", result);
+        if (scratchC)
+            clReleaseMemObject(scratchC);
+        if (scratchB)
+            clReleaseMemObject(scratchB);
+        if (scratchA)
+            clReleaseMemObject(scratchA);
+        cleanup();
+        exit(EXIT_FAILURE);
     }
 
-    if (deviceA)
+    tuneCacheKey(oclComputeDeviceID, oclSourceCode, buildOptions, matMulKernelNames[matMulKernel], (size_t)iARows * iCColumns, key);
+
+    // OpenCL 1.2 needs the local size to divide the global size, the blocked kernels round their grid up to it
+    bool bCached = autotuneWorkGroupSize(TUNE_CACHE_FILE, bRetune, key, oclCommandQueue, oclComputeDeviceID, oclKernel, 2,
+                                         [iARows, iCColumns](const size_t *candidateLocal, size_t *global) {
+                                             matMulGlobalWorkSize(matMulKernel, iARows, iCColumns, (candidateLocal[0] == 0) ? NULL : candidateLocal, global);
+                                             return ((candidateLocal[0] == 0) || ((global[0] % candidateLocal[0] == 0) && (global[1] % candidateLocal[1] == 0)));
+                                         },
+                                         local);
+
+    clReleaseMemObject(scratchC);
+    clReleaseMemObject(scratchB);
+    clReleaseMemObject(scratchA);
+
+    localWorkSize[0] = local[0];
+    localWorkSize[1] = local[1];
+
+    if (local[0] == 0)
+        printf("info>> Work-Group Size Left To The Runtime%s\n", (bCached == true) ? " (From " TUNE_CACHE_FILE ")" : ", Stored In " TUNE_CACHE_FILE);
+    else
+        printf("info>> Work-Group Size %zu x %zu%s\n", local[0], local[1], (bCached == true) ? " From " TUNE_CACHE_FILE : ", Stored In " TUNE_CACHE_FILE);
+}
+
+// matMulGlobalWorkSize() definition
+void matMulGlobalWorkSize(int kernel, int iCRows, int iCColumns, const size_t *local, size_t globalWorkSize[2])
+{
+    // code
+    if (kernel == MATMUL_KERNEL_TILED)
     {
-        clReleaseMemObject(deviceA);
-        deviceA = NULL;
+        // columns along dimension 0, both rounded up to whole tiles
+        globalWorkSize[0] = ((size_t)iCColumns + tileSize - 1) / tileSize * tileSize;
+        globalWorkSize[1] = ((size_t)iCRows + tileSize - 1) / tileSize * tileSize;
+    }
+    else if ((kernel == MATMUL_KERNEL_BLOCKED) || (kernel == MATMUL_KERNEL_PACKED))
+    {
+        // one work-item per micro-tile, columns along dimension 0, rounded up to whole work-groups
+        globalWorkSize[0] = ((size_t)iCColumns + microTileColumns - 1) / microTileColumns;
+        globalWorkSize[1] = ((size_t)iCRows + microTileRows - 1) / microTileRows;
+        if (local != NULL)
+        {
+            globalWorkSize[0] = (globalWorkSize[0] + local[0] - 1) / local[0] * local[0];
+            globalWorkSize[1] = (globalWorkSize[1] + local[1] - 1) / local[1] * local[1];
+        }
+    }
+    else
+    {
+        globalWorkSize[0] = (size_t)iCRows;
+        globalWorkSize[1] = (size_t)iCColumns;
+    }
+}
+
+// packedMatrixBSize() definition
+size_t packedMatrixBSize(int iAColumns, int iBColumns)
+{
+    // code
+    // depths padded to a multiple of 4, columns to whole MICRO_N panels
+    return ((size_t)(iAColumns + 3) / 4 * 4 * ((iBColumns + microTileColumns - 1) / microTileColumns * microTileColumns) * matMulTypes[matMulType].host.elementSize);
+}
+
+// enqueuePackMatrixB() definition
+void enqueuePackMatrixB(cl_mem source, int iAColumns, int iBColumns, cl_event *event)
+{
+    // local function declaration
+    void cleanup(void);
+
+    // local variable declaration
+    size_t globalWorkSize[2];
+    cl_int result;
+
+    // code
+    globalWorkSize[0] = (size_t)(iBColumns + microTileColumns - 1) / microTileColumns * microTileColumns;
+    globalWorkSize[1] = (size_t)(iAColumns + 3) / 4 * 4;
+
+    result = clSetKernelArg(oclPackKernel, 0, sizeof(cl_mem), (void *)&source);
+    result |= clSetKernelArg(oclPackKernel, 1, sizeof(cl_mem), (void *)&devicePackedB);
+    result |= clSetKernelArg(oclPackKernel, 2, sizeof(cl_int), (void *)&iAColumns);
+    result |= clSetKernelArg(oclPackKernel, 3, sizeof(cl_int), (void *)&iBColumns);
+    if (result == CL_SUCCESS)
+        result = clEnqueueNDRangeKernel(oclCommandQueue, oclPackKernel, 2, NULL, globalWorkSize, NULL, 0, NULL, event);
+    if (result != CL_SUCCESS)
+    {
+        printf("error>> Packing Matrix B Failed : %d. Terminating Now ...\n", result);
+        cleanup();
+        exit(EXIT_FAILURE);
+    }
+}
+
+// matMulSweep() definition
+void matMulSweep(void)
+{
+    // local function declaration
+    void *allocateHostMatrix(size_t);
+    void freeHostMatrix(void *);
+    void matMulGlobalWorkSize(int, int, int, const size_t *, size_t[2]);
+    size_t packedMatrixBSize(int, int);
+    void enqueuePackMatrixB(cl_mem, int, int, cl_event *);
+    void cleanup(void);
+
+    // local variable declaration
+    const MatMulType *type = &matMulTypes[matMulType];
+    HostGemmBlockedFunction blockedCPU = (bBlockedCPU == true) ? type->host.blocked : NULL;
+    int numberOfSampledProducts = NUMBER_OF_MATMUL_KERNELS + ((blockedCPU != NULL) ? 1 : 0);
+    cl_kernel sweepKernels[NUMBER_OF_MATMUL_KERNELS] = {NULL};
+    cl_ulong maxMemAllocSize = 0;
+    cl_int result = CL_SUCCESS;
+
+    // code
+    // generic builds of every kernel, the same binaries run every size
+    for (int kernel = 0; kernel < NUMBER_OF_MATMUL_KERNELS; kernel++)
+    {
+        sweepKernels[kernel] = clCreateKernel(oclProgram, matMulKernelNames[kernel], &result);
+        if (result != CL_SUCCESS)
+        {
+            printf("error>> clCreateKernel() Failed For %s : %d. Terminating Now ...\n", matMulKernelNames[kernel], result);
+            while (kernel-- > 0)
+                clReleaseKernel(sweepKernels[kernel]);
+            cleanup();
+            exit(EXIT_FAILURE);
+        }
+    }
+    clGetDeviceInfo(oclComputeDeviceID, CL_DEVICE_MAX_MEM_ALLOC_SIZE, sizeof(maxMemAllocSize), &maxMemAllocSize, NULL);
+
+    printf("\n==============================================================================================\n");
+    printf("+ GFLOP/s OF EVERY %s KERNEL (TILE_SIZE %d, MICRO TILE %d x %d), FASTEST OF %d RUNS +\n", type->option, tileSize, microTileRows, microTileColumns, TUNE_RUNS);
+    if (blockedCPU != NULL)
+        printf("+ CPU : BLOCKED %s ON %u THREADS, ONE RUN +\n", getCPUSimdName(cpuSimdLevel), numberOfCPUThreads);
+    printf("==============================================================================================\n");
+    printf("  %6s", "Size");
+    for (int kernel = 0; kernel < NUMBER_OF_MATMUL_KERNELS; kernel++)
+        printf(" %9s", matMulKernelOptions[kernel]);
+    if (blockedCPU != NULL)
+        printf(" %9s", "cpu");
+    printf(" %13s", "Best / Naive");
+    if (blockedCPU != NULL)
+        printf(" %12s", "Best / CPU");
+    printf("   %s\n", "Sampled Check");
+
+    for (int size = SWEEP_MIN_SIZE; size <= sweepMaxSize; size *= 2)
+    {
+        size_t numberOfElements = (size_t)size * size;
+        size_t matrixSize = numberOfElements * type->host.elementSize;
+        size_t resultSize = numberOfElements * type->host.resultSize;
+        float time[NUMBER_OF_MATMUL_KERNELS];
+        size_t numberOfMismatches = 0;
+        char traceName[PROFILE_NAME_LENGTH];
+
+        if ((matrixSize > maxMemAllocSize) || (resultSize > maxMemAllocSize))
+        {
+            printf("  %6d Skipped, A Matrix Exceeds CL_DEVICE_MAX_MEM_ALLOC_SIZE (%llu Bytes)\n", size, (unsigned long long)maxMemAllocSize);
+            break;
+        }
+
+        sprintf(traceName, "Sweep %d x %d", size, size);
+        int traceSlice = traceBegin(&traceLog, traceName, "gpu");
+
+        // matrices of this size replace the previous ones
+        freeHostMatrix(hostA);
+        freeHostMatrix(hostB);
+        freeHostMatrix(hostC);
+        hostA = allocateHostMatrix(matrixSize);
+        hostB = allocateHostMatrix(matrixSize);
+        hostC = allocateHostMatrix(resultSize);
+        if ((hostA == NULL) || (hostB == NULL) || (hostC == NULL))
+        {
+            printf("  %6d Skipped, Host Memory Allocation Failed\n", size);
+            traceEnd(&traceLog, traceSlice);
+            break;
+        }
+
+        // small values, so every sum of 8192 products is exact in the accumulator
+        type->host.fill(hostA, numberOfElements, 5);
+        type->host.fill(hostB, numberOfElements, 7);
+
+        if (deviceC)
+            clReleaseMemObject(deviceC);
+        if (deviceB)
+            clReleaseMemObject(deviceB);
+        if (deviceA)
+            clReleaseMemObject(deviceA);
+        deviceA = clCreateBuffer(oclContext, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, matrixSize, hostA, &result);
+        deviceB = (result == CL_SUCCESS) ? clCreateBuffer(oclContext, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, matrixSize, hostB, &result) : NULL;
+        deviceC = (result == CL_SUCCESS) ? clCreateBuffer(oclContext, CL_MEM_WRITE_ONLY, resultSize, NULL, &result) : NULL;
+        if (devicePackedB)
+            clReleaseMemObject(devicePackedB);
+        devicePackedB = (result == CL_SUCCESS) ? clCreateBuffer(oclContext, CL_MEM_READ_WRITE, packedMatrixBSize(size, size), NULL, &result) : NULL;
+        if (result != CL_SUCCESS)
+        {
+            printf("  %6d Skipped, clCreateBuffer() Failed : %d\n", size, result);
+            traceEnd(&traceLog, traceSlice);
+            break;
+        }
+
+        // B is packed once, like weights reused across many products, so the packed kernel is timed without it
+        enqueuePackMatrixB(deviceB, size, size, NULL);
+
+        // the blocked host product as the CPU baseline, timed once and sampled like the kernels
+        float timeCPU = -1.0f;
+        if (blockedCPU != NULL)
+        {
+            StopWatchInterface *timer = NULL;
+            sdkCreateTimer(&timer);
+            sdkStartTimer(&timer);
+            blockedCPU(hostA, hostB, hostC, size, size, size, size, cpuSimdLevel, numberOfCPUThreads);
+            sdkStopTimer(&timer);
+            timeCPU = sdkGetTimerValue(&timer);
+            sdkDeleteTimer(&timer);
+            numberOfMismatches += type->host.checkSamples(hostA, hostB, hostC, size, SWEEP_SAMPLES);
+        }
+
+        for (int kernel = 0; kernel < NUMBER_OF_MATMUL_KERNELS; kernel++)
+        {
+            size_t globalWorkSize[2];
+            size_t tileLocalWorkSize[2] = {(size_t)tileSize, (size_t)tileSize};
+            const size_t *local = NULL;
+
+            // the tiled kernel needs its tile, the tuned size belongs to the -kernel one, the runtime picks for the rest
+            if (kernel == MATMUL_KERNEL_TILED)
+                local = tileLocalWorkSize;
+            else if ((kernel == matMulKernel) && (localWorkSize[0] != 0))
+                local = localWorkSize;
+
+            time[kernel] = -1.0f;
+            result = clSetKernelArg(sweepKernels[kernel], 0, sizeof(cl_mem), (void *)&deviceA);
+            result |= clSetKernelArg(sweepKernels[kernel], 1, sizeof(cl_mem), (kernel == MATMUL_KERNEL_PACKED) ? (void *)&devicePackedB : (void *)&deviceB);
+            result |= clSetKernelArg(sweepKernels[kernel], 2, sizeof(cl_mem), (void *)&deviceC);
+            result |= clSetKernelArg(sweepKernels[kernel], 3, sizeof(cl_int), (void *)&size);
+            result |= clSetKernelArg(sweepKernels[kernel], 4, sizeof(cl_int), (void *)&size);
+            result |= clSetKernelArg(sweepKernels[kernel], 5, sizeof(cl_int), (void *)&size);
+            result |= clSetKernelArg(sweepKernels[kernel], 6, sizeof(cl_int), (void *)&size);
+            if (result != CL_SUCCESS)
+            {
+                printf("error>> clSetKernelArg() Failed For %s : %d. Terminating Now ...\n", matMulKernelNames[kernel], result);
+                for (kernel = 0; kernel < NUMBER_OF_MATMUL_KERNELS; kernel++)
+                    clReleaseKernel(sweepKernels[kernel]);
+                cleanup();
+                exit(EXIT_FAILURE);
+            }
+
+            // the naive local sizes divide BLOCK_WIDTH and every size is a multiple of it
+            matMulGlobalWorkSize(kernel, size, size, local, globalWorkSize);
+            time[kernel] = tuneTimeLaunch(oclCommandQueue, sweepKernels[kernel], 2, globalWorkSize, local);
+            if (time[kernel] < 0.0f)
+                continue;
+
+            // compare a spread of elements with the host, a full host product of 8192 x 8192 takes too long
+            result = clEnqueueReadBuffer(oclCommandQueue, deviceC, CL_TRUE, 0, resultSize, hostC, 0, NULL, NULL);
+            if (result == CL_SUCCESS)
+                numberOfMismatches += type->host.checkSamples(hostA, hostB, hostC, size, SWEEP_SAMPLES);
+            else
+                numberOfMismatches += SWEEP_SAMPLES;
+        }
+        traceEnd(&traceLog, traceSlice);
+
+        double flop = 2.0 * size * size * size;
+        float bestTime = -1.0f;
+        printf("  %6d", size);
+        for (int kernel = 0; kernel < NUMBER_OF_MATMUL_KERNELS; kernel++)
+        {
+            if (time[kernel] > 0.0f)
+                printf(" %9.2f", flop / (time[kernel] * 1.0e6));
+            else
+                printf(" %9s", "failed");
+            if ((time[kernel] > 0.0f) && ((bestTime < 0.0f) || (time[kernel] < bestTime)))
+                bestTime = time[kernel];
+        }
+        if (blockedCPU != NULL)
+            printf(" %9.2f", flop / (timeCPU * 1.0e6));
+        if ((time[MATMUL_KERNEL_NAIVE] > 0.0f) && (bestTime > 0.0f))
+            printf(" %12.2fx", time[MATMUL_KERNEL_NAIVE] / bestTime);
+        else
+            printf(" %13s", "-");
+        if ((blockedCPU != NULL) && (bestTime > 0.0f))
+            printf(" %11.2fx", timeCPU / bestTime);
+        else if (blockedCPU != NULL)
+            printf(" %12s", "-");
+        printf("   %zu Of %d Mismatched\n", numberOfMismatches, numberOfSampledProducts * SWEEP_SAMPLES);
+    }
+    printf("==============================================================================================\n");
+
+    for (int kernel = 0; kernel < NUMBER_OF_MATMUL_KERNELS; kernel++)
+        clReleaseKernel(sweepKernels[kernel]);
+}
+
+// gemmTestMatrix() definition
+void gemmTestMatrix(void)
+{
+    // local function declaration
+    cl_kernel buildGemmKernel(void);
+    void cleanup(void);
+
+    // local variable declaration
+    const MatMulType *type = &matMulTypes[matMulType];
+    const char *transposeNames[2] = {"N", "T"};
+    // M, N, K : single elements, partial tiles on every side, whole tiles, thin and flat products
+    const int shapes[][3] = {{1, 1, 1}, {7, 5, 3}, {16, 16, 16}, {33, 17, 45}, {64, 64, 64}, {100, 37, 70}, {5, 128, 3}, {128, 3, 129}};
+    const int numberOfShapes = sizeof(shapes) / sizeof(shapes[0]);
+    // alpha, beta : the plain product (C not read), scaled and accumulated, C scaled alone
+    const double scalars[][2] = {{1.0, 0.0}, {2.0, -1.0}, {0.0, 3.0}};
+    const int numberOfScalars = sizeof(scalars) / sizeof(scalars[0]);
+    size_t numberOfFailures = 0;
+    cl_int result = CL_SUCCESS;
+
+    // code
+    cl_kernel gemmKernel = buildGemmKernel();
+
+    printf("\n==============================================================================================\n");
+    printf("+ enqueueGemm() %s (GEMM_TILE %d) : MISMATCHED ELEMENTS OF THE WHOLE C BUFFER OVER alpha, beta = 1, 0 / 2, -1 / 0, 3 +\n", type->option, tileSize);
+    printf("==============================================================================================\n");
+    printf("  %18s", "M x N x K");
+    for (int transpose = 0; transpose < 4; transpose++)
+        printf(" %9s%s", transposeNames[transpose >> 1], transposeNames[transpose & 1]);
+    printf("\n");
+
+    for (int shape = 0; shape < numberOfShapes; shape++)
+    {
+        int M = shapes[shape][0];
+        int N = shapes[shape][1];
+        int K = shapes[shape][2];
+
+        printf("  %4d x %4d x %4d", M, N, K);
+        for (int transpose = 0; transpose < 4; transpose++)
+        {
+            int transposeA = (transpose >> 1) ? GEMM_TRANSPOSE : GEMM_NO_TRANSPOSE;
+            int transposeB = (transpose & 1) ? GEMM_TRANSPOSE : GEMM_NO_TRANSPOSE;
+
+            // every operand sits inside a larger buffer : an offset in front, rows padded beyond the leading
+            // dimension and a tail, so reads or writes outside the sub-matrices show up as mismatches of C
+            int aRows = (transposeA == GEMM_TRANSPOSE) ? K : M;
+            int aColumns = (transposeA == GEMM_TRANSPOSE) ? M : K;
+            int bRows = (transposeB == GEMM_TRANSPOSE) ? N : K;
+            int bColumns = (transposeB == GEMM_TRANSPOSE) ? K : N;
+            int offsetA = 5, lda = aColumns + 3;
+            int offsetB = 3, ldb = bColumns + 2;
+            int offsetC = 7, ldc = N + 4;
+            size_t countA = (size_t)offsetA + (size_t)aRows * lda;
+            size_t countB = (size_t)offsetB + (size_t)bRows * ldb;
+            size_t countC = (size_t)offsetC + (size_t)M * ldc + 2;
+
+            std::vector<unsigned char> A(countA * type->host.elementSize);
+            std::vector<unsigned char> B(countB * type->host.elementSize);
+            std::vector<unsigned char> C(countC * type->host.resultSize);
+            std::vector<unsigned char> expected(countC * type->host.resultSize);
+            std::vector<unsigned char> initialC(countC * type->host.resultSize);
+            size_t numberOfMismatches = 0;
+
+            type->host.fill(A.data(), countA, 5);
+            type->host.fill(B.data(), countB, 7);
+            type->host.fillResult(initialC.data(), countC, 3);
+
+            cl_mem deviceGemmA = clCreateBuffer(oclContext, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, A.size(), A.data(), &result);
+            cl_mem deviceGemmB = (result == CL_SUCCESS) ? clCreateBuffer(oclContext, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, B.size(), B.data(), &result) : NULL;
+            cl_mem deviceGemmC = (result == CL_SUCCESS) ? clCreateBuffer(oclContext, CL_MEM_READ_WRITE, C.size(), NULL, &result) : NULL;
+
+            for (int scalar = 0; (scalar < numberOfScalars) && (result == CL_SUCCESS); scalar++)
+            {
+                double alpha = scalars[scalar][0];
+                double beta = scalars[scalar][1];
+
+                memcpy(expected.data(), initialC.data(), expected.size());
+                type->host.referenceGeneral(transposeA, transposeB, M, N, K, alpha, A.data() + offsetA * type->host.elementSize, lda,
+                                            B.data() + offsetB * type->host.elementSize, ldb, beta, expected.data() + offsetC * type->host.resultSize, ldc);
+
+                result = clEnqueueWriteBuffer(oclCommandQueue, deviceGemmC, CL_TRUE, 0, initialC.size(), initialC.data(), 0, NULL, NULL);
+                if (result == CL_SUCCESS)
+                    result = enqueueGemm(oclCommandQueue, gemmKernel, &type->host, transposeA, transposeB, M, N, K, alpha, deviceGemmA, offsetA, lda, deviceGemmB,
+                                         offsetB, ldb, beta, deviceGemmC, offsetC, ldc, NULL);
+                if (result == CL_SUCCESS)
+                    result = clEnqueueReadBuffer(oclCommandQueue, deviceGemmC, CL_TRUE, 0, C.size(), C.data(), 0, NULL, NULL);
+                if (result == CL_SUCCESS)
+                    numberOfMismatches += type->host.verify(C.data(), expected.data(), countC).numberOfMismatches;
+            }
+
+            if (deviceGemmC)
+                clReleaseMemObject(deviceGemmC);
+            if (deviceGemmB)
+                clReleaseMemObject(deviceGemmB);
+            if (deviceGemmA)
+                clReleaseMemObject(deviceGemmA);
+
+            if (result != CL_SUCCESS)
+            {
+                printf("\nerror>> enqueueGemm() Failed For %d x %d x %d (%s%s) : %d. Terminating Now ...\n", M, N, K, transposeNames[transposeA], transposeNames[transposeB],
+                       result);
+                cleanup();
+                exit(EXIT_FAILURE);
+            }
+
+            if (numberOfMismatches != 0)
+                numberOfFailures++;
+            printf(" %10zu", numberOfMismatches);
+        }
+        printf("\n");
+    }
+    printf("- %zu Of %d Cases Mismatched\n", numberOfFailures, numberOfShapes * 4);
+
+    // performance : gemmTestSize cubed per transpose pair with beta = 1, fastest of TUNE_RUNS after a warm-up
+    size_t numberOfElements = (size_t)gemmTestSize * gemmTestSize;
+    std::vector<unsigned char> A(numberOfElements * type->host.elementSize);
+    std::vector<unsigned char> B(numberOfElements * type->host.elementSize);
+
+    type->host.fill(A.data(), numberOfElements, 5);
+    type->host.fill(B.data(), numberOfElements, 7);
+    cl_mem deviceGemmA = clCreateBuffer(oclContext, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, A.size(), A.data(), &result);
+    cl_mem deviceGemmB = (result == CL_SUCCESS) ? clCreateBuffer(oclContext, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, B.size(), B.data(), &result) : NULL;
+    cl_mem deviceGemmC = (result == CL_SUCCESS) ? clCreateBuffer(oclContext, CL_MEM_READ_WRITE, numberOfElements * type->host.resultSize, NULL, &result) : NULL;
+
+    printf("\n  %18s", "GFLOP/s, C += A B");
+    for (int transpose = 0; transpose < 4; transpose++)
+        printf(" %9s%s", transposeNames[transpose >> 1], transposeNames[transpose & 1]);
+    printf("\n  %4d x %4d x %4d", gemmTestSize, gemmTestSize, gemmTestSize);
+    for (int transpose = 0; (transpose < 4) && (result == CL_SUCCESS); transpose++)
+    {
+        int transposeA = (transpose >> 1) ? GEMM_TRANSPOSE : GEMM_NO_TRANSPOSE;
+        int transposeB = (transpose & 1) ? GEMM_TRANSPOSE : GEMM_NO_TRANSPOSE;
+        float bestTime = -1.0f;
+
+        // C is uninitialized, only the time counts here
+        for (int run = 0; (run <= TUNE_RUNS) && (result == CL_SUCCESS); run++)
+        {
+            cl_event event = NULL;
+            result = enqueueGemm(oclCommandQueue, gemmKernel, &type->host, transposeA, transposeB, gemmTestSize, gemmTestSize, gemmTestSize, 1.0, deviceGemmA, 0,
+                                 gemmTestSize, deviceGemmB, 0, gemmTestSize, 1.0, deviceGemmC, 0, gemmTestSize, &event);
+            if (result != CL_SUCCESS)
+                break;
+            clWaitForEvents(1, &event);
+
+            float time = profileEventTime(event);
+            clReleaseEvent(event);
+            if ((run > 0) && ((bestTime < 0.0f) || (time < bestTime)))
+                bestTime = time;
+        }
+
+        if (bestTime > 0.0f)
+            printf(" %10.2f", 2.0 * gemmTestSize * gemmTestSize * (double)gemmTestSize / (bestTime * 1.0e6));
+        else
+            printf(" %10s", "failed");
+    }
+    printf("\n==============================================================================================\n");
+
+    if (deviceGemmC)
+        clReleaseMemObject(deviceGemmC);
+    if (deviceGemmB)
+        clReleaseMemObject(deviceGemmB);
+    if (deviceGemmA)
+        clReleaseMemObject(deviceGemmA);
+
+    if (result != CL_SUCCESS)
+    {
+        printf("error>> enqueueGemm() Failed At %d x %d : %d. Terminating Now ...\n", gemmTestSize, gemmTestSize, result);
+        cleanup();
+        exit(EXIT_FAILURE);
+    }
+}
+
+// buildGemmKernel() definition
+cl_kernel buildGemmKernel(void)
+{
+    // local function declaration
+    void cleanup(void);
+
+    // local variable declaration
+    char options[SPECIALIZE_OPTIONS_LENGTH];
+    cl_int result = CL_SUCCESS;
+
+    // code
+    // the types of the run and the tile of the tiled kernel, kept in the specialization cache until cleanup()
+    snprintf(options, sizeof(options), "%s", buildOptions);
+    specializeDefine(options, "GEMM_TILE", tileSize);
+    cl_kernel gemmKernel = specializedKernel(&specializationCache, oclContext, oclComputeDeviceID, oclGemmSourceCode, "gemmGPU", options, &result, NULL);
+    if (gemmKernel == NULL)
+    {
+        printf("error>> gemmGPU Build Failed : %d. Terminating Now ...\n", result);
+        cleanup();
+        exit(EXIT_FAILURE);
+    }
+
+    return (gemmKernel);
+}
+
+// outOfCoreAcquire() definition
+OutOfCoreBlock *outOfCoreAcquire(std::vector<OutOfCoreBlock> &pool, long long key, unsigned long long touch, bool *pbResident)
+{
+    // code
+    // a hit keeps its block, a miss takes the least recently used one
+    OutOfCoreBlock *victim = &pool[0];
+    for (size_t slot = 0; slot < pool.size(); slot++)
+    {
+        if (pool[slot].key == key)
+        {
+            pool[slot].touch = touch;
+            *pbResident = true;
+            return (&pool[slot]);
+        }
+        if (pool[slot].touch < victim->touch)
+            victim = &pool[slot];
+    }
+
+    victim->key = key;
+    victim->touch = touch;
+    *pbResident = false;
+    return (victim);
+}
+
+// matMulOutOfCore() definition
+void matMulOutOfCore(void)
+{
+    // local function declaration
+    cl_kernel buildGemmKernel(void);
+    OutOfCoreBlock *outOfCoreAcquire(std::vector<OutOfCoreBlock> &, long long, unsigned long long, bool *);
+    void *allocateHostMatrix(size_t);
+    void freeHostMatrix(void *);
+    void cleanup(void);
+
+    // local variable declaration
+    const MatMulType *type = &matMulTypes[matMulType];
+    const char *queueNames[OUT_OF_CORE_QUEUES] = {"Upload Queue", "Compute Queue", "Writeback Queue"};
+    const int size = outOfCoreSize;
+    size_t elementSize = type->host.elementSize;
+    size_t resultSize = type->host.resultSize;
+    cl_ulong globalMemSize = 0;
+    cl_ulong maxMemAllocSize = 0;
+    cl_int result = CL_SUCCESS;
+
+    // code
+    cl_kernel gemmKernel = buildGemmKernel();
+
+    clGetDeviceInfo(oclComputeDeviceID, CL_DEVICE_GLOBAL_MEM_SIZE, sizeof(globalMemSize), &globalMemSize, NULL);
+    clGetDeviceInfo(oclComputeDeviceID, CL_DEVICE_MAX_MEM_ALLOC_SIZE, sizeof(maxMemAllocSize), &maxMemAllocSize, NULL);
+    cl_ulong memoryCap = (outOfCoreMemoryCap != 0) ? outOfCoreMemoryCap : globalMemSize / 2;
+
+    // the largest block (a multiple of OUT_OF_CORE_MIN_BLOCK unless it is the whole matrix) for which a whole row
+    // panel of A, two blocks of B and the C tiles fit the budget : the panel is then uploaded once per row of C and
+    // only B streams. Failing that, four A / B blocks, so one block of each can upload while the other two multiply
+    int blockSize = size;
+    for (int pass = 0; pass < 2; pass++)
+    {
+        blockSize = size;
+        while (blockSize > OUT_OF_CORE_MIN_BLOCK)
+        {
+            cl_ulong blockElements = (cl_ulong)blockSize * blockSize;
+            cl_ulong panelElements = (pass == 0) ? (cl_ulong)blockSize * ((size + blockSize - 1) / blockSize) * blockSize + 2 * blockElements : 4 * blockElements;
+            if ((panelElements * elementSize + OUT_OF_CORE_C_TILES * blockElements * resultSize <= memoryCap) && (blockElements * elementSize <= maxMemAllocSize) &&
+                (blockElements * resultSize <= maxMemAllocSize))
+                break;
+            blockSize = ((blockSize / 2 + OUT_OF_CORE_MIN_BLOCK - 1) / OUT_OF_CORE_MIN_BLOCK) * OUT_OF_CORE_MIN_BLOCK;
+        }
+        if (blockSize > OUT_OF_CORE_MIN_BLOCK)
+            break;
+    }
+
+    cl_ulong blockElements = (cl_ulong)blockSize * blockSize;
+    cl_ulong tileBytesC = blockElements * resultSize;
+    cl_ulong blockBytes = blockElements * elementSize;
+    if ((4 * blockBytes + OUT_OF_CORE_C_TILES * tileBytesC > memoryCap) || (blockBytes > maxMemAllocSize) || (tileBytesC > maxMemAllocSize))
+    {
+        printf("error>> -memcap Of %llu MB Does Not Hold Four %d x %d Blocks And %d C Tiles. Terminating Now ...\n", (unsigned long long)(memoryCap >> 20),
+               blockSize, blockSize, OUT_OF_CORE_C_TILES);
+        cleanup();
+        exit(EXIT_FAILURE);
+    }
+
+    // the blocks of one row of A are reused by every column of C, so that panel gets its pool first unless every
+    // block of B fits, which uploads B once; an undersized pool is streamed, least recently used first
+    int blocks = (size + blockSize - 1) / blockSize;
+    size_t numberOfBlocksB = (size_t)blocks * blocks;
+    size_t slots = (size_t)((memoryCap - OUT_OF_CORE_C_TILES * tileBytesC) / blockBytes);
+    size_t slotsA;
+    size_t slotsB;
+    if (slots >= numberOfBlocksB + 2)
+    {
+        slotsB = numberOfBlocksB;
+        slotsA = ((slots - slotsB) < (size_t)blocks) ? slots - slotsB : (size_t)blocks;
+    }
+    else
+    {
+        slotsA = ((slots - 2) < (size_t)blocks) ? slots - 2 : (size_t)blocks;
+        slotsB = ((slots - slotsA) < numberOfBlocksB) ? slots - slotsA : numberOfBlocksB;
+    }
+
+    size_t numberOfElements = (size_t)size * size;
+    freeHostMatrix(hostA);
+    freeHostMatrix(hostB);
+    freeHostMatrix(hostC);
+    hostA = allocateHostMatrix(numberOfElements * elementSize);
+    hostB = allocateHostMatrix(numberOfElements * elementSize);
+    hostC = allocateHostMatrix(numberOfElements * resultSize);
+    if ((hostA == NULL) || (hostB == NULL) || (hostC == NULL))
+    {
+        printf("error>> Host Memory Allocation Failed For %d x %d Matrices. Terminating Now ...\n", size, size);
+        cleanup();
+        exit(EXIT_FAILURE);
+    }
+
+    // small values, so every sum of the products is exact in the accumulator whatever the order of the depth blocks
+    type->host.fill(hostA, numberOfElements, 5);
+    type->host.fill(hostB, numberOfElements, 7);
+
+    for (int queueIndex = 0; queueIndex < OUT_OF_CORE_QUEUES; queueIndex++)
+    {
+        oclOutOfCoreQueues[queueIndex] = clCreateCommandQueue(oclContext, oclComputeDeviceID, CL_QUEUE_PROFILING_ENABLE, &result);
+        if (result != CL_SUCCESS)
+        {
+            printf("error>> clCreateCommandQueue() Failed For Out-Of-Core Queue %d : %d. Terminating Now ...\n", queueIndex, result);
+            cleanup();
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    OutOfCoreBlock emptyBlock = {NULL, -1, NULL, NULL, 0};
+    outOfCorePoolA.assign(slotsA, emptyBlock);
+    outOfCorePoolB.assign(slotsB, emptyBlock);
+    outOfCoreTilesC.assign(OUT_OF_CORE_C_TILES, emptyBlock);
+    for (size_t slot = 0; (slot < slotsA) && (result == CL_SUCCESS); slot++)
+        outOfCorePoolA[slot].buffer = clCreateBuffer(oclContext, CL_MEM_READ_ONLY, blockBytes, NULL, &result);
+    for (size_t slot = 0; (slot < slotsB) && (result == CL_SUCCESS); slot++)
+        outOfCorePoolB[slot].buffer = clCreateBuffer(oclContext, CL_MEM_READ_ONLY, blockBytes, NULL, &result);
+    for (int tile = 0; (tile < OUT_OF_CORE_C_TILES) && (result == CL_SUCCESS); tile++)
+        outOfCoreTilesC[tile].buffer = clCreateBuffer(oclContext, CL_MEM_READ_WRITE, tileBytesC, NULL, &result);
+    if (result != CL_SUCCESS)
+    {
+        printf("error>> clCreateBuffer() Failed For The Out-Of-Core Pools : %d. Terminating Now ...\n", result);
+        cleanup();
+        exit(EXIT_FAILURE);
+    }
+
+    printf("\n==============================================================================================\n");
+    printf("+ OUT-OF-CORE %s GEMM %d x %d x %d IN %llu MB OF DEVICE MEMORY +\n", type->option, size, size, size, (unsigned long long)(memoryCap >> 20));
+    printf("==============================================================================================\n");
+    printf("- Blocks          : %d x %d, %d x %d Tiles Of C, %d Deep\n", blockSize, blockSize, blocks, blocks, blocks);
+    printf("- A Pool          : %zu Of %d Blocks Per Row Panel (%s)\n", slotsA, blocks, (slotsA == (size_t)blocks) ? "Resident" : "Streamed");
+    printf("- B Pool          : %zu Of %zu Blocks (%s)\n", slotsB, numberOfBlocksB, (slotsB == numberOfBlocksB) ? "Resident" : "Streamed");
+    printf("- C Tiles         : %d (Double Buffered)\n", OUT_OF_CORE_C_TILES);
+
+    StopWatchInterface *timer = NULL;
+    sdkCreateTimer(&timer);
+    sdkStartTimer(&timer);
+    int traceSlice = traceBegin(&traceLog, "Out-Of-Core GEMM", "gpu");
+
+    // i, j, k : the depth blocks of one tile of C accumulate in place (beta = 1 after the first), the tile is written
+    // back while the next one is computed in the other C buffer
+    unsigned long long touch = 0;
+    cl_ulong bytesUploaded = 0;
+    cl_ulong bytesWrittenBack = 0;
+    size_t hostRowPitchA = (size_t)size * elementSize;
+    size_t hostRowPitchC = (size_t)size * resultSize;
+    int tileIndex = 0;
+    for (int i = 0; i < blocks; i++)
+    {
+        int rows = (size - i * blockSize < blockSize) ? size - i * blockSize : blockSize;
+        for (int j = 0; j < blocks; j++, tileIndex++)
+        {
+            int columns = (size - j * blockSize < blockSize) ? size - j * blockSize : blockSize;
+            OutOfCoreBlock *tileC = &outOfCoreTilesC[tileIndex % OUT_OF_CORE_C_TILES];
+            cl_event kernelEvent = NULL;
+
+            for (int k = 0; (k < blocks) && (result == CL_SUCCESS); k++)
+            {
+                int depth = (size - k * blockSize < blockSize) ? size - k * blockSize : blockSize;
+                OutOfCoreBlock *operands[2];
+                bool bResident[2];
+
+                // A (i, k) is depth wide, B (k, j) is columns wide, both packed at their own width in the block
+                operands[0] = outOfCoreAcquire(outOfCorePoolA, (long long)i * blocks + k, ++touch, &bResident[0]);
+                operands[1] = outOfCoreAcquire(outOfCorePoolB, (long long)k * blocks + j, ++touch, &bResident[1]);
+                for (int operand = 0; (operand < 2) && (result == CL_SUCCESS); operand++)
+                {
+                    if (bResident[operand] == true)
+                        continue;
+
+                    int blockRows = (operand == 0) ? rows : depth;
+                    int blockColumns = (operand == 0) ? depth : columns;
+                    size_t hostOrigin[3] = {(size_t)((operand == 0) ? k : j) * blockSize * elementSize, (size_t)((operand == 0) ? i : k) * blockSize, 0};
+                    size_t bufferOrigin[3] = {0, 0, 0};
+                    size_t region[3] = {(size_t)blockColumns * elementSize, (size_t)blockRows, 1};
+                    cl_event *lastUse = (operands[operand]->lastUse != NULL) ? &operands[operand]->lastUse : NULL;
+
+                    // the evicted block may still be read by a queued multiply-accumulate
+                    result = clEnqueueWriteBufferRect(oclOutOfCoreQueues[0], operands[operand]->buffer, CL_FALSE, bufferOrigin, hostOrigin, region, region[0], 0,
+                                                      hostRowPitchA, 0, (operand == 0) ? hostA : hostB, (lastUse != NULL) ? 1 : 0, lastUse,
+                                                      &operands[operand]->written);
+                    if (result == CL_SUCCESS)
+                    {
+                        outOfCoreEvents[0].push_back(operands[operand]->written);
+                        bytesUploaded += region[0] * region[1];
+                    }
+                }
+
+                // the multiply-accumulate waits for its uploads and, on the first depth block, for the last writeback
+                // out of this C buffer
+                cl_event waitList[3];
+                cl_uint numberOfWaits = 0;
+                for (int operand = 0; operand < 2; operand++)
+                    if (operands[operand]->written != NULL)
+                        waitList[numberOfWaits++] = operands[operand]->written;
+                if ((k == 0) && (tileC->lastUse != NULL))
+                    waitList[numberOfWaits++] = tileC->lastUse;
+
+                if (result == CL_SUCCESS)
+                    result = clEnqueueBarrierWithWaitList(oclOutOfCoreQueues[1], numberOfWaits, waitList, NULL);
+                if (result == CL_SUCCESS)
+                    result = enqueueGemm(oclOutOfCoreQueues[1], gemmKernel, &type->host, GEMM_NO_TRANSPOSE, GEMM_NO_TRANSPOSE, rows, columns, depth, 1.0,
+                                         operands[0]->buffer, 0, depth, operands[1]->buffer, 0, columns, (k == 0) ? 0.0 : 1.0, tileC->buffer, 0, columns,
+                                         &kernelEvent);
+                if (result == CL_SUCCESS)
+                {
+                    outOfCoreEvents[1].push_back(kernelEvent);
+                    operands[0]->lastUse = kernelEvent;
+                    operands[1]->lastUse = kernelEvent;
+                }
+            }
+
+            if (result == CL_SUCCESS)
+            {
+                size_t hostOrigin[3] = {(size_t)j * blockSize * resultSize, (size_t)i * blockSize, 0};
+                size_t bufferOrigin[3] = {0, 0, 0};
+                size_t region[3] = {(size_t)columns * resultSize, (size_t)rows, 1};
+
+                result = clEnqueueReadBufferRect(oclOutOfCoreQueues[2], tileC->buffer, CL_FALSE, bufferOrigin, hostOrigin, region, region[0], 0, hostRowPitchC, 0,
+                                                 hostC, 1, &kernelEvent, &tileC->lastUse);
+                if (result == CL_SUCCESS)
+                {
+                    outOfCoreEvents[2].push_back(tileC->lastUse);
+                    bytesWrittenBack += region[0] * region[1];
+                }
+            }
+
+            if (result != CL_SUCCESS)
+            {
+                printf("error>> Out-Of-Core GEMM Failed At Tile (%d, %d) : %d. Terminating Now ...\n", i, j, result);
+                sdkDeleteTimer(&timer);
+                cleanup();
+                exit(EXIT_FAILURE);
+            }
+
+            // submit now so the device starts on this tile while the next one is being enqueued
+            for (int queueIndex = 0; queueIndex < OUT_OF_CORE_QUEUES; queueIndex++)
+                clFlush(oclOutOfCoreQueues[queueIndex]);
+        }
+    }
+
+    // the writeback queue finishes last
+    for (int queueIndex = 0; queueIndex < OUT_OF_CORE_QUEUES; queueIndex++)
+        clFinish(oclOutOfCoreQueues[queueIndex]);
+
+    sdkStopTimer(&timer);
+    traceEnd(&traceLog, traceSlice);
+    float timeWithTransfers = sdkGetTimerValue(&timer);
+    sdkDeleteTimer(&timer);
+
+    // busy time of every queue (its commands run in order) against the span from the first START to the last END
+    double busyTime[OUT_OF_CORE_QUEUES] = {0.0};
+    cl_ulong firstStart = 0;
+    cl_ulong lastEnd = 0;
+    bool bProfiled = false;
+    for (int queueIndex = 0; queueIndex < OUT_OF_CORE_QUEUES; queueIndex++)
+    {
+        for (size_t index = 0; index < outOfCoreEvents[queueIndex].size(); index++)
+        {
+            ProfileTimestamps timestamps;
+            if (profileTimestamps(outOfCoreEvents[queueIndex][index], &timestamps) != CL_SUCCESS)
+                continue;
+
+            busyTime[queueIndex] += (double)(timestamps.end - timestamps.start) * 1.0e-6;
+            if ((bProfiled == false) || (timestamps.start < firstStart))
+                firstStart = timestamps.start;
+            if ((bProfiled == false) || (timestamps.end > lastEnd))
+                lastEnd = timestamps.end;
+            bProfiled = true;
+        }
+    }
+    double spanTime = (bProfiled == true) ? (double)(lastEnd - firstStart) * 1.0e-6 : 0.0;
+
+    size_t numberOfMismatches = type->host.checkSamples(hostA, hostB, hostC, size, OUT_OF_CORE_SAMPLES);
+    cl_ulong minimumUpload = 2 * (cl_ulong)numberOfElements * elementSize;
+
+    printf("- Uploaded        : %.2f MB (%.2fx The %.2f MB Of A And B)\n", (double)bytesUploaded / 1048576.0, (double)bytesUploaded / (double)minimumUpload,
+           (double)minimumUpload / 1048576.0);
+    printf("- Written Back    : %.2f MB\n", (double)bytesWrittenBack / 1048576.0);
+    for (int queueIndex = 0; queueIndex < OUT_OF_CORE_QUEUES; queueIndex++)
+        printf("- %-15s : %.3f ms Busy In %zu Commands\n", queueNames[queueIndex], busyTime[queueIndex], outOfCoreEvents[queueIndex].size());
+    if (spanTime > 0.0)
+        printf("- Overlap         : %.2fx (Busy Time Of All Queues / %.3f ms From First Start To Last End)\n",
+               (busyTime[0] + busyTime[1] + busyTime[2]) / spanTime, spanTime);
+    printf("- With Transfers  : %.3f ms, %.2f GFLOP/s\n", timeWithTransfers, 2.0 * size * size * (double)size / (timeWithTransfers * 1.0e6));
+    printf("- Sampled Check   : %zu Of %d Mismatched\n", numberOfMismatches, OUT_OF_CORE_SAMPLES);
+    printf("==============================================================================================\n");
+}
+
+// matMulMultiDevice() definition
+void matMulMultiDevice(void)
+{
+    // local function declaration
+    void *allocateHostMatrix(size_t);
+    void freeHostMatrix(void *);
+    void cleanup(void);
+
+    // local variable declaration
+    const MatMulType *type = &matMulTypes[matMulType];
+    const int size = multiDeviceSize;
+    size_t elementSize = type->host.elementSize;
+    size_t resultSize = type->host.resultSize;
+    char options[SPECIALIZE_OPTIONS_LENGTH];
+    cl_platform_id platformIDs[16];
+    cl_uint numberOfPlatforms = 0;
+    cl_int result = CL_SUCCESS;
+
+    // code
+    size_t numberOfElements = (size_t)size * size;
+    freeHostMatrix(hostA);
+    freeHostMatrix(hostB);
+    freeHostMatrix(hostC);
+    hostA = allocateHostMatrix(numberOfElements * elementSize);
+    hostB = allocateHostMatrix(numberOfElements * elementSize);
+    hostC = allocateHostMatrix(numberOfElements * resultSize);
+    if ((hostA == NULL) || (hostB == NULL) || (hostC == NULL))
+    {
+        printf("error>> Host Memory Allocation Failed For %d x %d Matrices. Terminating Now ...\n", size, size);
+        cleanup();
+        exit(EXIT_FAILURE);
+    }
+    type->host.fill(hostA, numberOfElements, 5);
+    type->host.fill(hostB, numberOfElements, 7);
+
+    // every device of the -devices type on every platform, one context per platform, gemmGPU built for each device
+    snprintf(options, sizeof(options), "%s", buildOptions);
+    specializeDefine(options, "GEMM_TILE", tileSize);
+    clGetPlatformIDs(16, platformIDs, &numberOfPlatforms);
+    for (cl_uint platform = 0; (platform < numberOfPlatforms) && (platform < 16); platform++)
+    {
+        cl_device_id deviceIDs[MULTI_DEVICE_MAX];
+        cl_device_id usable[MULTI_DEVICE_MAX];
+        cl_uint numberOfDevices = 0;
+        cl_uint numberOfUsable = 0;
+
+        if (clGetDeviceIDs(platformIDs[platform], multiDeviceType, MULTI_DEVICE_MAX, deviceIDs, &numberOfDevices) != CL_SUCCESS)
+            continue;
+        for (cl_uint device = 0; (device < numberOfDevices) && (device < MULTI_DEVICE_MAX); device++)
+        {
+            char deviceExtensions[4096] = "";
+            clGetDeviceInfo(deviceIDs[device], CL_DEVICE_EXTENSIONS, sizeof(deviceExtensions) - 1, deviceExtensions, NULL);
+            if ((type->extension == NULL) || (strstr(deviceExtensions, type->extension) != NULL))
+                usable[numberOfUsable++] = deviceIDs[device];
+        }
+        if (numberOfUsable == 0)
+            continue;
+
+        MultiDeviceContext context;
+        context.platform = platformIDs[platform];
+        context.context = clCreateContext(NULL, numberOfUsable, usable, NULL, NULL, &result);
+        if (result != CL_SUCCESS)
+        {
+            printf("info>> clCreateContext() Failed For Platform %u : %d, Skipping Its Devices.\n", platform, result);
+            continue;
+        }
+        multiDeviceContexts.push_back(context);
+
+        for (cl_uint device = 0; device < numberOfUsable; device++)
+        {
+            MultiDevice entry;
+            entry.device = usable[device];
+            entry.contextIndex = multiDeviceContexts.size() - 1;
+            entry.name[0] = '\0';
+            clGetDeviceInfo(entry.device, CL_DEVICE_NAME, sizeof(entry.name) - 1, entry.name, NULL);
+            entry.name[sizeof(entry.name) - 1] = '\0';
+            entry.kernelCache.numberOfBuilds = 0;
+            entry.kernelCache.numberOfBinaryHits = 0;
+            entry.kernel = NULL;
+            entry.tileC = NULL;
+            entry.gflops = 0.0;
+            entry.firstBlock = 0;
+            entry.numberOfBlocks = 0;
+            entry.uploads = 0;
+            entry.migrations = 0;
+            entry.queue = clCreateCommandQueue(context.context, entry.device, CL_QUEUE_PROFILING_ENABLE, &result);
+            if (result == CL_SUCCESS)
+                entry.kernel = specializedKernel(&entry.kernelCache, context.context, entry.device, oclGemmSourceCode, "gemmGPU", options, &result, NULL);
+
+            // the device still goes into the list, releaseMultiDevice() drops what it got
+            multiDevices.push_back(entry);
+            if (result != CL_SUCCESS)
+            {
+                printf("error>> gemmGPU Setup Failed On %s : %d. Terminating Now ...\n", entry.name, result);
+                cleanup();
+                exit(EXIT_FAILURE);
+            }
+        }
+    }
+
+    if (multiDevices.empty())
+    {
+        printf("error>> No OpenCL Device Of The -devices Type Supports -type %s. Terminating Now ...\n", type->option);
+        cleanup();
+        exit(EXIT_FAILURE);
+    }
+
+    // MULTI_DEVICE_BLOCK, halved until there are a few blocks for every device
+    int blockSize = MULTI_DEVICE_BLOCK;
+    while ((blockSize > 16) && ((size_t)((size + blockSize - 1) / blockSize) * ((size + blockSize - 1) / blockSize) < 4 * multiDevices.size()))
+        blockSize /= 2;
+    if (blockSize > size)
+        blockSize = size;
+    int blocks = (size + blockSize - 1) / blockSize;
+
+    for (size_t index = 0; index < multiDeviceContexts.size(); index++)
+    {
+        multiDeviceContexts[index].panelsA.assign(blocks, (cl_mem)NULL);
+        multiDeviceContexts[index].panelsB.assign(blocks, (cl_mem)NULL);
+        multiDeviceContexts[index].writtenA.assign(blocks, (cl_event)NULL);
+        multiDeviceContexts[index].writtenB.assign(blocks, (cl_event)NULL);
+    }
+    for (size_t index = 0; (index < multiDevices.size()) && (result == CL_SUCCESS); index++)
+    {
+        MultiDevice *device = &multiDevices[index];
+        device->bHasA.assign(blocks, 0);
+        device->bHasB.assign(blocks, 0);
+        device->tileC = clCreateBuffer(multiDeviceContexts[device->contextIndex].context, CL_MEM_READ_WRITE, (size_t)blockSize * blockSize * resultSize, NULL, &result);
+        if (result != CL_SUCCESS)
+        {
+            printf("error>> clCreateBuffer() Failed For The C Tile Of %s : %d. Terminating Now ...\n", device->name, result);
+            cleanup();
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    // weights : one blockSize x blockSize x size product on every device after a warm-up, A is the top of hostA and
+    // B the first size x blockSize elements of hostB, only the time counts
+    double totalGflops = 0.0;
+    for (size_t index = 0; index < multiDevices.size(); index++)
+    {
+        MultiDevice *device = &multiDevices[index];
+        cl_context context = multiDeviceContexts[device->contextIndex].context;
+        size_t panelBytes = (size_t)blockSize * size * elementSize;
+        float bestTime = -1.0f;
+
+        cl_mem sampleA = clCreateBuffer(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, panelBytes, hostA, &result);
+        cl_mem sampleB = (result == CL_SUCCESS) ? clCreateBuffer(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, panelBytes, hostB, &result) : NULL;
+        for (int run = 0; (run < 2) && (result == CL_SUCCESS); run++)
+        {
+            cl_event event = NULL;
+            result = enqueueGemm(device->queue, device->kernel, &type->host, GEMM_NO_TRANSPOSE, GEMM_NO_TRANSPOSE, blockSize, blockSize, size, 1.0, sampleA, 0, size,
+                                 sampleB, 0, blockSize, 0.0, device->tileC, 0, blockSize, &event);
+            if (result != CL_SUCCESS)
+                break;
+            clWaitForEvents(1, &event);
+            if (run > 0)
+                bestTime = profileEventTime(event);
+            clReleaseEvent(event);
+        }
+        if (sampleB)
+            clReleaseMemObject(sampleB);
+        if (sampleA)
+            clReleaseMemObject(sampleA);
+
+        if (result != CL_SUCCESS)
+        {
+            printf("error>> gemmGPU Calibration Failed On %s : %d. Terminating Now ...\n", device->name, result);
+            cleanup();
+            exit(EXIT_FAILURE);
+        }
+
+        // a device too fast for its timer still gets a share
+        device->gflops = 2.0 * blockSize * blockSize * (double)size / (((bestTime > 0.0f) ? bestTime : 1.0e-3f) * 1.0e6);
+        totalGflops += device->gflops;
+    }
+
+    // row-major ranges of blocks in proportion to the weights, so a device needs few row panels of A
+    size_t numberOfBlocks = (size_t)blocks * blocks;
+    double cumulativeGflops = 0.0;
+    for (size_t index = 0; index < multiDevices.size(); index++)
+    {
+        size_t firstBlock = (size_t)(numberOfBlocks * (cumulativeGflops / totalGflops) + 0.5);
+        cumulativeGflops += multiDevices[index].gflops;
+        size_t lastBlock = (index + 1 == multiDevices.size()) ? numberOfBlocks : (size_t)(numberOfBlocks * (cumulativeGflops / totalGflops) + 0.5);
+        multiDevices[index].firstBlock = firstBlock;
+        multiDevices[index].numberOfBlocks = lastBlock - firstBlock;
+    }
+
+    StopWatchInterface *timer = NULL;
+    sdkCreateTimer(&timer);
+    sdkStartTimer(&timer);
+    int traceSlice = traceBegin(&traceLog, "Multi-Device GEMM", "gpu");
+
+    // one block of every device per round, so every device has work queued from the start
+    size_t hostRowPitch = (size_t)size * elementSize;
+    size_t hostRowPitchC = (size_t)size * resultSize;
+    bool bQueued = true;
+    for (size_t round = 0; bQueued == true; round++)
+    {
+        bQueued = false;
+        for (size_t index = 0; index < multiDevices.size(); index++)
+        {
+            MultiDevice *device = &multiDevices[index];
+            MultiDeviceContext *context = &multiDeviceContexts[device->contextIndex];
+            if (round >= device->numberOfBlocks)
+                continue;
+
+            size_t block = device->firstBlock + round;
+            int i = (int)(block / blocks);
+            int j = (int)(block % blocks);
+            int rows = (size - i * blockSize < blockSize) ? size - i * blockSize : blockSize;
+            int columns = (size - j * blockSize < blockSize) ? size - j * blockSize : blockSize;
+            cl_event kernelEvent = NULL;
+            cl_event readEvent = NULL;
+
+            // A row panel i (rows x size) and B column panel j (size x columns) : uploaded by the first device of the
+            // context that needs it, migrated to the others once the upload is done
+            for (int operand = 0; (operand < 2) && (result == CL_SUCCESS); operand++)
+            {
+                int panel = (operand == 0) ? i : j;
+                std::vector<char> &bHas = (operand == 0) ? device->bHasA : device->bHasB;
+                std::vector<cl_mem> &panels = (operand == 0) ? context->panelsA : context->panelsB;
+                std::vector<cl_event> &written = (operand == 0) ? context->writtenA : context->writtenB;
+                if (bHas[panel] != 0)
+                    continue;
+
+                cl_event event = NULL;
+                if (panels[panel] == NULL)
+                {
+                    int panelRows = (operand == 0) ? rows : size;
+                    int panelColumns = (operand == 0) ? size : columns;
+                    size_t hostOrigin[3] = {(size_t)((operand == 0) ? 0 : j * blockSize) * elementSize, (size_t)((operand == 0) ? i * blockSize : 0), 0};
+                    size_t bufferOrigin[3] = {0, 0, 0};
+                    size_t region[3] = {(size_t)panelColumns * elementSize, (size_t)panelRows, 1};
+
+                    panels[panel] = clCreateBuffer(context->context, CL_MEM_READ_ONLY, region[0] * region[1], NULL, &result);
+                    if (result == CL_SUCCESS)
+                        result = clEnqueueWriteBufferRect(device->queue, panels[panel], CL_FALSE, bufferOrigin, hostOrigin, region, region[0], 0, hostRowPitch, 0,
+                                                          (operand == 0) ? hostA : hostB, 0, NULL, &event);
+                    if (result == CL_SUCCESS)
+                    {
+                        written[panel] = event;
+                        device->uploads++;
+                    }
+                }
+                else
+                {
+                    result = clEnqueueMigrateMemObjects(device->queue, 1, &panels[panel], 0, 1, &written[panel], &event);
+                    if (result == CL_SUCCESS)
+                        device->migrations++;
+                }
+
+                if (result == CL_SUCCESS)
+                {
+                    device->events.push_back(event);
+                    bHas[panel] = 1;
+                }
+            }
+
+            // the queue is in order, the barrier holds the product until an upload on another queue is done too
+            cl_event waitList[2] = {context->writtenA[i], context->writtenB[j]};
+            if (result == CL_SUCCESS)
+                result = clEnqueueBarrierWithWaitList(device->queue, 2, waitList, NULL);
+            if (result == CL_SUCCESS)
+                result = enqueueGemm(device->queue, device->kernel, &type->host, GEMM_NO_TRANSPOSE, GEMM_NO_TRANSPOSE, rows, columns, size, 1.0,
+                                     context->panelsA[i], 0, size, context->panelsB[j], 0, columns, 0.0, device->tileC, 0, columns, &kernelEvent);
+            if (result == CL_SUCCESS)
+            {
+                size_t hostOrigin[3] = {(size_t)j * blockSize * resultSize, (size_t)i * blockSize, 0};
+                size_t bufferOrigin[3] = {0, 0, 0};
+                size_t region[3] = {(size_t)columns * resultSize, (size_t)rows, 1};
+
+                device->events.push_back(kernelEvent);
+                result = clEnqueueReadBufferRect(device->queue, device->tileC, CL_FALSE, bufferOrigin, hostOrigin, region, region[0], 0, hostRowPitchC, 0, hostC, 0,
+                                                 NULL, &readEvent);
+                if (result == CL_SUCCESS)
+                    device->events.push_back(readEvent);
+            }
+
+            if (result != CL_SUCCESS)
+            {
+                printf("error>> Multi-Device GEMM Failed At Block (%d, %d) On %s : %d. Terminating Now ...\n", i, j, device->name, result);
+                sdkDeleteTimer(&timer);
+                cleanup();
+                exit(EXIT_FAILURE);
+            }
+
+            clFlush(device->queue);
+            bQueued = true;
+        }
+    }
+
+    for (size_t index = 0; index < multiDevices.size(); index++)
+        clFinish(multiDevices[index].queue);
+
+    sdkStopTimer(&timer);
+    traceEnd(&traceLog, traceSlice);
+    float timeWithTransfers = sdkGetTimerValue(&timer);
+    sdkDeleteTimer(&timer);
+
+    size_t numberOfMismatches = type->host.checkSamples(hostA, hostB, hostC, size, MULTI_DEVICE_SAMPLES);
+    double flop = 2.0 * size * size * (double)size;
+    double fastestGflops = 0.0;
+
+    printf("\n==============================================================================================\n");
+    printf("+ MULTI-DEVICE %s GEMM %d x %d x %d, %d x %d BLOCKS OF %d x %d ON %zu DEVICES IN %zu CONTEXTS +\n", type->option, size, size, size, blocks, blocks,
+           blockSize, blockSize, multiDevices.size(), multiDeviceContexts.size());
+    printf("==============================================================================================\n");
+    printf("  %-28s %7s %9s %7s %7s %9s %9s %10s\n", "Device", "Context", "GFLOP/s", "Share", "Blocks", "Uploads", "Migrated", "Busy (ms)");
+    for (size_t index = 0; index < multiDevices.size(); index++)
+    {
+        MultiDevice *device = &multiDevices[index];
+        double busyTime = 0.0;
+        for (size_t event = 0; event < device->events.size(); event++)
+            busyTime += profileEventTime(device->events[event]);
+        if (device->gflops > fastestGflops)
+            fastestGflops = device->gflops;
+
+        printf("  %-28.28s %7zu %9.2f %6.1f%% %7zu %9zu %9zu %10.3f\n", device->name, device->contextIndex, device->gflops, 100.0 * device->gflops / totalGflops,
+               device->numberOfBlocks, device->uploads, device->migrations, busyTime);
+    }
+    printf("- With Transfers  : %.3f ms, %.2f GFLOP/s (%.2fx The Fastest Device, %.2f GFLOP/s Summed Over The Devices)\n", timeWithTransfers,
+           flop / (timeWithTransfers * 1.0e6), flop / (timeWithTransfers * 1.0e6) / fastestGflops, totalGflops);
+    printf("- Sampled Check   : %zu Of %d Mismatched\n", numberOfMismatches, MULTI_DEVICE_SAMPLES);
+    printf("==============================================================================================\n");
+}
+
+// sparseBuffer() definition
+cl_mem sparseBuffer(const void *data, size_t size)
+{
+    // local function declaration
+    void cleanup(void);
+
+    // local variable declaration
+    cl_int result;
+
+    // code
+    // kept in sparseBuffers until cleanup(), read-only sources are initialized from data
+    cl_mem buffer = clCreateBuffer(oclContext, (data != NULL) ? (CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR) : CL_MEM_READ_WRITE, (size != 0) ? size : sizeof(float),
+                                   (void *)data, &result);
+    if (result != CL_SUCCESS)
+    {
+        printf("error>> clCreateBuffer() Failed For %zu Bytes Of The Sparse Products : %d. Terminating Now ...\n", size, result);
+        cleanup();
+        exit(EXIT_FAILURE);
+    }
+
+    sparseBuffers.push_back(buffer);
+    return (buffer);
+}
+
+// runSparseKernel() definition
+float runSparseKernel(cl_kernel kernel, cl_uint workDimensions, const size_t *globalWorkSize, const size_t *localWorkSize, cl_kernel fixupKernel, size_t fixupWorkSize)
+{
+    // local variable declaration
+    float bestTime = -1.0f;
+    cl_int result = CL_SUCCESS;
+
+    // code
+    // fastest of TUNE_RUNS after a warm-up (ms), the merge path counts both of its kernels
+    for (int run = 0; run <= TUNE_RUNS; run++)
+    {
+        cl_event events[2] = {NULL, NULL};
+        size_t fixupLocalWorkSize = SPARSE_GROUP_SIZE;
+        size_t fixupGlobalWorkSize = ((fixupWorkSize + SPARSE_GROUP_SIZE - 1) / SPARSE_GROUP_SIZE) * SPARSE_GROUP_SIZE;
+
+        result = clEnqueueNDRangeKernel(oclCommandQueue, kernel, workDimensions, NULL, globalWorkSize, localWorkSize, 0, NULL, &events[0]);
+        if ((result == CL_SUCCESS) && (fixupKernel != NULL))
+            result = clEnqueueNDRangeKernel(oclCommandQueue, fixupKernel, 1, NULL, &fixupGlobalWorkSize, &fixupLocalWorkSize, 0, NULL, &events[1]);
+        if (result == CL_SUCCESS)
+            result = clFinish(oclCommandQueue);
+
+        float time = profileEventTime(events[0]) + profileEventTime(events[1]);
+        for (int event = 0; event < 2; event++)
+            if (events[event])
+                clReleaseEvent(events[event]);
+        if (result != CL_SUCCESS)
+            return (-1.0f);
+
+        if ((run > 0) && ((bestTime < 0.0f) || (time < bestTime)))
+            bestTime = time;
+    }
+
+    return (bestTime);
+}
+
+// matMulSparse() definition
+void matMulSparse(void)
+{
+    // local function declaration
+    cl_mem sparseBuffer(const void *, size_t);
+    float runSparseKernel(cl_kernel, cl_uint, const size_t *, const size_t *, cl_kernel, size_t);
+    void cleanup(void);
+
+    // local variable declaration
+    const char *kernelNames[] = {"spmvCsrScalarGPU", "spmvCsrVectorGPU", "spmvCsrMergeGPU", "spmvCsrMergeFixupGPU", "spmvEllGPU", "spmvSellGPU", "spmmCsrGPU", "spmmSellGPU"};
+    enum
+    {
+        SPMV_CSR_SCALAR,
+        SPMV_CSR_VECTOR,
+        SPMV_CSR_MERGE,
+        SPMV_CSR_MERGE_FIXUP,
+        SPMV_ELL,
+        SPMV_SELL,
+        SPMM_CSR,
+        SPMM_SELL,
+        NUMBER_OF_SPARSE_KERNELS
+    };
+    cl_kernel kernels[NUMBER_OF_SPARSE_KERNELS];
+    char options[SPECIALIZE_OPTIONS_LENGTH] = "";
+    cl_ulong maxMemAllocSize = 0;
+    CsrMatrix csr;
+    EllMatrix ell;
+    SellMatrix sell;
+    cl_int result = CL_SUCCESS;
+
+    // code
+    int traceSlice = traceBegin(&traceLog, "Sparse Matrix Generation", "host");
+    sparsePowerLaw(&csr, sparseRows, sparseRows, sparseNonzerosPerRow, 2024);
+    int numberOfNonzeros = csr.rowOffsets[sparseRows];
+    int longestRow = sparseLongestRow(&csr);
+    int vectorWidth = sparseVectorWidth(&csr);
+
+    // formats padding beyond SPARSE_MAX_PADDING entries per nonzero or a single allocation are skipped
+    clGetDeviceInfo(oclComputeDeviceID, CL_DEVICE_MAX_MEM_ALLOC_SIZE, sizeof(maxMemAllocSize), &maxMemAllocSize, NULL);
+    size_t maxEntries = (size_t)SPARSE_MAX_PADDING * numberOfNonzeros;
+    if (maxEntries > maxMemAllocSize / sizeof(float))
+        maxEntries = (size_t)(maxMemAllocSize / sizeof(float));
+    bool bEll = csrToEll(&csr, &ell, maxEntries);
+    bool bSell = csrToSell(&csr, SPARSE_SLICE_HEIGHT, SPARSE_SIGMA, &sell, maxEntries);
+
+    size_t numberOfElementsX = (size_t)sparseRows * SPARSE_VECTORS;
+    std::vector<float> x(sparseRows);
+    std::vector<float> y(sparseRows);
+    std::vector<float> expectedY(sparseRows);
+    std::vector<float> X(numberOfElementsX);
+    std::vector<float> Y(numberOfElementsX);
+    std::vector<float> expectedXY(numberOfElementsX);
+    sparseFillDense(x.data(), x.size());
+    sparseFillDense(X.data(), X.size());
+    sparseReference(&csr, x.data(), expectedY.data(), 1);
+    sparseReference(&csr, X.data(), expectedXY.data(), SPARSE_VECTORS);
+    traceEnd(&traceLog, traceSlice);
+
+    specializeDefine(options, "SPARSE_GROUP_SIZE", SPARSE_GROUP_SIZE);
+    specializeDefine(options, "SPARSE_VECTOR_WIDTH", vectorWidth);
+    specializeDefine(options, "SPARSE_MERGE_ITEMS", SPARSE_MERGE_ITEMS);
+    specializeDefine(options, "SPARSE_SLICE_HEIGHT", SPARSE_SLICE_HEIGHT);
+    for (int kernel = 0; kernel < NUMBER_OF_SPARSE_KERNELS; kernel++)
+    {
+        kernels[kernel] = specializedKernel(&specializationCache, oclContext, oclComputeDeviceID, oclSparseSourceCode, kernelNames[kernel], options, &result, NULL);
+        if (kernels[kernel] == NULL)
+        {
+            printf("error>> %s Build Failed : %d. Terminating Now ...\n", kernelNames[kernel], result);
+            cleanup();
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    // the merge path has one carry per work-item
+    int numberOfCarries = (sparseRows + numberOfNonzeros + SPARSE_MERGE_ITEMS - 1) / SPARSE_MERGE_ITEMS;
+
+    cl_mem deviceRowOffsets = sparseBuffer(csr.rowOffsets.data(), csr.rowOffsets.size() * sizeof(int));
+    cl_mem deviceColumns = sparseBuffer(csr.columns.data(), csr.columns.size() * sizeof(int));
+    cl_mem deviceValues = sparseBuffer(csr.values.data(), csr.values.size() * sizeof(float));
+    cl_mem deviceX = sparseBuffer(x.data(), x.size() * sizeof(float));
+    cl_mem deviceY = sparseBuffer(NULL, y.size() * sizeof(float));
+    cl_mem deviceCarryRows = sparseBuffer(NULL, (size_t)numberOfCarries * sizeof(int));
+    cl_mem deviceCarryValues = sparseBuffer(NULL, (size_t)numberOfCarries * sizeof(float));
+    cl_mem deviceDenseX = sparseBuffer(X.data(), X.size() * sizeof(float));
+    cl_mem deviceDenseY = sparseBuffer(NULL, Y.size() * sizeof(float));
+    cl_mem deviceEllColumns = bEll ? sparseBuffer(ell.columns.data(), ell.columns.size() * sizeof(int)) : NULL;
+    cl_mem deviceEllValues = bEll ? sparseBuffer(ell.values.data(), ell.values.size() * sizeof(float)) : NULL;
+    cl_mem deviceSliceOffsets = bSell ? sparseBuffer(sell.sliceOffsets.data(), sell.sliceOffsets.size() * sizeof(int)) : NULL;
+    cl_mem deviceRowPermutation = bSell ? sparseBuffer(sell.rowPermutation.data(), sell.rowPermutation.size() * sizeof(int)) : NULL;
+    cl_mem deviceSellColumns = bSell ? sparseBuffer(sell.columns.data(), sell.columns.size() * sizeof(int)) : NULL;
+    cl_mem deviceSellValues = bSell ? sparseBuffer(sell.values.data(), sell.values.size() * sizeof(float)) : NULL;
+
+    // stored bytes of every format, the traffic of a product is its format and the dense vectors
+    size_t csrBytes = (csr.rowOffsets.size() + csr.columns.size()) * sizeof(int) + csr.values.size() * sizeof(float);
+    size_t ellBytes = ell.columns.size() * sizeof(int) + ell.values.size() * sizeof(float);
+    size_t sellBytes = (sell.sliceOffsets.size() + sell.rowPermutation.size() + sell.columns.size()) * sizeof(int) + sell.values.size() * sizeof(float);
+    size_t vectorBytes = 2 * (size_t)sparseRows * sizeof(float);
+
+    printf("\n==============================================================================================\n");
+    printf("+ SPARSE float PRODUCTS OF A %d x %d POWER-LAW MATRIX, FASTEST OF %d RUNS +\n", sparseRows, sparseRows, TUNE_RUNS);
+    printf("==============================================================================================\n");
+    printf("- Nonzeros        : %d (%.2f Per Row, Longest Row %d, %.4f%% Dense)\n", numberOfNonzeros, (double)numberOfNonzeros / sparseRows, longestRow,
+           100.0 * numberOfNonzeros / ((double)sparseRows * sparseRows));
+    printf("- Dense Product   : matrixMultiplyGPU Would Multiply %.0fx As Many Elements, Zeros Included\n", ((double)sparseRows * sparseRows) / numberOfNonzeros);
+    if (bEll)
+        printf("- ELL             : Width %d, %.2f Stored Entries Per Nonzero\n", ell.width, (double)ell.columns.size() / numberOfNonzeros);
+    else
+        printf("- ELL             : Skipped, Width %d Would Store Over %d Entries Per Nonzero\n", longestRow, SPARSE_MAX_PADDING);
+    char sellName[32];
+    sprintf(sellName, "SELL-%d-%d", SPARSE_SLICE_HEIGHT, SPARSE_SIGMA);
+    if (bSell)
+        printf("- %-15s : %.2f Stored Entries Per Nonzero\n", sellName, (double)sell.columns.size() / numberOfNonzeros);
+    else
+        printf("- %-15s : Skipped, Over %d Stored Entries Per Nonzero\n", sellName, SPARSE_MAX_PADDING);
+
+    printf("\n  %-26s %10s %10s %10s %10s   %s\n", "Kernel", "Stored MB", "Time (ms)", "GFLOP/s", "GB/s", "Mismatched");
+    for (int kernel = 0; kernel < NUMBER_OF_SPARSE_KERNELS; kernel++)
+    {
+        bool bSpMM = (kernel == SPMM_CSR) || (kernel == SPMM_SELL);
+        bool bSellKernel = (kernel == SPMV_SELL) || (kernel == SPMM_SELL);
+        size_t localWorkSize[2] = {SPARSE_GROUP_SIZE, 1};
+        size_t globalWorkSize[2] = {(size_t)sparseRows, 1};
+        size_t formatBytes = csrBytes;
+        cl_kernel fixupKernel = NULL;
+        char label[64];
+
+        if ((kernel == SPMV_CSR_MERGE_FIXUP) || ((kernel == SPMV_ELL) && (bEll == false)) || ((bSellKernel == true) && (bSell == false)))
+            continue;
+
+        // arguments : the shape, then the format, then the dense operands
+        result = CL_SUCCESS;
+        int argument = 0;
+        if (bSellKernel == true)
+            result |= clSetKernelArg(kernels[kernel], argument++, sizeof(cl_int), (void *)&sell.numberOfPositions);
+        else
+            result |= clSetKernelArg(kernels[kernel], argument++, sizeof(cl_int), (void *)&sparseRows);
+        if (kernel == SPMV_CSR_MERGE)
+            result |= clSetKernelArg(kernels[kernel], argument++, sizeof(cl_int), (void *)&numberOfNonzeros);
+        if (kernel == SPMV_ELL)
+            result |= clSetKernelArg(kernels[kernel], argument++, sizeof(cl_int), (void *)&ell.width);
+        if (bSpMM == true)
+        {
+            int numberOfVectors = SPARSE_VECTORS;
+            result |= clSetKernelArg(kernels[kernel], argument++, sizeof(cl_int), (void *)&numberOfVectors);
+        }
+
+        if (kernel == SPMV_ELL)
+        {
+            result |= clSetKernelArg(kernels[kernel], argument++, sizeof(cl_mem), (void *)&deviceEllColumns);
+            result |= clSetKernelArg(kernels[kernel], argument++, sizeof(cl_mem), (void *)&deviceEllValues);
+            formatBytes = ellBytes;
+        }
+        else if (bSellKernel == true)
+        {
+            result |= clSetKernelArg(kernels[kernel], argument++, sizeof(cl_mem), (void *)&deviceSliceOffsets);
+            result |= clSetKernelArg(kernels[kernel], argument++, sizeof(cl_mem), (void *)&deviceRowPermutation);
+            result |= clSetKernelArg(kernels[kernel], argument++, sizeof(cl_mem), (void *)&deviceSellColumns);
+            result |= clSetKernelArg(kernels[kernel], argument++, sizeof(cl_mem), (void *)&deviceSellValues);
+            formatBytes = sellBytes;
+            globalWorkSize[0] = (size_t)sell.numberOfPositions;
+        }
+        else
+        {
+            result |= clSetKernelArg(kernels[kernel], argument++, sizeof(cl_mem), (void *)&deviceRowOffsets);
+            result |= clSetKernelArg(kernels[kernel], argument++, sizeof(cl_mem), (void *)&deviceColumns);
+            result |= clSetKernelArg(kernels[kernel], argument++, sizeof(cl_mem), (void *)&deviceValues);
+        }
+
+        result |= clSetKernelArg(kernels[kernel], argument++, sizeof(cl_mem), (bSpMM == true) ? (void *)&deviceDenseX : (void *)&deviceX);
+        result |= clSetKernelArg(kernels[kernel], argument++, sizeof(cl_mem), (bSpMM == true) ? (void *)&deviceDenseY : (void *)&deviceY);
+        if (kernel == SPMV_CSR_MERGE)
+        {
+            result |= clSetKernelArg(kernels[kernel], argument++, sizeof(cl_mem), (void *)&deviceCarryRows);
+            result |= clSetKernelArg(kernels[kernel], argument++, sizeof(cl_mem), (void *)&deviceCarryValues);
+
+            fixupKernel = kernels[SPMV_CSR_MERGE_FIXUP];
+            result |= clSetKernelArg(fixupKernel, 0, sizeof(cl_int), (void *)&numberOfCarries);
+            result |= clSetKernelArg(fixupKernel, 1, sizeof(cl_mem), (void *)&deviceCarryRows);
+            result |= clSetKernelArg(fixupKernel, 2, sizeof(cl_mem), (void *)&deviceCarryValues);
+            result |= clSetKernelArg(fixupKernel, 3, sizeof(cl_mem), (void *)&deviceY);
+            globalWorkSize[0] = (size_t)numberOfCarries;
+        }
+        if (result != CL_SUCCESS)
+        {
+            printf("error>> clSetKernelArg() Failed For %s : %d. Terminating Now ...\n", kernelNames[kernel], result);
+            cleanup();
+            exit(EXIT_FAILURE);
+        }
+
+        // a work-item per row (position of SELL, carry of the merge path), SPARSE_VECTOR_WIDTH per row for the vector
+        // kernel, and SPARSE_VECTORS along dimension 0 for SpMM
+        if (kernel == SPMV_CSR_VECTOR)
+            globalWorkSize[0] *= vectorWidth;
+        if (bSpMM == true)
+        {
+            globalWorkSize[1] = globalWorkSize[0];
+            globalWorkSize[0] = SPARSE_VECTORS;
+            localWorkSize[0] = SPARSE_VECTORS;
+            localWorkSize[1] = SPARSE_GROUP_SIZE / SPARSE_VECTORS;
+        }
+        for (int dimension = 0; dimension < 2; dimension++)
+            globalWorkSize[dimension] = ((globalWorkSize[dimension] + localWorkSize[dimension] - 1) / localWorkSize[dimension]) * localWorkSize[dimension];
+
+        // results start as NaN, so a row no work-item stores shows up as a mismatch
+        cl_float nan = nanf("");
+        cl_mem output = (bSpMM == true) ? deviceDenseY : deviceY;
+        size_t outputBytes = ((bSpMM == true) ? numberOfElementsX : (size_t)sparseRows) * sizeof(float);
+        result = clEnqueueFillBuffer(oclCommandQueue, output, &nan, sizeof(nan), 0, outputBytes, 0, NULL, NULL);
+
+        float time = (result == CL_SUCCESS) ? runSparseKernel(kernels[kernel], 2, globalWorkSize, localWorkSize, fixupKernel, (size_t)numberOfCarries) : -1.0f;
+        if (time >= 0.0f)
+            result = clEnqueueReadBuffer(oclCommandQueue, output, CL_TRUE, 0, outputBytes, (bSpMM == true) ? Y.data() : y.data(), 0, NULL, NULL);
+        if ((time < 0.0f) || (result != CL_SUCCESS))
+        {
+            printf("error>> %s Failed : %d. Terminating Now ...\n", kernelNames[kernel], result);
+            cleanup();
+            exit(EXIT_FAILURE);
+        }
+
+        VerifyReport report = (bSpMM == true) ? verifyArrays<float>(Y.data(), expectedXY.data(), numberOfElementsX, 0.0f, 0, numberOfCPUThreads)
+                                              : verifyArrays<float>(y.data(), expectedY.data(), (size_t)sparseRows, 0.0f, 0, numberOfCPUThreads);
+        double flop = 2.0 * numberOfNonzeros * ((bSpMM == true) ? SPARSE_VECTORS : 1);
+        double bytes = (double)formatBytes + (double)vectorBytes * ((bSpMM == true) ? SPARSE_VECTORS : 1);
+
+        if (kernel == SPMV_CSR_VECTOR)
+            sprintf(label, "%s (%d)", kernelNames[kernel], vectorWidth);
+        else if (kernel == SPMV_CSR_MERGE)
+            sprintf(label, "%s + Fixup", kernelNames[kernel]);
+        else
+            sprintf(label, "%s", kernelNames[kernel]);
+        printf("  %-26s %10.2f %10.3f %10.2f %10.2f   %zu Of %zu\n", label, formatBytes / 1048576.0, time, (time > 0.0f) ? flop / (time * 1.0e6) : 0.0,
+               (time > 0.0f) ? bytes / (time * 1.0e6) : 0.0, report.numberOfMismatches, report.numberOfElements);
+    }
+    printf("==============================================================================================\n");
+}
+
+// matMulGemv() definition
+void matMulGemv(void)
+{
+    // local function declaration
+    void cleanup(void);
+
+    // local variable declaration
+    const MatMulType *type = &matMulTypes[matMulType];
+    const int M = gemvRows;
+    const int N = gemvColumns;
+    size_t elementSize = type->host.elementSize;
+    size_t resultSize = type->host.resultSize;
+    char extensions[4096] = "";
+    const char *subGroupOptions = NULL;
+    cl_ulong maxMemAllocSize = 0;
+    cl_int result = CL_SUCCESS;
+
+    // code
+    clGetDeviceInfo(oclComputeDeviceID, CL_DEVICE_MAX_MEM_ALLOC_SIZE, sizeof(maxMemAllocSize), &maxMemAllocSize, NULL);
+    size_t matrixBytes = (size_t)M * N * elementSize;
+    if (matrixBytes > maxMemAllocSize)
+    {
+        printf("error>> A %d x %d Matrix Exceeds CL_DEVICE_MAX_MEM_ALLOC_SIZE (%llu Bytes). Terminating Now ...\n", M, N, (unsigned long long)maxMemAllocSize);
+        cleanup();
+        exit(EXIT_FAILURE);
+    }
+
+    // sub-group reductions need cl_intel_subgroups or cl_khr_subgroups (OpenCL C 2.0), the local memory tree runs anywhere
+    clGetDeviceInfo(oclComputeDeviceID, CL_DEVICE_EXTENSIONS, sizeof(extensions) - 1, extensions, NULL);
+    if (strstr(extensions, "cl_intel_subgroups") != NULL)
+        subGroupOptions = "-D USE_SUBGROUPS";
+    else if (strstr(extensions, "cl_khr_subgroups") != NULL)
+        subGroupOptions = "-cl-std=CL2.0 -D USE_SUBGROUPS -D USE_KHR_SUBGROUPS";
+
+    // a work-group of a power of two from 32 to GEMV_MAX_GROUP_SIZE work-items, with about four elements of the row each
+    int groupSize = 32;
+    while ((groupSize < GEMV_MAX_GROUP_SIZE) && (groupSize * 4 < N))
+        groupSize *= 2;
+
+    char options[SPECIALIZE_OPTIONS_LENGTH];
+    char subGroupBuildOptions[SPECIALIZE_OPTIONS_LENGTH];
+    snprintf(options, sizeof(options), "%s", buildOptions);
+    specializeDefine(options, "GEMV_GROUP_SIZE", groupSize);
+    specializeDefine(options, "GEMV_COLUMNS", GEMV_COLUMNS);
+    snprintf(subGroupBuildOptions, sizeof(subGroupBuildOptions), "%s %s", options, (subGroupOptions != NULL) ? subGroupOptions : "");
+
+    cl_kernel gemvKernel = specializedKernel(&specializationCache, oclContext, oclComputeDeviceID, oclGemvSourceCode, "gemvGPU", options, &result, NULL);
+    cl_kernel gemvTransposedKernel = (gemvKernel != NULL)
+                                         ? specializedKernel(&specializationCache, oclContext, oclComputeDeviceID, oclGemvSourceCode, "gemvTransposedGPU", options, &result, NULL)
+                                         : NULL;
+    cl_kernel gemvTransposedSumKernel = (gemvTransposedKernel != NULL)
+                                            ? specializedKernel(&specializationCache, oclContext, oclComputeDeviceID, oclGemvSourceCode, "gemvTransposedSumGPU", options, &result, NULL)
+                                            : NULL;
+    if ((gemvKernel == NULL) || (gemvTransposedKernel == NULL) || (gemvTransposedSumKernel == NULL))
+    {
+        printf("error>> gemvGPU Build Failed : %d. Terminating Now ...\n", result);
+        cleanup();
+        exit(EXIT_FAILURE);
+    }
+
+    // not fatal, the local memory tree stands in
+    cl_kernel gemvSubGroupKernel = NULL;
+    if (subGroupOptions != NULL)
+    {
+        gemvSubGroupKernel = specializedKernel(&specializationCache, oclContext, oclComputeDeviceID, oclGemvSourceCode, "gemvGPU", subGroupBuildOptions, &result, NULL);
+        if (gemvSubGroupKernel == NULL)
+            printf("info>> gemvGPU With Sub-Group Reductions Could Not Be Built : %d, Skipping It.\n", result);
+    }
+
+    // the dense kernel with a one column B, the way a matrix-vector product ran before
+    cl_kernel naiveKernel = clCreateKernel(oclProgram, matMulKernelNames[MATMUL_KERNEL_NAIVE], &result);
+    if (result != CL_SUCCESS)
+    {
+        printf("error>> clCreateKernel() Failed For %s : %d. Terminating Now ...\n", matMulKernelNames[MATMUL_KERNEL_NAIVE], result);
+        cleanup();
+        exit(EXIT_FAILURE);
+    }
+
+    int longest = (M > N) ? M : N;
+    std::vector<unsigned char> A(matrixBytes);
+    std::vector<unsigned char> x((size_t)longest * elementSize);
+    std::vector<unsigned char> y((size_t)longest * resultSize);
+    std::vector<unsigned char> expectedY((size_t)M * resultSize);
+    std::vector<unsigned char> expectedTransposedY((size_t)N * resultSize);
+    type->host.fill(A.data(), (size_t)M * N, 5);
+    type->host.fill(x.data(), (size_t)longest, 7);
+    type->host.referenceGeneral(GEMM_NO_TRANSPOSE, GEMM_NO_TRANSPOSE, M, 1, N, 1.0, A.data(), N, x.data(), 1, 0.0, expectedY.data(), 1);
+    type->host.referenceGeneral(GEMM_TRANSPOSE, GEMM_NO_TRANSPOSE, N, 1, M, 1.0, A.data(), N, x.data(), 1, 0.0, expectedTransposedY.data(), 1);
+
+    cl_mem deviceGemvA = clCreateBuffer(oclContext, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, A.size(), A.data(), &result);
+    cl_mem deviceGemvX = (result == CL_SUCCESS) ? clCreateBuffer(oclContext, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, x.size(), x.data(), &result) : NULL;
+    cl_mem deviceGemvY = (result == CL_SUCCESS) ? clCreateBuffer(oclContext, CL_MEM_READ_WRITE, y.size(), NULL, &result) : NULL;
+    size_t copyBytes = (matrixBytes < GEMV_MAX_COPY_BYTES) ? matrixBytes : GEMV_MAX_COPY_BYTES;
+    // per-band sums of y = A^T x when its columns alone do not fill the device
+    size_t partialSize = gemvTransposedMaxBands(oclComputeDeviceID) * (size_t)N * type->host.accumulatorSize;
+    cl_mem deviceGemvPartial = (result == CL_SUCCESS) ? clCreateBuffer(oclContext, CL_MEM_READ_WRITE, partialSize, NULL, &result) : NULL;
+    cl_mem deviceCopy = ((result == CL_SUCCESS) && (gemvPeakBandwidth <= 0.0)) ? clCreateBuffer(oclContext, CL_MEM_READ_WRITE, copyBytes, NULL, &result) : NULL;
+    if (result != CL_SUCCESS)
+    {
+        printf("error>> clCreateBuffer() Failed For The Matrix-Vector Products : %d. Terminating Now ...\n", result);
+        if (deviceCopy)
+            clReleaseMemObject(deviceCopy);
+        if (deviceGemvPartial)
+            clReleaseMemObject(deviceGemvPartial);
+        if (deviceGemvY)
+            clReleaseMemObject(deviceGemvY);
+        if (deviceGemvX)
+            clReleaseMemObject(deviceGemvX);
+        if (deviceGemvA)
+            clReleaseMemObject(deviceGemvA);
+        clReleaseKernel(naiveKernel);
+        cleanup();
+        exit(EXIT_FAILURE);
+    }
+
+    // peak : -peakbw, or a device to device copy of (up to 256 MB of) A, which reads and writes every byte
+    double peakBandwidth = gemvPeakBandwidth;
+    const char *peakSource = "-peakbw";
+    if (deviceCopy != NULL)
+    {
+        float bestTime = -1.0f;
+        for (int run = 0; (run <= TUNE_RUNS) && (result == CL_SUCCESS); run++)
+        {
+            cl_event event = NULL;
+            result = clEnqueueCopyBuffer(oclCommandQueue, deviceGemvA, deviceCopy, 0, 0, copyBytes, 0, NULL, &event);
+            if (result != CL_SUCCESS)
+                break;
+            clWaitForEvents(1, &event);
+
+            float time = profileEventTime(event);
+            clReleaseEvent(event);
+            if ((run > 0) && ((bestTime < 0.0f) || (time < bestTime)))
+                bestTime = time;
+        }
+        clReleaseMemObject(deviceCopy);
+        peakBandwidth = (bestTime > 0.0f) ? 2.0 * copyBytes / (bestTime * 1.0e6) : 0.0;
+        peakSource = "Measured clEnqueueCopyBuffer";
+    }
+
+    printf("\n==============================================================================================\n");
+    printf("+ %s MATRIX-VECTOR PRODUCTS OF A %d x %d MATRIX, FASTEST OF %d RUNS +\n", type->option, M, N, TUNE_RUNS);
+    printf("==============================================================================================\n");
+    printf("- Peak Bandwidth  : %.2f GB/s (%s)\n", peakBandwidth, peakSource);
+    printf("- Work-Group      : %d Work-Items, Sub-Group Reductions %s\n", groupSize,
+           (gemvSubGroupKernel != NULL) ? "Available" : "Not Available");
+    printf("\n  %-30s %10s %10s %10s %10s   %s\n", "Kernel", "Time (ms)", "GB/s", "Of Peak", "GFLOP/s", "Mismatched");
+
+    // y = A x three ways, then y = A^T x
+    const char *variantNames[] = {"matrixMultiplyGPU (B 1 Column)", "gemvGPU (Local Tree)", "gemvGPU (Sub-Groups)", "gemvTransposedGPU"};
+    cl_kernel variantKernels[] = {naiveKernel, gemvKernel, gemvSubGroupKernel, gemvTransposedKernel};
+    for (int variant = 0; variant < 4; variant++)
+    {
+        int transpose = (variant == 3) ? GEMM_TRANSPOSE : GEMM_NO_TRANSPOSE;
+        int lengthY = (transpose == GEMM_TRANSPOSE) ? N : M;
+        float bestTime = -1.0f;
+
+        if (variantKernels[variant] == NULL)
+            continue;
+
+        // results start as all ones bits, so an element no work-item stores shows up as a mismatch
+        cl_uchar pattern = 0xff;
+        result = clEnqueueFillBuffer(oclCommandQueue, deviceGemvY, &pattern, sizeof(pattern), 0, y.size(), 0, NULL, NULL);
+
+        if ((variant == 0) && (result == CL_SUCCESS))
+        {
+            int oneColumn = 1;
+            size_t globalWorkSize[2] = {(size_t)M, 1};
+            result = clSetKernelArg(naiveKernel, 0, sizeof(cl_mem), (void *)&deviceGemvA);
+            result |= clSetKernelArg(naiveKernel, 1, sizeof(cl_mem), (void *)&deviceGemvX);
+            result |= clSetKernelArg(naiveKernel, 2, sizeof(cl_mem), (void *)&deviceGemvY);
+            result |= clSetKernelArg(naiveKernel, 3, sizeof(cl_int), (void *)&M);
+            result |= clSetKernelArg(naiveKernel, 4, sizeof(cl_int), (void *)&N);
+            result |= clSetKernelArg(naiveKernel, 5, sizeof(cl_int), (void *)&oneColumn);
+            result |= clSetKernelArg(naiveKernel, 6, sizeof(cl_int), (void *)&oneColumn);
+            if (result == CL_SUCCESS)
+                bestTime = tuneTimeLaunch(oclCommandQueue, naiveKernel, 2, globalWorkSize, NULL);
+        }
+        else
+        {
+            for (int run = 0; (run <= TUNE_RUNS) && (result == CL_SUCCESS); run++)
+            {
+                // the banded transposed product counts both of its kernels
+                cl_event events[2] = {NULL, NULL};
+                result = enqueueGemv(oclCommandQueue, variantKernels[variant], &type->host, transpose, M, N, deviceGemvA, 0, N, deviceGemvX, deviceGemvY,
+                                     gemvTransposedSumKernel, deviceGemvPartial, events);
+                if (result == CL_SUCCESS)
+                    result = clFinish(oclCommandQueue);
+
+                float time = profileEventTime(events[0]) + profileEventTime(events[1]);
+                for (int event = 0; event < 2; event++)
+                    if (events[event])
+                        clReleaseEvent(events[event]);
+                if (result != CL_SUCCESS)
+                    break;
+                if ((run > 0) && ((bestTime < 0.0f) || (time < bestTime)))
+                    bestTime = time;
+            }
+        }
+
+        if ((result == CL_SUCCESS) && (bestTime >= 0.0f))
+            result = clEnqueueReadBuffer(oclCommandQueue, deviceGemvY, CL_TRUE, 0, (size_t)lengthY * resultSize, y.data(), 0, NULL, NULL);
+        if ((result != CL_SUCCESS) || (bestTime < 0.0f))
+        {
+            printf("error>> %s Failed : %d. Terminating Now ...\n", variantNames[variant], result);
+            clReleaseMemObject(deviceGemvPartial);
+            clReleaseMemObject(deviceGemvY);
+            clReleaseMemObject(deviceGemvX);
+            clReleaseMemObject(deviceGemvA);
+            clReleaseKernel(naiveKernel);
+            cleanup();
+            exit(EXIT_FAILURE);
+        }
+
+        // A once, x once (the naive kernel reads it once per row, which the cache absorbs at best) and y
+        VerifyReport report = type->host.verify(y.data(), (transpose == GEMM_TRANSPOSE) ? expectedTransposedY.data() : expectedY.data(), (size_t)lengthY);
+        double bytes = (double)matrixBytes + (double)((transpose == GEMM_TRANSPOSE) ? M : N) * elementSize + (double)lengthY * resultSize;
+        double bandwidth = (bestTime > 0.0f) ? bytes / (bestTime * 1.0e6) : 0.0;
+        printf("  %-30s %10.3f %10.2f %9.1f%% %10.2f   %zu Of %d\n", variantNames[variant], bestTime, bandwidth, (peakBandwidth > 0.0) ? 100.0 * bandwidth / peakBandwidth : 0.0,
+               (bestTime > 0.0f) ? 2.0 * M * (double)N / (bestTime * 1.0e6) : 0.0, report.numberOfMismatches, lengthY);
+    }
+    printf("==============================================================================================\n");
+
+    clReleaseMemObject(deviceGemvPartial);
+    clReleaseMemObject(deviceGemvY);
+    clReleaseMemObject(deviceGemvX);
+    clReleaseMemObject(deviceGemvA);
+    clReleaseKernel(naiveKernel);
+}
+
+// specializeMatrixMultiply() definition
+cl_kernel specializeMatrixMultiply(int iARows, int iAColumns, int iBColumns, int iCColumns)
+{
+    // local variable declaration
+    char options[SPECIALIZE_OPTIONS_LENGTH] = "";
+    bool bBuilt = false;
+    cl_int result;
+
+    // code
+    snprintf(options, sizeof(options), "%s", buildOptions);
+    specializeDefine(options, "FIXED_A_ROWS", iARows);
+    specializeDefine(options, "FIXED_A_COLUMNS", iAColumns);
+    specializeDefine(options, "FIXED_B_COLUMNS", iBColumns);
+    specializeDefine(options, "FIXED_C_COLUMNS", iCColumns);
+
+    // the tiled kernel fixes its own work-group size and drops its bounds checks when the shape is a tile multiple
+    if ((matMulKernel != MATMUL_KERNEL_TILED) && (localWorkSize[0] != 0))
+    {
+        specializeDefine(options, "FIXED_LOCAL_SIZE_X", (long long)localWorkSize[0]);
+        specializeDefine(options, "FIXED_LOCAL_SIZE_Y", (long long)localWorkSize[1]);
+    }
+
+    // the grid of the naive kernel is the shape of C, so every work-item is inside it
+    if (matMulKernel == MATMUL_KERNEL_NAIVE)
+        specializeDefineText(options, "EXACT_GRID", NULL);
+
+    int traceSlice = traceBegin(&traceLog, "specializeMatrixMultiply", "setup");
+    cl_kernel kernel = specializedKernel(&specializationCache, oclContext, oclComputeDeviceID, oclSourceCode, matMulKernelNames[matMulKernel], options, &result, &bBuilt);
+    traceEnd(&traceLog, traceSlice);
+
+    if (kernel == NULL)
+    {
+        // not fatal, the generic kernel runs every shape
+        printf("info>> Specialized %s Could Not Be Built : %d, Using The Generic Kernel.\n", matMulKernelNames[matMulKernel], result);
+        bSpecialize = false;
+        return (NULL);
+    }
+
+    if (bBuilt == true)
+        printf("info>> Specialized %s Built With %s\n", matMulKernelNames[matMulKernel], options);
+
+    return (kernel);
+}
+
+// releaseOutOfCore() definition
+void releaseOutOfCore(void)
+{
+    // code
+    std::vector<OutOfCoreBlock> *pools[3] = {&outOfCorePoolA, &outOfCorePoolB, &outOfCoreTilesC};
+    for (int pool = 0; pool < 3; pool++)
+    {
+        // the events of the blocks are owned by outOfCoreEvents
+        for (size_t slot = 0; slot < pools[pool]->size(); slot++)
+            if ((*pools[pool])[slot].buffer)
+                clReleaseMemObject((*pools[pool])[slot].buffer);
+        pools[pool]->clear();
+    }
+
+    for (int queueIndex = 0; queueIndex < OUT_OF_CORE_QUEUES; queueIndex++)
+    {
+        if (oclOutOfCoreQueues[queueIndex])
+            clFinish(oclOutOfCoreQueues[queueIndex]);
+
+        for (size_t index = 0; index < outOfCoreEvents[queueIndex].size(); index++)
+            clReleaseEvent(outOfCoreEvents[queueIndex][index]);
+        outOfCoreEvents[queueIndex].clear();
+
+        if (oclOutOfCoreQueues[queueIndex])
+        {
+            clReleaseCommandQueue(oclOutOfCoreQueues[queueIndex]);
+            oclOutOfCoreQueues[queueIndex] = NULL;
+        }
+    }
+}
+
+// releaseMultiDevice() definition
+void releaseMultiDevice(void)
+{
+    // code
+    for (size_t index = 0; index < multiDevices.size(); index++)
+    {
+        MultiDevice *device = &multiDevices[index];
+        if (device->queue)
+            clFinish(device->queue);
+
+        for (size_t event = 0; event < device->events.size(); event++)
+            clReleaseEvent(device->events[event]);
+        releaseSpecializationCache(&device->kernelCache);
+        if (device->tileC)
+            clReleaseMemObject(device->tileC);
+        if (device->queue)
+            clReleaseCommandQueue(device->queue);
+    }
+    multiDevices.clear();
+
+    for (size_t index = 0; index < multiDeviceContexts.size(); index++)
+    {
+        MultiDeviceContext *context = &multiDeviceContexts[index];
+        for (size_t panel = 0; panel < context->panelsA.size(); panel++)
+            if (context->panelsA[panel])
+                clReleaseMemObject(context->panelsA[panel]);
+        for (size_t panel = 0; panel < context->panelsB.size(); panel++)
+            if (context->panelsB[panel])
+                clReleaseMemObject(context->panelsB[panel]);
+        clReleaseContext(context->context);
+    }
+    multiDeviceContexts.clear();
+}
+
+// cleanup() definition
+void cleanup(void)
+{
+    // local function declaration
+    void releaseOutOfCore(void);
+    void releaseMultiDevice(void);
+    void freeHostMatrix(void *);
+
+    // code
+    releaseProfileLog(&profileLog);
+    releaseOutOfCore();
+    releaseMultiDevice();
+
+    for (size_t index = 0; index < sparseBuffers.size(); index++)
+        if (sparseBuffers[index])
+            clReleaseMemObject(sparseBuffers[index]);
+    sparseBuffers.clear();
+
+    if (bDeviceBuffersMapped == true)
+    {
+        // hand the zero-copy host matrices back before their buffers go away
+        clEnqueueUnmapMemObject(oclCommandQueue, deviceA, hostA, 0, NULL, NULL);
+        clEnqueueUnmapMemObject(oclCommandQueue, deviceB, hostB, 0, NULL, NULL);
+        clEnqueueUnmapMemObject(oclCommandQueue, deviceC, hostC, 0, NULL, NULL);
+        clFinish(oclCommandQueue);
+        bDeviceBuffersMapped = false;
+    }
+
+    if (bHostMatricesFromRuntime == true)
+    {
+        // mapped pointers owned by the OpenCL runtime, anything else was allocated here and is freed below
+        hostA = NULL;
+        hostB = NULL;
+        hostC = NULL;
+        bHostMatricesFromRuntime = false;
+    }
+
+    if (devicePackedB)
+    {
+        clReleaseMemObject(devicePackedB);
+        devicePackedB = NULL;
+    }
+
+    if (deviceC)
+    {
+        clReleaseMemObject(deviceC);
+        deviceC = NULL;
+    }
+
+    if (deviceB)
+    {
+        clReleaseMemObject(deviceB);
+        deviceB = NULL;
+    }
+
+    if (deviceA)
+    {
+        clReleaseMemObject(deviceA);
+        deviceA = NULL;
+    }
+
+    releaseSpecializationCache(&specializationCache);
+
+    if (oclPackKernel)
+    {
+        clReleaseKernel(oclPackKernel);
+        oclPackKernel = NULL;
     }
 
     if (oclKernel)
@@ -527,19 +3251,19 @@ void cleanup(void)
 
     if (hostC)
     {
-        free(hostC);
+        freeHostMatrix(hostC);
         hostC = NULL;
     }
 
     if (hostB)
     {
-        free(hostB);
+        freeHostMatrix(hostB);
         hostB = NULL;
     }
 
     if (hostA)
     {
-        free(hostA);
+        freeHostMatrix(hostA);
         hostA = NULL;
     }
 }
@@ -0,0 +1,774 @@
+// helper_gemm.h
+// host side of the typed GEMM kernels : one template per operation (fill, reference product, sampled check,
+// comparison) instantiated for every element type, half matrices are kept as their 16 bit patterns.
+// General product C = alpha * op(A) * op(B) + beta * C on sub-matrices of row-major buffers (offsets and
+// leading dimensions), the gemmGPU kernel below and enqueueGemm() with its host reference. Matrix-vector
+// products y = A x and y = A^T x through the gemvGPU kernels and enqueueGemv()
+
+#ifndef HELPER_GEMM_H
+#define HELPER_GEMM_H
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include <CL/opencl.h>
+
+#define GEMM_NO_TRANSPOSE 0
+#define GEMM_TRANSPOSE 1
+
+// include after helper_timer.h, which has no include guard
+#include "helper_verify.h"
+#include "helper_host_gemm.h"
+
+////////////////////////////////////////////////////////////////////////////////
+//! IEEE half <-> float, rounding to the nearest even like convert_half() in the kernels
+////////////////////////////////////////////////////////////////////////////////
+inline float halfToFloat(cl_half value)
+{
+    unsigned int sign = ((unsigned int)value & 0x8000u) << 16;
+    unsigned int exponent = ((unsigned int)value >> 10) & 0x1fu;
+    unsigned int mantissa = (unsigned int)value & 0x3ffu;
+    unsigned int bits;
+    float result;
+
+    if (exponent == 0x1fu)
+    {
+        bits = sign | 0x7f800000u | (mantissa << 13);
+    }
+    else if (exponent != 0)
+    {
+        bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+    }
+    else if (mantissa == 0)
+    {
+        bits = sign;
+    }
+    else
+    {
+        // subnormal half, a normal float once the leading bit is moved up to the implicit one
+        exponent = 113;
+        while ((mantissa & 0x400u) == 0)
+        {
+            mantissa <<= 1;
+            exponent--;
+        }
+        bits = sign | (exponent << 23) | ((mantissa & 0x3ffu) << 13);
+    }
+
+    memcpy(&result, &bits, sizeof(result));
+    return (result);
+}
+
+inline cl_half floatToHalf(float value)
+{
+    unsigned int bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    unsigned int sign = (bits >> 16) & 0x8000u;
+    unsigned int mantissa = bits & 0x7fffffu;
+    int exponent = (int)((bits >> 23) & 0xffu) - 127 + 15;
+    unsigned int half;
+    unsigned int remainder;
+    unsigned int halfway;
+
+    if (((bits >> 23) & 0xffu) == 0xffu)
+        return ((cl_half)(sign | 0x7c00u | ((mantissa != 0) ? 0x200u : 0)));
+    if (exponent >= 31)
+        return ((cl_half)(sign | 0x7c00u));
+
+    if (exponent <= 0)
+    {
+        // subnormal half or zero
+        if (exponent < -10)
+            return ((cl_half)sign);
+        mantissa |= 0x800000u;
+        unsigned int shift = (unsigned int)(14 - exponent);
+        half = mantissa >> shift;
+        remainder = mantissa & ((1u << shift) - 1);
+        halfway = 1u << (shift - 1);
+    }
+    else
+    {
+        half = ((unsigned int)exponent << 10) | (mantissa >> 13);
+        remainder = mantissa & 0x1fffu;
+        halfway = 0x1000u;
+    }
+
+    // a carry out of the mantissa moves up to the next exponent, or to infinity
+    if ((remainder > halfway) || ((remainder == halfway) && ((half & 1) != 0)))
+        half++;
+    return ((cl_half)(sign | half));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Value conversion between the host element types, half goes through float
+////////////////////////////////////////////////////////////////////////////////
+template <typename TO, typename FROM>
+inline TO gemmConvert(FROM value)
+{
+    return ((TO)value);
+}
+
+template <>
+inline float gemmConvert<float, cl_half>(cl_half value)
+{
+    return (halfToFloat(value));
+}
+
+template <>
+inline cl_half gemmConvert<cl_half, float>(float value)
+{
+    return (floatToHalf(value));
+}
+
+// values are compared as ints for the integer results and as floats for the others
+template <typename R>
+struct GemmCompareType
+{
+    typedef float type;
+};
+
+template <>
+struct GemmCompareType<cl_int>
+{
+    typedef cl_int type;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//! count elements of (index % modulo) - modulo / 2 : small values whose products and sums are exact
+//! in every accumulator type
+////////////////////////////////////////////////////////////////////////////////
+template <typename T>
+void gemmFill(void *data, size_t count, int modulo)
+{
+    for (size_t index = 0; index < count; index++)
+        ((T *)data)[index] = gemmConvert<T>((float)((int)(index % modulo) - modulo / 2));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! C = A x B on the host, with the element (T), result (R) and accumulator (ACC) types of the kernel
+////////////////////////////////////////////////////////////////////////////////
+template <typename T, typename R, typename ACC>
+void gemmReference(const void *A, const void *B, void *C, int numberOfARows, int numberOfAColumns, int numberOfBColumns, int numberOfCColumns)
+{
+    const T *a = (const T *)A;
+    const T *b = (const T *)B;
+    R *c = (R *)C;
+
+    for (int row = 0; row < numberOfARows; row++)
+    {
+        for (int column = 0; column < numberOfBColumns; column++)
+        {
+            ACC value = 0;
+            for (int depth = 0; depth < numberOfAColumns; depth++)
+                value += gemmConvert<ACC>(a[row * numberOfAColumns + depth]) * gemmConvert<ACC>(b[depth * numberOfBColumns + column]);
+            c[row * numberOfCColumns + column] = gemmConvert<R>(value);
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! C = alpha * op(A) * op(B) + beta * C on the host, op(A) M x K, op(B) K x N, row-major with leading
+//! dimensions lda / ldb / ldc. The sum is accumulated like gemmGPU, C is not read when beta is 0
+////////////////////////////////////////////////////////////////////////////////
+template <typename T, typename R, typename ACC>
+void gemmReferenceGeneral(int transposeA, int transposeB, int M, int N, int K, double alpha, const void *A, int lda, const void *B, int ldb, double beta, void *C,
+                          int ldc)
+{
+    const T *a = (const T *)A;
+    const T *b = (const T *)B;
+    R *c = (R *)C;
+    ACC alphaValue = (ACC)alpha;
+    ACC betaValue = (ACC)beta;
+
+    for (int row = 0; row < M; row++)
+    {
+        for (int column = 0; column < N; column++)
+        {
+            ACC value = 0;
+            for (int depth = 0; depth < K; depth++)
+            {
+                T aElement = (transposeA == GEMM_TRANSPOSE) ? a[depth * lda + row] : a[row * lda + depth];
+                T bElement = (transposeB == GEMM_TRANSPOSE) ? b[column * ldb + depth] : b[depth * ldb + column];
+                value += gemmConvert<ACC>(aElement) * gemmConvert<ACC>(bElement);
+            }
+
+            R *element = &c[row * ldc + column];
+            if (betaValue == 0)
+                *element = gemmConvert<R>((ACC)(alphaValue * value));
+            else
+                *element = gemmConvert<R>((ACC)(alphaValue * value + betaValue * gemmConvert<ACC>(*element)));
+        }
+    }
+}
+
+template <typename ACC>
+void gemmScalar(double value, void *scalar)
+{
+    *(ACC *)scalar = (ACC)value;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Mismatches among numberOfSamples elements spread over C of a size x size product, for the products
+//! too large for a full host reference
+////////////////////////////////////////////////////////////////////////////////
+template <typename T, typename R, typename ACC>
+size_t gemmCheckSamples(const void *A, const void *B, const void *C, int size, size_t numberOfSamples)
+{
+    const T *a = (const T *)A;
+    const T *b = (const T *)B;
+    const R *c = (const R *)C;
+    size_t numberOfElements = (size_t)size * size;
+    size_t numberOfMismatches = 0;
+
+    for (size_t sample = 0; sample < numberOfSamples; sample++)
+    {
+        size_t index = (size_t)((sample * 2654435761ull) % numberOfElements);
+        size_t row = index / size;
+        size_t column = index % size;
+        ACC value = 0;
+
+        for (int depth = 0; depth < size; depth++)
+            value += gemmConvert<ACC>(a[row * size + depth]) * gemmConvert<ACC>(b[(size_t)depth * size + column]);
+
+        R expected = gemmConvert<R>(value);
+        if (memcmp(&c[index], &expected, sizeof(R)) != 0)
+            numberOfMismatches++;
+    }
+
+    return (numberOfMismatches);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! verifyArrays() / printVerifyReport() on the int or float values of count results of type R, exact match
+////////////////////////////////////////////////////////////////////////////////
+template <typename R>
+VerifyReport gemmVerify(const void *result, const void *expected, size_t count)
+{
+    typedef typename GemmCompareType<R>::type C;
+    std::vector<C> resultValues(count);
+    std::vector<C> expectedValues(count);
+
+    for (size_t index = 0; index < count; index++)
+    {
+        resultValues[index] = gemmConvert<C>(((const R *)result)[index]);
+        expectedValues[index] = gemmConvert<C>(((const R *)expected)[index]);
+    }
+
+    return (verifyArrays(resultValues.data(), expectedValues.data(), count, 0.0f, 0, 0));
+}
+
+template <typename R>
+void gemmPrintVerifyReport(const VerifyReport *report, const void *result, const void *expected)
+{
+    typedef typename GemmCompareType<R>::type C;
+    std::vector<C> resultValues(report->numberOfElements);
+    std::vector<C> expectedValues(report->numberOfElements);
+
+    for (size_t index = 0; index < report->numberOfElements; index++)
+    {
+        resultValues[index] = gemmConvert<C>(((const R *)result)[index]);
+        expectedValues[index] = gemmConvert<C>(((const R *)expected)[index]);
+    }
+
+    printVerifyReport(report, resultValues.data(), expectedValues.data());
+}
+
+// the host operations of one element type
+typedef struct GemmHostType
+{
+    size_t elementSize;     // of A and B
+    size_t resultSize;      // of C
+    size_t accumulatorSize; // of alpha and beta
+    void (*fill)(void *data, size_t count, int modulo);       // of A or B
+    void (*fillResult)(void *data, size_t count, int modulo); // of C
+    void (*scalar)(double value, void *scalar); // alpha or beta in the accumulator type
+    void (*reference)(const void *A, const void *B, void *C, int numberOfARows, int numberOfAColumns, int numberOfBColumns, int numberOfCColumns);
+    void (*referenceGeneral)(int transposeA, int transposeB, int M, int N, int K, double alpha, const void *A, int lda, const void *B, int ldb, double beta, void *C,
+                             int ldc);
+    size_t (*checkSamples)(const void *A, const void *B, const void *C, int size, size_t numberOfSamples);
+    VerifyReport (*verify)(const void *result, const void *expected, size_t count);
+    void (*printVerifyReport)(const VerifyReport *report, const void *result, const void *expected);
+    HostGemmBlockedFunction blocked; // cache-blocked SIMD product with the same results as reference, or NULL
+} GemmHostType;
+
+template <typename T, typename R, typename ACC>
+inline GemmHostType gemmHostType(void)
+{
+    GemmHostType type = {sizeof(T),
+                         sizeof(R),
+                         sizeof(ACC),
+                         gemmFill<T>,
+                         gemmFill<R>,
+                         gemmScalar<ACC>,
+                         gemmReference<T, R, ACC>,
+                         gemmReferenceGeneral<T, R, ACC>,
+                         gemmCheckSamples<T, R, ACC>,
+                         gemmVerify<R>,
+                         gemmPrintVerifyReport<R>,
+                         HostGemmBlocked<T, R, ACC>::function()};
+    return (type);
+}
+
+static const char *const oclGemmSourceCode =
+    "// contraction into fma would round alpha * value + beta * C differently from the host                                      \n"
+    "#pragma OPENCL FP_CONTRACT OFF                                                                                              \n"
+    "                                                                                                                            \n"
+    "#if defined(cl_khr_fp64)                                                                                                    \n"
+    "#pragma OPENCL EXTENSION cl_khr_fp64 : enable                                                                               \n"
+    "#endif                                                                                                                      \n"
+    "#if defined(cl_khr_fp16)                                                                                                    \n"
+    "#pragma OPENCL EXTENSION cl_khr_fp16 : enable                                                                               \n"
+    "#endif                                                                                                                      \n"
+    "                                                                                                                            \n"
+    "#ifndef ELEMENT_TYPE                                                                                                        \n"
+    "#define ELEMENT_TYPE float                                                                                                  \n"
+    "#endif                                                                                                                      \n"
+    "#ifndef RESULT_TYPE                                                                                                         \n"
+    "#define RESULT_TYPE ELEMENT_TYPE                                                                                            \n"
+    "#endif                                                                                                                      \n"
+    "#ifndef ACCUMULATOR_TYPE                                                                                                    \n"
+    "#define ACCUMULATOR_TYPE float                                                                                              \n"
+    "#endif                                                                                                                      \n"
+    "#ifndef GEMM_TILE                                                                                                           \n"
+    "#define GEMM_TILE 16                                                                                                        \n"
+    "#endif                                                                                                                      \n"
+    "                                                                                                                            \n"
+    "// C = alpha * op(A) * op(B) + beta * C, op(A) M x K and op(B) K x N, every matrix row-major at its offset                  \n"
+    "// with its leading dimension. One GEMM_TILE x GEMM_TILE tile of C per work-group                                           \n"
+    "__kernel __attribute__((reqd_work_group_size(GEMM_TILE, GEMM_TILE, 1)))                                                     \n"
+    "void gemmGPU(int transposeA, int transposeB, int M, int N, int K, ACCUMULATOR_TYPE alpha,                                   \n"
+    "             __global const ELEMENT_TYPE *A, int offsetA, int lda, __global const ELEMENT_TYPE *B, int offsetB, int ldb,    \n"
+    "             ACCUMULATOR_TYPE beta, __global RESULT_TYPE *C, int offsetC, int ldc)                                          \n"
+    "{                                                                                                                           \n"
+    "    __local ELEMENT_TYPE tileA[GEMM_TILE][GEMM_TILE]; // tileA[r][k] = op(A)[rowBase + r][depthBase + k]                    \n"
+    "    __local ELEMENT_TYPE tileB[GEMM_TILE][GEMM_TILE]; // tileB[k][c] = op(B)[depthBase + k][columnBase + c]                 \n"
+    "                                                                                                                            \n"
+    "    int localColumn = get_local_id(0);                                                                                      \n"
+    "    int localRow = get_local_id(1);                                                                                         \n"
+    "    int columnBase = get_group_id(0) * GEMM_TILE;                                                                           \n"
+    "    int rowBase = get_group_id(1) * GEMM_TILE;                                                                              \n"
+    "    ACCUMULATOR_TYPE value = 0;                                                                                             \n"
+    "                                                                                                                            \n"
+    "    A += offsetA;                                                                                                           \n"
+    "    B += offsetB;                                                                                                           \n"
+    "    C += offsetC;                                                                                                           \n"
+    "                                                                                                                            \n"
+    "    for (int depthBase = 0; depthBase < K; depthBase += GEMM_TILE)                                                          \n"
+    "    {                                                                                                                       \n"
+    "        // dimension 0 walks the contiguous index of the stored matrix, transposed or not, so loads stay coalesced          \n"
+    "        if (transposeA)                                                                                                     \n"
+    "        {                                                                                                                   \n"
+    "            int row = rowBase + localColumn;                                                                                \n"
+    "            int depth = depthBase + localRow;                                                                               \n"
+    "            tileA[localColumn][localRow] = ((row < M) && (depth < K)) ? A[depth * lda + row] : 0;                           \n"
+    "        }                                                                                                                   \n"
+    "        else                                                                                                                \n"
+    "        {                                                                                                                   \n"
+    "            int row = rowBase + localRow;                                                                                   \n"
+    "            int depth = depthBase + localColumn;                                                                            \n"
+    "            tileA[localRow][localColumn] = ((row < M) && (depth < K)) ? A[row * lda + depth] : 0;                           \n"
+    "        }                                                                                                                   \n"
+    "                                                                                                                            \n"
+    "        if (transposeB)                                                                                                     \n"
+    "        {                                                                                                                   \n"
+    "            int depth = depthBase + localColumn;                                                                            \n"
+    "            int column = columnBase + localRow;                                                                             \n"
+    "            tileB[localColumn][localRow] = ((depth < K) && (column < N)) ? B[column * ldb + depth] : 0;                     \n"
+    "        }                                                                                                                   \n"
+    "        else                                                                                                                \n"
+    "        {                                                                                                                   \n"
+    "            int depth = depthBase + localRow;                                                                               \n"
+    "            int column = columnBase + localColumn;                                                                          \n"
+    "            tileB[localRow][localColumn] = ((depth < K) && (column < N)) ? B[depth * ldb + column] : 0;                     \n"
+    "        }                                                                                                                   \n"
+    "        barrier(CLK_LOCAL_MEM_FENCE);                                                                                       \n"
+    "                                                                                                                            \n"
+    "        for (int depth = 0; depth < GEMM_TILE; depth++)                                                                     \n"
+    "            value += (ACCUMULATOR_TYPE)tileA[localRow][depth] * tileB[depth][localColumn];                                  \n"
+    "        barrier(CLK_LOCAL_MEM_FENCE);                                                                                       \n"
+    "    }                                                                                                                       \n"
+    "                                                                                                                            \n"
+    "    int row = rowBase + localRow;                                                                                           \n"
+    "    int column = columnBase + localColumn;                                                                                  \n"
+    "    if ((row < M) && (column < N))                                                                                          \n"
+    "    {                                                                                                                       \n"
+    "        // C is not read when beta is 0, so it may hold anything then                                                       \n"
+    "        __global RESULT_TYPE *element = C + row * ldc + column;                                                             \n"
+    "        if (beta == 0)                                                                                                      \n"
+    "            *element = (RESULT_TYPE)(alpha * value);                                                                        \n"
+    "        else                                                                                                                \n"
+    "            *element = (RESULT_TYPE)(alpha * value + beta * (ACCUMULATOR_TYPE)(*element));                                  \n"
+    "    }                                                                                                                       \n"
+    "}                                                                                                                           \n";
+
+////////////////////////////////////////////////////////////////////////////////
+//! Elements a rows x columns matrix at offset with leading dimension ld spans, false if ld is too
+//! small for its rows or the offset is negative
+////////////////////////////////////////////////////////////////////////////////
+inline bool gemmMatrixExtent(int rows, int columns, int offset, int ld, size_t *pExtent)
+{
+    if ((offset < 0) || (ld < ((columns > 1) ? columns : 1)))
+        return (false);
+
+    *pExtent = ((rows == 0) || (columns == 0)) ? 0 : (size_t)offset + (size_t)(rows - 1) * ld + columns;
+    return (true);
+}
+
+inline bool gemmBufferHolds(cl_mem buffer, size_t extent, size_t elementSize)
+{
+    size_t size = 0;
+
+    if (extent == 0)
+        return (true);
+    if (clGetMemObjectInfo(buffer, CL_MEM_SIZE, sizeof(size), &size, NULL) != CL_SUCCESS)
+        return (false);
+    return (extent * elementSize <= size);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Enqueue gemmGPU (oclGemmSourceCode built with the -D ELEMENT_TYPE / RESULT_TYPE / ACCUMULATOR_TYPE of type) for
+//! C = alpha * op(A) * op(B) + beta * C, op(X) is X for GEMM_NO_TRANSPOSE and its transpose for
+//! GEMM_TRANSPOSE. Row-major like the rest of the samples : op(A) is M x K, op(B) K x N and C M x N,
+//! each starting offset elements into its buffer with ld elements between rows of the stored matrix.
+//! CL_INVALID_VALUE for bad arguments or buffers too small for them, nothing is enqueued for an empty C
+//! (*event is NULL then), event may be NULL
+////////////////////////////////////////////////////////////////////////////////
+inline cl_int enqueueGemm(cl_command_queue queue, cl_kernel kernel, const GemmHostType *type, int transposeA, int transposeB, int M, int N, int K, double alpha,
+                          cl_mem A, int offsetA, int lda, cl_mem B, int offsetB, int ldb, double beta, cl_mem C, int offsetC, int ldc, cl_event *event)
+{
+    unsigned char alphaValue[sizeof(cl_double)];
+    unsigned char betaValue[sizeof(cl_double)];
+    size_t localWorkSize[3];
+    size_t globalWorkSize[2];
+    size_t extentA;
+    size_t extentB;
+    size_t extentC;
+    cl_int result;
+
+    if (event != NULL)
+        *event = NULL;
+
+    if (((transposeA != GEMM_NO_TRANSPOSE) && (transposeA != GEMM_TRANSPOSE)) || ((transposeB != GEMM_NO_TRANSPOSE) && (transposeB != GEMM_TRANSPOSE)))
+        return (CL_INVALID_VALUE);
+    if ((M < 0) || (N < 0) || (K < 0))
+        return (CL_INVALID_VALUE);
+
+    // the stored A is K x M when transposed, the stored B N x K
+    bool bValid = (transposeA == GEMM_TRANSPOSE) ? gemmMatrixExtent(K, M, offsetA, lda, &extentA) : gemmMatrixExtent(M, K, offsetA, lda, &extentA);
+    bValid = bValid && ((transposeB == GEMM_TRANSPOSE) ? gemmMatrixExtent(N, K, offsetB, ldb, &extentB) : gemmMatrixExtent(K, N, offsetB, ldb, &extentB));
+    bValid = bValid && gemmMatrixExtent(M, N, offsetC, ldc, &extentC);
+    if (bValid == false)
+        return (CL_INVALID_VALUE);
+
+    if ((M == 0) || (N == 0))
+        return (CL_SUCCESS);
+
+    if ((gemmBufferHolds(A, extentA, type->elementSize) == false) || (gemmBufferHolds(B, extentB, type->elementSize) == false) ||
+        (gemmBufferHolds(C, extentC, type->resultSize) == false))
+        return (CL_INVALID_VALUE);
+
+    // the tile size the program was built with, from reqd_work_group_size
+    cl_device_id device;
+    result = clGetCommandQueueInfo(queue, CL_QUEUE_DEVICE, sizeof(device), &device, NULL);
+    result |= clGetKernelWorkGroupInfo(kernel, device, CL_KERNEL_COMPILE_WORK_GROUP_SIZE, sizeof(localWorkSize), localWorkSize, NULL);
+    if (result != CL_SUCCESS)
+        return (result);
+
+    type->scalar(alpha, alphaValue);
+    type->scalar(beta, betaValue);
+
+    result = clSetKernelArg(kernel, 0, sizeof(cl_int), (void *)&transposeA);
+    result |= clSetKernelArg(kernel, 1, sizeof(cl_int), (void *)&transposeB);
+    result |= clSetKernelArg(kernel, 2, sizeof(cl_int), (void *)&M);
+    result |= clSetKernelArg(kernel, 3, sizeof(cl_int), (void *)&N);
+    result |= clSetKernelArg(kernel, 4, sizeof(cl_int), (void *)&K);
+    result |= clSetKernelArg(kernel, 5, type->accumulatorSize, (void *)alphaValue);
+    result |= clSetKernelArg(kernel, 6, sizeof(cl_mem), (void *)&A);
+    result |= clSetKernelArg(kernel, 7, sizeof(cl_int), (void *)&offsetA);
+    result |= clSetKernelArg(kernel, 8, sizeof(cl_int), (void *)&lda);
+    result |= clSetKernelArg(kernel, 9, sizeof(cl_mem), (void *)&B);
+    result |= clSetKernelArg(kernel, 10, sizeof(cl_int), (void *)&offsetB);
+    result |= clSetKernelArg(kernel, 11, sizeof(cl_int), (void *)&ldb);
+    result |= clSetKernelArg(kernel, 12, type->accumulatorSize, (void *)betaValue);
+    result |= clSetKernelArg(kernel, 13, sizeof(cl_mem), (void *)&C);
+    result |= clSetKernelArg(kernel, 14, sizeof(cl_int), (void *)&offsetC);
+    result |= clSetKernelArg(kernel, 15, sizeof(cl_int), (void *)&ldc);
+    if (result != CL_SUCCESS)
+        return (result);
+
+    // whole tiles over C, the kernel masks the edges
+    globalWorkSize[0] = ((N + localWorkSize[0] - 1) / localWorkSize[0]) * localWorkSize[0];
+    globalWorkSize[1] = ((M + localWorkSize[1] - 1) / localWorkSize[1]) * localWorkSize[1];
+    return (clEnqueueNDRangeKernel(queue, kernel, 2, NULL, globalWorkSize, localWorkSize, 0, NULL, event));
+}
+
+static const char *const oclGemvSourceCode =
+    "#if defined(cl_khr_fp64)                                                                                                    \n"
+    "#pragma OPENCL EXTENSION cl_khr_fp64 : enable                                                                               \n"
+    "#endif                                                                                                                      \n"
+    "#if defined(cl_khr_fp16)                                                                                                    \n"
+    "#pragma OPENCL EXTENSION cl_khr_fp16 : enable                                                                               \n"
+    "#endif                                                                                                                      \n"
+    "#ifdef USE_KHR_SUBGROUPS                                                                                                    \n"
+    "#pragma OPENCL EXTENSION cl_khr_subgroups : enable                                                                          \n"
+    "#endif                                                                                                                      \n"
+    "                                                                                                                            \n"
+    "#ifndef ELEMENT_TYPE                                                                                                        \n"
+    "#define ELEMENT_TYPE float                                                                                                  \n"
+    "#endif                                                                                                                      \n"
+    "#ifndef RESULT_TYPE                                                                                                         \n"
+    "#define RESULT_TYPE ELEMENT_TYPE                                                                                            \n"
+    "#endif                                                                                                                      \n"
+    "#ifndef ACCUMULATOR_TYPE                                                                                                    \n"
+    "#define ACCUMULATOR_TYPE float                                                                                              \n"
+    "#endif                                                                                                                      \n"
+    "#ifndef GEMV_GROUP_SIZE                                                                                                     \n"
+    "#define GEMV_GROUP_SIZE 256                                                                                                 \n"
+    "#endif                                                                                                                      \n"
+    "#ifndef GEMV_COLUMNS                                                                                                        \n"
+    "#define GEMV_COLUMNS 32                                                                                                     \n"
+    "#endif                                                                                                                      \n"
+    "                                                                                                                            \n"
+    "// sum of value over a work-group of GEMV_GROUP_SIZE (a power of two), valid in work-item 0 : sub-group reductions          \n"
+    "// where the device has them (USE_SUBGROUPS), a local memory tree over scratch otherwise                                    \n"
+    "ACCUMULATOR_TYPE gemvGroupSum(ACCUMULATOR_TYPE value, __local ACCUMULATOR_TYPE *scratch)                                    \n"
+    "{                                                                                                                           \n"
+    "    int localIndex = get_local_id(0);                                                                                       \n"
+    "#ifdef USE_SUBGROUPS                                                                                                        \n"
+    "    value = sub_group_reduce_add(value);                                                                                    \n"
+    "    if (get_sub_group_local_id() == 0)                                                                                      \n"
+    "        scratch[get_sub_group_id()] = value;                                                                                \n"
+    "    barrier(CLK_LOCAL_MEM_FENCE);                                                                                           \n"
+    "                                                                                                                            \n"
+    "    if (localIndex == 0)                                                                                                    \n"
+    "    {                                                                                                                       \n"
+    "        for (int subGroup = 1; subGroup < (int)get_num_sub_groups(); subGroup++)                                            \n"
+    "            value += scratch[subGroup];                                                                                     \n"
+    "    }                                                                                                                       \n"
+    "#else                                                                                                                       \n"
+    "    scratch[localIndex] = value;                                                                                            \n"
+    "    barrier(CLK_LOCAL_MEM_FENCE);                                                                                           \n"
+    "                                                                                                                            \n"
+    "    for (int stride = GEMV_GROUP_SIZE / 2; stride > 0; stride >>= 1)                                                        \n"
+    "    {                                                                                                                       \n"
+    "        if (localIndex < stride)                                                                                            \n"
+    "            scratch[localIndex] += scratch[localIndex + stride];                                                            \n"
+    "        barrier(CLK_LOCAL_MEM_FENCE);                                                                                       \n"
+    "    }                                                                                                                       \n"
+    "    value = scratch[0];                                                                                                     \n"
+    "#endif                                                                                                                      \n"
+    "    return (value);                                                                                                         \n"
+    "}                                                                                                                           \n"
+    "                                                                                                                            \n"
+    "// y = A x, A M x N row-major from offsetA with lda elements between rows : one work-group per row, its work-items          \n"
+    "// read the row and x in coalesced strides of GEMV_GROUP_SIZE and add up their partial dot products                         \n"
+    "__kernel __attribute__((reqd_work_group_size(GEMV_GROUP_SIZE, 1, 1)))                                                       \n"
+    "void gemvGPU(int M, int N, __global const ELEMENT_TYPE *A, int offsetA, int lda, __global const ELEMENT_TYPE *x,            \n"
+    "             __global RESULT_TYPE *y)                                                                                       \n"
+    "{                                                                                                                           \n"
+    "    __local ACCUMULATOR_TYPE scratch[GEMV_GROUP_SIZE];                                                                      \n"
+    "                                                                                                                            \n"
+    "    int row = get_group_id(0);                                                                                              \n"
+    "    __global const ELEMENT_TYPE *a = A + offsetA + (size_t)row * lda;                                                       \n"
+    "    ACCUMULATOR_TYPE sum = 0;                                                                                               \n"
+    "                                                                                                                            \n"
+    "    if (row < M)                                                                                                            \n"
+    "    {                                                                                                                       \n"
+    "        for (int column = get_local_id(0); column < N; column += GEMV_GROUP_SIZE)                                           \n"
+    "            sum += (ACCUMULATOR_TYPE)a[column] * x[column];                                                                 \n"
+    "    }                                                                                                                       \n"
+    "    sum = gemvGroupSum(sum, scratch);                                                                                       \n"
+    "                                                                                                                            \n"
+    "    if ((get_local_id(0) == 0) && (row < M))                                                                                \n"
+    "        y[row] = (RESULT_TYPE)sum;                                                                                          \n"
+    "}                                                                                                                           \n"
+    "                                                                                                                            \n"
+    "// y = A^T x, A M x N as above : y[column] sums down a column. Dimension 0 spans GEMV_COLUMNS neighbouring columns so       \n"
+    "// every row is read coalesced, dimension 1 splits the rows into get_num_groups(1) bands of rowsPerBand rows, and           \n"
+    "// inside a band deals them out to GEMV_GROUP_SIZE / GEMV_COLUMNS interleaved slices whose partial sums meet in a           \n"
+    "// local memory tree. With one band the sum goes to y, with more to partial[band * N + column] for                          \n"
+    "// gemvTransposedSumGPU                                                                                                     \n"
+    "__kernel __attribute__((reqd_work_group_size(GEMV_COLUMNS, GEMV_GROUP_SIZE / GEMV_COLUMNS, 1)))                             \n"
+    "void gemvTransposedGPU(int M, int N, __global const ELEMENT_TYPE *A, int offsetA, int lda,                                  \n"
+    "                       __global const ELEMENT_TYPE *x, __global RESULT_TYPE *y, int rowsPerBand,                            \n"
+    "                       __global ACCUMULATOR_TYPE *partial)                                                                  \n"
+    "{                                                                                                                           \n"
+    "    __local ACCUMULATOR_TYPE scratch[GEMV_GROUP_SIZE / GEMV_COLUMNS][GEMV_COLUMNS];                                         \n"
+    "                                                                                                                            \n"
+    "    int localColumn = get_local_id(0);                                                                                      \n"
+    "    int slice = get_local_id(1);                                                                                            \n"
+    "    int column = get_group_id(0) * GEMV_COLUMNS + localColumn;                                                              \n"
+    "    int band = get_group_id(1);                                                                                             \n"
+    "    int rowBegin = band * rowsPerBand;                                                                                      \n"
+    "    int rowEnd = (M - rowBegin < rowsPerBand) ? M : rowBegin + rowsPerBand;                                                 \n"
+    "    ACCUMULATOR_TYPE sum = 0;                                                                                               \n"
+    "                                                                                                                            \n"
+    "    if (column < N)                                                                                                         \n"
+    "    {                                                                                                                       \n"
+    "        for (int row = rowBegin + slice; row < rowEnd; row += GEMV_GROUP_SIZE / GEMV_COLUMNS)                               \n"
+    "            sum += (ACCUMULATOR_TYPE)A[offsetA + (size_t)row * lda + column] * x[row];                                      \n"
+    "    }                                                                                                                       \n"
+    "    scratch[slice][localColumn] = sum;                                                                                      \n"
+    "    barrier(CLK_LOCAL_MEM_FENCE);                                                                                           \n"
+    "                                                                                                                            \n"
+    "    for (int stride = (GEMV_GROUP_SIZE / GEMV_COLUMNS) / 2; stride > 0; stride >>= 1)                                       \n"
+    "    {                                                                                                                       \n"
+    "        if (slice < stride)                                                                                                 \n"
+    "            scratch[slice][localColumn] += scratch[slice + stride][localColumn];                                            \n"
+    "        barrier(CLK_LOCAL_MEM_FENCE);                                                                                       \n"
+    "    }                                                                                                                       \n"
+    "                                                                                                                            \n"
+    "    if ((slice == 0) && (column < N))                                                                                       \n"
+    "    {                                                                                                                       \n"
+    "        if (get_num_groups(1) == 1)                                                                                         \n"
+    "            y[column] = (RESULT_TYPE)scratch[0][localColumn];                                                               \n"
+    "        else                                                                                                                \n"
+    "            partial[(size_t)band * N + column] = scratch[0][localColumn];                                                   \n"
+    "    }                                                                                                                       \n"
+    "}                                                                                                                           \n"
+    "                                                                                                                            \n"
+    "// y[column] = sum of the per-band partial sums of gemvTransposedGPU, added in band order so the result does not            \n"
+    "// depend on scheduling                                                                                                     \n"
+    "__kernel void gemvTransposedSumGPU(int N, int bands, __global const ACCUMULATOR_TYPE *partial, __global RESULT_TYPE *y)     \n"
+    "{                                                                                                                           \n"
+    "    int column = get_global_id(0);                                                                                          \n"
+    "    ACCUMULATOR_TYPE sum = 0;                                                                                               \n"
+    "                                                                                                                            \n"
+    "    if (column < N)                                                                                                         \n"
+    "    {                                                                                                                       \n"
+    "        for (int band = 0; band < bands; band++)                                                                            \n"
+    "            sum += partial[(size_t)band * N + column];                                                                      \n"
+    "        y[column] = (RESULT_TYPE)sum;                                                                                       \n"
+    "    }                                                                                                                       \n"
+    "}                                                                                                                           \n";
+
+// gemvTransposedGPU splits the rows of A into bands until there are about this many work-groups per compute unit
+#define GEMV_GROUPS_PER_COMPUTE_UNIT 4
+
+////////////////////////////////////////////////////////////////////////////////
+//! Most bands enqueueGemv() splits y = A^T x into on device, its partial buffer needs this many times N
+//! elements of the accumulator type
+////////////////////////////////////////////////////////////////////////////////
+inline size_t gemvTransposedMaxBands(cl_device_id device)
+{
+    cl_uint computeUnits = 1;
+
+    clGetDeviceInfo(device, CL_DEVICE_MAX_COMPUTE_UNITS, sizeof(computeUnits), &computeUnits, NULL);
+    return ((size_t)((computeUnits != 0) ? computeUnits : 1) * GEMV_GROUPS_PER_COMPUTE_UNIT);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Enqueue gemvGPU (GEMM_NO_TRANSPOSE, y = A x) or gemvTransposedGPU (GEMM_TRANSPOSE, y = A^T x) of
+//! oclGemvSourceCode, built like gemmGPU, as kernel. A is M x N row-major from offsetA with lda elements between
+//! rows, x holds N (M transposed) elements and y M (N transposed). The transposed product splits the rows into
+//! bands when there are too few columns to fill the device, their sums go to partial (sized with
+//! gemvTransposedMaxBands()) and sumKernel (gemvTransposedSumGPU of the same program) adds them up. Without
+//! sumKernel or partial it runs as one band. CL_INVALID_VALUE for bad arguments or buffers too small for them.
+//! events (may be NULL) receives the product and the band sum (NULL with one band), both are NULL for an empty y
+////////////////////////////////////////////////////////////////////////////////
+inline cl_int enqueueGemv(cl_command_queue queue, cl_kernel kernel, const GemmHostType *type, int transpose, int M, int N, cl_mem A, int offsetA, int lda,
+                          cl_mem x, cl_mem y, cl_kernel sumKernel, cl_mem partial, cl_event events[2])
+{
+    size_t localWorkSize[3];
+    size_t globalWorkSize[2];
+    size_t extentA;
+    cl_int result;
+
+    if (events != NULL)
+    {
+        events[0] = NULL;
+        events[1] = NULL;
+    }
+
+    if (((transpose != GEMM_NO_TRANSPOSE) && (transpose != GEMM_TRANSPOSE)) || (M < 0) || (N < 0))
+        return (CL_INVALID_VALUE);
+    if (gemmMatrixExtent(M, N, offsetA, lda, &extentA) == false)
+        return (CL_INVALID_VALUE);
+
+    int lengthX = (transpose == GEMM_TRANSPOSE) ? M : N;
+    int lengthY = (transpose == GEMM_TRANSPOSE) ? N : M;
+    if (lengthY == 0)
+        return (CL_SUCCESS);
+
+    if ((gemmBufferHolds(A, extentA, type->elementSize) == false) || (gemmBufferHolds(x, (size_t)lengthX, type->elementSize) == false) ||
+        (gemmBufferHolds(y, (size_t)lengthY, type->resultSize) == false))
+        return (CL_INVALID_VALUE);
+
+    // the work-group the program was built with, from reqd_work_group_size
+    cl_device_id device;
+    result = clGetCommandQueueInfo(queue, CL_QUEUE_DEVICE, sizeof(device), &device, NULL);
+    result |= clGetKernelWorkGroupInfo(kernel, device, CL_KERNEL_COMPILE_WORK_GROUP_SIZE, sizeof(localWorkSize), localWorkSize, NULL);
+    if (result != CL_SUCCESS)
+        return (result);
+
+    result = clSetKernelArg(kernel, 0, sizeof(cl_int), (void *)&M);
+    result |= clSetKernelArg(kernel, 1, sizeof(cl_int), (void *)&N);
+    result |= clSetKernelArg(kernel, 2, sizeof(cl_mem), (void *)&A);
+    result |= clSetKernelArg(kernel, 3, sizeof(cl_int), (void *)&offsetA);
+    result |= clSetKernelArg(kernel, 4, sizeof(cl_int), (void *)&lda);
+    result |= clSetKernelArg(kernel, 5, sizeof(cl_mem), (void *)&x);
+    result |= clSetKernelArg(kernel, 6, sizeof(cl_mem), (void *)&y);
+    if (result != CL_SUCCESS)
+        return (result);
+
+    // a work-group per row
+    if (transpose == GEMM_NO_TRANSPOSE)
+    {
+        globalWorkSize[0] = (size_t)M * localWorkSize[0];
+        return (clEnqueueNDRangeKernel(queue, kernel, 1, NULL, globalWorkSize, localWorkSize, 0, NULL, (events != NULL) ? &events[0] : NULL));
+    }
+
+    // GEMV_COLUMNS columns per work-group and as many bands of rows as it takes to give every compute unit
+    // GEMV_GROUPS_PER_COMPUTE_UNIT work-groups, each band at least one row per slice and all within partial
+    size_t columnGroups = ((size_t)N + localWorkSize[0] - 1) / localWorkSize[0];
+    size_t bands = 1;
+    size_t partialSize = 0;
+    if ((sumKernel != NULL) && (partial != NULL) && (clGetMemObjectInfo(partial, CL_MEM_SIZE, sizeof(partialSize), &partialSize, NULL) == CL_SUCCESS))
+    {
+        size_t maxBands = partialSize / ((size_t)N * type->accumulatorSize);
+        size_t rowBands = ((size_t)M + localWorkSize[1] - 1) / localWorkSize[1];
+        bands = (gemvTransposedMaxBands(device) + columnGroups - 1) / columnGroups;
+        if (bands > rowBands)
+            bands = rowBands;
+        if (bands > maxBands)
+            bands = maxBands;
+        if (bands < 1)
+            bands = 1;
+    }
+
+    // whole slices per band, which can leave fewer bands than asked for
+    int rowsPerBand = (int)((((size_t)M + bands - 1) / bands + localWorkSize[1] - 1) / localWorkSize[1] * localWorkSize[1]);
+    if (rowsPerBand < 1)
+        rowsPerBand = 1;
+    bands = ((size_t)M + rowsPerBand - 1) / rowsPerBand;
+    if (bands < 1)
+        bands = 1;
+
+    cl_mem partialArgument = (bands > 1) ? partial : y;
+    result = clSetKernelArg(kernel, 7, sizeof(cl_int), (void *)&rowsPerBand);
+    result |= clSetKernelArg(kernel, 8, sizeof(cl_mem), (void *)&partialArgument);
+    if (result != CL_SUCCESS)
+        return (result);
+
+    globalWorkSize[0] = columnGroups * localWorkSize[0];
+    globalWorkSize[1] = bands * localWorkSize[1];
+    result = clEnqueueNDRangeKernel(queue, kernel, 2, NULL, globalWorkSize, localWorkSize, 0, NULL, (events != NULL) ? &events[0] : NULL);
+    if ((result != CL_SUCCESS) || (bands == 1))
+        return (result);
+
+    cl_int numberOfBands = (cl_int)bands;
+    result = clSetKernelArg(sumKernel, 0, sizeof(cl_int), (void *)&N);
+    result |= clSetKernelArg(sumKernel, 1, sizeof(cl_int), (void *)&numberOfBands);
+    result |= clSetKernelArg(sumKernel, 2, sizeof(cl_mem), (void *)&partial);
+    result |= clSetKernelArg(sumKernel, 3, sizeof(cl_mem), (void *)&y);
+    if (result != CL_SUCCESS)
+        return (result);
+
+    // in-order queue, so the sum starts after the product
+    globalWorkSize[0] = (size_t)N;
+    return (clEnqueueNDRangeKernel(queue, sumKernel, 1, NULL, globalWorkSize, NULL, 0, NULL, (events != NULL) ? &events[1] : NULL));
+}
+
+#endif // HELPER_GEMM_H
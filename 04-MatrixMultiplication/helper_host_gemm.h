@@ -0,0 +1,344 @@
+// helper_host_gemm.h
+// cache-blocked host GEMM in the BLIS / GotoBLAS layout : KC x NC panels of B and MC x KC blocks of A are packed
+// into contiguous micro-panels, and an MR x NR micro-kernel (scalar, AVX2 or AVX-512) keeps its block of C in
+// registers over the whole KC depth. The columns of C are split across the persistent, pinned thread pool of
+// parallelFor(), whose workers keep their packing buffers from one product to the next
+
+#ifndef HELPER_HOST_GEMM_H
+#define HELPER_HOST_GEMM_H
+
+#include <string.h>
+#include <vector>
+
+#include <CL/opencl.h>
+
+#include "helper_parallel.h"
+
+// block sizes : an MC x KC block of A stays in L2, a KC x NR micro-panel of B in L1, a KC x NC panel of B in L3
+#define HOST_GEMM_MR 6
+#define HOST_GEMM_MC 96 // multiple of HOST_GEMM_MR
+#define HOST_GEMM_KC 256
+#define HOST_GEMM_NC 2048 // multiple of every micro-kernel's NR
+#define HOST_GEMM_MAX_NR 32
+
+// sums of int32 wrap around modulo 2^32 without undefined behaviour, which gives the same low 32 bits as the
+// kernels' long accumulator converted to int
+template <typename T>
+struct HostGemmArithmetic
+{
+    typedef T type;
+};
+
+template <>
+struct HostGemmArithmetic<cl_int>
+{
+    typedef cl_uint type;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//! Micro-kernels : the MR x NR product of kc columns of a packed A micro-panel (MR values per depth) and
+//! kc rows of a packed B micro-panel (NR values per depth), written row-major to c[MR][NR]
+////////////////////////////////////////////////////////////////////////////////
+template <typename T, int NR>
+void hostGemmMicroKernelScalar(int kc, const T *a, const T *b, T *c)
+{
+    typedef typename HostGemmArithmetic<T>::type U;
+    U accumulators[HOST_GEMM_MR][NR] = {};
+
+    for (int depth = 0; depth < kc; depth++)
+    {
+        for (int row = 0; row < HOST_GEMM_MR; row++)
+        {
+            for (int column = 0; column < NR; column++)
+                accumulators[row][column] += (U)a[row] * (U)b[column];
+        }
+        a += HOST_GEMM_MR;
+        b += NR;
+    }
+
+    for (int row = 0; row < HOST_GEMM_MR; row++)
+    {
+        for (int column = 0; column < NR; column++)
+            c[row * NR + column] = (T)accumulators[row][column];
+    }
+}
+
+#if defined(HELPER_PARALLEL_X86)
+// 6 x 16 : 12 accumulators of 8 lanes, two loads of B and six broadcasts of A per depth
+TARGET_AVX2 inline void hostGemmMicroKernelAVX2(int kc, const float *a, const float *b, float *c)
+{
+    __m256 accumulators[HOST_GEMM_MR][2];
+
+    for (int row = 0; row < HOST_GEMM_MR; row++)
+        accumulators[row][0] = accumulators[row][1] = _mm256_setzero_ps();
+
+    for (int depth = 0; depth < kc; depth++)
+    {
+        __m256 b0 = _mm256_loadu_ps(b);
+        __m256 b1 = _mm256_loadu_ps(b + 8);
+        for (int row = 0; row < HOST_GEMM_MR; row++)
+        {
+            __m256 aValue = _mm256_broadcast_ss(a + row);
+            accumulators[row][0] = _mm256_fmadd_ps(aValue, b0, accumulators[row][0]);
+            accumulators[row][1] = _mm256_fmadd_ps(aValue, b1, accumulators[row][1]);
+        }
+        a += HOST_GEMM_MR;
+        b += 16;
+    }
+
+    for (int row = 0; row < HOST_GEMM_MR; row++)
+    {
+        _mm256_storeu_ps(c + row * 16, accumulators[row][0]);
+        _mm256_storeu_ps(c + row * 16 + 8, accumulators[row][1]);
+    }
+}
+
+TARGET_AVX2 inline void hostGemmMicroKernelAVX2(int kc, const cl_int *a, const cl_int *b, cl_int *c)
+{
+    __m256i accumulators[HOST_GEMM_MR][2];
+
+    for (int row = 0; row < HOST_GEMM_MR; row++)
+        accumulators[row][0] = accumulators[row][1] = _mm256_setzero_si256();
+
+    for (int depth = 0; depth < kc; depth++)
+    {
+        __m256i b0 = _mm256_loadu_si256((const __m256i *)b);
+        __m256i b1 = _mm256_loadu_si256((const __m256i *)(b + 8));
+        for (int row = 0; row < HOST_GEMM_MR; row++)
+        {
+            __m256i aValue = _mm256_set1_epi32(a[row]);
+            accumulators[row][0] = _mm256_add_epi32(accumulators[row][0], _mm256_mullo_epi32(aValue, b0));
+            accumulators[row][1] = _mm256_add_epi32(accumulators[row][1], _mm256_mullo_epi32(aValue, b1));
+        }
+        a += HOST_GEMM_MR;
+        b += 16;
+    }
+
+    for (int row = 0; row < HOST_GEMM_MR; row++)
+    {
+        _mm256_storeu_si256((__m256i *)(c + row * 16), accumulators[row][0]);
+        _mm256_storeu_si256((__m256i *)(c + row * 16 + 8), accumulators[row][1]);
+    }
+}
+
+// 6 x 32 : the same shape with 16 lane registers
+TARGET_AVX512 inline void hostGemmMicroKernelAVX512(int kc, const float *a, const float *b, float *c)
+{
+    __m512 accumulators[HOST_GEMM_MR][2];
+
+    for (int row = 0; row < HOST_GEMM_MR; row++)
+        accumulators[row][0] = accumulators[row][1] = _mm512_setzero_ps();
+
+    for (int depth = 0; depth < kc; depth++)
+    {
+        __m512 b0 = _mm512_loadu_ps(b);
+        __m512 b1 = _mm512_loadu_ps(b + 16);
+        for (int row = 0; row < HOST_GEMM_MR; row++)
+        {
+            __m512 aValue = _mm512_set1_ps(a[row]);
+            accumulators[row][0] = _mm512_fmadd_ps(aValue, b0, accumulators[row][0]);
+            accumulators[row][1] = _mm512_fmadd_ps(aValue, b1, accumulators[row][1]);
+        }
+        a += HOST_GEMM_MR;
+        b += 32;
+    }
+
+    for (int row = 0; row < HOST_GEMM_MR; row++)
+    {
+        _mm512_storeu_ps(c + row * 32, accumulators[row][0]);
+        _mm512_storeu_ps(c + row * 32 + 16, accumulators[row][1]);
+    }
+}
+
+TARGET_AVX512 inline void hostGemmMicroKernelAVX512(int kc, const cl_int *a, const cl_int *b, cl_int *c)
+{
+    __m512i accumulators[HOST_GEMM_MR][2];
+
+    for (int row = 0; row < HOST_GEMM_MR; row++)
+        accumulators[row][0] = accumulators[row][1] = _mm512_setzero_si512();
+
+    for (int depth = 0; depth < kc; depth++)
+    {
+        __m512i b0 = _mm512_loadu_si512((const void *)b);
+        __m512i b1 = _mm512_loadu_si512((const void *)(b + 16));
+        for (int row = 0; row < HOST_GEMM_MR; row++)
+        {
+            __m512i aValue = _mm512_set1_epi32(a[row]);
+            accumulators[row][0] = _mm512_add_epi32(accumulators[row][0], _mm512_mullo_epi32(aValue, b0));
+            accumulators[row][1] = _mm512_add_epi32(accumulators[row][1], _mm512_mullo_epi32(aValue, b1));
+        }
+        a += HOST_GEMM_MR;
+        b += 32;
+    }
+
+    for (int row = 0; row < HOST_GEMM_MR; row++)
+    {
+        _mm512_storeu_si512((void *)(c + row * 32), accumulators[row][0]);
+        _mm512_storeu_si512((void *)(c + row * 32 + 16), accumulators[row][1]);
+    }
+}
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+//! Pack rows [row, row + mc) x depths [depth, depth + kc) of A (lda) into MR row micro-panels, MR values
+//! per depth, the rows past mc padded with 0
+////////////////////////////////////////////////////////////////////////////////
+template <typename T>
+void hostGemmPackA(const T *A, int lda, int row, int depth, int mc, int kc, T *packed)
+{
+    for (int panel = 0; panel < mc; panel += HOST_GEMM_MR)
+    {
+        for (int k = 0; k < kc; k++)
+        {
+            for (int r = 0; r < HOST_GEMM_MR; r++)
+                *packed++ = (panel + r < mc) ? A[(size_t)(row + panel + r) * lda + depth + k] : (T)0;
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Pack depths [depth, depth + kc) x columns [column, column + nc) of B (ldb) into nr column micro-panels,
+//! nr values per depth, the columns past nc padded with 0
+////////////////////////////////////////////////////////////////////////////////
+template <typename T>
+void hostGemmPackB(const T *B, int ldb, int depth, int column, int kc, int nc, int nr, T *packed)
+{
+    for (int panel = 0; panel < nc; panel += nr)
+    {
+        int width = (nc - panel < nr) ? nc - panel : nr;
+        for (int k = 0; k < kc; k++)
+        {
+            const T *source = B + (size_t)(depth + k) * ldb + column + panel;
+            memcpy(packed, source, width * sizeof(T));
+            for (int c = width; c < nr; c++)
+                packed[c] = (T)0;
+            packed += nr;
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! C (M x N, ldc) = A (M x K, lda = K) x B (K x N, ldb = N) of float or int32, with the micro-kernel of
+//! simdLevel on numberOfThreads threads. Each thread owns a range of columns of C (multiples of NR) and
+//! packs its own panels, so the threads never synchronize
+////////////////////////////////////////////////////////////////////////////////
+template <typename T>
+void hostGemmBlocked(const T *A, const T *B, T *C, int M, int K, int N, int ldc, int simdLevel, unsigned int numberOfThreads)
+{
+    typedef typename HostGemmArithmetic<T>::type U;
+    void (*microKernel)(int, const T *, const T *, T *) = hostGemmMicroKernelScalar<T, 8>;
+    int nr = 8;
+
+#if defined(HELPER_PARALLEL_X86)
+    if (simdLevel == CPU_SIMD_AVX512)
+    {
+        microKernel = hostGemmMicroKernelAVX512;
+        nr = 32;
+    }
+    else if (simdLevel == CPU_SIMD_AVX2)
+    {
+        microKernel = hostGemmMicroKernelAVX2;
+        nr = 16;
+    }
+#else
+    (void)simdLevel;
+#endif
+
+    if ((M <= 0) || (N <= 0))
+        return;
+    if (K <= 0)
+    {
+        for (int row = 0; row < M; row++)
+            memset(C + (size_t)row * ldc, 0, N * sizeof(T));
+        return;
+    }
+
+    parallelFor((size_t)N, (size_t)nr, numberOfThreads, [=](size_t columnBegin, size_t columnEnd, unsigned int) {
+        // allocated once per thread, the ranges of a loop never share a thread at the same time
+        static thread_local std::vector<T> packedA;
+        static thread_local std::vector<T> packedB;
+        packedA.resize((size_t)HOST_GEMM_MC * HOST_GEMM_KC);
+        packedB.resize((size_t)HOST_GEMM_KC * HOST_GEMM_NC);
+        T block[HOST_GEMM_MR * HOST_GEMM_MAX_NR];
+
+        for (int jc = (int)columnBegin; jc < (int)columnEnd; jc += HOST_GEMM_NC)
+        {
+            int nc = ((int)columnEnd - jc < HOST_GEMM_NC) ? (int)columnEnd - jc : HOST_GEMM_NC;
+
+            for (int pc = 0; pc < K; pc += HOST_GEMM_KC)
+            {
+                int kc = (K - pc < HOST_GEMM_KC) ? K - pc : HOST_GEMM_KC;
+                hostGemmPackB(B, N, pc, jc, kc, nc, nr, packedB.data());
+
+                for (int ic = 0; ic < M; ic += HOST_GEMM_MC)
+                {
+                    int mc = (M - ic < HOST_GEMM_MC) ? M - ic : HOST_GEMM_MC;
+                    hostGemmPackA(A, K, ic, pc, mc, kc, packedA.data());
+
+                    for (int jr = 0; jr < nc; jr += nr)
+                    {
+                        int columns = (nc - jr < nr) ? nc - jr : nr;
+                        for (int ir = 0; ir < mc; ir += HOST_GEMM_MR)
+                        {
+                            int rows = (mc - ir < HOST_GEMM_MR) ? mc - ir : HOST_GEMM_MR;
+                            microKernel(kc, packedA.data() + (size_t)ir * kc, packedB.data() + (size_t)jr * kc, block);
+
+                            // the first depth block stores, the next ones add to C
+                            for (int r = 0; r < rows; r++)
+                            {
+                                T *c = C + (size_t)(ic + ir + r) * ldc + jc + jr;
+                                const T *source = block + r * nr;
+                                if (pc == 0)
+                                    memcpy(c, source, columns * sizeof(T));
+                                else
+                                {
+                                    for (int column = 0; column < columns; column++)
+                                        c[column] = (T)((U)c[column] + (U)source[column]);
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    });
+}
+
+// the blocked product for the element (T), result (R) and accumulator (ACC) types of a kernel, NULL where the
+// host has none : float, and int32 whose int result is the low 32 bits of the long sum
+typedef void (*HostGemmBlockedFunction)(const void *A, const void *B, void *C, int M, int K, int N, int ldc, int simdLevel, unsigned int numberOfThreads);
+
+template <typename T>
+void hostGemmBlockedUntyped(const void *A, const void *B, void *C, int M, int K, int N, int ldc, int simdLevel, unsigned int numberOfThreads)
+{
+    hostGemmBlocked((const T *)A, (const T *)B, (T *)C, M, K, N, ldc, simdLevel, numberOfThreads);
+}
+
+template <typename T, typename R, typename ACC>
+struct HostGemmBlocked
+{
+    static HostGemmBlockedFunction function(void)
+    {
+        return (NULL);
+    }
+};
+
+template <>
+struct HostGemmBlocked<cl_float, cl_float, cl_float>
+{
+    static HostGemmBlockedFunction function(void)
+    {
+        return (hostGemmBlockedUntyped<cl_float>);
+    }
+};
+
+template <>
+struct HostGemmBlocked<cl_int, cl_int, cl_long>
+{
+    static HostGemmBlockedFunction function(void)
+    {
+        return (hostGemmBlockedUntyped<cl_int>);
+    }
+};
+
+#endif // HELPER_HOST_GEMM_H
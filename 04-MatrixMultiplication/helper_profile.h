@@ -0,0 +1,225 @@
+// helper_profile.h
+// device side timing of every enqueued command through OpenCL events, the command queues
+// have to be created with CL_QUEUE_PROFILING_ENABLE
+
+#ifndef HELPER_PROFILE_H
+#define HELPER_PROFILE_H
+
+#include <stdio.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include <CL/opencl.h>
+
+#define PROFILE_MAX_EVENTS 1024 // commands beyond this are enqueued without an event and only counted
+#define PROFILE_NAME_LENGTH 48
+
+// phases of the breakdown
+#define PROFILE_PHASE_H2D 0    // host to device writes
+#define PROFILE_PHASE_KERNEL 1 // kernels
+#define PROFILE_PHASE_D2H 2    // device to host reads
+#define PROFILE_PHASE_MAP 3    // map / unmap hand-overs of zero-copy buffers
+#define PROFILE_PHASES 4
+
+static const char *const profilePhaseNames[PROFILE_PHASES] = {"H2D", "Kernel", "D2H", "Map"};
+
+typedef struct ProfileLog
+{
+    size_t numberOfEvents;
+    size_t numberOfDroppedEvents;
+    cl_event events[PROFILE_MAX_EVENTS];
+    int phases[PROFILE_MAX_EVENTS];
+    cl_ulong hostTimes[PROFILE_MAX_EVENTS]; // profileHostTime() just before the enqueue
+    char names[PROFILE_MAX_EVENTS][PROFILE_NAME_LENGTH];
+} ProfileLog;
+
+// CL_PROFILING_COMMAND_QUEUED / SUBMIT / START / END of one command (ns)
+typedef struct ProfileTimestamps
+{
+    cl_ulong queued;
+    cl_ulong submit;
+    cl_ulong start;
+    cl_ulong end;
+} ProfileTimestamps;
+
+////////////////////////////////////////////////////////////////////////////////
+//! Monotonic host clock (ns), device timestamps use their own clock
+////////////////////////////////////////////////////////////////////////////////
+inline cl_ulong profileHostTime(void)
+{
+    return ((cl_ulong)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Next event slot of the log, passed as the event argument of a clEnqueue*() call,
+//! NULL once the log is full
+////////////////////////////////////////////////////////////////////////////////
+inline cl_event *profileEvent(ProfileLog *log, const char *name, int phase)
+{
+    if (log->numberOfEvents == PROFILE_MAX_EVENTS)
+    {
+        log->numberOfDroppedEvents++;
+        return (NULL);
+    }
+
+    size_t index = log->numberOfEvents++;
+    log->events[index] = NULL;
+    log->phases[index] = phase;
+    log->hostTimes[index] = profileHostTime();
+    snprintf(log->names[index], PROFILE_NAME_LENGTH, "%s", name);
+    return (&log->events[index]);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Add an event the caller keeps (e.g. for dependencies), the log holds its own reference
+////////////////////////////////////////////////////////////////////////////////
+inline void profileRetainEvent(ProfileLog *log, const char *name, int phase, cl_event event)
+{
+    cl_event *slot = profileEvent(log, name, phase);
+    if (slot != NULL)
+    {
+        clRetainEvent(event);
+        *slot = event;
+    }
+}
+
+inline cl_int profileTimestamps(cl_event event, ProfileTimestamps *timestamps)
+{
+    cl_int result;
+
+    result = clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_QUEUED, sizeof(cl_ulong), &timestamps->queued, NULL);
+    result |= clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_SUBMIT, sizeof(cl_ulong), &timestamps->submit, NULL);
+    result |= clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_START, sizeof(cl_ulong), &timestamps->start, NULL);
+    result |= clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_END, sizeof(cl_ulong), &timestamps->end, NULL);
+    return (result);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! START to END of a completed command (ms), 0 if it was not profiled
+////////////////////////////////////////////////////////////////////////////////
+inline float profileEventTime(cl_event event)
+{
+    ProfileTimestamps timestamps;
+
+    if (event == NULL || profileTimestamps(event, &timestamps) != CL_SUCCESS)
+        return (0.0f);
+    return ((float)((double)(timestamps.end - timestamps.start) * 1.0e-6));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Print the timestamps of every command relative to the first QUEUED, then the breakdown :
+//! busy time per phase, queueing delay (QUEUED -> START) and host gaps (the device idle between
+//! the first START and the last END, waiting for the host to enqueue or release work),
+//! the queues must be finished
+////////////////////////////////////////////////////////////////////////////////
+inline void printProfileLog(const ProfileLog *log)
+{
+    std::vector<ProfileTimestamps> timestamps;
+    std::vector<size_t> profiled;
+    cl_ulong origin = 0;
+
+    for (size_t index = 0; index < log->numberOfEvents; index++)
+    {
+        ProfileTimestamps current;
+        if (log->events[index] == NULL || profileTimestamps(log->events[index], &current) != CL_SUCCESS)
+            continue;
+
+        if (profiled.empty() || current.queued < origin)
+            origin = current.queued;
+        timestamps.push_back(current);
+        profiled.push_back(index);
+    }
+
+    if (profiled.empty())
+    {
+        printf("- Device Profile : No Profiled Commands (Queues Need CL_QUEUE_PROFILING_ENABLE)\n");
+        return;
+    }
+
+    printf("- Device Profile Of %zu Commands (ms From The First QUEUED) :\n", profiled.size());
+    printf("  %-32s %-6s %11s %11s %11s %11s %11s %11s\n", "Command", "Phase", "Queued", "Submit", "Start", "End", "Duration", "Queue Delay");
+    for (size_t command = 0; command < profiled.size(); command++)
+    {
+        const ProfileTimestamps *current = &timestamps[command];
+        printf("  %-32s %-6s %11.4f %11.4f %11.4f %11.4f %11.4f %11.4f\n", log->names[profiled[command]], profilePhaseNames[log->phases[profiled[command]]],
+               (double)(current->queued - origin) * 1.0e-6, (double)(current->submit - origin) * 1.0e-6,
+               (double)(current->start - origin) * 1.0e-6, (double)(current->end - origin) * 1.0e-6,
+               (double)(current->end - current->start) * 1.0e-6, (double)(current->start - current->queued) * 1.0e-6);
+    }
+
+    // busy time per phase, commands of different queues may overlap
+    double phaseTime[PROFILE_PHASES] = {0.0};
+    size_t phaseCommands[PROFILE_PHASES] = {0};
+    double queueingDelay = 0.0;
+    double maxQueueingDelay = 0.0;
+    for (size_t command = 0; command < profiled.size(); command++)
+    {
+        const ProfileTimestamps *current = &timestamps[command];
+        int phase = log->phases[profiled[command]];
+        double delay = (double)(current->start - current->queued) * 1.0e-6;
+
+        phaseTime[phase] += (double)(current->end - current->start) * 1.0e-6;
+        phaseCommands[phase]++;
+        queueingDelay += delay;
+        if (delay > maxQueueingDelay)
+            maxQueueingDelay = delay;
+    }
+
+    // walk the commands in START order, whatever is not covered by a running command is a host gap
+    std::vector<size_t> order(profiled.size());
+    for (size_t command = 0; command < order.size(); command++)
+        order[command] = command;
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return (timestamps[a].start < timestamps[b].start); });
+
+    cl_ulong firstStart = timestamps[order[0]].start;
+    cl_ulong busyUntil = timestamps[order[0]].end;
+    cl_ulong hostGap = 0;
+    size_t numberOfHostGaps = 0;
+    for (size_t command = 1; command < order.size(); command++)
+    {
+        const ProfileTimestamps *current = &timestamps[order[command]];
+        if (current->start > busyUntil)
+        {
+            hostGap += current->start - busyUntil;
+            numberOfHostGaps++;
+        }
+        if (current->end > busyUntil)
+            busyUntil = current->end;
+    }
+
+    double span = (double)(busyUntil - origin) * 1.0e-6;
+    double deviceSpan = (double)(busyUntil - firstStart) * 1.0e-6;
+    printf("- Device Profile Breakdown (Span From First QUEUED To Last END = %0.4f (ms)) :\n", span);
+    for (int phase = 0; phase < PROFILE_PHASES; phase++)
+    {
+        if (phaseCommands[phase] == 0)
+            continue;
+        printf("  %-6s : %0.4f (ms) In %zu Commands, %0.1f%% Of The Span\n", profilePhaseNames[phase], phaseTime[phase], phaseCommands[phase], 100.0 * phaseTime[phase] / span);
+    }
+    printf("  Queueing Delay (QUEUED -> START) : %0.4f (ms) In Total, %0.4f (ms) Max, %0.4f (ms) Before The First Command Started\n",
+           queueingDelay, maxQueueingDelay, (double)(firstStart - origin) * 1.0e-6);
+    printf("  Host Gap (Device Idle Between Commands) : %0.4f (ms) In %zu Gaps, %0.1f%% Of The Device Span Of %0.4f (ms)\n",
+           (double)hostGap * 1.0e-6, numberOfHostGaps, (deviceSpan > 0.0) ? 100.0 * (double)hostGap * 1.0e-6 / deviceSpan : 0.0, deviceSpan);
+    if (log->numberOfDroppedEvents)
+        printf("  %zu Further Commands Were Not Profiled (Log Holds %d)\n", log->numberOfDroppedEvents, PROFILE_MAX_EVENTS);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Release the events of the log and empty it
+////////////////////////////////////////////////////////////////////////////////
+inline void releaseProfileLog(ProfileLog *log)
+{
+    for (size_t index = 0; index < log->numberOfEvents; index++)
+    {
+        if (log->events[index])
+        {
+            clReleaseEvent(log->events[index]);
+            log->events[index] = NULL;
+        }
+    }
+    log->numberOfEvents = 0;
+    log->numberOfDroppedEvents = 0;
+}
+
+#endif // HELPER_PROFILE_H
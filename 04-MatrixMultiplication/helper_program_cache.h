@@ -0,0 +1,236 @@
+// helper_program_cache.h
+// on-disk cache of built program binaries (C and C++) : a program is loaded with
+// clCreateProgramWithBinary() when an earlier run built the same source with the same options for the
+// same device and driver, and built from source (refreshing the cache) when there is no usable binary
+
+#ifndef HELPER_PROGRAM_CACHE_H
+#define HELPER_PROGRAM_CACHE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <CL/opencl.h>
+
+#if defined(WIN32) || defined(_WIN32) || defined(WIN64) || defined(_WIN64)
+#include <windows.h>
+#include <direct.h>  // _mkdir()
+#include <process.h> // _getpid()
+#define programCacheMakeDirectory(path) _mkdir(path)
+#define programCacheProcessID() ((unsigned long)_getpid())
+#else
+#include <sys/stat.h> // mkdir()
+#include <unistd.h>   // getpid()
+#define programCacheMakeDirectory(path) mkdir(path, 0755)
+#define programCacheProcessID() ((unsigned long)getpid())
+#endif
+
+#if defined(__cplusplus)
+#define PROGRAM_CACHE_INLINE inline
+#else
+#define PROGRAM_CACHE_INLINE static __inline
+#endif
+
+#define PROGRAM_CACHE_DIRECTORY "oclProgramCache" // OCL_PROGRAM_CACHE_DIR overrides it, an empty value turns the cache off
+#define PROGRAM_CACHE_MAGIC "OCLPBIN1"
+#define PROGRAM_CACHE_KEY_LENGTH 1024
+#define PROGRAM_CACHE_PATH_LENGTH 1024
+
+////////////////////////////////////////////////////////////////////////////////
+//! 64-bit FNV-1a over length bytes, chained through hash
+////////////////////////////////////////////////////////////////////////////////
+PROGRAM_CACHE_INLINE cl_ulong programCacheHash(const void *data, size_t length, cl_ulong hash)
+{
+    const unsigned char *bytes = (const unsigned char *)data;
+    size_t index;
+
+    for (index = 0; index < length; index++)
+    {
+        hash ^= bytes[index];
+        hash *= 0x100000001B3ull;
+    }
+    return (hash);
+}
+
+PROGRAM_CACHE_INLINE const char *programCacheDirectory(void)
+{
+    const char *directory = getenv("OCL_PROGRAM_CACHE_DIR");
+    return ((directory != NULL) ? directory : PROGRAM_CACHE_DIRECTORY);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Key (device name, driver version, build options, source hash) and the file it is cached in,
+//! the key is stored in the file too, so a hash collision reads as a stale entry
+////////////////////////////////////////////////////////////////////////////////
+PROGRAM_CACHE_INLINE void programCacheKey(cl_device_id device, const char *source, const char *options, char *key, char *path)
+{
+    char deviceName[256] = "";
+    char driverVersion[128] = "";
+    cl_ulong sourceHash;
+    cl_ulong keyHash;
+
+    clGetDeviceInfo(device, CL_DEVICE_NAME, sizeof(deviceName) - 1, deviceName, NULL);
+    clGetDeviceInfo(device, CL_DRIVER_VERSION, sizeof(driverVersion) - 1, driverVersion, NULL);
+
+    sourceHash = programCacheHash(source, strlen(source), 0xCBF29CE484222325ull);
+    snprintf(key, PROGRAM_CACHE_KEY_LENGTH, "%s\n%s\n%s\n%016llx", deviceName, driverVersion, (options != NULL) ? options : "", (unsigned long long)sourceHash);
+
+    keyHash = programCacheHash(key, strlen(key), 0xCBF29CE484222325ull);
+    snprintf(path, PROGRAM_CACHE_PATH_LENGTH, "%s/%016llx.bin", programCacheDirectory(), (unsigned long long)keyHash);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Binary cached under key, NULL if there is none (the caller frees it)
+////////////////////////////////////////////////////////////////////////////////
+PROGRAM_CACHE_INLINE unsigned char *programCacheRead(const char *path, const char *key, size_t *pBinarySize)
+{
+    FILE *file = fopen(path, "rb");
+    char magic[sizeof(PROGRAM_CACHE_MAGIC)] = "";
+    char storedKey[PROGRAM_CACHE_KEY_LENGTH];
+    cl_ulong keyLength = 0;
+    cl_ulong binarySize = 0;
+    unsigned char *binary = NULL;
+
+    if (file == NULL)
+        return (NULL);
+
+    if ((fread(magic, 1, sizeof(magic) - 1, file) == sizeof(magic) - 1) && (memcmp(magic, PROGRAM_CACHE_MAGIC, sizeof(magic) - 1) == 0) &&
+        (fread(&keyLength, sizeof(keyLength), 1, file) == 1) && (keyLength < sizeof(storedKey)) &&
+        (fread(storedKey, 1, (size_t)keyLength, file) == (size_t)keyLength))
+    {
+        storedKey[keyLength] = '\0';
+        if ((strcmp(storedKey, key) == 0) && (fread(&binarySize, sizeof(binarySize), 1, file) == 1) && (binarySize != 0))
+        {
+            binary = (unsigned char *)malloc((size_t)binarySize);
+            if ((binary != NULL) && (fread(binary, 1, (size_t)binarySize, file) != (size_t)binarySize))
+            {
+                free(binary);
+                binary = NULL;
+            }
+        }
+    }
+
+    fclose(file);
+    *pBinarySize = (size_t)binarySize;
+    return (binary);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Store the binary of a built program : written to a file of its own, then renamed over the entry,
+//! so concurrent runs never see a partial file and the last writer wins
+////////////////////////////////////////////////////////////////////////////////
+PROGRAM_CACHE_INLINE void programCacheWrite(cl_program program, const char *path, const char *key)
+{
+    static unsigned int numberOfWrites = 0;
+    char temporaryPath[PROGRAM_CACHE_PATH_LENGTH + 64];
+    size_t binarySize = 0;
+    unsigned char *binary = NULL;
+    cl_ulong keyLength = (cl_ulong)strlen(key);
+    cl_ulong storedSize;
+    FILE *file;
+    int bWritten;
+
+    // single device programs, so one binary
+    if ((clGetProgramInfo(program, CL_PROGRAM_BINARY_SIZES, sizeof(binarySize), &binarySize, NULL) != CL_SUCCESS) || (binarySize == 0))
+        return;
+
+    binary = (unsigned char *)malloc(binarySize);
+    if (binary == NULL)
+        return;
+
+    if (clGetProgramInfo(program, CL_PROGRAM_BINARIES, sizeof(binary), &binary, NULL) != CL_SUCCESS)
+    {
+        free(binary);
+        return;
+    }
+
+    programCacheMakeDirectory(programCacheDirectory());
+    snprintf(temporaryPath, sizeof(temporaryPath), "%s.%lu.%u.tmp", path, programCacheProcessID(), numberOfWrites++);
+
+    file = fopen(temporaryPath, "wb");
+    if (file == NULL)
+    {
+        free(binary);
+        return;
+    }
+
+    storedSize = (cl_ulong)binarySize;
+    bWritten = (fwrite(PROGRAM_CACHE_MAGIC, 1, sizeof(PROGRAM_CACHE_MAGIC) - 1, file) == sizeof(PROGRAM_CACHE_MAGIC) - 1) &&
+               (fwrite(&keyLength, sizeof(keyLength), 1, file) == 1) && (fwrite(key, 1, (size_t)keyLength, file) == (size_t)keyLength) &&
+               (fwrite(&storedSize, sizeof(storedSize), 1, file) == 1) && (fwrite(binary, 1, binarySize, file) == binarySize);
+    bWritten = (fclose(file) == 0) && bWritten;
+    free(binary);
+
+#if defined(WIN32) || defined(_WIN32) || defined(WIN64) || defined(_WIN64)
+    if (!bWritten || !MoveFileExA(temporaryPath, path, MOVEFILE_REPLACE_EXISTING))
+        remove(temporaryPath);
+#else
+    if (!bWritten || (rename(temporaryPath, path) != 0))
+        remove(temporaryPath);
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Create and build a program for one device, from the cached binary when there is a usable one.
+//! *pResult is the error of the create or build call, on a build error the program is returned
+//! for the build log. *pFromCache (may be NULL) tells whether the binary was used
+////////////////////////////////////////////////////////////////////////////////
+PROGRAM_CACHE_INLINE cl_program buildProgramWithCache(cl_context context, cl_device_id device, const char *source, const char *options, cl_int *pResult,
+                                                      cl_bool *pFromCache)
+{
+    char key[PROGRAM_CACHE_KEY_LENGTH];
+    char path[PROGRAM_CACHE_PATH_LENGTH];
+    cl_program program = NULL;
+    cl_bool bCacheEnabled = (programCacheDirectory()[0] != '\0') ? CL_TRUE : CL_FALSE;
+    cl_int result;
+
+    if (pFromCache != NULL)
+        *pFromCache = CL_FALSE;
+
+    if (bCacheEnabled == CL_TRUE)
+    {
+        size_t binarySize = 0;
+        unsigned char *binary;
+
+        programCacheKey(device, source, options, key, path);
+        binary = programCacheRead(path, key, &binarySize);
+        if (binary != NULL)
+        {
+            cl_int binaryStatus = CL_INVALID_BINARY;
+
+            program = clCreateProgramWithBinary(context, 1, &device, &binarySize, (const unsigned char **)&binary, &binaryStatus, &result);
+            free(binary);
+
+            // a rejected or stale binary falls back to the source below
+            if ((program != NULL) && ((result != CL_SUCCESS) || (binaryStatus != CL_SUCCESS) || (clBuildProgram(program, 1, &device, options, NULL, NULL) != CL_SUCCESS)))
+            {
+                clReleaseProgram(program);
+                program = NULL;
+            }
+
+            if (program != NULL)
+            {
+                if (pFromCache != NULL)
+                    *pFromCache = CL_TRUE;
+                *pResult = CL_SUCCESS;
+                return (program);
+            }
+        }
+    }
+
+    program = clCreateProgramWithSource(context, 1, &source, NULL, &result);
+    if (result != CL_SUCCESS)
+    {
+        *pResult = result;
+        return (NULL);
+    }
+
+    result = clBuildProgram(program, 1, &device, options, NULL, NULL);
+    if ((result == CL_SUCCESS) && (bCacheEnabled == CL_TRUE))
+        programCacheWrite(program, path, key);
+
+    *pResult = result;
+    return (program);
+}
+
+#endif // HELPER_PROGRAM_CACHE_H
@@ -0,0 +1,472 @@
+// helper_sparse.h
+// host side of the sparse kernels : CSR matrices with a power-law generator and the reference products, the
+// converters to ELL and SELL-C-sigma, and oclSparseSourceCode with the SpMV (CSR scalar, vector and merge-path,
+// ELL, SELL) and SpMM (CSR, SELL) kernels. Values and vectors are small integers, so every sum is exact in float
+// and every kernel must match the reference exactly whatever order it adds in
+
+#ifndef HELPER_SPARSE_H
+#define HELPER_SPARSE_H
+
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+#include <CL/opencl.h>
+
+typedef struct CsrMatrix
+{
+    int numberOfRows;
+    int numberOfColumns;
+    std::vector<int> rowOffsets; // numberOfRows + 1, row r is [rowOffsets[r], rowOffsets[r + 1])
+    std::vector<int> columns;    // ascending within a row
+    std::vector<float> values;
+} CsrMatrix;
+
+typedef struct EllMatrix
+{
+    int numberOfRows;
+    int width;                // longest row, every row padded to it
+    std::vector<int> columns; // column-major : entry k of row r at k * numberOfRows + r, padding is column 0
+    std::vector<float> values;
+} EllMatrix;
+
+typedef struct SellMatrix
+{
+    int numberOfRows;
+    int sliceHeight;             // C
+    int sigma;                   // rows sorted by length within windows of sigma rows
+    int numberOfPositions;       // numberOfRows rounded up to slices
+    std::vector<int> sliceOffsets;   // numberOfSlices + 1, slice s is column-major from sliceOffsets[s]
+    std::vector<int> rowPermutation; // row of every sorted position, -1 past the last row
+    std::vector<int> columns;
+    std::vector<float> values;
+} SellMatrix;
+
+////////////////////////////////////////////////////////////////////////////////
+//! xorshift64*, the generator of sparsePowerLaw()
+////////////////////////////////////////////////////////////////////////////////
+inline unsigned int sparseRandom(unsigned long long *state)
+{
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return ((unsigned int)((*state * 2685821657736338717ull) >> 32));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! numberOfRows x numberOfColumns CSR matrix with power-law row lengths : Pareto (alpha 1.5) lengths with a mean of
+//! about averagePerRow, so most rows are short and a few reach numberOfColumns. Random distinct columns, values 1 to 4
+////////////////////////////////////////////////////////////////////////////////
+inline void sparsePowerLaw(CsrMatrix *matrix, int numberOfRows, int numberOfColumns, int averagePerRow, unsigned long long seed)
+{
+    const double alpha = 1.5;
+    const double minimumLength = averagePerRow * (alpha - 1.0) / alpha;
+    unsigned long long state = (seed != 0) ? seed : 1;
+    std::vector<int> row;
+
+    matrix->numberOfRows = numberOfRows;
+    matrix->numberOfColumns = numberOfColumns;
+    matrix->rowOffsets.assign(1, 0);
+    matrix->columns.clear();
+    matrix->values.clear();
+
+    for (int rowIndex = 0; rowIndex < numberOfRows; rowIndex++)
+    {
+        double uniform = (sparseRandom(&state) + 1.0) / 4294967296.0;
+        double length = minimumLength / pow(uniform, 1.0 / alpha);
+        int numberOfEntries = (length >= numberOfColumns) ? numberOfColumns : (int)length;
+        if (numberOfEntries < 1)
+            numberOfEntries = 1;
+
+        // a dense enough row takes every column, others draw distinct ones
+        row.clear();
+        if (numberOfEntries * 2 > numberOfColumns)
+        {
+            for (int column = 0; column < numberOfColumns; column++)
+                if ((int)(sparseRandom(&state) % numberOfColumns) < numberOfEntries)
+                    row.push_back(column);
+        }
+        else
+        {
+            for (int entry = 0; entry < numberOfEntries; entry++)
+                row.push_back((int)(sparseRandom(&state) % numberOfColumns));
+            std::sort(row.begin(), row.end());
+            row.erase(std::unique(row.begin(), row.end()), row.end());
+        }
+
+        for (size_t entry = 0; entry < row.size(); entry++)
+        {
+            matrix->columns.push_back(row[entry]);
+            matrix->values.push_back((float)(1 + sparseRandom(&state) % 4));
+        }
+        matrix->rowOffsets.push_back((int)matrix->columns.size());
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! count elements of (index % 5) - 2, the dense vectors of the sparse products
+////////////////////////////////////////////////////////////////////////////////
+inline void sparseFillDense(float *data, size_t count)
+{
+    for (size_t index = 0; index < count; index++)
+        data[index] = (float)((int)(index % 5) - 2);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Y = A X on the host, X numberOfColumns x numberOfVectors and Y numberOfRows x numberOfVectors row-major
+//! (numberOfVectors 1 is y = A x)
+////////////////////////////////////////////////////////////////////////////////
+inline void sparseReference(const CsrMatrix *matrix, const float *X, float *Y, int numberOfVectors)
+{
+    for (int row = 0; row < matrix->numberOfRows; row++)
+    {
+        float *y = Y + (size_t)row * numberOfVectors;
+        for (int vector = 0; vector < numberOfVectors; vector++)
+            y[vector] = 0.0f;
+
+        for (int index = matrix->rowOffsets[row]; index < matrix->rowOffsets[row + 1]; index++)
+        {
+            const float *x = X + (size_t)matrix->columns[index] * numberOfVectors;
+            for (int vector = 0; vector < numberOfVectors; vector++)
+                y[vector] += matrix->values[index] * x[vector];
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Longest row of a CSR matrix
+////////////////////////////////////////////////////////////////////////////////
+inline int sparseLongestRow(const CsrMatrix *matrix)
+{
+    int longest = 0;
+
+    for (int row = 0; row < matrix->numberOfRows; row++)
+        if (matrix->rowOffsets[row + 1] - matrix->rowOffsets[row] > longest)
+            longest = matrix->rowOffsets[row + 1] - matrix->rowOffsets[row];
+    return (longest);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! CSR -> ELL, false (ell left empty) if the padded matrix would exceed maxEntries
+////////////////////////////////////////////////////////////////////////////////
+inline bool csrToEll(const CsrMatrix *matrix, EllMatrix *ell, size_t maxEntries)
+{
+    int width = sparseLongestRow(matrix);
+    size_t numberOfEntries = (size_t)width * matrix->numberOfRows;
+
+    ell->numberOfRows = matrix->numberOfRows;
+    ell->width = 0;
+    ell->columns.clear();
+    ell->values.clear();
+    if (numberOfEntries > maxEntries)
+        return (false);
+
+    ell->width = width;
+    ell->columns.assign(numberOfEntries, 0);
+    ell->values.assign(numberOfEntries, 0.0f);
+    for (int row = 0; row < matrix->numberOfRows; row++)
+    {
+        for (int index = matrix->rowOffsets[row]; index < matrix->rowOffsets[row + 1]; index++)
+        {
+            size_t entry = (size_t)(index - matrix->rowOffsets[row]) * matrix->numberOfRows + row;
+            ell->columns[entry] = matrix->columns[index];
+            ell->values[entry] = matrix->values[index];
+        }
+    }
+    return (true);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! CSR -> SELL-C-sigma with slices of sliceHeight rows, sorting by length (longest first) within windows of sigma
+//! rows (a multiple of sliceHeight, 1 keeps the order), false (sell left empty) beyond maxEntries
+////////////////////////////////////////////////////////////////////////////////
+inline bool csrToSell(const CsrMatrix *matrix, int sliceHeight, int sigma, SellMatrix *sell, size_t maxEntries)
+{
+    int numberOfSlices = (matrix->numberOfRows + sliceHeight - 1) / sliceHeight;
+    const std::vector<int> &offsets = matrix->rowOffsets;
+
+    sell->numberOfRows = matrix->numberOfRows;
+    sell->sliceHeight = sliceHeight;
+    sell->sigma = sigma;
+    sell->numberOfPositions = numberOfSlices * sliceHeight;
+    sell->rowPermutation.assign(sell->numberOfPositions, -1);
+    sell->sliceOffsets.assign(numberOfSlices + 1, 0);
+    sell->columns.clear();
+    sell->values.clear();
+
+    for (int row = 0; row < matrix->numberOfRows; row++)
+        sell->rowPermutation[row] = row;
+    for (int window = 0; window < matrix->numberOfRows; window += sigma)
+    {
+        int windowEnd = (window + sigma < matrix->numberOfRows) ? window + sigma : matrix->numberOfRows;
+        std::stable_sort(sell->rowPermutation.begin() + window, sell->rowPermutation.begin() + windowEnd,
+                         [&offsets](int a, int b) { return (offsets[a + 1] - offsets[a] > offsets[b + 1] - offsets[b]); });
+    }
+
+    // every slice as wide as its longest row
+    size_t numberOfEntries = 0;
+    for (int slice = 0; slice < numberOfSlices; slice++)
+    {
+        int width = 0;
+        for (int lane = 0; lane < sliceHeight; lane++)
+        {
+            int row = sell->rowPermutation[slice * sliceHeight + lane];
+            if ((row >= 0) && (offsets[row + 1] - offsets[row] > width))
+                width = offsets[row + 1] - offsets[row];
+        }
+        numberOfEntries += (size_t)width * sliceHeight;
+        if ((numberOfEntries > maxEntries) || (numberOfEntries > 0x7fffffff))
+        {
+            sell->sliceOffsets.clear();
+            sell->rowPermutation.clear();
+            return (false);
+        }
+        sell->sliceOffsets[slice + 1] = (int)numberOfEntries;
+    }
+
+    sell->columns.assign(numberOfEntries, 0);
+    sell->values.assign(numberOfEntries, 0.0f);
+    for (int position = 0; position < sell->numberOfPositions; position++)
+    {
+        int row = sell->rowPermutation[position];
+        if (row < 0)
+            continue;
+
+        size_t begin = (size_t)sell->sliceOffsets[position / sliceHeight] + position % sliceHeight;
+        for (int index = offsets[row]; index < offsets[row + 1]; index++)
+        {
+            size_t entry = begin + (size_t)(index - offsets[row]) * sliceHeight;
+            sell->columns[entry] = matrix->columns[index];
+            sell->values[entry] = matrix->values[index];
+        }
+    }
+    return (true);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Work-items per row of spmvCsrVectorGPU : the power of two (2 to 32) just above the mean row length
+////////////////////////////////////////////////////////////////////////////////
+inline int sparseVectorWidth(const CsrMatrix *matrix)
+{
+    double meanLength = (matrix->numberOfRows > 0) ? (double)matrix->columns.size() / matrix->numberOfRows : 0.0;
+    int width = 2;
+
+    while ((width < 32) && (width < meanLength))
+        width *= 2;
+    return (width);
+}
+
+static const char *const oclSparseSourceCode =
+    "#ifndef SPARSE_GROUP_SIZE                                                                                                   \n"
+    "#define SPARSE_GROUP_SIZE 128                                                                                               \n"
+    "#endif                                                                                                                      \n"
+    "#ifndef SPARSE_VECTOR_WIDTH                                                                                                 \n"
+    "#define SPARSE_VECTOR_WIDTH 8                                                                                               \n"
+    "#endif                                                                                                                      \n"
+    "#ifndef SPARSE_MERGE_ITEMS                                                                                                  \n"
+    "#define SPARSE_MERGE_ITEMS 16                                                                                               \n"
+    "#endif                                                                                                                      \n"
+    "#ifndef SPARSE_SLICE_HEIGHT                                                                                                 \n"
+    "#define SPARSE_SLICE_HEIGHT 32                                                                                              \n"
+    "#endif                                                                                                                      \n"
+    "                                                                                                                            \n"
+    "// y = A x, A in CSR : one work-item per row, a long row keeps the neighbouring work-items of its work-group waiting        \n"
+    "__kernel void spmvCsrScalarGPU(int numberOfRows, __global const int *rowOffsets, __global const int *columns,               \n"
+    "                               __global const float *values, __global const float *x, __global float *y)                    \n"
+    "{                                                                                                                           \n"
+    "    int row = get_global_id(0);                                                                                             \n"
+    "    if (row >= numberOfRows)                                                                                                \n"
+    "        return;                                                                                                             \n"
+    "                                                                                                                            \n"
+    "    float sum = 0.0f;                                                                                                       \n"
+    "    for (int index = rowOffsets[row]; index < rowOffsets[row + 1]; index++)                                                 \n"
+    "        sum += values[index] * x[columns[index]];                                                                           \n"
+    "    y[row] = sum;                                                                                                           \n"
+    "}                                                                                                                           \n"
+    "                                                                                                                            \n"
+    "// SPARSE_VECTOR_WIDTH work-items per row (a power of two dividing SPARSE_GROUP_SIZE) : their strided reads of the row      \n"
+    "// are coalesced and a tree in local memory adds up their partial sums                                                      \n"
+    "__kernel __attribute__((reqd_work_group_size(SPARSE_GROUP_SIZE, 1, 1)))                                                     \n"
+    "void spmvCsrVectorGPU(int numberOfRows, __global const int *rowOffsets, __global const int *columns,                        \n"
+    "                      __global const float *values, __global const float *x, __global float *y)                             \n"
+    "{                                                                                                                           \n"
+    "    __local float partialSums[SPARSE_GROUP_SIZE];                                                                           \n"
+    "                                                                                                                            \n"
+    "    int localIndex = get_local_id(0);                                                                                       \n"
+    "    int lane = localIndex & (SPARSE_VECTOR_WIDTH - 1);                                                                      \n"
+    "    int row = get_global_id(0) / SPARSE_VECTOR_WIDTH;                                                                       \n"
+    "    float sum = 0.0f;                                                                                                       \n"
+    "                                                                                                                            \n"
+    "    if (row < numberOfRows)                                                                                                 \n"
+    "    {                                                                                                                       \n"
+    "        for (int index = rowOffsets[row] + lane; index < rowOffsets[row + 1]; index += SPARSE_VECTOR_WIDTH)                 \n"
+    "            sum += values[index] * x[columns[index]];                                                                       \n"
+    "    }                                                                                                                       \n"
+    "    partialSums[localIndex] = sum;                                                                                          \n"
+    "    barrier(CLK_LOCAL_MEM_FENCE);                                                                                           \n"
+    "                                                                                                                            \n"
+    "    for (int stride = SPARSE_VECTOR_WIDTH / 2; stride > 0; stride >>= 1)                                                    \n"
+    "    {                                                                                                                       \n"
+    "        if (lane < stride)                                                                                                  \n"
+    "            partialSums[localIndex] += partialSums[localIndex + stride];                                                    \n"
+    "        barrier(CLK_LOCAL_MEM_FENCE);                                                                                       \n"
+    "    }                                                                                                                       \n"
+    "                                                                                                                            \n"
+    "    if ((lane == 0) && (row < numberOfRows))                                                                                \n"
+    "        y[row] = partialSums[localIndex];                                                                                   \n"
+    "}                                                                                                                           \n"
+    "                                                                                                                            \n"
+    "// merge-path : the row ends and the nonzeros merge into one path of numberOfRows + numberOfNonzeros steps and every        \n"
+    "// work-item takes SPARSE_MERGE_ITEMS steps, so none gets more than its share however skewed the rows are. A work-item      \n"
+    "// stores the rows it completes, the partial sum of the row it stops in goes to carryRows / carryValues (-1 : none)         \n"
+    "__kernel void spmvCsrMergeGPU(int numberOfRows, int numberOfNonzeros, __global const int *rowOffsets,                       \n"
+    "                              __global const int *columns, __global const float *values, __global const float *x,           \n"
+    "                              __global float *y, __global int *carryRows, __global float *carryValues)                      \n"
+    "{                                                                                                                           \n"
+    "    int item = get_global_id(0);                                                                                            \n"
+    "    int pathLength = numberOfRows + numberOfNonzeros;                                                                       \n"
+    "    int diagonal = item * SPARSE_MERGE_ITEMS;                                                                               \n"
+    "    if (diagonal >= pathLength)                                                                                             \n"
+    "        return;                                                                                                             \n"
+    "                                                                                                                            \n"
+    "    // the start of the path on this diagonal : the first row whose end lies beyond it, the nonzeros before it consumed     \n"
+    "    int low = max(diagonal - numberOfNonzeros, 0);                                                                          \n"
+    "    int high = min(diagonal, numberOfRows);                                                                                 \n"
+    "    while (low < high)                                                                                                      \n"
+    "    {                                                                                                                       \n"
+    "        int middle = (low + high) >> 1;                                                                                     \n"
+    "        if (rowOffsets[middle + 1] <= diagonal - middle - 1)                                                                \n"
+    "            low = middle + 1;                                                                                               \n"
+    "        else                                                                                                                \n"
+    "            high = middle;                                                                                                  \n"
+    "    }                                                                                                                       \n"
+    "                                                                                                                            \n"
+    "    int row = low;                                                                                                          \n"
+    "    int index = diagonal - low;                                                                                             \n"
+    "    int diagonalEnd = min(diagonal + SPARSE_MERGE_ITEMS, pathLength);                                                       \n"
+    "    float sum = 0.0f;                                                                                                       \n"
+    "    for (int step = diagonal; step < diagonalEnd; step++)                                                                   \n"
+    "    {                                                                                                                       \n"
+    "        if (index < rowOffsets[row + 1])                                                                                    \n"
+    "        {                                                                                                                   \n"
+    "            sum += values[index] * x[columns[index]];                                                                       \n"
+    "            index++;                                                                                                        \n"
+    "        }                                                                                                                   \n"
+    "        else                                                                                                                \n"
+    "        {                                                                                                                   \n"
+    "            y[row] = sum;                                                                                                   \n"
+    "            sum = 0.0f;                                                                                                     \n"
+    "            row++;                                                                                                          \n"
+    "        }                                                                                                                   \n"
+    "    }                                                                                                                       \n"
+    "                                                                                                                            \n"
+    "    carryRows[item] = (row < numberOfRows) ? row : -1;                                                                      \n"
+    "    carryValues[item] = sum;                                                                                                \n"
+    "}                                                                                                                           \n"
+    "                                                                                                                            \n"
+    "// adds the carries of spmvCsrMergeGPU to their rows : the first carry of every run of equal rows adds the whole run,       \n"
+    "// in order, so no two work-items update one row and the sums do not depend on the scheduling                               \n"
+    "__kernel void spmvCsrMergeFixupGPU(int numberOfCarries, __global const int *carryRows,                                      \n"
+    "                                   __global const float *carryValues, __global float *y)                                    \n"
+    "{                                                                                                                           \n"
+    "    int carry = get_global_id(0);                                                                                           \n"
+    "    if (carry >= numberOfCarries)                                                                                           \n"
+    "        return;                                                                                                             \n"
+    "                                                                                                                            \n"
+    "    int row = carryRows[carry];                                                                                             \n"
+    "    if ((row < 0) || ((carry > 0) && (carryRows[carry - 1] == row)))                                                        \n"
+    "        return;                                                                                                             \n"
+    "                                                                                                                            \n"
+    "    float sum = 0.0f;                                                                                                       \n"
+    "    for (int next = carry; (next < numberOfCarries) && (carryRows[next] == row); next++)                                    \n"
+    "        sum += carryValues[next];                                                                                           \n"
+    "    y[row] += sum;                                                                                                          \n"
+    "}                                                                                                                           \n"
+    "                                                                                                                            \n"
+    "// ELL : every row padded to the longest one with zeros and stored column-major (entry k of row r at                        \n"
+    "// k * numberOfRows + r), so neighbouring work-items read neighbouring addresses                                            \n"
+    "__kernel void spmvEllGPU(int numberOfRows, int width, __global const int *columns, __global const float *values,            \n"
+    "                         __global const float *x, __global float *y)                                                        \n"
+    "{                                                                                                                           \n"
+    "    int row = get_global_id(0);                                                                                             \n"
+    "    if (row >= numberOfRows)                                                                                                \n"
+    "        return;                                                                                                             \n"
+    "                                                                                                                            \n"
+    "    float sum = 0.0f;                                                                                                       \n"
+    "    for (int entry = 0; entry < width; entry++)                                                                             \n"
+    "    {                                                                                                                       \n"
+    "        size_t index = (size_t)entry * numberOfRows + row;                                                                  \n"
+    "        sum += values[index] * x[columns[index]];                                                                           \n"
+    "    }                                                                                                                       \n"
+    "    y[row] = sum;                                                                                                           \n"
+    "}                                                                                                                           \n"
+    "                                                                                                                            \n"
+    "// SELL-C-sigma : rows sorted by length within windows of sigma rows and cut into slices of SPARSE_SLICE_HEIGHT (C),        \n"
+    "// every slice padded to its own longest row and stored column-major from sliceOffsets[slice]. rowPermutation is the        \n"
+    "// row of every sorted position, -1 past the last row                                                                       \n"
+    "__kernel void spmvSellGPU(int numberOfPositions, __global const int *sliceOffsets, __global const int *rowPermutation,      \n"
+    "                          __global const int *columns, __global const float *values, __global const float *x,               \n"
+    "                          __global float *y)                                                                                \n"
+    "{                                                                                                                           \n"
+    "    int position = get_global_id(0);                                                                                        \n"
+    "    if (position >= numberOfPositions)                                                                                      \n"
+    "        return;                                                                                                             \n"
+    "                                                                                                                            \n"
+    "    int slice = position / SPARSE_SLICE_HEIGHT;                                                                             \n"
+    "    int begin = sliceOffsets[slice] + position % SPARSE_SLICE_HEIGHT;                                                       \n"
+    "    int width = (sliceOffsets[slice + 1] - sliceOffsets[slice]) / SPARSE_SLICE_HEIGHT;                                      \n"
+    "    float sum = 0.0f;                                                                                                       \n"
+    "    for (int entry = 0; entry < width; entry++)                                                                             \n"
+    "    {                                                                                                                       \n"
+    "        int index = begin + entry * SPARSE_SLICE_HEIGHT;                                                                    \n"
+    "        sum += values[index] * x[columns[index]];                                                                           \n"
+    "    }                                                                                                                       \n"
+    "                                                                                                                            \n"
+    "    int row = rowPermutation[position];                                                                                     \n"
+    "    if (row >= 0)                                                                                                           \n"
+    "        y[row] = sum;                                                                                                       \n"
+    "}                                                                                                                           \n"
+    "                                                                                                                            \n"
+    "// Y = A X, X and Y row-major numberOfVectors wide : dimension 0 runs along a row of X, so the work-items of one            \n"
+    "// sparse row read neighbouring elements of X for every nonzero and share the reads of the row itself                       \n"
+    "__kernel void spmmCsrGPU(int numberOfRows, int numberOfVectors, __global const int *rowOffsets,                             \n"
+    "                         __global const int *columns, __global const float *values, __global const float *X,                \n"
+    "                         __global float *Y)                                                                                 \n"
+    "{                                                                                                                           \n"
+    "    int vector = get_global_id(0);                                                                                          \n"
+    "    int row = get_global_id(1);                                                                                             \n"
+    "    if ((vector >= numberOfVectors) || (row >= numberOfRows))                                                               \n"
+    "        return;                                                                                                             \n"
+    "                                                                                                                            \n"
+    "    float sum = 0.0f;                                                                                                       \n"
+    "    for (int index = rowOffsets[row]; index < rowOffsets[row + 1]; index++)                                                 \n"
+    "        sum += values[index] * X[(size_t)columns[index] * numberOfVectors + vector];                                        \n"
+    "    Y[(size_t)row * numberOfVectors + vector] = sum;                                                                        \n"
+    "}                                                                                                                           \n"
+    "                                                                                                                            \n"
+    "__kernel void spmmSellGPU(int numberOfPositions, int numberOfVectors, __global const int *sliceOffsets,                     \n"
+    "                          __global const int *rowPermutation, __global const int *columns,                                  \n"
+    "                          __global const float *values, __global const float *X, __global float *Y)                         \n"
+    "{                                                                                                                           \n"
+    "    int vector = get_global_id(0);                                                                                          \n"
+    "    int position = get_global_id(1);                                                                                        \n"
+    "    if ((vector >= numberOfVectors) || (position >= numberOfPositions))                                                     \n"
+    "        return;                                                                                                             \n"
+    "                                                                                                                            \n"
+    "    int slice = position / SPARSE_SLICE_HEIGHT;                                                                             \n"
+    "    int begin = sliceOffsets[slice] + position % SPARSE_SLICE_HEIGHT;                                                       \n"
+    "    int width = (sliceOffsets[slice + 1] - sliceOffsets[slice]) / SPARSE_SLICE_HEIGHT;                                      \n"
+    "    float sum = 0.0f;                                                                                                       \n"
+    "    for (int entry = 0; entry < width; entry++)                                                                             \n"
+    "    {                                                                                                                       \n"
+    "        int index = begin + entry * SPARSE_SLICE_HEIGHT;                                                                    \n"
+    "        sum += values[index] * X[(size_t)columns[index] * numberOfVectors + vector];                                        \n"
+    "    }                                                                                                                       \n"
+    "                                                                                                                            \n"
+    "    int row = rowPermutation[position];                                                                                     \n"
+    "    if (row >= 0)                                                                                                           \n"
+    "        Y[(size_t)row * numberOfVectors + vector] = sum;                                                                    \n"
+    "}                                                                                                                           \n";
+
+#endif // HELPER_SPARSE_H
@@ -0,0 +1,142 @@
+// helper_specialize.h
+// kernels specialized through -D build options : known sizes are baked into the build so the compiler can
+// unroll and drop bounds checks, each variant is built on first use and kept for the rest of the run
+// (and on disk through helper_program_cache.h)
+
+#ifndef HELPER_SPECIALIZE_H
+#define HELPER_SPECIALIZE_H
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include <CL/opencl.h>
+
+#include "helper_program_cache.h"
+
+#define SPECIALIZE_OPTIONS_LENGTH 512
+
+typedef struct SpecializedKernel
+{
+    char options[SPECIALIZE_OPTIONS_LENGTH];
+    char name[64];
+    cl_program program; // shared by the kernels built with the same options
+    cl_kernel kernel;
+} SpecializedKernel;
+
+typedef struct SpecializationCache
+{
+    std::vector<SpecializedKernel> kernels;
+    size_t numberOfBuilds;     // programs compiled (or loaded from the binary cache) this run
+    size_t numberOfBinaryHits; // of those, loaded from the binary cache
+} SpecializationCache;
+
+////////////////////////////////////////////////////////////////////////////////
+//! Append -D name=value to options
+////////////////////////////////////////////////////////////////////////////////
+inline void specializeDefine(char *options, const char *name, long long value)
+{
+    size_t length = strlen(options);
+    snprintf(options + length, SPECIALIZE_OPTIONS_LENGTH - length, "%s-D %s=%lld", (length != 0) ? " " : "", name, value);
+}
+
+inline void specializeDefineText(char *options, const char *name, const char *text)
+{
+    size_t length = strlen(options);
+    if (text != NULL)
+        snprintf(options + length, SPECIALIZE_OPTIONS_LENGTH - length, "%s-D %s=%s", (length != 0) ? " " : "", name, text);
+    else
+        snprintf(options + length, SPECIALIZE_OPTIONS_LENGTH - length, "%s-D %s", (length != 0) ? " " : "", name);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Kernel name of source built with options, built on the first request and cached after that.
+//! NULL with *pResult set if the build failed, the build log is printed then. *pBuilt (may be NULL)
+//! tells whether this request had to build the program
+////////////////////////////////////////////////////////////////////////////////
+inline cl_kernel specializedKernel(SpecializationCache *cache, cl_context context, cl_device_id device, const char *source, const char *name, const char *options,
+                                   cl_int *pResult, bool *pBuilt)
+{
+    cl_program program = NULL;
+    cl_int result = CL_SUCCESS;
+
+    if (pBuilt != NULL)
+        *pBuilt = false;
+
+    for (size_t index = 0; index < cache->kernels.size(); index++)
+    {
+        SpecializedKernel *entry = &cache->kernels[index];
+        if (strcmp(entry->options, options) != 0)
+            continue;
+        if (strcmp(entry->name, name) == 0)
+        {
+            *pResult = CL_SUCCESS;
+            return (entry->kernel);
+        }
+        program = entry->program;
+    }
+
+    if (program == NULL)
+    {
+        cl_bool bFromCache = CL_FALSE;
+
+        program = buildProgramWithCache(context, device, source, options, &result, &bFromCache);
+        if (program == NULL)
+        {
+            *pResult = result;
+            return (NULL);
+        }
+
+        if (result != CL_SUCCESS)
+        {
+            char buffer[2048] = "";
+            clGetProgramBuildInfo(program, device, CL_PROGRAM_BUILD_LOG, sizeof(buffer) - 1, buffer, NULL);
+            printf("info>> Specialized Build Failed (%s) : %d, Build Log : %s\n", options, result, buffer);
+            clReleaseProgram(program);
+            *pResult = result;
+            return (NULL);
+        }
+
+        cache->numberOfBuilds++;
+        if (bFromCache == CL_TRUE)
+            cache->numberOfBinaryHits++;
+        if (pBuilt != NULL)
+            *pBuilt = true;
+    }
+    else
+    {
+        // the new entry holds its own reference, releaseSpecializationCache() drops one per entry
+        clRetainProgram(program);
+    }
+
+    SpecializedKernel entry;
+    snprintf(entry.options, SPECIALIZE_OPTIONS_LENGTH, "%s", options);
+    snprintf(entry.name, sizeof(entry.name), "%s", name);
+    entry.program = program;
+    entry.kernel = clCreateKernel(program, name, &result);
+    if (result != CL_SUCCESS)
+    {
+        clReleaseProgram(program);
+        *pResult = result;
+        return (NULL);
+    }
+
+    cache->kernels.push_back(entry);
+    *pResult = CL_SUCCESS;
+    return (entry.kernel);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Release every cached kernel and program and empty the cache
+////////////////////////////////////////////////////////////////////////////////
+inline void releaseSpecializationCache(SpecializationCache *cache)
+{
+    for (size_t index = cache->kernels.size(); index > 0; index--)
+    {
+        clReleaseKernel(cache->kernels[index - 1].kernel);
+        clReleaseProgram(cache->kernels[index - 1].program);
+    }
+    cache->kernels.clear();
+}
+
+#endif // HELPER_SPECIALIZE_H
@@ -6,5 +6,30 @@ cl.exe MatMul.cpp /c /EHsc /Fo".\MatMul.obj" /I "C:\Program Files\NVIDIA GPU Com
 link.exe MatMul.obj opencl.lib /LIBPATH:"C:\Program Files\NVIDIA GPU Computing Toolkit\CUDA\v11.1\lib\x64"
 
 MatMul.exe
+MatMul.exe -zerocopy alloc
+MatMul.exe -zerocopy usehost
+MatMul.exe -trace MatMul.json
+MatMul.exe -specialize off
+MatMul.exe -kernel tiled
+MatMul.exe -kernel tiled -tile 32
+MatMul.exe -kernel blocked
+MatMul.exe -kernel packed -micro 4x8
+MatMul.exe -type float -kernel blocked
+MatMul.exe -type double
+MatMul.exe -type half
+MatMul.exe -type int8 -kernel tiled
+MatMul.exe -type float -cpu naive
+MatMul.exe -type float -threads 1
+MatMul.exe -sweep
+MatMul.exe -gemmtest
+MatMul.exe -type float -gemmtest -gemmsize 2048
+MatMul.exe -outofcore 4096 -memcap 64
+MatMul.exe -device cpu -type float -outofcore 2048 -memcap 16
+MatMul.exe -type float -multidevice 4096
+MatMul.exe -multidevice 2048 -devices gpu
+MatMul.exe -sparse 1000000
+MatMul.exe -sparse 200000 -nnzperrow 64
+MatMul.exe -type float -gemv 8192x8192
+MatMul.exe -gemv 16384x1024
 
 del MatMul.obj
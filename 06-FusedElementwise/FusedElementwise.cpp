@@ -0,0 +1,359 @@
+// headers
+#include <stdio.h>
+#include <stdlib.h> // exit()
+#include <string.h> // strcmp()
+#include <math.h>   // fabs()
+
+#include <CL/opencl.h> // standard OpenCL header
+
+#include "helper_timer.h"
+#include "FusedElementwise.h"
+
+// global OpenCL variables
+size_t iNumberOfArrayElements = 11444777;
+int numberOfRuns = 10;
+
+cl_platform_id oclPlatformID;
+cl_device_id oclDeviceID;
+
+cl_context oclContext;
+cl_command_queue oclCommandQueue;
+
+FusedElementwiseEngine *engine = NULL;
+
+float *hostA = NULL;
+float *hostB = NULL;
+float *hostC = NULL;
+float *hostOutput = NULL;
+float *gold = NULL;
+
+// a, b, c => inputs, d => output, t, u => intermediates of the unfused evaluation
+DeviceVector *deviceA = NULL;
+DeviceVector *deviceB = NULL;
+DeviceVector *deviceC = NULL;
+DeviceVector *deviceD = NULL;
+DeviceVector *deviceT = NULL;
+DeviceVector *deviceU = NULL;
+
+// timeOnDevice() definition
+// average time of one call of evaluate(), after one warm-up call that also builds the kernels
+template <typename Function>
+float timeOnDevice(Function evaluate)
+{
+    // code
+    evaluate();
+    clFinish(oclCommandQueue);
+
+    // start timer
+    StopWatchInterface *timer = NULL;
+    sdkCreateTimer(&timer);
+    sdkStartTimer(&timer);
+
+    for (int run = 0; run < numberOfRuns; run++)
+        evaluate();
+
+    // finish OpenCL command queue
+    clFinish(oclCommandQueue);
+
+    // stop timer
+    sdkStopTimer(&timer);
+    float time = sdkGetTimerValue(&timer) / numberOfRuns;
+    sdkDeleteTimer(&timer);
+    timer = NULL;
+
+    return (time);
+}
+
+// main() definition
+int main(int argc, char *argv[])
+{
+    // local function declaration
+    void fillArrayWithRandomNumbers(float *, size_t);
+    bool compareWithGold(const char *);
+    void printResult(const char *, int, int, int, float, float);
+    void cleanup(void);
+
+    // local variable declaration
+    size_t size;
+    cl_int result;
+    bool bAccuracy = true;
+
+    // code
+    // parse command line
+    for (int argIndex = 1; argIndex < argc; argIndex++)
+    {
+        if ((strcmp(argv[argIndex], "-n") == 0) && (argIndex + 1 < argc))
+        {
+            iNumberOfArrayElements = (size_t)strtoull(argv[++argIndex], NULL, 10);
+        }
+        else if ((strcmp(argv[argIndex], "-runs") == 0) && (argIndex + 1 < argc))
+        {
+            numberOfRuns = atoi(argv[++argIndex]);
+        }
+        else
+        {
+            printf("usage : %s [-n elements] [-runs count]\n", argv[0]);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    if ((iNumberOfArrayElements == 0) || (iNumberOfArrayElements > 0x7fffffff) || (numberOfRuns < 1))
+    {
+        printf("error>> Invalid Element Count Or Run Count. Terminating Now...\n");
+        exit(EXIT_FAILURE);
+    }
+
+    size = iNumberOfArrayElements * sizeof(float);
+
+    // host memory allocation
+    hostA = (float *)malloc(size);
+    hostB = (float *)malloc(size);
+    hostC = (float *)malloc(size);
+    hostOutput = (float *)malloc(size);
+    gold = (float *)malloc(size);
+    if ((hostA == NULL) || (hostB == NULL) || (hostC == NULL) || (hostOutput == NULL) || (gold == NULL))
+    {
+        printf("error>> Host Memory Allocation Failed. Terminating Now...\n");
+        cleanup();
+        exit(EXIT_FAILURE);
+    }
+
+    // filling values into host arrays
+    fillArrayWithRandomNumbers(hostA, iNumberOfArrayElements);
+    fillArrayWithRandomNumbers(hostB, iNumberOfArrayElements);
+    fillArrayWithRandomNumbers(hostC, iNumberOfArrayElements);
+
+    // get OpenCL supporting platform's ID
+    result = clGetPlatformIDs(1, &oclPlatformID, NULL);
+    if (result != CL_SUCCESS)
+    {
+        printf("error>> clGetPlatformIDs() Failed : %d. Terminating Now ...\n", result);
+        cleanup();
+        exit(EXIT_FAILURE);
+    }
+
+    // get OpenCL supporting GPU device's ID
+    result = clGetDeviceIDs(oclPlatformID, CL_DEVICE_TYPE_GPU, 1, &oclDeviceID, NULL);
+    if (result != CL_SUCCESS)
+    {
+        printf("error>> clGetDeviceIDs() Failed : %d. Terminating Now ...\n", result);
+        cleanup();
+        exit(EXIT_FAILURE);
+    }
+
+    // create OpenCL compute context
+    oclContext = clCreateContext(NULL, 1, &oclDeviceID, NULL, NULL, &result);
+    if (result != CL_SUCCESS)
+    {
+        printf("error>> clCreateContext() Failed : %d. Terminating Now ...\n", result);
+        cleanup();
+        exit(EXIT_FAILURE);
+    }
+
+    // create command queue
+    oclCommandQueue = clCreateCommandQueue(oclContext, oclDeviceID, 0, &result);
+    if (result != CL_SUCCESS)
+    {
+        printf("error>> clCreateCommandQueue() Failed : %d. Terminating Now ...\n", result);
+        cleanup();
+        exit(EXIT_FAILURE);
+    }
+
+    // kernels are generated and built on first use of each expression shape
+    engine = new FusedElementwiseEngine(oclContext, oclDeviceID, oclCommandQueue);
+
+    // allocate device memory
+    DeviceVector **deviceVectors[] = {&deviceA, &deviceB, &deviceC, &deviceD, &deviceT, &deviceU};
+    for (int index = 0; index < 6; index++)
+    {
+        *deviceVectors[index] = new DeviceVector(*engine, iNumberOfArrayElements, &result);
+        if (result != CL_SUCCESS)
+        {
+            printf("error>> clCreateBuffer() Failed For Device Vector %d : %d. Terminating Now ...\n", index, result);
+            cleanup();
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    DeviceVector &a = *deviceA;
+    DeviceVector &b = *deviceB;
+    DeviceVector &c = *deviceC;
+    DeviceVector &d = *deviceD;
+    DeviceVector &t = *deviceT;
+    DeviceVector &u = *deviceU;
+
+    // write host arrays to device memory
+    result = a.write(hostA);
+    result |= b.write(hostB);
+    result |= c.write(hostC);
+    if (result != CL_SUCCESS)
+    {
+        printf("error>> clEnqueueWriteBuffer() Failed : %d. Terminating Now ...\n", result);
+        cleanup();
+        exit(EXIT_FAILURE);
+    }
+    clFinish(oclCommandQueue);
+
+    printf("\n==================================================================================\n");
+    printf("+ FUSED VERSUS KERNEL-PER-OPERATION ELEMENTWISE EXPRESSIONS ON %zu ELEMENTS +\n", iNumberOfArrayElements);
+    printf("==================================================================================\n");
+
+    // d = a + b * c
+    for (size_t index = 0; index < iNumberOfArrayElements; index++)
+        gold[index] = hostA[index] + hostB[index] * hostC[index];
+
+    float timeFused = timeOnDevice([&]() { d = a + b * c; });
+    bAccuracy = compareWithGold("d = a + b * c") && bAccuracy;
+    float timeUnfused = timeOnDevice([&]() {
+        t = b * c;
+        d = a + t;
+    });
+    printResult("d = a + b * c", 4, 2, 6, timeFused, timeUnfused);
+
+    // d = sqrt(a * a + b * b) * 0.5 - c / (a + 1)
+    for (size_t index = 0; index < iNumberOfArrayElements; index++)
+        gold[index] = sqrtf(hostA[index] * hostA[index] + hostB[index] * hostB[index]) * 0.5f - hostC[index] / (hostA[index] + 1.0f);
+
+    unsigned int kernelsBuilt = engine->kernelsBuilt;
+    timeFused = timeOnDevice([&]() { d = sqrt(a * a + b * b) * 0.5f - c / (a + 1.0f); });
+    std::string fusedSource = (engine->kernelsBuilt != kernelsBuilt) ? engine->lastBuiltSource : std::string();
+    bAccuracy = compareWithGold("d = sqrt(a * a + b * b) * 0.5 - c / (a + 1)") && bAccuracy;
+    timeUnfused = timeOnDevice([&]() {
+        t = a * a;
+        u = b * b;
+        t = t + u;
+        t = sqrt(t);
+        t = t * 0.5f;
+        u = a + 1.0f;
+        u = c / u;
+        d = t - u;
+    });
+    printResult("d = sqrt(a * a + b * b) * 0.5 - c / (a + 1)", 4, 8, 19, timeFused, timeUnfused);
+
+    // same shape, different constants => the cached kernel is reused
+    unsigned int cacheHits = engine->cacheHits;
+    kernelsBuilt = engine->kernelsBuilt;
+    for (int run = 1; run <= 4; run++)
+        d = fmax(a * (float)run, b) - c * (float)run;
+    clFinish(oclCommandQueue);
+
+    for (size_t index = 0; index < iNumberOfArrayElements; index++)
+        gold[index] = fmaxf(hostA[index] * 4.0f, hostB[index]) - hostC[index] * 4.0f;
+    bAccuracy = compareWithGold("d = fmax(a * k, b) - c * k") && bAccuracy;
+
+    printf("- d = fmax(a * k, b) - c * k For k = 1..4 Built %u Kernel(s) And Hit The Cache %u Time(s)\n", engine->kernelsBuilt - kernelsBuilt, engine->cacheHits - cacheHits);
+    printf("- Kernels Built = %u, Cache Hits = %u\n\n", engine->kernelsBuilt, engine->cacheHits);
+
+    if (fusedSource.empty() == false)
+        printf("- Generated Kernel For sqrt(a * a + b * b) * 0.5 - c / (a + 1) :\n%s\n", fusedSource.c_str());
+
+    if (bAccuracy == true)
+        printf("# Comparison Of CPU And Fused GPU Expressions Is With Relative Accuracy Of Limit Of 0.00001.\n");
+    else
+        printf("# Comparison Of CPU And Fused GPU Expressions Is Not With Relative Accuracy Of Limit Of 0.00001.\n");
+    printf("==================================================================================\n");
+
+    // total cleanup
+    cleanup();
+
+    return (0);
+}
+
+// printResult() definition
+// arrays : vectors touched by the fused kernel, kernels / arrays of the unfused chain
+void printResult(const char *expression, int fusedArrays, int unfusedKernels, int unfusedArrays, float timeFused, float timeUnfused)
+{
+    // code
+    double fusedGigaBytes = ((double)fusedArrays * iNumberOfArrayElements * sizeof(cl_float)) / 1.0e9;
+    double unfusedGigaBytes = ((double)unfusedArrays * iNumberOfArrayElements * sizeof(cl_float)) / 1.0e9;
+
+    printf("- %s\n", expression);
+    printf("    Fused   : 1 Kernel,  %2d Arrays Moved, %0.6f (ms), %0.3f (GB/s)\n", fusedArrays, timeFused, fusedGigaBytes / (timeFused / 1000.0));
+    printf("    Unfused : %d Kernels, %2d Arrays Moved, %0.6f (ms), %0.3f (GB/s)\n", unfusedKernels, unfusedArrays, timeUnfused, unfusedGigaBytes / (timeUnfused / 1000.0));
+    printf("    Speedup Of Fused Evaluation = %0.2fx\n\n", timeUnfused / timeFused);
+}
+
+// compareWithGold() definition
+bool compareWithGold(const char *expression)
+{
+    // local function declaration
+    void cleanup(void);
+
+    // code
+    cl_int result = deviceD->read(hostOutput);
+    if (result != CL_SUCCESS)
+    {
+        printf("error>> clEnqueueReadBuffer() Failed : %d. Terminating Now ...\n", result);
+        cleanup();
+        exit(EXIT_FAILURE);
+    }
+
+    for (size_t index = 0; index < iNumberOfArrayElements; index++)
+    {
+        float tolerance = 0.00001f * fmaxf(1.0f, fabsf(gold[index]));
+        if (fabsf(gold[index] - hostOutput[index]) > tolerance)
+        {
+            printf("- %s Differs At Array Index %zu : CPU %0.6f, GPU %0.6f\n", expression, index, gold[index], hostOutput[index]);
+            return (false);
+        }
+    }
+
+    return (true);
+}
+
+// cleanup() definition
+void cleanup(void)
+{
+    // code
+    // OpenCL cleanup
+    DeviceVector **deviceVectors[] = {&deviceU, &deviceT, &deviceD, &deviceC, &deviceB, &deviceA};
+    for (int index = 0; index < 6; index++)
+    {
+        if (*deviceVectors[index])
+        {
+            delete *deviceVectors[index];
+            *deviceVectors[index] = NULL;
+        }
+    }
+
+    if (engine)
+    {
+        delete engine;
+        engine = NULL;
+    }
+
+    if (oclCommandQueue)
+    {
+        clReleaseCommandQueue(oclCommandQueue);
+        oclCommandQueue = NULL;
+    }
+
+    if (oclContext)
+    {
+        clReleaseContext(oclContext);
+        oclContext = NULL;
+    }
+
+    // free allocated host memory
+    float **hostArrays[] = {&gold, &hostOutput, &hostC, &hostB, &hostA};
+    for (int index = 0; index < 5; index++)
+    {
+        if (*hostArrays[index])
+        {
+            free(*hostArrays[index]);
+            *hostArrays[index] = NULL;
+        }
+    }
+}
+
+// fillArrayWithRandomNumbers() definition
+void fillArrayWithRandomNumbers(float *pFloatArray, size_t iSize)
+{
+    // code
+    size_t index;
+    const float fScale = 1.0f / (float)RAND_MAX;
+    for (index = 0; index < iSize; index++)
+    {
+        pFloatArray[index] = fScale * rand();
+    }
+}
@@ -0,0 +1,520 @@
+// FusedElementwise.h
+// expression templates over OpenCL float buffers : a whole elementwise expression such as
+// d = a + b * c is captured as a tree, generated into one kernel and evaluated in one pass,
+// without intermediate buffers. Kernels are built once per expression shape and cached by
+// the hash of that shape, the scalar constants of an expression are kernel arguments.
+
+#ifndef FUSED_ELEMENTWISE_H
+#define FUSED_ELEMENTWISE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include <CL/opencl.h>
+
+class DeviceVector;
+
+////////////////////////////////////////////////////////////////////////////////
+// operators, each one turns the source of its operand(s) into the source of the result
+////////////////////////////////////////////////////////////////////////////////
+struct AddOp
+{
+    static const char *name() { return ("add"); }
+    static std::string source(const std::string &l, const std::string &r) { return ("(" + l + " + " + r + ")"); }
+};
+
+struct SubtractOp
+{
+    static const char *name() { return ("sub"); }
+    static std::string source(const std::string &l, const std::string &r) { return ("(" + l + " - " + r + ")"); }
+};
+
+struct MultiplyOp
+{
+    static const char *name() { return ("mul"); }
+    static std::string source(const std::string &l, const std::string &r) { return ("(" + l + " * " + r + ")"); }
+};
+
+struct DivideOp
+{
+    static const char *name() { return ("div"); }
+    static std::string source(const std::string &l, const std::string &r) { return ("(" + l + " / " + r + ")"); }
+};
+
+struct MinOp
+{
+    static const char *name() { return ("min"); }
+    static std::string source(const std::string &l, const std::string &r) { return ("fmin(" + l + ", " + r + ")"); }
+};
+
+struct MaxOp
+{
+    static const char *name() { return ("max"); }
+    static std::string source(const std::string &l, const std::string &r) { return ("fmax(" + l + ", " + r + ")"); }
+};
+
+struct NegateOp
+{
+    static const char *name() { return ("neg"); }
+    static std::string source(const std::string &e) { return ("(-" + e + ")"); }
+};
+
+struct SqrtOp
+{
+    static const char *name() { return ("sqrt"); }
+    static std::string source(const std::string &e) { return ("sqrt(" + e + ")"); }
+};
+
+struct ExpOp
+{
+    static const char *name() { return ("exp"); }
+    static std::string source(const std::string &e) { return ("exp(" + e + ")"); }
+};
+
+struct LogOp
+{
+    static const char *name() { return ("log"); }
+    static std::string source(const std::string &e) { return ("log(" + e + ")"); }
+};
+
+struct AbsOp
+{
+    static const char *name() { return ("abs"); }
+    static std::string source(const std::string &e) { return ("fabs(" + e + ")"); }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// expression tree nodes
+// every node knows how to
+//   appendShape()     : describe its structure, the cache key of the fused kernel
+//   appendSource()    : emit its kernel parameters and return its value expression
+//   setArguments()    : bind its leaves to the kernel arguments, in the same order
+//   hasLength()       : check that every vector leaf matches the output length
+////////////////////////////////////////////////////////////////////////////////
+template <typename E>
+class Expression
+{
+public:
+    const E &self() const { return (static_cast<const E &>(*this)); }
+};
+
+// DeviceVector leaves are held by pointer, every other node by value
+class VectorTerminal;
+
+template <typename E>
+struct ExpressionStorage
+{
+    typedef E type;
+};
+
+template <>
+struct ExpressionStorage<DeviceVector>
+{
+    typedef VectorTerminal type;
+};
+
+class VectorTerminal : public Expression<VectorTerminal>
+{
+public:
+    VectorTerminal(const DeviceVector &v) : vector(&v) {}
+
+    void appendShape(std::string &shape) const { shape += "v"; }
+    std::string appendSource(std::string &parameters, int &leafIndex) const;
+    cl_int setArguments(cl_kernel kernel, cl_uint &argIndex) const;
+    bool hasLength(size_t length) const;
+
+    const DeviceVector *vector;
+};
+
+class ScalarTerminal : public Expression<ScalarTerminal>
+{
+public:
+    ScalarTerminal(float v) : value(v) {}
+
+    void appendShape(std::string &shape) const { shape += "s"; }
+
+    std::string appendSource(std::string &parameters, int &leafIndex) const
+    {
+        std::string name = "s" + std::to_string(leafIndex++);
+        parameters += ", const float " + name;
+        return (name);
+    }
+
+    cl_int setArguments(cl_kernel kernel, cl_uint &argIndex) const
+    {
+        return (clSetKernelArg(kernel, argIndex++, sizeof(cl_float), (void *)&value));
+    }
+
+    bool hasLength(size_t) const { return (true); }
+
+    cl_float value;
+};
+
+template <typename Op, typename L, typename R>
+class BinaryExpression : public Expression<BinaryExpression<Op, L, R>>
+{
+public:
+    BinaryExpression(const L &l, const R &r) : left(l), right(r) {}
+
+    void appendShape(std::string &shape) const
+    {
+        shape += Op::name();
+        shape += "(";
+        left.appendShape(shape);
+        shape += ",";
+        right.appendShape(shape);
+        shape += ")";
+    }
+
+    std::string appendSource(std::string &parameters, int &leafIndex) const
+    {
+        std::string l = left.appendSource(parameters, leafIndex);
+        std::string r = right.appendSource(parameters, leafIndex);
+        return (Op::source(l, r));
+    }
+
+    cl_int setArguments(cl_kernel kernel, cl_uint &argIndex) const
+    {
+        cl_int result = left.setArguments(kernel, argIndex);
+        if (result != CL_SUCCESS)
+            return (result);
+        return (right.setArguments(kernel, argIndex));
+    }
+
+    bool hasLength(size_t length) const { return (left.hasLength(length) && right.hasLength(length)); }
+
+    L left;
+    R right;
+};
+
+template <typename Op, typename E>
+class UnaryExpression : public Expression<UnaryExpression<Op, E>>
+{
+public:
+    UnaryExpression(const E &e) : operand(e) {}
+
+    void appendShape(std::string &shape) const
+    {
+        shape += Op::name();
+        shape += "(";
+        operand.appendShape(shape);
+        shape += ")";
+    }
+
+    std::string appendSource(std::string &parameters, int &leafIndex) const
+    {
+        return (Op::source(operand.appendSource(parameters, leafIndex)));
+    }
+
+    cl_int setArguments(cl_kernel kernel, cl_uint &argIndex) const { return (operand.setArguments(kernel, argIndex)); }
+
+    bool hasLength(size_t length) const { return (operand.hasLength(length)); }
+
+    E operand;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// kernel cache and evaluation
+////////////////////////////////////////////////////////////////////////////////
+class FusedElementwiseEngine
+{
+public:
+    FusedElementwiseEngine(cl_context context, cl_device_id device, cl_command_queue queue)
+        : oclContext(context), oclDeviceID(device), oclCommandQueue(queue), localWorkSize(256), kernelsBuilt(0), cacheHits(0)
+    {
+    }
+
+    ~FusedElementwiseEngine()
+    {
+        release();
+    }
+
+    //! generate (or find) the fused kernel of expression and enqueue it to write output
+    template <typename E>
+    cl_int evaluate(DeviceVector &output, const Expression<E> &expression);
+
+    //! release every cached kernel and program
+    void release(void)
+    {
+        for (auto &bucket : cache)
+        {
+            for (size_t index = 0; index < bucket.second.size(); index++)
+            {
+                clReleaseKernel(bucket.second[index].kernel);
+                clReleaseProgram(bucket.second[index].program);
+            }
+        }
+        cache.clear();
+    }
+
+    //! FNV-1a hash of an expression shape
+    static unsigned long long hashShape(const std::string &shape)
+    {
+        unsigned long long hash = 14695981039346656037ULL;
+        for (size_t index = 0; index < shape.size(); index++)
+        {
+            hash ^= (unsigned char)shape[index];
+            hash *= 1099511628211ULL;
+        }
+        return (hash);
+    }
+
+    cl_context oclContext;
+    cl_device_id oclDeviceID;
+    cl_command_queue oclCommandQueue;
+
+    size_t localWorkSize;
+    unsigned int kernelsBuilt;
+    unsigned int cacheHits;
+    std::string lastBuiltSource;
+
+private:
+    struct CachedKernel
+    {
+        std::string shape; // the full shape, hash collisions must not mix kernels up
+        cl_program program;
+        cl_kernel kernel;
+        size_t localWorkSize;
+    };
+
+    const CachedKernel *findKernel(unsigned long long hash, const std::string &shape)
+    {
+        auto bucket = cache.find(hash);
+        if (bucket == cache.end())
+            return (NULL);
+
+        for (size_t index = 0; index < bucket->second.size(); index++)
+        {
+            if (bucket->second[index].shape == shape)
+                return (&bucket->second[index]);
+        }
+        return (NULL);
+    }
+
+    const CachedKernel *buildKernel(unsigned long long hash, const std::string &shape, const std::string &parameters, const std::string &value, cl_int *result)
+    {
+        CachedKernel entry;
+        entry.shape = shape;
+
+        std::string source =
+            "// " + shape + "\n"
+            "__kernel void fusedElementwise(__global float *output, int length" + parameters + ")\n"
+            "{\n"
+            "    int i = get_global_id(0);\n"
+            "    if(i < length)\n"
+            "    {\n"
+            "        output[i] = " + value + ";\n"
+            "    }\n"
+            "}\n";
+        const char *sourcePointer = source.c_str();
+
+        entry.program = clCreateProgramWithSource(oclContext, 1, &sourcePointer, NULL, result);
+        if (*result != CL_SUCCESS)
+            return (NULL);
+
+        *result = clBuildProgram(entry.program, 1, &oclDeviceID, NULL, NULL, NULL);
+        if (*result != CL_SUCCESS)
+        {
+            size_t len;
+            char buffer[2048];
+            clGetProgramBuildInfo(entry.program, oclDeviceID, CL_PROGRAM_BUILD_LOG, sizeof(buffer), buffer, &len);
+            printf("OpenCL Program Build Log : %s\n", buffer);
+            clReleaseProgram(entry.program);
+            return (NULL);
+        }
+
+        entry.kernel = clCreateKernel(entry.program, "fusedElementwise", result);
+        if (*result != CL_SUCCESS)
+        {
+            clReleaseProgram(entry.program);
+            return (NULL);
+        }
+
+        entry.localWorkSize = localWorkSize;
+        size_t kernelWorkGroupSize = localWorkSize;
+        clGetKernelWorkGroupInfo(entry.kernel, oclDeviceID, CL_KERNEL_WORK_GROUP_SIZE, sizeof(kernelWorkGroupSize), &kernelWorkGroupSize, NULL);
+        if (entry.localWorkSize > kernelWorkGroupSize)
+            entry.localWorkSize = kernelWorkGroupSize;
+
+        kernelsBuilt++;
+        lastBuiltSource = source;
+
+        std::vector<CachedKernel> &bucket = cache[hash];
+        bucket.push_back(entry);
+        return (&bucket.back());
+    }
+
+    std::unordered_map<unsigned long long, std::vector<CachedKernel>> cache;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// float vector in device memory, assigning an expression to it evaluates the expression
+////////////////////////////////////////////////////////////////////////////////
+class DeviceVector : public Expression<DeviceVector>
+{
+public:
+    DeviceVector(FusedElementwiseEngine &e, size_t n, cl_int *result) : engine(&e), length(n)
+    {
+        buffer = clCreateBuffer(engine->oclContext, CL_MEM_READ_WRITE, length * sizeof(cl_float), NULL, result);
+        if (*result != CL_SUCCESS)
+            buffer = NULL;
+    }
+
+    ~DeviceVector()
+    {
+        if (buffer)
+        {
+            clReleaseMemObject(buffer);
+            buffer = NULL;
+        }
+    }
+
+    cl_int write(const float *host)
+    {
+        return (clEnqueueWriteBuffer(engine->oclCommandQueue, buffer, CL_FALSE, 0, length * sizeof(cl_float), host, 0, NULL, NULL));
+    }
+
+    cl_int read(float *host) const
+    {
+        return (clEnqueueReadBuffer(engine->oclCommandQueue, buffer, CL_TRUE, 0, length * sizeof(cl_float), host, 0, NULL, NULL));
+    }
+
+    //! evaluate expression into this vector, a failure is fatal (use engine.evaluate() to handle it)
+    template <typename E>
+    DeviceVector &operator=(const Expression<E> &expression)
+    {
+        cl_int result = engine->evaluate(*this, expression);
+        if (result != CL_SUCCESS)
+        {
+            printf("error>> Evaluating Fused Elementwise Expression Failed : %d. Terminating Now ...\n", result);
+            exit(EXIT_FAILURE);
+        }
+        return (*this);
+    }
+
+    DeviceVector &operator=(const DeviceVector &other)
+    {
+        return (operator=(VectorTerminal(other)));
+    }
+
+    FusedElementwiseEngine *engine;
+    size_t length;
+    cl_mem buffer;
+
+private:
+    DeviceVector(const DeviceVector &);
+};
+
+inline std::string VectorTerminal::appendSource(std::string &parameters, int &leafIndex) const
+{
+    std::string name = "v" + std::to_string(leafIndex++);
+    parameters += ", __global const float *" + name;
+    return (name + "[i]");
+}
+
+inline cl_int VectorTerminal::setArguments(cl_kernel kernel, cl_uint &argIndex) const
+{
+    return (clSetKernelArg(kernel, argIndex++, sizeof(cl_mem), (void *)&vector->buffer));
+}
+
+inline bool VectorTerminal::hasLength(size_t length) const
+{
+    return (vector->length == length);
+}
+
+template <typename E>
+cl_int FusedElementwiseEngine::evaluate(DeviceVector &output, const Expression<E> &expression)
+{
+    typedef typename ExpressionStorage<E>::type Node;
+
+    const Node node(expression.self());
+    cl_int result = CL_SUCCESS;
+
+    if ((node.hasLength(output.length) == false) || (output.length > 0x7fffffff))
+        return (CL_INVALID_BUFFER_SIZE);
+
+    std::string shape;
+    node.appendShape(shape);
+    unsigned long long hash = hashShape(shape);
+
+    const CachedKernel *entry = findKernel(hash, shape);
+    if (entry != NULL)
+    {
+        cacheHits++;
+    }
+    else
+    {
+        std::string parameters;
+        int leafIndex = 0;
+        std::string value = node.appendSource(parameters, leafIndex);
+
+        entry = buildKernel(hash, shape, parameters, value, &result);
+        if (entry == NULL)
+            return (result);
+    }
+
+    cl_int length = (cl_int)output.length;
+    cl_uint argIndex = 0;
+
+    result = clSetKernelArg(entry->kernel, argIndex++, sizeof(cl_mem), (void *)&output.buffer);
+    result |= clSetKernelArg(entry->kernel, argIndex++, sizeof(cl_int), (void *)&length);
+    if (result == CL_SUCCESS)
+        result = node.setArguments(entry->kernel, argIndex);
+    if (result != CL_SUCCESS)
+        return (result);
+
+    size_t localSize = entry->localWorkSize;
+    size_t globalSize = ((output.length + localSize - 1) / localSize) * localSize;
+
+    return (clEnqueueNDRangeKernel(oclCommandQueue, entry->kernel, 1, NULL, &globalSize, &localSize, 0, NULL, NULL));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// operator overloads building the tree
+////////////////////////////////////////////////////////////////////////////////
+#define FUSED_BINARY_OPERATOR(function, Op)                                                                                                                  \
+    template <typename L, typename R>                                                                                                                        \
+    BinaryExpression<Op, typename ExpressionStorage<L>::type, typename ExpressionStorage<R>::type> function(const Expression<L> &l, const Expression<R> &r) \
+    {                                                                                                                                                        \
+        return (BinaryExpression<Op, typename ExpressionStorage<L>::type, typename ExpressionStorage<R>::type>(l.self(), r.self()));                         \
+    }                                                                                                                                                        \
+                                                                                                                                                             \
+    template <typename L>                                                                                                                                    \
+    BinaryExpression<Op, typename ExpressionStorage<L>::type, ScalarTerminal> function(const Expression<L> &l, float r)                                      \
+    {                                                                                                                                                        \
+        return (BinaryExpression<Op, typename ExpressionStorage<L>::type, ScalarTerminal>(l.self(), ScalarTerminal(r)));                                     \
+    }                                                                                                                                                        \
+                                                                                                                                                             \
+    template <typename R>                                                                                                                                    \
+    BinaryExpression<Op, ScalarTerminal, typename ExpressionStorage<R>::type> function(float l, const Expression<R> &r)                                      \
+    {                                                                                                                                                        \
+        return (BinaryExpression<Op, ScalarTerminal, typename ExpressionStorage<R>::type>(ScalarTerminal(l), r.self()));                                     \
+    }
+
+#define FUSED_UNARY_FUNCTION(function, Op)                                                    \
+    template <typename E>                                                                     \
+    UnaryExpression<Op, typename ExpressionStorage<E>::type> function(const Expression<E> &e) \
+    {                                                                                         \
+        return (UnaryExpression<Op, typename ExpressionStorage<E>::type>(e.self()));          \
+    }
+
+FUSED_BINARY_OPERATOR(operator+, AddOp)
+FUSED_BINARY_OPERATOR(operator-, SubtractOp)
+FUSED_BINARY_OPERATOR(operator*, MultiplyOp)
+FUSED_BINARY_OPERATOR(operator/, DivideOp)
+FUSED_BINARY_OPERATOR(fmin, MinOp)
+FUSED_BINARY_OPERATOR(fmax, MaxOp)
+
+FUSED_UNARY_FUNCTION(operator-, NegateOp)
+FUSED_UNARY_FUNCTION(sqrt, SqrtOp)
+FUSED_UNARY_FUNCTION(exp, ExpOp)
+FUSED_UNARY_FUNCTION(log, LogOp)
+FUSED_UNARY_FUNCTION(fabs, AbsOp)
+
+#undef FUSED_BINARY_OPERATOR
+#undef FUSED_UNARY_FUNCTION
+
+#endif // FUSED_ELEMENTWISE_H
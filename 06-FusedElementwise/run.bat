@@ -0,0 +1,10 @@
+cls
+
+del FusedElementwise.exe
+
+cl.exe FusedElementwise.cpp /c /EHsc /Fo".\FusedElementwise.obj" /I "C:\Program Files\NVIDIA GPU Computing Toolkit\CUDA\v11.1\include" 
+link.exe FusedElementwise.obj opencl.lib /LIBPATH:"C:\Program Files\NVIDIA GPU Computing Toolkit\CUDA\v11.1\lib\x64"
+
+FusedElementwise.exe
+
+del FusedElementwise.obj
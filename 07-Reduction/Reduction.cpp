@@ -0,0 +1,701 @@
+// headers
+#include <stdio.h>
+#include <stdlib.h> // exit()
+#include <string.h> // strcmp(), strstr()
+#include <math.h>   // fabs()
+#include <limits.h> // INT_MAX
+
+#include <CL/opencl.h> // standard OpenCL header
+
+#include "helper_timer.h"
+
+// element types
+#define TYPE_FLOAT 0
+#define TYPE_INT 1
+#define TYPE_DOUBLE 2
+#define NUMBER_OF_TYPES 3
+
+// reductions, argmax returns the value and the smallest index holding it
+#define OP_SUM 0
+#define OP_MIN 1
+#define OP_MAX 2
+#define OP_DOT 3
+#define OP_ARGMAX 4
+#define NUMBER_OF_OPS 5
+
+#define MAX_NUMBER_OF_GROUPS 4096
+
+// global OpenCL variables
+size_t iNumberOfArrayElements = 11444777;
+int numberOfRuns = 10;
+
+cl_platform_id oclPlatformID;
+cl_device_id oclDeviceID;
+
+cl_context oclContext;
+cl_command_queue oclCommandQueue;
+
+// one program per element type and reduction, specialized with -D
+cl_program oclPrograms[NUMBER_OF_TYPES][NUMBER_OF_OPS];
+cl_kernel oclFirstStageKernels[NUMBER_OF_TYPES][NUMBER_OF_OPS];
+cl_kernel oclFinalStageKernels[NUMBER_OF_TYPES][NUMBER_OF_OPS];
+
+const char *typeNames[NUMBER_OF_TYPES] = {"float", "int", "double"};
+const size_t typeSizes[NUMBER_OF_TYPES] = {sizeof(cl_float), sizeof(cl_int), sizeof(cl_double)};
+const char *typeBuildOptions[NUMBER_OF_TYPES] = {
+    "-D T=float -D T_MAX=FLT_MAX -D T_LOWEST=-FLT_MAX",
+    "-D T=int -D T_MAX=INT_MAX -D T_LOWEST=INT_MIN",
+    "-D T=double -D T_MAX=DBL_MAX -D T_LOWEST=-DBL_MAX -D USE_FP64"};
+
+const char *opNames[NUMBER_OF_OPS] = {"sum", "min", "max", "dot", "argmax"};
+const char *opBuildOptions[NUMBER_OF_OPS] = {"-D OP_SUM", "-D OP_MIN", "-D OP_MAX", "-D OP_DOT", "-D OP_ARGMAX"};
+
+bool bDoubleSupported = false;
+const char *subGroupBuildOptions = ""; // empty => local memory tree reduction only
+
+void *hostInput1 = NULL;
+void *hostInput2 = NULL;
+float *hostReadback = NULL;
+
+cl_mem deviceInput1 = NULL;
+cl_mem deviceInput2 = NULL;
+cl_mem devicePartialValues = NULL;
+cl_mem devicePartialIndices = NULL;
+cl_mem deviceResultValue = NULL;
+cl_mem deviceResultIndex = NULL;
+
+size_t localWorkSize = 256;
+size_t numberOfGroups = 0;
+
+// OpenCL kernel
+// reduceFirstStage reduces a grid-stride slice of the input per work-group into partialValues / partialIndices,
+// reduceFinalStage reduces those partials with a single work-group. Within a work-group the values are combined
+// with sub-group reductions where the device has them and a local memory tree otherwise.
+const char *oclSourceCode =
+    "#ifdef USE_FP64                                                                                                          \n"
+    "#pragma OPENCL EXTENSION cl_khr_fp64 : enable                                                                            \n"
+    "#endif                                                                                                                   \n"
+    "#ifdef USE_KHR_SUBGROUPS                                                                                                 \n"
+    "#pragma OPENCL EXTENSION cl_khr_subgroups : enable                                                                       \n"
+    "#endif                                                                                                                   \n"
+    "                                                                                                                         \n"
+    "#if defined(OP_SUM) || defined(OP_DOT)                                                                                   \n"
+    "#define IDENTITY ((T)0)                                                                                                  \n"
+    "#define COMBINE(a, b) ((a) + (b))                                                                                        \n"
+    "#define SUB_GROUP_REDUCE(x) sub_group_reduce_add(x)                                                                      \n"
+    "#elif defined(OP_MIN)                                                                                                    \n"
+    "#define IDENTITY T_MAX                                                                                                   \n"
+    "#define COMBINE(a, b) min(a, b)                                                                                          \n"
+    "#define SUB_GROUP_REDUCE(x) sub_group_reduce_min(x)                                                                      \n"
+    "#else                                                                                                                    \n"
+    "#define IDENTITY T_LOWEST                                                                                                \n"
+    "#define COMBINE(a, b) max(a, b)                                                                                          \n"
+    "#define SUB_GROUP_REDUCE(x) sub_group_reduce_max(x)                                                                      \n"
+    "#endif                                                                                                                   \n"
+    "                                                                                                                         \n"
+    "#ifdef OP_DOT                                                                                                            \n"
+    "#define LOAD(i) (input1[i] * input2[i])                                                                                  \n"
+    "#else                                                                                                                    \n"
+    "#define LOAD(i) (input1[i])                                                                                              \n"
+    "#endif                                                                                                                   \n"
+    "                                                                                                                         \n"
+    "void argMaxCombine(T *value, int *index, T otherValue, int otherIndex)                                                   \n"
+    "{                                                                                                                        \n"
+    "    if((otherValue > *value) || ((otherValue == *value) && (otherIndex < *index)))                                       \n"
+    "    {                                                                                                                    \n"
+    "        *value = otherValue;                                                                                             \n"
+    "        *index = otherIndex;                                                                                             \n"
+    "    }                                                                                                                    \n"
+    "}                                                                                                                        \n"
+    "                                                                                                                         \n"
+    "void workGroupReduce(T *value, int *index, __local T *scratchValues, __local int *scratchIndices)                        \n"
+    "{                                                                                                                        \n"
+    "    int localId = get_local_id(0);                                                                                       \n"
+    "#ifdef USE_SUBGROUPS                                                                                                     \n"
+    "    T subGroupValue = SUB_GROUP_REDUCE(*value);                                                                          \n"
+    "#ifdef OP_ARGMAX                                                                                                         \n"
+    "    int subGroupIndex = sub_group_reduce_min((*value == subGroupValue) ? *index : INT_MAX);                              \n"
+    "#else                                                                                                                    \n"
+    "    int subGroupIndex = INT_MAX;                                                                                         \n"
+    "#endif                                                                                                                   \n"
+    "    if(get_sub_group_local_id() == 0)                                                                                    \n"
+    "    {                                                                                                                    \n"
+    "        scratchValues[get_sub_group_id()] = subGroupValue;                                                               \n"
+    "        scratchIndices[get_sub_group_id()] = subGroupIndex;                                                              \n"
+    "    }                                                                                                                    \n"
+    "    barrier(CLK_LOCAL_MEM_FENCE);                                                                                        \n"
+    "                                                                                                                         \n"
+    "    if(localId == 0)                                                                                                     \n"
+    "    {                                                                                                                    \n"
+    "        for(int subGroup = 1; subGroup < (int)get_num_sub_groups(); subGroup++)                                          \n"
+    "        {                                                                                                                \n"
+    "#ifdef OP_ARGMAX                                                                                                         \n"
+    "            argMaxCombine(&subGroupValue, &subGroupIndex, scratchValues[subGroup], scratchIndices[subGroup]);            \n"
+    "#else                                                                                                                    \n"
+    "            subGroupValue = COMBINE(subGroupValue, scratchValues[subGroup]);                                             \n"
+    "#endif                                                                                                                   \n"
+    "        }                                                                                                                \n"
+    "        *value = subGroupValue;                                                                                          \n"
+    "        *index = subGroupIndex;                                                                                          \n"
+    "    }                                                                                                                    \n"
+    "#else                                                                                                                    \n"
+    "    scratchValues[localId] = *value;                                                                                     \n"
+    "    scratchIndices[localId] = *index;                                                                                    \n"
+    "    barrier(CLK_LOCAL_MEM_FENCE);                                                                                        \n"
+    "                                                                                                                         \n"
+    "    for(int offset = get_local_size(0) / 2; offset > 0; offset >>= 1)                                                    \n"
+    "    {                                                                                                                    \n"
+    "        if(localId < offset)                                                                                             \n"
+    "        {                                                                                                                \n"
+    "#ifdef OP_ARGMAX                                                                                                         \n"
+    "            T pairValue = scratchValues[localId];                                                                        \n"
+    "            int pairIndex = scratchIndices[localId];                                                                     \n"
+    "            argMaxCombine(&pairValue, &pairIndex, scratchValues[localId + offset], scratchIndices[localId + offset]);    \n"
+    "            scratchValues[localId] = pairValue;                                                                          \n"
+    "            scratchIndices[localId] = pairIndex;                                                                         \n"
+    "#else                                                                                                                    \n"
+    "            scratchValues[localId] = COMBINE(scratchValues[localId], scratchValues[localId + offset]);                   \n"
+    "#endif                                                                                                                   \n"
+    "        }                                                                                                                \n"
+    "        barrier(CLK_LOCAL_MEM_FENCE);                                                                                    \n"
+    "    }                                                                                                                    \n"
+    "                                                                                                                         \n"
+    "    *value = scratchValues[0];                                                                                           \n"
+    "    *index = scratchIndices[0];                                                                                          \n"
+    "#endif                                                                                                                   \n"
+    "}                                                                                                                        \n"
+    "                                                                                                                         \n"
+    "__kernel void reduceFirstStage(__global const T *input1, __global const T *input2, int length,                           \n"
+    "                               __global T *partialValues, __global int *partialIndices,                                  \n"
+    "                               __local T *scratchValues, __local int *scratchIndices)                                    \n"
+    "{                                                                                                                        \n"
+    "    T value = IDENTITY;                                                                                                  \n"
+    "    int index = INT_MAX;                                                                                                 \n"
+    "    for(int i = get_global_id(0); i < length; i += get_global_size(0))                                                   \n"
+    "    {                                                                                                                    \n"
+    "#ifdef OP_ARGMAX                                                                                                         \n"
+    "        argMaxCombine(&value, &index, input1[i], i);                                                                     \n"
+    "#else                                                                                                                    \n"
+    "        value = COMBINE(value, LOAD(i));                                                                                 \n"
+    "#endif                                                                                                                   \n"
+    "    }                                                                                                                    \n"
+    "                                                                                                                         \n"
+    "    workGroupReduce(&value, &index, scratchValues, scratchIndices);                                                      \n"
+    "    if(get_local_id(0) == 0)                                                                                             \n"
+    "    {                                                                                                                    \n"
+    "        partialValues[get_group_id(0)] = value;                                                                          \n"
+    "        partialIndices[get_group_id(0)] = index;                                                                         \n"
+    "    }                                                                                                                    \n"
+    "}                                                                                                                        \n"
+    "                                                                                                                         \n"
+    "__kernel void reduceFinalStage(__global const T *partialValues, __global const int *partialIndices, int numberOfPartials,\n"
+    "                               __global T *resultValue, __global int *resultIndex,                                       \n"
+    "                               __local T *scratchValues, __local int *scratchIndices)                                    \n"
+    "{                                                                                                                        \n"
+    "    T value = IDENTITY;                                                                                                  \n"
+    "    int index = INT_MAX;                                                                                                 \n"
+    "    for(int i = get_local_id(0); i < numberOfPartials; i += get_local_size(0))                                           \n"
+    "    {                                                                                                                    \n"
+    "#ifdef OP_ARGMAX                                                                                                         \n"
+    "        argMaxCombine(&value, &index, partialValues[i], partialIndices[i]);                                              \n"
+    "#else                                                                                                                    \n"
+    "        value = COMBINE(value, partialValues[i]);                                                                        \n"
+    "#endif                                                                                                                   \n"
+    "    }                                                                                                                    \n"
+    "                                                                                                                         \n"
+    "    workGroupReduce(&value, &index, scratchValues, scratchIndices);                                                      \n"
+    "    if(get_local_id(0) == 0)                                                                                             \n"
+    "    {                                                                                                                    \n"
+    "        *resultValue = value;                                                                                            \n"
+    "        *resultIndex = index;                                                                                            \n"
+    "    }                                                                                                                    \n"
+    "}                                                                                                                        \n";
+
+// main() definition
+int main(int argc, char *argv[])
+{
+    // local function declaration
+    void buildReductionKernels(int);
+    void fillHostArrays(int);
+    cl_int reduceOnDevice(int, int, void *, cl_int *);
+    void reduceOnHost(int, int, double *, int *);
+    double toDouble(int, const void *);
+    void cleanup(void);
+
+    // local variable declaration
+    bool bUseSubGroups = true;
+    size_t size;
+    cl_int result;
+    bool bAccuracy = true;
+
+    // code
+    // parse command line
+    for (int argIndex = 1; argIndex < argc; argIndex++)
+    {
+        if ((strcmp(argv[argIndex], "-n") == 0) && (argIndex + 1 < argc))
+        {
+            iNumberOfArrayElements = (size_t)strtoull(argv[++argIndex], NULL, 10);
+        }
+        else if ((strcmp(argv[argIndex], "-runs") == 0) && (argIndex + 1 < argc))
+        {
+            numberOfRuns = atoi(argv[++argIndex]);
+        }
+        else if (strcmp(argv[argIndex], "-nosubgroups") == 0)
+        {
+            bUseSubGroups = false;
+        }
+        else
+        {
+            printf("usage : %s [-n elements] [-runs count] [-nosubgroups]\n", argv[0]);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    if ((iNumberOfArrayElements == 0) || (iNumberOfArrayElements > INT_MAX) || (numberOfRuns < 1))
+    {
+        printf("error>> Invalid Element Count Or Run Count. Terminating Now...\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // get OpenCL supporting platform's ID
+    result = clGetPlatformIDs(1, &oclPlatformID, NULL);
+    if (result != CL_SUCCESS)
+    {
+        printf("error>> clGetPlatformIDs() Failed : %d. Terminating Now ...\n", result);
+        cleanup();
+        exit(EXIT_FAILURE);
+    }
+
+    // get OpenCL supporting GPU device's ID
+    result = clGetDeviceIDs(oclPlatformID, CL_DEVICE_TYPE_GPU, 1, &oclDeviceID, NULL);
+    if (result != CL_SUCCESS)
+    {
+        printf("error>> clGetDeviceIDs() Failed : %d. Terminating Now ...\n", result);
+        cleanup();
+        exit(EXIT_FAILURE);
+    }
+
+    // double needs cl_khr_fp64, sub-group reductions need cl_khr_subgroups (OpenCL C 2.0) or cl_intel_subgroups
+    char extensions[4096] = "";
+    clGetDeviceInfo(oclDeviceID, CL_DEVICE_EXTENSIONS, sizeof(extensions), extensions, NULL);
+    bDoubleSupported = (strstr(extensions, "cl_khr_fp64") != NULL);
+    if (bUseSubGroups == true)
+    {
+        if (strstr(extensions, "cl_intel_subgroups") != NULL)
+            subGroupBuildOptions = "-D USE_SUBGROUPS";
+        else if (strstr(extensions, "cl_khr_subgroups") != NULL)
+            subGroupBuildOptions = "-cl-std=CL2.0 -D USE_SUBGROUPS -D USE_KHR_SUBGROUPS";
+    }
+
+    // create OpenCL compute context
+    oclContext = clCreateContext(NULL, 1, &oclDeviceID, NULL, NULL, &result);
+    if (result != CL_SUCCESS)
+    {
+        printf("error>> clCreateContext() Failed : %d. Terminating Now ...\n", result);
+        cleanup();
+        exit(EXIT_FAILURE);
+    }
+
+    // create command queue
+    oclCommandQueue = clCreateCommandQueue(oclContext, oclDeviceID, 0, &result);
+    if (result != CL_SUCCESS)
+    {
+        printf("error>> clCreateCommandQueue() Failed : %d. Terminating Now ...\n", result);
+        cleanup();
+        exit(EXIT_FAILURE);
+    }
+
+    // host memory allocation, sized for the widest element type
+    size = iNumberOfArrayElements * sizeof(cl_double);
+    hostInput1 = malloc(size);
+    hostInput2 = malloc(size);
+    hostReadback = (float *)malloc(iNumberOfArrayElements * sizeof(cl_float));
+    if ((hostInput1 == NULL) || (hostInput2 == NULL) || (hostReadback == NULL))
+    {
+        printf("error>> Host Memory Allocation Failed. Terminating Now...\n");
+        cleanup();
+        exit(EXIT_FAILURE);
+    }
+
+    // allocate device memory
+    deviceInput1 = clCreateBuffer(oclContext, CL_MEM_READ_ONLY, size, NULL, &result);
+    if (result == CL_SUCCESS)
+        deviceInput2 = clCreateBuffer(oclContext, CL_MEM_READ_ONLY, size, NULL, &result);
+    if (result == CL_SUCCESS)
+        devicePartialValues = clCreateBuffer(oclContext, CL_MEM_READ_WRITE, MAX_NUMBER_OF_GROUPS * sizeof(cl_double), NULL, &result);
+    if (result == CL_SUCCESS)
+        devicePartialIndices = clCreateBuffer(oclContext, CL_MEM_READ_WRITE, MAX_NUMBER_OF_GROUPS * sizeof(cl_int), NULL, &result);
+    if (result == CL_SUCCESS)
+        deviceResultValue = clCreateBuffer(oclContext, CL_MEM_WRITE_ONLY, sizeof(cl_double), NULL, &result);
+    if (result == CL_SUCCESS)
+        deviceResultIndex = clCreateBuffer(oclContext, CL_MEM_WRITE_ONLY, sizeof(cl_int), NULL, &result);
+    if (result != CL_SUCCESS)
+    {
+        printf("error>> clCreateBuffer() Failed : %d. Terminating Now ...\n", result);
+        cleanup();
+        exit(EXIT_FAILURE);
+    }
+
+    printf("\n==================================================================================\n");
+    printf("+ DEVICE REDUCTIONS OF %zu ELEMENTS (%s) +\n", iNumberOfArrayElements, (subGroupBuildOptions[0] != '\0') ? "Sub-Group Operations" : "Local Memory Tree");
+    printf("==================================================================================\n");
+
+    for (int type = 0; type < NUMBER_OF_TYPES; type++)
+    {
+        if ((type == TYPE_DOUBLE) && (bDoubleSupported == false))
+        {
+            printf("- double : Skipped, Device Does Not Support cl_khr_fp64\n");
+            continue;
+        }
+
+        // device code for all reductions of this type, the launch configuration follows the first one built
+        buildReductionKernels(type);
+
+        fillHostArrays(type);
+
+        size = iNumberOfArrayElements * typeSizes[type];
+        result = clEnqueueWriteBuffer(oclCommandQueue, deviceInput1, CL_FALSE, 0, size, hostInput1, 0, NULL, NULL);
+        result |= clEnqueueWriteBuffer(oclCommandQueue, deviceInput2, CL_TRUE, 0, size, hostInput2, 0, NULL, NULL);
+        if (result != CL_SUCCESS)
+        {
+            printf("error>> clEnqueueWriteBuffer() Failed : %d. Terminating Now ...\n", result);
+            cleanup();
+            exit(EXIT_FAILURE);
+        }
+
+        for (int op = 0; op < NUMBER_OF_OPS; op++)
+        {
+            unsigned char deviceValue[sizeof(cl_double)];
+            cl_int deviceIndex = 0;
+
+            // warm-up, then the average of numberOfRuns reductions including the read of the scalar result
+            result = reduceOnDevice(type, op, deviceValue, &deviceIndex);
+
+            StopWatchInterface *timer = NULL;
+            sdkCreateTimer(&timer);
+            sdkStartTimer(&timer);
+
+            for (int run = 0; (run < numberOfRuns) && (result == CL_SUCCESS); run++)
+                result = reduceOnDevice(type, op, deviceValue, &deviceIndex);
+
+            sdkStopTimer(&timer);
+            float timeOnGPU = sdkGetTimerValue(&timer) / numberOfRuns;
+            sdkDeleteTimer(&timer);
+            timer = NULL;
+
+            if (result != CL_SUCCESS)
+            {
+                printf("error>> Reduction %s Of %s Failed : %d. Terminating Now ...\n", opNames[op], typeNames[type], result);
+                cleanup();
+                exit(EXIT_FAILURE);
+            }
+
+            double hostValue;
+            int hostIndex;
+            reduceOnHost(type, op, &hostValue, &hostIndex);
+
+            // sums of floating point values depend on the order of the additions
+            double gpuValue = toDouble(type, deviceValue);
+            double tolerance = 0.0;
+            if (((op == OP_SUM) || (op == OP_DOT)) && (type != TYPE_INT))
+                tolerance = ((type == TYPE_FLOAT) ? 1.0e-4 : 1.0e-10) * fabs(hostValue);
+
+            bool bMatch = (fabs(gpuValue - hostValue) <= tolerance) && ((op != OP_ARGMAX) || (deviceIndex == hostIndex));
+            bAccuracy = bAccuracy && bMatch;
+
+            double gigaBytes = (double)((op == OP_DOT) ? 2 : 1) * size / 1.0e9;
+            if (op == OP_ARGMAX)
+                printf("- %-6s %-6s : GPU %0.6f At %d, CPU %0.6f At %d, %0.6f (ms), %0.3f (GB/s)%s\n", typeNames[type], opNames[op], gpuValue, deviceIndex, hostValue, hostIndex, timeOnGPU, gigaBytes / (timeOnGPU / 1000.0), bMatch ? "" : " MISMATCH");
+            else
+                printf("- %-6s %-6s : GPU %0.6f, CPU %0.6f, %0.6f (ms), %0.3f (GB/s)%s\n", typeNames[type], opNames[op], gpuValue, hostValue, timeOnGPU, gigaBytes / (timeOnGPU / 1000.0), bMatch ? "" : " MISMATCH");
+        }
+    }
+
+    // what the reductions replace : reading the whole float array back to reduce it on the host
+    StopWatchInterface *timer = NULL;
+    sdkCreateTimer(&timer);
+    sdkStartTimer(&timer);
+
+    result = clEnqueueReadBuffer(oclCommandQueue, deviceInput1, CL_TRUE, 0, iNumberOfArrayElements * sizeof(cl_float), hostReadback, 0, NULL, NULL);
+
+    sdkStopTimer(&timer);
+    float timeOnReadback = sdkGetTimerValue(&timer);
+    sdkDeleteTimer(&timer);
+    timer = NULL;
+
+    if (result == CL_SUCCESS)
+        printf("\n- Reading %zu Floats Back To The Host Instead = %0.6f (ms) For %0.3f (MB)\n", iNumberOfArrayElements, timeOnReadback, iNumberOfArrayElements * sizeof(cl_float) / 1.0e6);
+    printf("- Work-Groups = %zu Of %zu Work-Items, Then 1 Work-Group Over The Partials\n", numberOfGroups, localWorkSize);
+
+    if (bAccuracy == true)
+        printf("# Comparison Of CPU And GPU Reductions Is With Accuracy Of Limit Of 0.0001 (Relative, Floating Point Sums).\n");
+    else
+        printf("# Comparison Of CPU And GPU Reductions Is Not With Accuracy Of Limit Of 0.0001 (Relative, Floating Point Sums).\n");
+    printf("==================================================================================\n");
+
+    // total cleanup
+    cleanup();
+
+    return (0);
+}
+
+// buildReductionKernels() definition
+void buildReductionKernels(int type)
+{
+    // local function declaration
+    void cleanup(void);
+
+    // local variable declaration
+    cl_int result;
+    char options[512];
+
+    // code
+    for (int op = 0; op < NUMBER_OF_OPS; op++)
+    {
+        sprintf(options, "%s %s %s", typeBuildOptions[type], opBuildOptions[op], subGroupBuildOptions);
+
+        // create OpenCL program from .cl
+        oclPrograms[type][op] = clCreateProgramWithSource(oclContext, 1, (const char **)&oclSourceCode, NULL, &result);
+        if (result != CL_SUCCESS)
+        {
+            printf("error>> clCreateProgramWithSource() Failed : %d. Terminating Now ...\n", result);
+            cleanup();
+            exit(EXIT_FAILURE);
+        }
+
+        // build OpenCL program
+        result = clBuildProgram(oclPrograms[type][op], 0, NULL, options, NULL, NULL);
+        if (result != CL_SUCCESS)
+        {
+            size_t len;
+            char buffer[2048];
+            clGetProgramBuildInfo(oclPrograms[type][op], oclDeviceID, CL_PROGRAM_BUILD_LOG, sizeof(buffer), buffer, &len);
+            printf("OpenCL Program Build Log : %s\n", buffer);
+            printf("error>> clBuildProgram() Failed For %s : %d. Terminating Now ...\n", options, result);
+            cleanup();
+            exit(EXIT_FAILURE);
+        }
+
+        oclFirstStageKernels[type][op] = clCreateKernel(oclPrograms[type][op], "reduceFirstStage", &result);
+        if (result == CL_SUCCESS)
+            oclFinalStageKernels[type][op] = clCreateKernel(oclPrograms[type][op], "reduceFinalStage", &result);
+        if (result != CL_SUCCESS)
+        {
+            printf("error>> clCreateKernel() Failed For %s : %d. Terminating Now ...\n", options, result);
+            cleanup();
+            exit(EXIT_FAILURE);
+        }
+
+        // the local memory tree needs a power of 2 work-group size, the same for every kernel
+        size_t kernelWorkGroupSize = localWorkSize;
+        clGetKernelWorkGroupInfo(oclFirstStageKernels[type][op], oclDeviceID, CL_KERNEL_WORK_GROUP_SIZE, sizeof(kernelWorkGroupSize), &kernelWorkGroupSize, NULL);
+        while (localWorkSize > kernelWorkGroupSize)
+            localWorkSize /= 2;
+        clGetKernelWorkGroupInfo(oclFinalStageKernels[type][op], oclDeviceID, CL_KERNEL_WORK_GROUP_SIZE, sizeof(kernelWorkGroupSize), &kernelWorkGroupSize, NULL);
+        while (localWorkSize > kernelWorkGroupSize)
+            localWorkSize /= 2;
+    }
+
+    // enough work-groups to fill the device, each work-item then loops over several elements
+    cl_uint computeUnits = 1;
+    clGetDeviceInfo(oclDeviceID, CL_DEVICE_MAX_COMPUTE_UNITS, sizeof(computeUnits), &computeUnits, NULL);
+
+    numberOfGroups = (iNumberOfArrayElements + localWorkSize - 1) / localWorkSize;
+    if (numberOfGroups > (size_t)computeUnits * 8)
+        numberOfGroups = (size_t)computeUnits * 8;
+    if (numberOfGroups > MAX_NUMBER_OF_GROUPS)
+        numberOfGroups = MAX_NUMBER_OF_GROUPS;
+}
+
+// reduceOnDevice() definition
+cl_int reduceOnDevice(int type, int op, void *value, cl_int *index)
+{
+    // local variable declaration
+    cl_kernel firstStageKernel = oclFirstStageKernels[type][op];
+    cl_kernel finalStageKernel = oclFinalStageKernels[type][op];
+    cl_int length = (cl_int)iNumberOfArrayElements;
+    cl_int numberOfPartials = (cl_int)numberOfGroups;
+    size_t globalWorkSize = numberOfGroups * localWorkSize;
+    cl_int result;
+
+    // code
+    result = clSetKernelArg(firstStageKernel, 0, sizeof(cl_mem), (void *)&deviceInput1);
+    result |= clSetKernelArg(firstStageKernel, 1, sizeof(cl_mem), (void *)&deviceInput2);
+    result |= clSetKernelArg(firstStageKernel, 2, sizeof(cl_int), (void *)&length);
+    result |= clSetKernelArg(firstStageKernel, 3, sizeof(cl_mem), (void *)&devicePartialValues);
+    result |= clSetKernelArg(firstStageKernel, 4, sizeof(cl_mem), (void *)&devicePartialIndices);
+    result |= clSetKernelArg(firstStageKernel, 5, localWorkSize * typeSizes[type], NULL);
+    result |= clSetKernelArg(firstStageKernel, 6, localWorkSize * sizeof(cl_int), NULL);
+    if (result != CL_SUCCESS)
+        return (result);
+
+    result = clEnqueueNDRangeKernel(oclCommandQueue, firstStageKernel, 1, NULL, &globalWorkSize, &localWorkSize, 0, NULL, NULL);
+    if (result != CL_SUCCESS)
+        return (result);
+
+    result = clSetKernelArg(finalStageKernel, 0, sizeof(cl_mem), (void *)&devicePartialValues);
+    result |= clSetKernelArg(finalStageKernel, 1, sizeof(cl_mem), (void *)&devicePartialIndices);
+    result |= clSetKernelArg(finalStageKernel, 2, sizeof(cl_int), (void *)&numberOfPartials);
+    result |= clSetKernelArg(finalStageKernel, 3, sizeof(cl_mem), (void *)&deviceResultValue);
+    result |= clSetKernelArg(finalStageKernel, 4, sizeof(cl_mem), (void *)&deviceResultIndex);
+    result |= clSetKernelArg(finalStageKernel, 5, localWorkSize * typeSizes[type], NULL);
+    result |= clSetKernelArg(finalStageKernel, 6, localWorkSize * sizeof(cl_int), NULL);
+    if (result != CL_SUCCESS)
+        return (result);
+
+    result = clEnqueueNDRangeKernel(oclCommandQueue, finalStageKernel, 1, NULL, &localWorkSize, &localWorkSize, 0, NULL, NULL);
+    if (result != CL_SUCCESS)
+        return (result);
+
+    // only the scalar result (and its index) crosses the bus
+    result = clEnqueueReadBuffer(oclCommandQueue, deviceResultValue, CL_FALSE, 0, typeSizes[type], value, 0, NULL, NULL);
+    if (result != CL_SUCCESS)
+        return (result);
+
+    return (clEnqueueReadBuffer(oclCommandQueue, deviceResultIndex, CL_TRUE, 0, sizeof(cl_int), index, 0, NULL, NULL));
+}
+
+// fillHostArrays() definition
+void fillHostArrays(int type)
+{
+    // code
+    // ints stay within [-8, 8] so that neither the sum nor the dot product overflows
+    for (size_t index = 0; index < iNumberOfArrayElements; index++)
+    {
+        if (type == TYPE_FLOAT)
+        {
+            ((float *)hostInput1)[index] = (float)rand() / (float)RAND_MAX;
+            ((float *)hostInput2)[index] = (float)rand() / (float)RAND_MAX;
+        }
+        else if (type == TYPE_INT)
+        {
+            ((int *)hostInput1)[index] = (rand() % 17) - 8;
+            ((int *)hostInput2)[index] = (rand() % 17) - 8;
+        }
+        else
+        {
+            ((double *)hostInput1)[index] = (double)rand() / (double)RAND_MAX;
+            ((double *)hostInput2)[index] = (double)rand() / (double)RAND_MAX;
+        }
+    }
+}
+
+// toDouble() definition
+double toDouble(int type, const void *value)
+{
+    // code
+    if (type == TYPE_FLOAT)
+        return ((double)*(const float *)value);
+    else if (type == TYPE_INT)
+        return ((double)*(const int *)value);
+    else
+        return (*(const double *)value);
+}
+
+// reduceOnHost() definition
+void reduceOnHost(int type, int op, double *value, int *index)
+{
+    // local function declaration
+    double toDouble(int, const void *);
+
+    // local variable declaration
+    const char *input1 = (const char *)hostInput1;
+    const char *input2 = (const char *)hostInput2;
+    size_t elementSize = typeSizes[type];
+
+    // code
+    // all reference values are accumulated in double, exact for the int inputs
+    double result = (op == OP_SUM || op == OP_DOT) ? 0.0 : toDouble(type, input1);
+    *index = 0;
+
+    for (size_t element = 0; element < iNumberOfArrayElements; element++)
+    {
+        double x = toDouble(type, input1 + element * elementSize);
+
+        if (op == OP_SUM)
+            result += x;
+        else if (op == OP_DOT)
+            result += x * toDouble(type, input2 + element * elementSize);
+        else if ((op == OP_MIN) && (x < result))
+            result = x;
+        else if (((op == OP_MAX) || (op == OP_ARGMAX)) && (x > result))
+        {
+            result = x;
+            *index = (int)element;
+        }
+    }
+
+    *value = result;
+}
+
+// cleanup() definition
+void cleanup(void)
+{
+    // code
+    // OpenCL cleanup
+    for (int type = 0; type < NUMBER_OF_TYPES; type++)
+    {
+        for (int op = 0; op < NUMBER_OF_OPS; op++)
+        {
+            if (oclFinalStageKernels[type][op])
+            {
+                clReleaseKernel(oclFinalStageKernels[type][op]);
+                oclFinalStageKernels[type][op] = NULL;
+            }
+
+            if (oclFirstStageKernels[type][op])
+            {
+                clReleaseKernel(oclFirstStageKernels[type][op]);
+                oclFirstStageKernels[type][op] = NULL;
+            }
+
+            if (oclPrograms[type][op])
+            {
+                clReleaseProgram(oclPrograms[type][op]);
+                oclPrograms[type][op] = NULL;
+            }
+        }
+    }
+
+    // free allocated device memory
+    cl_mem *deviceBuffers[] = {&deviceResultIndex, &deviceResultValue, &devicePartialIndices, &devicePartialValues, &deviceInput2, &deviceInput1};
+    for (int index = 0; index < 6; index++)
+    {
+        if (*deviceBuffers[index])
+        {
+            clReleaseMemObject(*deviceBuffers[index]);
+            *deviceBuffers[index] = NULL;
+        }
+    }
+
+    if (oclCommandQueue)
+    {
+        clReleaseCommandQueue(oclCommandQueue);
+        oclCommandQueue = NULL;
+    }
+
+    if (oclContext)
+    {
+        clReleaseContext(oclContext);
+        oclContext = NULL;
+    }
+
+    // free allocated host memory
+    if (hostReadback)
+    {
+        free(hostReadback);
+        hostReadback = NULL;
+    }
+
+    if (hostInput2)
+    {
+        free(hostInput2);
+        hostInput2 = NULL;
+    }
+
+    if (hostInput1)
+    {
+        free(hostInput1);
+        hostInput1 = NULL;
+    }
+}
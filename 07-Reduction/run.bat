@@ -0,0 +1,11 @@
+cls
+
+del Reduction.exe
+
+cl.exe Reduction.cpp /c /EHsc /Fo".\Reduction.obj" /I "C:\Program Files\NVIDIA GPU Computing Toolkit\CUDA\v11.1\include" 
+link.exe Reduction.obj opencl.lib /LIBPATH:"C:\Program Files\NVIDIA GPU Computing Toolkit\CUDA\v11.1\lib\x64"
+
+Reduction.exe
+Reduction.exe -nosubgroups
+
+del Reduction.obj
@@ -0,0 +1,513 @@
+// headers
+#include <stdio.h>
+#include <stdlib.h> // exit()
+#include <string.h> // strcmp()
+#include <math.h>   // fabs()
+#include <limits.h> // INT_MAX
+#include <limits>   // std::numeric_limits
+#include <vector>
+
+#include <CL/opencl.h> // standard OpenCL header
+
+#include "helper_timer.h"
+#include "helper_parallel.h"
+#include "helper_scan.h"
+
+// element types
+#define TYPE_INT 0
+#define TYPE_FLOAT 1
+#define NUMBER_OF_TYPES 2
+
+// global OpenCL variables
+size_t iNumberOfArrayElements = 11444777;
+int numberOfRuns = 10;
+int elementType = TYPE_INT;
+int scanOperator = 0; // index into scanOperators
+
+cl_platform_id oclPlatformID;
+cl_device_id oclDeviceID;
+
+cl_context oclContext;
+cl_command_queue oclCommandQueue;
+
+cl_program oclProgram;
+ScanKernels oclScanKernels = {};
+
+const char *typeNames[NUMBER_OF_TYPES] = {"int", "float"};
+const size_t typeSizes[NUMBER_OF_TYPES] = {sizeof(cl_int), sizeof(cl_float)};
+const char *typeBuildOptions[NUMBER_OF_TYPES] = {
+    "-D T=int -D T_MAX=INT_MAX -D T_LOWEST=INT_MIN",
+    "-D T=float -D T_MAX=FLT_MAX -D T_LOWEST=-FLT_MAX"};
+
+void *hostInput = NULL;
+void *hostOutput = NULL;
+void *gold = NULL;
+
+cl_mem deviceInput = NULL;
+cl_mem deviceOutput = NULL;
+cl_mem deviceSegmentSums = NULL;
+
+float timeOnCPU = 0.0f;
+float timeOnCPUParallel = 0.0f;
+float timeOnGPU = 0.0f;
+
+// host side of the scan operators, the same combine and identity as SCAN_OP and SCAN_IDENTITY in scanOperators
+template <typename T>
+struct ScanAdd
+{
+    static T combine(T a, T b) { return (a + b); }
+    static T identity(void) { return ((T)0); }
+};
+
+template <typename T>
+struct ScanMax
+{
+    static T combine(T a, T b) { return ((a > b) ? a : b); }
+    static T identity(void) { return (std::numeric_limits<T>::lowest()); }
+};
+
+template <typename T>
+struct ScanMin
+{
+    static T combine(T a, T b) { return ((a < b) ? a : b); }
+    static T identity(void) { return (std::numeric_limits<T>::max()); }
+};
+
+// scanOnHost() definition
+template <typename T, template <typename> class OP>
+void scanOnHost(const T *input, T *output, size_t length, bool bInclusive)
+{
+    // code
+    T running = OP<T>::identity();
+    for (size_t index = 0; index < length; index++)
+    {
+        T value = input[index];
+        if (bInclusive == true)
+        {
+            running = OP<T>::combine(running, value);
+            output[index] = running;
+        }
+        else
+        {
+            output[index] = running;
+            running = OP<T>::combine(running, value);
+        }
+    }
+}
+
+// scanOnHostParallel() definition
+template <typename T, template <typename> class OP>
+void scanOnHostParallel(const T *input, T *output, size_t length, bool bInclusive)
+{
+    // code
+    // same three phases as the device : reduce every thread's range, scan the range sums, scan every range from its prefix
+    unsigned int numberOfThreads = getNumberOfCPUThreads();
+    std::vector<T> rangeSums(numberOfThreads + 1, OP<T>::identity());
+
+    parallelFor(length, 1024, numberOfThreads, [&](size_t begin, size_t end, unsigned int threadIndex) {
+        T sum = OP<T>::identity();
+        for (size_t index = begin; index < end; index++)
+            sum = OP<T>::combine(sum, input[index]);
+        rangeSums[threadIndex + 1] = sum;
+    });
+
+    for (unsigned int threadIndex = 1; threadIndex <= numberOfThreads; threadIndex++)
+        rangeSums[threadIndex] = OP<T>::combine(rangeSums[threadIndex - 1], rangeSums[threadIndex]);
+
+    parallelFor(length, 1024, numberOfThreads, [&](size_t begin, size_t end, unsigned int threadIndex) {
+        T running = rangeSums[threadIndex];
+        for (size_t index = begin; index < end; index++)
+        {
+            T value = input[index];
+            if (bInclusive == true)
+            {
+                running = OP<T>::combine(running, value);
+                output[index] = running;
+            }
+            else
+            {
+                output[index] = running;
+                running = OP<T>::combine(running, value);
+            }
+        }
+    });
+}
+
+// scanOnHostTimed() definition
+template <typename T, template <typename> class OP>
+void scanOnHostTimed(bool bInclusive)
+{
+    // code
+    // sequential reference into gold, threaded version into hostOutput
+    StopWatchInterface *timer = NULL;
+    sdkCreateTimer(&timer);
+
+    sdkStartTimer(&timer);
+    scanOnHost<T, OP>((const T *)hostInput, (T *)gold, iNumberOfArrayElements, bInclusive);
+    sdkStopTimer(&timer);
+    timeOnCPU = sdkGetTimerValue(&timer);
+
+    sdkResetTimer(&timer);
+    sdkStartTimer(&timer);
+    scanOnHostParallel<T, OP>((const T *)hostInput, (T *)hostOutput, iNumberOfArrayElements, bInclusive);
+    sdkStopTimer(&timer);
+    timeOnCPUParallel = sdkGetTimerValue(&timer);
+
+    sdkDeleteTimer(&timer);
+    timer = NULL;
+}
+
+// scan operators, a new associative operator is a host functor above and one row here
+struct ScanOperator
+{
+    const char *name;                          // -op argument
+    const char *buildOptions;                  // SCAN_OP and SCAN_IDENTITY for the kernels
+    void (*scanOnHost[NUMBER_OF_TYPES])(bool); // scanOnHostTimed() for every element type
+    float floatTolerance;                      // relative error allowed on floats, 0 when the order of operations does not matter
+};
+
+const ScanOperator scanOperators[] = {
+    {"add", "-D SCAN_OP(a,b)=((a)+(b)) -D SCAN_IDENTITY=((T)0)", {scanOnHostTimed<int, ScanAdd>, scanOnHostTimed<float, ScanAdd>}, 0.001f},
+    {"max", "-D SCAN_OP(a,b)=max(a,b) -D SCAN_IDENTITY=T_LOWEST", {scanOnHostTimed<int, ScanMax>, scanOnHostTimed<float, ScanMax>}, 0.0f},
+    {"min", "-D SCAN_OP(a,b)=min(a,b) -D SCAN_IDENTITY=T_MAX", {scanOnHostTimed<int, ScanMin>, scanOnHostTimed<float, ScanMin>}, 0.0f}};
+
+#define NUMBER_OF_SCAN_OPERATORS ((int)(sizeof(scanOperators) / sizeof(scanOperators[0])))
+
+// compareWithGold() definition
+// sums of floats depend on the order of the additions, the operator's floatTolerance allows for that
+bool compareWithGold(const void *result, size_t *pBreakValue)
+{
+    // code
+    for (size_t index = 0; index < iNumberOfArrayElements; index++)
+    {
+        bool bMatch;
+        if (elementType == TYPE_INT)
+        {
+            bMatch = (((const int *)result)[index] == ((const int *)gold)[index]);
+        }
+        else
+        {
+            float expected = ((const float *)gold)[index];
+            float tolerance = scanOperators[scanOperator].floatTolerance * fmaxf(1.0f, fabsf(expected));
+            bMatch = (fabsf(((const float *)result)[index] - expected) <= tolerance);
+        }
+
+        if (bMatch == false)
+        {
+            *pBreakValue = index;
+            return (false);
+        }
+    }
+
+    return (true);
+}
+
+// main() definition
+int main(int argc, char *argv[])
+{
+    // local function declaration
+    void fillHostInput(void);
+    bool compareWithGold(const void *, size_t *);
+    cl_int scanOnDevice(cl_int);
+    void cleanup(void);
+
+    // local variable declaration
+    size_t size;
+    cl_int result;
+    char options[512];
+    bool bAccuracy = true;
+
+    // code
+    // parse command line
+    for (int argIndex = 1; argIndex < argc; argIndex++)
+    {
+        if ((strcmp(argv[argIndex], "-n") == 0) && (argIndex + 1 < argc))
+        {
+            iNumberOfArrayElements = (size_t)strtoull(argv[++argIndex], NULL, 10);
+        }
+        else if ((strcmp(argv[argIndex], "-runs") == 0) && (argIndex + 1 < argc))
+        {
+            numberOfRuns = atoi(argv[++argIndex]);
+        }
+        else if ((strcmp(argv[argIndex], "-type") == 0) && (argIndex + 1 < argc))
+        {
+            argIndex++;
+            elementType = -1;
+            for (int type = 0; type < NUMBER_OF_TYPES; type++)
+            {
+                if (strcmp(argv[argIndex], typeNames[type]) == 0)
+                    elementType = type;
+            }
+        }
+        else if ((strcmp(argv[argIndex], "-op") == 0) && (argIndex + 1 < argc))
+        {
+            argIndex++;
+            scanOperator = -1;
+            for (int op = 0; op < NUMBER_OF_SCAN_OPERATORS; op++)
+            {
+                if (strcmp(argv[argIndex], scanOperators[op].name) == 0)
+                    scanOperator = op;
+            }
+        }
+        else
+        {
+            printf("usage : %s [-n elements] [-runs count] [-type int|float] [-op ", argv[0]);
+            for (int op = 0; op < NUMBER_OF_SCAN_OPERATORS; op++)
+                printf((op == 0) ? "%s" : "|%s", scanOperators[op].name);
+            printf("]\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    if ((iNumberOfArrayElements == 0) || (iNumberOfArrayElements > INT_MAX) || (numberOfRuns < 1) || (elementType < 0) || (scanOperator < 0))
+    {
+        printf("error>> Invalid Element Count, Run Count, Type Or Operator. Terminating Now...\n");
+        exit(EXIT_FAILURE);
+    }
+
+    size = iNumberOfArrayElements * typeSizes[elementType];
+
+    // host memory allocation
+    hostInput = malloc(size);
+    hostOutput = malloc(size);
+    gold = malloc(size);
+    if ((hostInput == NULL) || (hostOutput == NULL) || (gold == NULL))
+    {
+        printf("error>> Host Memory Allocation Failed. Terminating Now...\n");
+        cleanup();
+        exit(EXIT_FAILURE);
+    }
+
+    // filling values into host array
+    fillHostInput();
+
+    // get OpenCL supporting platform's ID
+    result = clGetPlatformIDs(1, &oclPlatformID, NULL);
+    if (result != CL_SUCCESS)
+    {
+        printf("error>> clGetPlatformIDs() Failed : %d. Terminating Now ...\n", result);
+        cleanup();
+        exit(EXIT_FAILURE);
+    }
+
+    // get OpenCL supporting GPU device's ID
+    result = clGetDeviceIDs(oclPlatformID, CL_DEVICE_TYPE_GPU, 1, &oclDeviceID, NULL);
+    if (result != CL_SUCCESS)
+    {
+        printf("error>> clGetDeviceIDs() Failed : %d. Terminating Now ...\n", result);
+        cleanup();
+        exit(EXIT_FAILURE);
+    }
+
+    // create OpenCL compute context
+    oclContext = clCreateContext(NULL, 1, &oclDeviceID, NULL, NULL, &result);
+    if (result != CL_SUCCESS)
+    {
+        printf("error>> clCreateContext() Failed : %d. Terminating Now ...\n", result);
+        cleanup();
+        exit(EXIT_FAILURE);
+    }
+
+    // create command queue
+    oclCommandQueue = clCreateCommandQueue(oclContext, oclDeviceID, 0, &result);
+    if (result != CL_SUCCESS)
+    {
+        printf("error>> clCreateCommandQueue() Failed : %d. Terminating Now ...\n", result);
+        cleanup();
+        exit(EXIT_FAILURE);
+    }
+
+    // create OpenCL program from .cl
+    oclProgram = clCreateProgramWithSource(oclContext, 1, (const char **)&oclScanSourceCode, NULL, &result);
+    if (result != CL_SUCCESS)
+    {
+        printf("error>> clCreateProgramWithSource() Failed : %d. Terminating Now ...\n", result);
+        cleanup();
+        exit(EXIT_FAILURE);
+    }
+
+    // build OpenCL program, specialized for the element type and the operator
+    sprintf(options, "%s %s -D ITEMS_PER_WORK_ITEM=%d", typeBuildOptions[elementType], scanOperators[scanOperator].buildOptions, SCAN_ITEMS_PER_WORK_ITEM);
+    result = clBuildProgram(oclProgram, 0, NULL, options, NULL, NULL);
+    if (result != CL_SUCCESS)
+    {
+        size_t len;
+        char buffer[2048];
+        clGetProgramBuildInfo(oclProgram, oclDeviceID, CL_PROGRAM_BUILD_LOG, sizeof(buffer), buffer, &len);
+        printf("OpenCL Program Build Log : %s\n", buffer);
+        printf("error>> clBuildProgram() Failed : %d. Terminating Now ...\n", result);
+        cleanup();
+        exit(EXIT_FAILURE);
+    }
+
+    // create OpenCL kernels by passing kernel function names that we used in .cl file
+    result = createScanKernels(oclProgram, oclDeviceID, typeSizes[elementType], 256, &oclScanKernels);
+    if (result != CL_SUCCESS)
+    {
+        printf("error>> clCreateKernel() Failed : %d. Terminating Now ...\n", result);
+        cleanup();
+        exit(EXIT_FAILURE);
+    }
+
+    // kernel configuration, one segment per work-group
+    cl_uint computeUnits = 1;
+    clGetDeviceInfo(oclDeviceID, CL_DEVICE_MAX_COMPUTE_UNITS, sizeof(computeUnits), &computeUnits, NULL);
+    configureScan(&oclScanKernels, iNumberOfArrayElements, computeUnits);
+
+    // allocate device memory
+    deviceInput = clCreateBuffer(oclContext, CL_MEM_READ_ONLY, size, NULL, &result);
+    if (result == CL_SUCCESS)
+        deviceOutput = clCreateBuffer(oclContext, CL_MEM_READ_WRITE, size, NULL, &result);
+    if (result == CL_SUCCESS)
+        deviceSegmentSums = clCreateBuffer(oclContext, CL_MEM_READ_WRITE, oclScanKernels.localWorkSize * typeSizes[elementType], NULL, &result);
+    if (result != CL_SUCCESS)
+    {
+        printf("error>> clCreateBuffer() Failed : %d. Terminating Now ...\n", result);
+        cleanup();
+        exit(EXIT_FAILURE);
+    }
+
+    // write above "input" device buffer to device memory
+    result = clEnqueueWriteBuffer(oclCommandQueue, deviceInput, CL_TRUE, 0, size, hostInput, 0, NULL, NULL);
+    if (result != CL_SUCCESS)
+    {
+        printf("error>> clEnqueueWriteBuffer() Failed : %d. Terminating Now ...\n", result);
+        cleanup();
+        exit(EXIT_FAILURE);
+    }
+
+    printf("\n==================================================================================\n");
+    printf("+ PREFIX SCAN (%s, %s) OF %zu ELEMENTS +\n", scanOperators[scanOperator].name, typeNames[elementType], iNumberOfArrayElements);
+    printf("==================================================================================\n");
+
+    for (int inclusive = 1; inclusive >= 0; inclusive--)
+    {
+        const char *scanName = (inclusive == 1) ? "Inclusive" : "Exclusive";
+        size_t breakValue = 0;
+
+        // host scans
+        scanOperators[scanOperator].scanOnHost[elementType](inclusive == 1);
+        if (compareWithGold(hostOutput, &breakValue) == false)
+        {
+            printf("- %s Scan : Threaded Host Scan Differs At Array Index %zu\n", scanName, breakValue);
+            bAccuracy = false;
+        }
+
+        // device scan, warm-up then the average of numberOfRuns
+        result = scanOnDevice(inclusive);
+        clFinish(oclCommandQueue);
+
+        StopWatchInterface *timer = NULL;
+        sdkCreateTimer(&timer);
+        sdkStartTimer(&timer);
+
+        for (int run = 0; (run < numberOfRuns) && (result == CL_SUCCESS); run++)
+            result = scanOnDevice(inclusive);
+        clFinish(oclCommandQueue);
+
+        sdkStopTimer(&timer);
+        timeOnGPU = sdkGetTimerValue(&timer) / numberOfRuns;
+        sdkDeleteTimer(&timer);
+        timer = NULL;
+
+        if (result == CL_SUCCESS)
+            result = clEnqueueReadBuffer(oclCommandQueue, deviceOutput, CL_TRUE, 0, size, hostOutput, 0, NULL, NULL);
+        if (result != CL_SUCCESS)
+        {
+            printf("error>> Device Scan Failed : %d. Terminating Now ...\n", result);
+            cleanup();
+            exit(EXIT_FAILURE);
+        }
+
+        if (compareWithGold(hostOutput, &breakValue) == false)
+        {
+            printf("- %s Scan : Device Scan Differs At Array Index %zu\n", scanName, breakValue);
+            bAccuracy = false;
+        }
+
+        printf("- %s Scan On GPU = %0.6f (ms), %0.3f (Million Elements/s)\n", scanName, timeOnGPU, (iNumberOfArrayElements / 1.0e6) / (timeOnGPU / 1000.0));
+        printf("- %s Scan On CPU With %u Threads = %0.6f (ms), %0.3f (Million Elements/s)\n", scanName, getNumberOfCPUThreads(), timeOnCPUParallel, (iNumberOfArrayElements / 1.0e6) / (timeOnCPUParallel / 1000.0));
+        printf("- %s Scan On CPU = %0.6f (ms), %0.3f (Million Elements/s)\n\n", scanName, timeOnCPU, (iNumberOfArrayElements / 1.0e6) / (timeOnCPU / 1000.0));
+    }
+
+    printf("- %zu Segments Of %zu Elements, Work-Groups Of %zu Work-Items With %d Elements Each Per Tile\n", oclScanKernels.numberOfSegments, oclScanKernels.segmentLength, oclScanKernels.localWorkSize, SCAN_ITEMS_PER_WORK_ITEM);
+    if (bAccuracy == true)
+        printf("# Comparison Of CPU And GPU Scans Is With Accuracy Of Limit Of %g (Relative, Floating Point).\n", scanOperators[scanOperator].floatTolerance);
+    else
+        printf("# Comparison Of CPU And GPU Scans Is Not With Accuracy Of Limit Of %g (Relative, Floating Point).\n", scanOperators[scanOperator].floatTolerance);
+    printf("==================================================================================\n");
+
+    // total cleanup
+    cleanup();
+
+    return (0);
+}
+
+// scanOnDevice() definition
+cl_int scanOnDevice(cl_int inclusive)
+{
+    // code
+    return (enqueueScan(oclCommandQueue, &oclScanKernels, deviceInput, deviceOutput, deviceSegmentSums, inclusive));
+}
+
+// fillHostInput() definition
+void fillHostInput(void)
+{
+    // code
+    // small signed ints keep the int sums far away from overflow
+    for (size_t index = 0; index < iNumberOfArrayElements; index++)
+    {
+        if (elementType == TYPE_INT)
+            ((int *)hostInput)[index] = (rand() % 19) - 9;
+        else
+            ((float *)hostInput)[index] = (float)rand() / (float)RAND_MAX;
+    }
+}
+
+// cleanup() definition
+void cleanup(void)
+{
+    // code
+    // OpenCL cleanup
+    releaseScanKernels(&oclScanKernels);
+
+    if (oclProgram)
+    {
+        clReleaseProgram(oclProgram);
+        oclProgram = NULL;
+    }
+
+    // free allocated device memory
+    cl_mem *deviceBuffers[] = {&deviceSegmentSums, &deviceOutput, &deviceInput};
+    for (int index = 0; index < 3; index++)
+    {
+        if (*deviceBuffers[index])
+        {
+            clReleaseMemObject(*deviceBuffers[index]);
+            *deviceBuffers[index] = NULL;
+        }
+    }
+
+    if (oclCommandQueue)
+    {
+        clReleaseCommandQueue(oclCommandQueue);
+        oclCommandQueue = NULL;
+    }
+
+    if (oclContext)
+    {
+        clReleaseContext(oclContext);
+        oclContext = NULL;
+    }
+
+    // free allocated host memory
+    void **hostArrays[] = {&gold, &hostOutput, &hostInput};
+    for (int index = 0; index < 3; index++)
+    {
+        if (*hostArrays[index])
+        {
+            free(*hostArrays[index]);
+            *hostArrays[index] = NULL;
+        }
+    }
+}
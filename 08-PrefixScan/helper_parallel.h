@@ -0,0 +1,278 @@
+// helper_parallel.h
+// static partitioning of host loops over a persistent pool of pinned threads and runtime x86 SIMD feature detection
+
+#ifndef HELPER_PARALLEL_H
+#define HELPER_PARALLEL_H
+
+#include <stddef.h>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(WIN32) || defined(_WIN32) || defined(WIN64) || defined(_WIN64)
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define HELPER_PARALLEL_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+// functions using AVX2 / AVX-512 intrinsics are marked with these so the rest of the file
+// keeps the baseline instruction set (MSVC accepts the intrinsics without any flag)
+#if defined(HELPER_PARALLEL_X86) && (defined(__GNUC__) || defined(__clang__))
+#define TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define TARGET_AVX512 __attribute__((target("avx512f")))
+#else
+#define TARGET_AVX2
+#define TARGET_AVX512
+#endif
+
+//! SIMD instruction sets the host loops can dispatch to
+#define CPU_SIMD_NONE 0
+#define CPU_SIMD_AVX2 1
+#define CPU_SIMD_AVX512 2
+
+////////////////////////////////////////////////////////////////////////////////
+//! Widest of the above that both the CPU and the OS (saved register state) support
+////////////////////////////////////////////////////////////////////////////////
+inline int getCPUSimdLevel(void)
+{
+#if defined(HELPER_PARALLEL_X86) && defined(_MSC_VER)
+    int info[4];
+
+    __cpuid(info, 0);
+    if (info[0] < 7)
+        return (CPU_SIMD_NONE);
+
+    // FMA, OSXSAVE and AVX, then the OS must save YMM (and for AVX-512 opmask / ZMM) state
+    __cpuid(info, 1);
+    if (((info[2] & (1 << 12)) == 0) || ((info[2] & (1 << 27)) == 0) || ((info[2] & (1 << 28)) == 0))
+        return (CPU_SIMD_NONE);
+
+    unsigned long long xcr0 = _xgetbv(0);
+    if ((xcr0 & 0x6) != 0x6)
+        return (CPU_SIMD_NONE);
+
+    __cpuidex(info, 7, 0);
+    if ((info[1] & (1 << 16)) && ((xcr0 & 0xe6) == 0xe6))
+        return (CPU_SIMD_AVX512);
+    if (info[1] & (1 << 5))
+        return (CPU_SIMD_AVX2);
+
+    return (CPU_SIMD_NONE);
+#elif defined(HELPER_PARALLEL_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+        return (CPU_SIMD_AVX512);
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        return (CPU_SIMD_AVX2);
+
+    return (CPU_SIMD_NONE);
+#else
+    return (CPU_SIMD_NONE);
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Printable name of a CPU_SIMD_* level
+////////////////////////////////////////////////////////////////////////////////
+inline const char *getCPUSimdName(int simdLevel)
+{
+    const char *names[] = {"Scalar", "AVX2", "AVX-512"};
+
+    if ((simdLevel < CPU_SIMD_NONE) || (simdLevel > CPU_SIMD_AVX512))
+        return ("Unknown");
+
+    return (names[simdLevel]);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Number of hardware threads, at least 1
+////////////////////////////////////////////////////////////////////////////////
+inline unsigned int getNumberOfCPUThreads(void)
+{
+    unsigned int numberOfThreads = std::thread::hardware_concurrency();
+
+    return ((numberOfThreads == 0) ? 1 : numberOfThreads);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Pin the calling thread to the index-th processor the process may run on (wrapping around),
+//! ignored where the OS offers no affinity (and beyond the first 64 processors on Windows)
+////////////////////////////////////////////////////////////////////////////////
+inline void parallelPinCurrentThread(unsigned int index)
+{
+#if defined(WIN32) || defined(_WIN32) || defined(WIN64) || defined(_WIN64)
+    DWORD_PTR processMask = 0, systemMask = 0;
+    if ((GetProcessAffinityMask(GetCurrentProcess(), &processMask, &systemMask) == 0) || (processMask == 0))
+        return;
+
+    unsigned int numberOfProcessors = 0;
+    for (unsigned int bit = 0; bit < sizeof(DWORD_PTR) * 8; bit++)
+        numberOfProcessors += (unsigned int)((processMask >> bit) & 1);
+
+    unsigned int wanted = index % numberOfProcessors;
+    for (unsigned int bit = 0; bit < sizeof(DWORD_PTR) * 8; bit++)
+    {
+        if (((processMask >> bit) & 1) && (wanted-- == 0))
+        {
+            SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << bit);
+            return;
+        }
+    }
+#elif defined(__linux__)
+    cpu_set_t allowed;
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0)
+        return;
+
+    int numberOfProcessors = CPU_COUNT(&allowed);
+    if (numberOfProcessors == 0)
+        return;
+
+    int wanted = (int)(index % (unsigned int)numberOfProcessors);
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+    {
+        if (CPU_ISSET(cpu, &allowed) && (wanted-- == 0))
+        {
+            cpu_set_t pinned;
+            CPU_ZERO(&pinned);
+            CPU_SET(cpu, &pinned);
+            pthread_setaffinity_np(pthread_self(), sizeof(pinned), &pinned);
+            return;
+        }
+    }
+#else
+    (void)index;
+#endif
+}
+
+// the workers of parallelFor(), created on first use and kept until the process exits,
+// worker i is pinned to processor i and runs range i of every loop
+typedef struct ParallelPool
+{
+    std::mutex submitMutex; // one parallelFor() at a time
+    std::mutex mutex;
+    std::condition_variable wake; // a new loop was posted
+    std::condition_variable done; // every range of the loop has finished
+    std::vector<std::thread> workers;
+    std::function<void(unsigned int)> job; // runs range threadIndex of the current loop
+    unsigned long long generation;         // loops posted so far
+    unsigned int numberOfRanges;
+    unsigned int pending; // ranges of the current loop still running
+    bool bStop;
+
+    ParallelPool() : generation(0), numberOfRanges(0), pending(0), bStop(false) {}
+
+    ~ParallelPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            bStop = true;
+        }
+        wake.notify_all();
+        for (size_t index = 0; index < workers.size(); index++)
+            workers[index].join();
+    }
+} ParallelPool;
+
+inline ParallelPool *parallelPool(void)
+{
+    static ParallelPool pool;
+    return (&pool);
+}
+
+// set on the workers, a parallelFor() inside a parallelFor() runs its ranges on the calling worker
+inline bool *parallelInsideWorker(void)
+{
+    static thread_local bool bInside = false;
+    return (&bInside);
+}
+
+inline void parallelWorker(ParallelPool *pool, unsigned int workerIndex, unsigned long long generation)
+{
+    parallelPinCurrentThread(workerIndex);
+    *parallelInsideWorker() = true;
+
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(pool->mutex);
+            pool->wake.wait(lock, [&] { return (pool->bStop || (pool->generation != generation)); });
+            if (pool->bStop)
+                return;
+            generation = pool->generation;
+            if (workerIndex >= pool->numberOfRanges)
+                continue;
+        }
+
+        pool->job(workerIndex);
+
+        std::lock_guard<std::mutex> lock(pool->mutex);
+        if (--pool->pending == 0)
+            pool->done.notify_one();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Split [0, count) into one contiguous range per thread and call
+//! function(begin, end, threadIndex) for each range on the pool above, the calling
+//! thread waits. Range boundaries are multiples of grain (except the final end), and
+//! for the same count, grain and numberOfThreads range i always runs on worker i, which
+//! stays pinned to one processor, so a buffer first touched through parallelFor() ends
+//! up on the NUMA node of the processor that later processes that part of it.
+////////////////////////////////////////////////////////////////////////////////
+template <typename Function>
+inline void parallelFor(size_t count, size_t grain, unsigned int numberOfThreads, Function function)
+{
+    if (grain == 0)
+        grain = 1;
+
+    size_t numberOfGrains = (count + grain - 1) / grain;
+    if (numberOfThreads > numberOfGrains)
+        numberOfThreads = (unsigned int)numberOfGrains;
+    if (numberOfThreads <= 1)
+    {
+        function((size_t)0, count, 0u);
+        return;
+    }
+
+    auto range = [&](unsigned int threadIndex) {
+        size_t begin = (numberOfGrains * threadIndex / numberOfThreads) * grain;
+        size_t end = (numberOfGrains * (threadIndex + 1) / numberOfThreads) * grain;
+        function(begin, (end > count) ? count : end, threadIndex);
+    };
+
+    if (*parallelInsideWorker() == true)
+    {
+        for (unsigned int threadIndex = 0; threadIndex < numberOfThreads; threadIndex++)
+            range(threadIndex);
+        return;
+    }
+
+    ParallelPool *pool = parallelPool();
+    std::lock_guard<std::mutex> submit(pool->submitMutex);
+    std::unique_lock<std::mutex> lock(pool->mutex);
+
+    while (pool->workers.size() < numberOfThreads)
+        pool->workers.emplace_back(parallelWorker, pool, (unsigned int)pool->workers.size(), pool->generation);
+
+    pool->job = range;
+    pool->numberOfRanges = numberOfThreads;
+    pool->pending = numberOfThreads;
+    pool->generation++;
+    pool->wake.notify_all();
+
+    pool->done.wait(lock, [&] { return (pool->pending == 0); });
+    pool->job = nullptr;
+}
+
+#endif // HELPER_PARALLEL_H
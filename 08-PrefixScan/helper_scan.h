@@ -0,0 +1,311 @@
+// helper_scan.h
+// three phase scan shared by the samples : every work-group reduces its contiguous segment (scanReduceSegments), one
+// work-group scans those segment sums (scanSegmentSums), then every work-group scans its segment again starting from its
+// prefix (scanSegments). oclScanSourceCode is built with -D T, SCAN_OP(a,b), SCAN_IDENTITY and
+// ITEMS_PER_WORK_ITEM=SCAN_ITEMS_PER_WORK_ITEM, createScanKernels(), configureScan() and enqueueScan() run it
+
+#ifndef HELPER_SCAN_H
+#define HELPER_SCAN_H
+
+#include <stddef.h>
+
+#include <CL/opencl.h>
+
+#define SCAN_ITEMS_PER_WORK_ITEM 4
+
+// OpenCL kernels
+static const char *const oclScanSourceCode =
+    "// SCAN_OP(a, b) must be associative with SCAN_IDENTITY as its identity, the order of the operands is preserved             \n"
+    "// local size must be a power of 2, a tile is ITEMS_PER_WORK_ITEM consecutive elements per work-item                        \n"
+    "                                                                                                                            \n"
+    "// exclusive scan of one value per work-item over the work-group (up-sweep / down-sweep), *total gets the reduction         \n"
+    "T workGroupExclusiveScan(T value, __local T *scratch, T *total)                                                             \n"
+    "{                                                                                                                           \n"
+    "    int localId = get_local_id(0);                                                                                          \n"
+    "    int localSize = get_local_size(0);                                                                                      \n"
+    "                                                                                                                            \n"
+    "    scratch[localId] = value;                                                                                               \n"
+    "    barrier(CLK_LOCAL_MEM_FENCE);                                                                                           \n"
+    "                                                                                                                            \n"
+    "    for(int stride = 1; stride < localSize; stride <<= 1)                                                                   \n"
+    "    {                                                                                                                       \n"
+    "        int index = (localId + 1) * stride * 2 - 1;                                                                         \n"
+    "        if(index < localSize)                                                                                               \n"
+    "        {                                                                                                                   \n"
+    "            scratch[index] = SCAN_OP(scratch[index - stride], scratch[index]);                                              \n"
+    "        }                                                                                                                   \n"
+    "        barrier(CLK_LOCAL_MEM_FENCE);                                                                                       \n"
+    "    }                                                                                                                       \n"
+    "                                                                                                                            \n"
+    "    *total = scratch[localSize - 1];                                                                                        \n"
+    "    barrier(CLK_LOCAL_MEM_FENCE);                                                                                           \n"
+    "                                                                                                                            \n"
+    "    if(localId == 0)                                                                                                        \n"
+    "    {                                                                                                                       \n"
+    "        scratch[localSize - 1] = SCAN_IDENTITY;                                                                             \n"
+    "    }                                                                                                                       \n"
+    "    barrier(CLK_LOCAL_MEM_FENCE);                                                                                           \n"
+    "                                                                                                                            \n"
+    "    for(int stride = localSize / 2; stride > 0; stride >>= 1)                                                               \n"
+    "    {                                                                                                                       \n"
+    "        int index = (localId + 1) * stride * 2 - 1;                                                                         \n"
+    "        if(index < localSize)                                                                                               \n"
+    "        {                                                                                                                   \n"
+    "            T left = scratch[index - stride];                                                                               \n"
+    "            scratch[index - stride] = scratch[index];                                                                       \n"
+    "            scratch[index] = SCAN_OP(scratch[index], left);                                                                 \n"
+    "        }                                                                                                                   \n"
+    "        barrier(CLK_LOCAL_MEM_FENCE);                                                                                       \n"
+    "    }                                                                                                                       \n"
+    "                                                                                                                            \n"
+    "    T prefix = scratch[localId];                                                                                            \n"
+    "    barrier(CLK_LOCAL_MEM_FENCE);                                                                                           \n"
+    "    return (prefix);                                                                                                        \n"
+    "}                                                                                                                           \n"
+    "                                                                                                                            \n"
+    "// coalesced copy of one tile into local memory, padded with SCAN_IDENTITY past the end of the input                        \n"
+    "// element indices are uint : length is at most INT_MAX, but the end of the last segment and the start of the tile          \n"
+    "// after it can go past it                                                                                                  \n"
+    "void loadTile(__global const T *input, uint tileStart, uint length, __local T *tile)                                        \n"
+    "{                                                                                                                           \n"
+    "    uint tileSize = get_local_size(0) * ITEMS_PER_WORK_ITEM;                                                                \n"
+    "    for(uint index = get_local_id(0); index < tileSize; index += get_local_size(0))                                         \n"
+    "    {                                                                                                                       \n"
+    "        tile[index] = (tileStart + index < length) ? input[tileStart + index] : SCAN_IDENTITY;                              \n"
+    "    }                                                                                                                       \n"
+    "    barrier(CLK_LOCAL_MEM_FENCE);                                                                                           \n"
+    "}                                                                                                                           \n"
+    "                                                                                                                            \n"
+    "// phase 1 : reduction of each work-group's segment                                                                         \n"
+    "__kernel void scanReduceSegments(__global const T *input, int length, int segmentLength, __global T *segmentSums,           \n"
+    "                                 __local T *tile, __local T *scratch)                                                       \n"
+    "{                                                                                                                           \n"
+    "    int localId = get_local_id(0);                                                                                          \n"
+    "    uint tileSize = get_local_size(0) * ITEMS_PER_WORK_ITEM;                                                                \n"
+    "    uint segmentStart = get_group_id(0) * (uint)segmentLength;                                                              \n"
+    "    uint segmentEnd = min(segmentStart + (uint)segmentLength, (uint)length);                                                \n"
+    "    T carry = SCAN_IDENTITY;                                                                                                \n"
+    "                                                                                                                            \n"
+    "    for(uint tileStart = segmentStart; tileStart < segmentEnd; tileStart += tileSize)                                       \n"
+    "    {                                                                                                                       \n"
+    "        loadTile(input, tileStart, segmentEnd, tile);                                                                       \n"
+    "                                                                                                                            \n"
+    "        T threadSum = SCAN_IDENTITY;                                                                                        \n"
+    "        for(int item = 0; item < ITEMS_PER_WORK_ITEM; item++)                                                               \n"
+    "        {                                                                                                                   \n"
+    "            threadSum = SCAN_OP(threadSum, tile[localId * ITEMS_PER_WORK_ITEM + item]);                                     \n"
+    "        }                                                                                                                   \n"
+    "                                                                                                                            \n"
+    "        T tileTotal;                                                                                                        \n"
+    "        workGroupExclusiveScan(threadSum, scratch, &tileTotal);                                                             \n"
+    "        carry = SCAN_OP(carry, tileTotal);                                                                                  \n"
+    "    }                                                                                                                       \n"
+    "                                                                                                                            \n"
+    "    if(localId == 0)                                                                                                        \n"
+    "    {                                                                                                                       \n"
+    "        segmentSums[get_group_id(0)] = carry;                                                                               \n"
+    "    }                                                                                                                       \n"
+    "}                                                                                                                           \n"
+    "                                                                                                                            \n"
+    "// phase 2 : exclusive scan of the segment sums in place, by a single work-group                                            \n"
+    "__kernel void scanSegmentSums(__global T *segmentSums, int numberOfSegments, __local T *scratch)                            \n"
+    "{                                                                                                                           \n"
+    "    int localId = get_local_id(0);                                                                                          \n"
+    "    T total;                                                                                                                \n"
+    "    T prefix = workGroupExclusiveScan((localId < numberOfSegments) ? segmentSums[localId] : SCAN_IDENTITY, scratch, &total);\n"
+    "    if(localId < numberOfSegments)                                                                                          \n"
+    "    {                                                                                                                       \n"
+    "        segmentSums[localId] = prefix;                                                                                      \n"
+    "    }                                                                                                                       \n"
+    "}                                                                                                                           \n"
+    "                                                                                                                            \n"
+    "// phase 3 : scan of each segment, starting from the scanned sum of the segments before it                                  \n"
+    "__kernel void scanSegments(__global const T *input, __global T *output, int length, int segmentLength,                      \n"
+    "                           __global const T *segmentPrefixes, int inclusive, __local T *tile, __local T *scratch)           \n"
+    "{                                                                                                                           \n"
+    "    int localId = get_local_id(0);                                                                                          \n"
+    "    uint tileSize = get_local_size(0) * ITEMS_PER_WORK_ITEM;                                                                \n"
+    "    uint segmentStart = get_group_id(0) * (uint)segmentLength;                                                              \n"
+    "    uint segmentEnd = min(segmentStart + (uint)segmentLength, (uint)length);                                                \n"
+    "    T carry = segmentPrefixes[get_group_id(0)];                                                                             \n"
+    "                                                                                                                            \n"
+    "    for(uint tileStart = segmentStart; tileStart < segmentEnd; tileStart += tileSize)                                       \n"
+    "    {                                                                                                                       \n"
+    "        loadTile(input, tileStart, segmentEnd, tile);                                                                       \n"
+    "                                                                                                                            \n"
+    "        T threadSum = SCAN_IDENTITY;                                                                                        \n"
+    "        for(int item = 0; item < ITEMS_PER_WORK_ITEM; item++)                                                               \n"
+    "        {                                                                                                                   \n"
+    "            threadSum = SCAN_OP(threadSum, tile[localId * ITEMS_PER_WORK_ITEM + item]);                                     \n"
+    "        }                                                                                                                   \n"
+    "                                                                                                                            \n"
+    "        T tileTotal;                                                                                                        \n"
+    "        T running = SCAN_OP(carry, workGroupExclusiveScan(threadSum, scratch, &tileTotal));                                 \n"
+    "        for(int item = 0; item < ITEMS_PER_WORK_ITEM; item++)                                                               \n"
+    "        {                                                                                                                   \n"
+    "            T value = tile[localId * ITEMS_PER_WORK_ITEM + item];                                                           \n"
+    "            if(inclusive)                                                                                                   \n"
+    "            {                                                                                                               \n"
+    "                running = SCAN_OP(running, value);                                                                          \n"
+    "                tile[localId * ITEMS_PER_WORK_ITEM + item] = running;                                                       \n"
+    "            }                                                                                                               \n"
+    "            else                                                                                                            \n"
+    "            {                                                                                                               \n"
+    "                tile[localId * ITEMS_PER_WORK_ITEM + item] = running;                                                       \n"
+    "                running = SCAN_OP(running, value);                                                                          \n"
+    "            }                                                                                                               \n"
+    "        }                                                                                                                   \n"
+    "        barrier(CLK_LOCAL_MEM_FENCE);                                                                                       \n"
+    "                                                                                                                            \n"
+    "        for(uint index = localId; (index < tileSize) && (tileStart + index < segmentEnd); index += get_local_size(0))       \n"
+    "        {                                                                                                                   \n"
+    "            output[tileStart + index] = tile[index];                                                                        \n"
+    "        }                                                                                                                   \n"
+    "        carry = SCAN_OP(carry, tileTotal);                                                                                  \n"
+    "        barrier(CLK_LOCAL_MEM_FENCE);                                                                                       \n"
+    "    }                                                                                                                       \n"
+    "}                                                                                                                           \n";
+
+////////////////////////////////////////////////////////////////////////////////
+//! Kernels of a program built from oclScanSourceCode and the segments of one scan length
+////////////////////////////////////////////////////////////////////////////////
+struct ScanKernels
+{
+    cl_kernel reduceSegmentsKernel;
+    cl_kernel segmentSumsKernel;
+    cl_kernel segmentsKernel;
+    size_t elementSize;      // sizeof(T)
+    size_t localWorkSize;    // power of 2 accepted by all three kernels
+    size_t length;           // elements scanned, at most INT_MAX
+    size_t numberOfSegments; // one per work-group, at most localWorkSize
+    size_t segmentLength;    // a whole number of tiles
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//! Release the kernels of createScanKernels(), NULL ones are skipped
+////////////////////////////////////////////////////////////////////////////////
+inline void releaseScanKernels(ScanKernels *scan)
+{
+    cl_kernel *kernels[] = {&scan->segmentsKernel, &scan->segmentSumsKernel, &scan->reduceSegmentsKernel};
+    for (int index = 0; index < 3; index++)
+    {
+        if (*kernels[index])
+        {
+            clReleaseKernel(*kernels[index]);
+            *kernels[index] = NULL;
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Create the three kernels of program for elements of elementSize bytes and pick the largest power of 2
+//! work-group, up to maxLocalWorkSize, that every one of them accepts on device. The kernels are released
+//! again on failure
+////////////////////////////////////////////////////////////////////////////////
+inline cl_int createScanKernels(cl_program program, cl_device_id device, size_t elementSize, size_t maxLocalWorkSize, ScanKernels *scan)
+{
+    cl_int result;
+
+    scan->reduceSegmentsKernel = clCreateKernel(program, "scanReduceSegments", &result);
+    scan->segmentSumsKernel = NULL;
+    scan->segmentsKernel = NULL;
+    if (result == CL_SUCCESS)
+        scan->segmentSumsKernel = clCreateKernel(program, "scanSegmentSums", &result);
+    if (result == CL_SUCCESS)
+        scan->segmentsKernel = clCreateKernel(program, "scanSegments", &result);
+    if (result != CL_SUCCESS)
+    {
+        releaseScanKernels(scan);
+        return (result);
+    }
+
+    scan->elementSize = elementSize;
+    scan->localWorkSize = maxLocalWorkSize;
+    scan->length = 0;
+    scan->numberOfSegments = 0;
+    scan->segmentLength = 0;
+
+    cl_kernel kernels[] = {scan->reduceSegmentsKernel, scan->segmentSumsKernel, scan->segmentsKernel};
+    for (int index = 0; index < 3; index++)
+    {
+        size_t kernelWorkGroupSize = scan->localWorkSize;
+        clGetKernelWorkGroupInfo(kernels[index], device, CL_KERNEL_WORK_GROUP_SIZE, sizeof(kernelWorkGroupSize), &kernelWorkGroupSize, NULL);
+        while (scan->localWorkSize > kernelWorkGroupSize)
+            scan->localWorkSize /= 2;
+    }
+
+    return (CL_SUCCESS);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Segments for a scan of length (1 To INT_MAX) elements : about 4 per compute unit, no more than the single
+//! work-group of phase 2 can scan, and each a whole number of tiles. The segment sums buffer of enqueueScan()
+//! needs localWorkSize elements whatever the length
+////////////////////////////////////////////////////////////////////////////////
+inline void configureScan(ScanKernels *scan, size_t length, cl_uint computeUnits)
+{
+    size_t tileSize = scan->localWorkSize * SCAN_ITEMS_PER_WORK_ITEM;
+    size_t numberOfTiles = (length + tileSize - 1) / tileSize;
+
+    scan->length = length;
+    scan->numberOfSegments = (size_t)computeUnits * 4;
+    if (scan->numberOfSegments > scan->localWorkSize)
+        scan->numberOfSegments = scan->localWorkSize;
+    if (scan->numberOfSegments > numberOfTiles)
+        scan->numberOfSegments = numberOfTiles;
+    scan->segmentLength = ((numberOfTiles + scan->numberOfSegments - 1) / scan->numberOfSegments) * tileSize;
+    scan->numberOfSegments = (length + scan->segmentLength - 1) / scan->segmentLength;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Enqueue the three phases for output = inclusive (inclusive != 0) or exclusive scan of the configured length
+//! elements of input, segmentSums holds the partial results between the phases
+////////////////////////////////////////////////////////////////////////////////
+inline cl_int enqueueScan(cl_command_queue queue, const ScanKernels *scan, cl_mem input, cl_mem output, cl_mem segmentSums, cl_int inclusive)
+{
+    cl_int length = (cl_int)scan->length;
+    cl_int segmentLength = (cl_int)scan->segmentLength;
+    cl_int numberOfSegments = (cl_int)scan->numberOfSegments;
+    size_t localWorkSize = scan->localWorkSize;
+    size_t tileBytes = localWorkSize * SCAN_ITEMS_PER_WORK_ITEM * scan->elementSize;
+    size_t scratchBytes = localWorkSize * scan->elementSize;
+    size_t globalWorkSize = scan->numberOfSegments * localWorkSize;
+    cl_int result;
+
+    // phase 1
+    result = clSetKernelArg(scan->reduceSegmentsKernel, 0, sizeof(cl_mem), (void *)&input);
+    result |= clSetKernelArg(scan->reduceSegmentsKernel, 1, sizeof(cl_int), (void *)&length);
+    result |= clSetKernelArg(scan->reduceSegmentsKernel, 2, sizeof(cl_int), (void *)&segmentLength);
+    result |= clSetKernelArg(scan->reduceSegmentsKernel, 3, sizeof(cl_mem), (void *)&segmentSums);
+    result |= clSetKernelArg(scan->reduceSegmentsKernel, 4, tileBytes, NULL);
+    result |= clSetKernelArg(scan->reduceSegmentsKernel, 5, scratchBytes, NULL);
+    if (result == CL_SUCCESS)
+        result = clEnqueueNDRangeKernel(queue, scan->reduceSegmentsKernel, 1, NULL, &globalWorkSize, &localWorkSize, 0, NULL, NULL);
+    if (result != CL_SUCCESS)
+        return (result);
+
+    // phase 2
+    result = clSetKernelArg(scan->segmentSumsKernel, 0, sizeof(cl_mem), (void *)&segmentSums);
+    result |= clSetKernelArg(scan->segmentSumsKernel, 1, sizeof(cl_int), (void *)&numberOfSegments);
+    result |= clSetKernelArg(scan->segmentSumsKernel, 2, scratchBytes, NULL);
+    if (result == CL_SUCCESS)
+        result = clEnqueueNDRangeKernel(queue, scan->segmentSumsKernel, 1, NULL, &localWorkSize, &localWorkSize, 0, NULL, NULL);
+    if (result != CL_SUCCESS)
+        return (result);
+
+    // phase 3
+    result = clSetKernelArg(scan->segmentsKernel, 0, sizeof(cl_mem), (void *)&input);
+    result |= clSetKernelArg(scan->segmentsKernel, 1, sizeof(cl_mem), (void *)&output);
+    result |= clSetKernelArg(scan->segmentsKernel, 2, sizeof(cl_int), (void *)&length);
+    result |= clSetKernelArg(scan->segmentsKernel, 3, sizeof(cl_int), (void *)&segmentLength);
+    result |= clSetKernelArg(scan->segmentsKernel, 4, sizeof(cl_mem), (void *)&segmentSums);
+    result |= clSetKernelArg(scan->segmentsKernel, 5, sizeof(cl_int), (void *)&inclusive);
+    result |= clSetKernelArg(scan->segmentsKernel, 6, tileBytes, NULL);
+    result |= clSetKernelArg(scan->segmentsKernel, 7, scratchBytes, NULL);
+    if (result == CL_SUCCESS)
+        result = clEnqueueNDRangeKernel(queue, scan->segmentsKernel, 1, NULL, &globalWorkSize, &localWorkSize, 0, NULL, NULL);
+
+    return (result);
+}
+
+#endif // HELPER_SCAN_H
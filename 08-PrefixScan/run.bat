@@ -0,0 +1,12 @@
+cls
+
+del PrefixScan.exe
+
+cl.exe PrefixScan.cpp /c /EHsc /Fo".\PrefixScan.obj" /I "C:\Program Files\NVIDIA GPU Computing Toolkit\CUDA\v11.1\include" 
+link.exe PrefixScan.obj opencl.lib /LIBPATH:"C:\Program Files\NVIDIA GPU Computing Toolkit\CUDA\v11.1\lib\x64"
+
+PrefixScan.exe
+PrefixScan.exe -n 1000003 -op max
+PrefixScan.exe -type float
+
+del PrefixScan.obj
@@ -0,0 +1,773 @@
+// headers
+#include <stdio.h>
+#include <stdlib.h> // exit()
+#include <string.h> // strcmp()
+#include <limits.h> // INT_MAX
+#include <algorithm> // std::sort()
+#include <utility>   // std::pair
+#include <vector>
+
+#include <CL/opencl.h> // standard OpenCL header
+
+#include "helper_timer.h"
+#include "helper_scan.h"
+
+// bits sorted per pass, a 32-bit key takes 8 passes and a 64-bit key 16
+#define RADIX_BITS 4
+#define RADIX (1 << RADIX_BITS)
+
+#define ITEMS_PER_WORK_ITEM 4
+
+// benchmark sweep, sizes above maxNumberOfKeys or above what fits the device are skipped
+#define NUMBER_OF_SWEEP_SIZES 6
+const size_t sweepSizes[NUMBER_OF_SWEEP_SIZES] = {1000, 10000, 100000, 1000000, 10000000, 100000000};
+
+// global OpenCL variables
+size_t iNumberOfKeys = 0; // 0 runs the sweep
+size_t maxNumberOfKeys = 100000000;
+int numberOfRuns = 5;
+int keyBits = 32;
+bool bKeyValue = false;
+
+cl_platform_id oclPlatformID;
+cl_device_id oclDeviceID;
+
+cl_context oclContext;
+cl_command_queue oclCommandQueue;
+
+cl_program oclSortProgram;
+cl_kernel oclHistogramKernel;
+cl_kernel oclScatterKernel;
+
+// exclusive scan of the digit histograms, the three phase scan of helper_scan.h specialized for uint sums
+cl_program oclScanProgram;
+ScanKernels oclScanKernels = {};
+
+void *hostKeys = NULL;
+void *hostSortedKeys = NULL;
+void *gold = NULL;
+cl_uint *hostSortedValues = NULL;
+
+// keys and values ping-pong between the two buffers of each pair, the input buffers are only read by the first pass
+cl_mem deviceKeysInput = NULL;
+cl_mem deviceKeys[2] = {NULL, NULL};
+cl_mem deviceValuesInput = NULL;
+cl_mem deviceValues[2] = {NULL, NULL};
+cl_mem deviceHistograms = NULL;
+cl_mem deviceHistogramOffsets = NULL;
+cl_mem deviceSegmentSums = NULL;
+
+size_t sortLocalWorkSize = 256;
+size_t numberOfBlocks = 0;
+cl_uint computeUnits = 1;
+
+float timeOnCPU = 0.0f;
+float timeOnGPU = 0.0f;
+
+// OpenCL kernels
+// one LSD pass : per block digit histograms (radixHistogram), exclusive scan of all histograms (scan program),
+// then a stable scatter of every block into its digits' ranges (radixScatter)
+const char *oclSortSourceCode =
+    "// KEY_TYPE is uint or ulong, HAS_VALUES selects key-value mode (uint payloads), RADIX_BITS bits are sorted per pass        \n"
+    "// a block is ITEMS_PER_WORK_ITEM consecutive keys per work-item, local size must be a power of 2                           \n"
+    "                                                                                                                            \n"
+    "#define RADIX (1 << RADIX_BITS)                                                                                             \n"
+    "#define RADIX_MASK (RADIX - 1)                                                                                              \n"
+    "#define DIGIT(key, shift) ((uint)((key) >> (shift)) & RADIX_MASK)                                                           \n"
+    "                                                                                                                            \n"
+    "// exclusive sum of one value per work-item over the work-group (up-sweep / down-sweep), *total gets the sum                \n"
+    "uint workGroupExclusiveSum(uint value, __local uint *scratch, uint *total)                                                  \n"
+    "{                                                                                                                           \n"
+    "    int localId = get_local_id(0);                                                                                          \n"
+    "    int localSize = get_local_size(0);                                                                                      \n"
+    "                                                                                                                            \n"
+    "    scratch[localId] = value;                                                                                               \n"
+    "    barrier(CLK_LOCAL_MEM_FENCE);                                                                                           \n"
+    "                                                                                                                            \n"
+    "    for(int stride = 1; stride < localSize; stride <<= 1)                                                                   \n"
+    "    {                                                                                                                       \n"
+    "        int index = (localId + 1) * stride * 2 - 1;                                                                         \n"
+    "        if(index < localSize)                                                                                               \n"
+    "        {                                                                                                                   \n"
+    "            scratch[index] += scratch[index - stride];                                                                      \n"
+    "        }                                                                                                                   \n"
+    "        barrier(CLK_LOCAL_MEM_FENCE);                                                                                       \n"
+    "    }                                                                                                                       \n"
+    "                                                                                                                            \n"
+    "    *total = scratch[localSize - 1];                                                                                        \n"
+    "    barrier(CLK_LOCAL_MEM_FENCE);                                                                                           \n"
+    "                                                                                                                            \n"
+    "    if(localId == 0)                                                                                                        \n"
+    "    {                                                                                                                       \n"
+    "        scratch[localSize - 1] = 0;                                                                                         \n"
+    "    }                                                                                                                       \n"
+    "    barrier(CLK_LOCAL_MEM_FENCE);                                                                                           \n"
+    "                                                                                                                            \n"
+    "    for(int stride = localSize / 2; stride > 0; stride >>= 1)                                                               \n"
+    "    {                                                                                                                       \n"
+    "        int index = (localId + 1) * stride * 2 - 1;                                                                         \n"
+    "        if(index < localSize)                                                                                               \n"
+    "        {                                                                                                                   \n"
+    "            uint left = scratch[index - stride];                                                                            \n"
+    "            scratch[index - stride] = scratch[index];                                                                       \n"
+    "            scratch[index] += left;                                                                                         \n"
+    "        }                                                                                                                   \n"
+    "        barrier(CLK_LOCAL_MEM_FENCE);                                                                                       \n"
+    "    }                                                                                                                       \n"
+    "                                                                                                                            \n"
+    "    uint prefix = scratch[localId];                                                                                         \n"
+    "    barrier(CLK_LOCAL_MEM_FENCE);                                                                                           \n"
+    "    return (prefix);                                                                                                        \n"
+    "}                                                                                                                           \n"
+    "                                                                                                                            \n"
+    "// count of every digit in each work-group's block, stored digit-major so that one exclusive scan over                      \n"
+    "// the whole array gives every (digit, block) pair its first output position                                                \n"
+    "__kernel void radixHistogram(__global const KEY_TYPE *keys, int length, int shift, __global uint *histograms)               \n"
+    "{                                                                                                                           \n"
+    "    __local uint localHistogram[RADIX];                                                                                     \n"
+    "                                                                                                                            \n"
+    "    int localId = get_local_id(0);                                                                                          \n"
+    "    int blockSize = get_local_size(0) * ITEMS_PER_WORK_ITEM;                                                                \n"
+    "    int blockStart = get_group_id(0) * blockSize;                                                                           \n"
+    "                                                                                                                            \n"
+    "    for(int digit = localId; digit < RADIX; digit += get_local_size(0))                                                     \n"
+    "    {                                                                                                                       \n"
+    "        localHistogram[digit] = 0;                                                                                          \n"
+    "    }                                                                                                                       \n"
+    "    barrier(CLK_LOCAL_MEM_FENCE);                                                                                           \n"
+    "                                                                                                                            \n"
+    "    for(int index = localId; (index < blockSize) && (blockStart + index < length); index += get_local_size(0))              \n"
+    "    {                                                                                                                       \n"
+    "        atomic_inc(&localHistogram[DIGIT(keys[blockStart + index], shift)]);                                                \n"
+    "    }                                                                                                                       \n"
+    "    barrier(CLK_LOCAL_MEM_FENCE);                                                                                           \n"
+    "                                                                                                                            \n"
+    "    for(int digit = localId; digit < RADIX; digit += get_local_size(0))                                                     \n"
+    "    {                                                                                                                       \n"
+    "        histograms[digit * get_num_groups(0) + get_group_id(0)] = localHistogram[digit];                                    \n"
+    "    }                                                                                                                       \n"
+    "}                                                                                                                           \n"
+    "                                                                                                                            \n"
+    "// stable sort of each block by the digit in local memory (one split per bit), then every key goes to the                   \n"
+    "// scanned offset of its (digit, block) plus its rank among the keys of the block with the same digit                       \n"
+    "__kernel void radixScatter(__global const KEY_TYPE *keysIn, __global KEY_TYPE *keysOut,                                     \n"
+    "                           __global const uint *valuesIn, __global uint *valuesOut,                                         \n"
+    "                           int length, int shift, __global const uint *histogramOffsets,                                    \n"
+    "                           __local KEY_TYPE *localKeys, __local uint *localValues, __local uint *scratch)                   \n"
+    "{                                                                                                                           \n"
+    "    __local uint digitStarts[RADIX];                                                                                        \n"
+    "                                                                                                                            \n"
+    "    int localId = get_local_id(0);                                                                                          \n"
+    "    int localSize = get_local_size(0);                                                                                      \n"
+    "    int blockSize = localSize * ITEMS_PER_WORK_ITEM;                                                                        \n"
+    "    int blockStart = get_group_id(0) * blockSize;                                                                           \n"
+    "    int blockLength = min(blockSize, length - blockStart);                                                                  \n"
+    "                                                                                                                            \n"
+    "    // padding keys have every bit set, the stable splits keep them behind all real keys                                    \n"
+    "    for(int index = localId; index < blockSize; index += localSize)                                                         \n"
+    "    {                                                                                                                       \n"
+    "        localKeys[index] = (index < blockLength) ? keysIn[blockStart + index] : (KEY_TYPE)(-1);                             \n"
+    "#if HAS_VALUES                                                                                                              \n"
+    "        localValues[index] = (index < blockLength) ? valuesIn[blockStart + index] : 0;                                      \n"
+    "#endif                                                                                                                      \n"
+    "    }                                                                                                                       \n"
+    "    barrier(CLK_LOCAL_MEM_FENCE);                                                                                           \n"
+    "                                                                                                                            \n"
+    "    for(int bit = shift; bit < shift + RADIX_BITS; bit++)                                                                   \n"
+    "    {                                                                                                                       \n"
+    "        KEY_TYPE itemKeys[ITEMS_PER_WORK_ITEM];                                                                             \n"
+    "#if HAS_VALUES                                                                                                              \n"
+    "        uint itemValues[ITEMS_PER_WORK_ITEM];                                                                               \n"
+    "#endif                                                                                                                      \n"
+    "        uint zeros = 0;                                                                                                     \n"
+    "        for(int item = 0; item < ITEMS_PER_WORK_ITEM; item++)                                                               \n"
+    "        {                                                                                                                   \n"
+    "            itemKeys[item] = localKeys[localId * ITEMS_PER_WORK_ITEM + item];                                               \n"
+    "#if HAS_VALUES                                                                                                              \n"
+    "            itemValues[item] = localValues[localId * ITEMS_PER_WORK_ITEM + item];                                           \n"
+    "#endif                                                                                                                      \n"
+    "            zeros += 1 - (uint)((itemKeys[item] >> bit) & 1);                                                               \n"
+    "        }                                                                                                                   \n"
+    "                                                                                                                            \n"
+    "        uint totalZeros;                                                                                                    \n"
+    "        uint zerosBefore = workGroupExclusiveSum(zeros, scratch, &totalZeros);                                              \n"
+    "        uint onesBefore = localId * ITEMS_PER_WORK_ITEM - zerosBefore;                                                      \n"
+    "                                                                                                                            \n"
+    "        for(int item = 0; item < ITEMS_PER_WORK_ITEM; item++)                                                               \n"
+    "        {                                                                                                                   \n"
+    "            uint destination = ((itemKeys[item] >> bit) & 1) ? (totalZeros + onesBefore++) : zerosBefore++;                 \n"
+    "            localKeys[destination] = itemKeys[item];                                                                        \n"
+    "#if HAS_VALUES                                                                                                              \n"
+    "            localValues[destination] = itemValues[item];                                                                    \n"
+    "#endif                                                                                                                      \n"
+    "        }                                                                                                                   \n"
+    "        barrier(CLK_LOCAL_MEM_FENCE);                                                                                       \n"
+    "    }                                                                                                                       \n"
+    "                                                                                                                            \n"
+    "    for(int index = localId; index < blockSize; index += localSize)                                                         \n"
+    "    {                                                                                                                       \n"
+    "        uint digit = DIGIT(localKeys[index], shift);                                                                        \n"
+    "        if((index == 0) || (digit != DIGIT(localKeys[index - 1], shift)))                                                   \n"
+    "        {                                                                                                                   \n"
+    "            digitStarts[digit] = index;                                                                                     \n"
+    "        }                                                                                                                   \n"
+    "    }                                                                                                                       \n"
+    "    barrier(CLK_LOCAL_MEM_FENCE);                                                                                           \n"
+    "                                                                                                                            \n"
+    "    for(int index = localId; index < blockLength; index += localSize)                                                       \n"
+    "    {                                                                                                                       \n"
+    "        uint digit = DIGIT(localKeys[index], shift);                                                                        \n"
+    "        uint destination = histogramOffsets[digit * get_num_groups(0) + get_group_id(0)] + index - digitStarts[digit];      \n"
+    "        keysOut[destination] = localKeys[index];                                                                            \n"
+    "#if HAS_VALUES                                                                                                              \n"
+    "        valuesOut[destination] = localValues[index];                                                                        \n"
+    "#endif                                                                                                                      \n"
+    "    }                                                                                                                       \n"
+    "}                                                                                                                           \n";
+
+// xorshift64() definition
+// fast host generator, rand() is far too slow and too narrow for 100M 64-bit keys
+cl_ulong xorshift64(cl_ulong *pState)
+{
+    // code
+    cl_ulong x = *pState;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    *pState = x;
+    return (x);
+}
+
+// fillHostKeys() definition
+template <typename K>
+void fillHostKeys(K *keys, size_t numberOfKeys)
+{
+    // code
+    cl_ulong state = 0x9e3779b97f4a7c15ULL;
+    for (size_t index = 0; index < numberOfKeys; index++)
+        keys[index] = (K)xorshift64(&state);
+}
+
+// sortOnHost() definition
+// std::sort of the keys, or of (key, value) pairs in key-value mode, is the baseline the device sort replaces
+template <typename K>
+void sortOnHost(const K *keys, K *sortedKeys, size_t numberOfKeys)
+{
+    // code
+    if (bKeyValue == false)
+    {
+        memcpy(sortedKeys, keys, numberOfKeys * sizeof(K));
+        std::sort(sortedKeys, sortedKeys + numberOfKeys);
+    }
+    else
+    {
+        std::vector<std::pair<K, cl_uint>> pairs(numberOfKeys);
+        for (size_t index = 0; index < numberOfKeys; index++)
+            pairs[index] = std::make_pair(keys[index], (cl_uint)index);
+
+        std::sort(pairs.begin(), pairs.end());
+
+        for (size_t index = 0; index < numberOfKeys; index++)
+            sortedKeys[index] = pairs[index].first;
+    }
+}
+
+// checkSortedOnDevice() definition
+// keys must equal the host sort, and in key-value mode every value (the original index) must point back at its
+// key with equal keys keeping their input order
+template <typename K>
+bool checkSortedOnDevice(const K *keys, const K *sortedKeys, const cl_uint *sortedValues, const K *expected,
+                         size_t numberOfKeys, size_t *pBreakValue)
+{
+    // code
+    for (size_t index = 0; index < numberOfKeys; index++)
+    {
+        bool bMatch = (sortedKeys[index] == expected[index]);
+        if ((bMatch == true) && (bKeyValue == true))
+        {
+            bMatch = (sortedValues[index] < numberOfKeys) && (keys[sortedValues[index]] == sortedKeys[index]);
+            if ((bMatch == true) && (index > 0) && (sortedKeys[index] == sortedKeys[index - 1]))
+                bMatch = (sortedValues[index] > sortedValues[index - 1]);
+        }
+
+        if (bMatch == false)
+        {
+            *pBreakValue = index;
+            return (false);
+        }
+    }
+
+    return (true);
+}
+
+// main() definition
+int main(int argc, char *argv[])
+{
+    // local function declaration
+    cl_program buildProgram(const char *, const char *);
+    bool sortBenchmark(size_t);
+    void cleanup(void);
+
+    // local variable declaration
+    cl_int result;
+    char options[512];
+    bool bAccuracy = true;
+
+    // code
+    // parse command line
+    for (int argIndex = 1; argIndex < argc; argIndex++)
+    {
+        if ((strcmp(argv[argIndex], "-n") == 0) && (argIndex + 1 < argc))
+        {
+            iNumberOfKeys = (size_t)strtoull(argv[++argIndex], NULL, 10);
+            if (iNumberOfKeys == 0)
+            {
+                printf("error>> -n Needs At Least 1 Key, Leave It Out To Run The Sweep. Terminating Now...\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+        else if ((strcmp(argv[argIndex], "-maxn") == 0) && (argIndex + 1 < argc))
+        {
+            maxNumberOfKeys = (size_t)strtoull(argv[++argIndex], NULL, 10);
+        }
+        else if ((strcmp(argv[argIndex], "-runs") == 0) && (argIndex + 1 < argc))
+        {
+            numberOfRuns = atoi(argv[++argIndex]);
+        }
+        else if ((strcmp(argv[argIndex], "-bits") == 0) && (argIndex + 1 < argc))
+        {
+            keyBits = atoi(argv[++argIndex]);
+        }
+        else if (strcmp(argv[argIndex], "-values") == 0)
+        {
+            bKeyValue = true;
+        }
+        else
+        {
+            printf("usage : %s [-n keys | -maxn keys] [-runs count] [-bits 32|64] [-values]\n", argv[0]);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    if (((keyBits != 32) && (keyBits != 64)) || (numberOfRuns < 1) || (iNumberOfKeys > INT_MAX) || (maxNumberOfKeys == 0))
+    {
+        printf("error>> Invalid Key Count, Run Count Or Key Width. Terminating Now...\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // get OpenCL supporting platform's ID
+    result = clGetPlatformIDs(1, &oclPlatformID, NULL);
+    if (result != CL_SUCCESS)
+    {
+        printf("error>> clGetPlatformIDs() Failed : %d. Terminating Now ...\n", result);
+        cleanup();
+        exit(EXIT_FAILURE);
+    }
+
+    // get OpenCL supporting GPU device's ID
+    result = clGetDeviceIDs(oclPlatformID, CL_DEVICE_TYPE_GPU, 1, &oclDeviceID, NULL);
+    if (result != CL_SUCCESS)
+    {
+        printf("error>> clGetDeviceIDs() Failed : %d. Terminating Now ...\n", result);
+        cleanup();
+        exit(EXIT_FAILURE);
+    }
+
+    // create OpenCL compute context
+    oclContext = clCreateContext(NULL, 1, &oclDeviceID, NULL, NULL, &result);
+    if (result != CL_SUCCESS)
+    {
+        printf("error>> clCreateContext() Failed : %d. Terminating Now ...\n", result);
+        cleanup();
+        exit(EXIT_FAILURE);
+    }
+
+    // create command queue
+    oclCommandQueue = clCreateCommandQueue(oclContext, oclDeviceID, 0, &result);
+    if (result != CL_SUCCESS)
+    {
+        printf("error>> clCreateCommandQueue() Failed : %d. Terminating Now ...\n", result);
+        cleanup();
+        exit(EXIT_FAILURE);
+    }
+
+    // build OpenCL programs, the sort for the key width and mode, the scan for uint sums
+    sprintf(options, "-D KEY_TYPE=%s -D HAS_VALUES=%d -D RADIX_BITS=%d -D ITEMS_PER_WORK_ITEM=%d",
+            (keyBits == 64) ? "ulong" : "uint", (bKeyValue == true) ? 1 : 0, RADIX_BITS, ITEMS_PER_WORK_ITEM);
+    oclSortProgram = buildProgram(oclSortSourceCode, options);
+
+    sprintf(options, "-D T=uint -D SCAN_OP(a,b)=((a)+(b)) -D SCAN_IDENTITY=0u -D ITEMS_PER_WORK_ITEM=%d", SCAN_ITEMS_PER_WORK_ITEM);
+    oclScanProgram = buildProgram(oclScanSourceCode, options);
+
+    // create OpenCL kernels by passing kernel function names that we used in .cl file
+    oclHistogramKernel = clCreateKernel(oclSortProgram, "radixHistogram", &result);
+    if (result == CL_SUCCESS)
+        oclScatterKernel = clCreateKernel(oclSortProgram, "radixScatter", &result);
+    if (result == CL_SUCCESS)
+        result = createScanKernels(oclScanProgram, oclDeviceID, sizeof(cl_uint), 256, &oclScanKernels);
+    if (result != CL_SUCCESS)
+    {
+        printf("error>> clCreateKernel() Failed : %d. Terminating Now ...\n", result);
+        cleanup();
+        exit(EXIT_FAILURE);
+    }
+
+    // kernel configuration, power of 2 work-groups that both sort kernels accept (createScanKernels() does the same for the scan)
+    cl_kernel sortKernels[] = {oclHistogramKernel, oclScatterKernel};
+    for (int index = 0; index < 2; index++)
+    {
+        size_t kernelWorkGroupSize = sortLocalWorkSize;
+        clGetKernelWorkGroupInfo(sortKernels[index], oclDeviceID, CL_KERNEL_WORK_GROUP_SIZE, sizeof(kernelWorkGroupSize), &kernelWorkGroupSize, NULL);
+        while (sortLocalWorkSize > kernelWorkGroupSize)
+            sortLocalWorkSize /= 2;
+    }
+
+    clGetDeviceInfo(oclDeviceID, CL_DEVICE_MAX_COMPUTE_UNITS, sizeof(computeUnits), &computeUnits, NULL);
+
+    printf("\n==================================================================================================\n");
+    printf("+ RADIX SORT OF %d-BIT KEYS%s, %d BITS PER PASS, BLOCKS OF %zu KEYS +\n", keyBits,
+           (bKeyValue == true) ? " WITH 32-BIT VALUES" : "", RADIX_BITS, sortLocalWorkSize * ITEMS_PER_WORK_ITEM);
+    printf("==================================================================================================\n");
+    printf("%12s %14s %16s %16s %16s %10s\n", "Keys", "GPU (ms)", "GPU (MKeys/s)", "std::sort (ms)", "CPU (MKeys/s)", "Speedup");
+
+    if (iNumberOfKeys != 0)
+    {
+        bAccuracy = sortBenchmark(iNumberOfKeys);
+    }
+    else
+    {
+        for (int sizeIndex = 0; sizeIndex < NUMBER_OF_SWEEP_SIZES; sizeIndex++)
+        {
+            if (sweepSizes[sizeIndex] <= maxNumberOfKeys)
+            {
+                if (sortBenchmark(sweepSizes[sizeIndex]) == false)
+                    bAccuracy = false;
+            }
+        }
+    }
+
+    printf("==================================================================================================\n");
+    if (bAccuracy == true)
+        printf("# Device Sort Matches std::sort%s.\n", (bKeyValue == true) ? ", Values Follow Their Keys And Equal Keys Keep Input Order" : "");
+    else
+        printf("# Device Sort Does Not Match std::sort.\n");
+    printf("==================================================================================================\n");
+
+    // total cleanup
+    cleanup();
+
+    return (0);
+}
+
+// buildProgram() definition
+cl_program buildProgram(const char *sourceCode, const char *options)
+{
+    // local function declaration
+    void cleanup(void);
+
+    // local variable declaration
+    cl_program program;
+    cl_int result;
+
+    // code
+    // create OpenCL program from .cl
+    program = clCreateProgramWithSource(oclContext, 1, (const char **)&sourceCode, NULL, &result);
+    if (result != CL_SUCCESS)
+    {
+        printf("error>> clCreateProgramWithSource() Failed : %d. Terminating Now ...\n", result);
+        cleanup();
+        exit(EXIT_FAILURE);
+    }
+
+    // build OpenCL program
+    result = clBuildProgram(program, 0, NULL, options, NULL, NULL);
+    if (result != CL_SUCCESS)
+    {
+        size_t len;
+        char buffer[2048];
+        clGetProgramBuildInfo(program, oclDeviceID, CL_PROGRAM_BUILD_LOG, sizeof(buffer), buffer, &len);
+        printf("OpenCL Program Build Log : %s\n", buffer);
+        printf("error>> clBuildProgram() Failed : %d. Terminating Now ...\n", result);
+        clReleaseProgram(program);
+        cleanup();
+        exit(EXIT_FAILURE);
+    }
+
+    return (program);
+}
+
+// sortBenchmark() definition
+// sorts numberOfKeys random keys numberOfRuns times on the device and once with std::sort, prints one table row
+bool sortBenchmark(size_t numberOfKeys)
+{
+    // local function declaration
+    cl_int sortOnDevice(size_t, int *);
+    void releaseBenchmarkMemory(void);
+    void cleanup(void);
+
+    // local variable declaration
+    size_t keySize = keyBits / 8;
+    size_t blockSize = sortLocalWorkSize * ITEMS_PER_WORK_ITEM;
+    size_t breakValue = 0;
+    bool bAccuracy;
+    int outputIndex = 0;
+    cl_ulong maxMemAllocSize = 0;
+    cl_ulong globalMemSize = 0;
+    cl_int result = CL_SUCCESS;
+
+    // code
+    numberOfBlocks = (numberOfKeys + blockSize - 1) / blockSize;
+
+    // skip sizes whose buffers do not fit, keeping them within half of global memory as VecAdd does
+    size_t histogramSize = RADIX * numberOfBlocks * sizeof(cl_uint);
+    cl_ulong deviceBytes = 3 * (cl_ulong)numberOfKeys * keySize + 2 * (cl_ulong)histogramSize;
+    if (bKeyValue == true)
+        deviceBytes += 3 * (cl_ulong)numberOfKeys * sizeof(cl_uint);
+
+    clGetDeviceInfo(oclDeviceID, CL_DEVICE_MAX_MEM_ALLOC_SIZE, sizeof(maxMemAllocSize), &maxMemAllocSize, NULL);
+    clGetDeviceInfo(oclDeviceID, CL_DEVICE_GLOBAL_MEM_SIZE, sizeof(globalMemSize), &globalMemSize, NULL);
+    if ((deviceBytes > globalMemSize / 2) || ((cl_ulong)numberOfKeys * keySize > maxMemAllocSize) || (RADIX * numberOfBlocks > INT_MAX))
+    {
+        printf("%12zu   skipped, needs %llu MB of device memory\n", numberOfKeys, (unsigned long long)(deviceBytes >> 20));
+        return (true);
+    }
+
+    // scan configuration for the RADIX * numberOfBlocks histogram entries
+    configureScan(&oclScanKernels, RADIX * numberOfBlocks, computeUnits);
+
+    // host memory allocation
+    hostKeys = malloc(numberOfKeys * keySize);
+    hostSortedKeys = malloc(numberOfKeys * keySize);
+    gold = malloc(numberOfKeys * keySize);
+    hostSortedValues = (cl_uint *)malloc(numberOfKeys * sizeof(cl_uint));
+    if ((hostKeys == NULL) || (hostSortedKeys == NULL) || (gold == NULL) || (hostSortedValues == NULL))
+    {
+        printf("error>> Host Memory Allocation Failed. Terminating Now...\n");
+        cleanup();
+        exit(EXIT_FAILURE);
+    }
+
+    if (keyBits == 64)
+        fillHostKeys((cl_ulong *)hostKeys, numberOfKeys);
+    else
+        fillHostKeys((cl_uint *)hostKeys, numberOfKeys);
+
+    // allocate device memory
+    deviceKeysInput = clCreateBuffer(oclContext, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, numberOfKeys * keySize, hostKeys, &result);
+    for (int index = 0; (index < 2) && (result == CL_SUCCESS); index++)
+        deviceKeys[index] = clCreateBuffer(oclContext, CL_MEM_READ_WRITE, numberOfKeys * keySize, NULL, &result);
+    if ((result == CL_SUCCESS) && (bKeyValue == true))
+    {
+        // values are the input indices, so the check can follow every value back to its key
+        for (size_t index = 0; index < numberOfKeys; index++)
+            hostSortedValues[index] = (cl_uint)index;
+
+        deviceValuesInput = clCreateBuffer(oclContext, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, numberOfKeys * sizeof(cl_uint), hostSortedValues, &result);
+        for (int index = 0; (index < 2) && (result == CL_SUCCESS); index++)
+            deviceValues[index] = clCreateBuffer(oclContext, CL_MEM_READ_WRITE, numberOfKeys * sizeof(cl_uint), NULL, &result);
+    }
+    if (result == CL_SUCCESS)
+        deviceHistograms = clCreateBuffer(oclContext, CL_MEM_READ_WRITE, histogramSize, NULL, &result);
+    if (result == CL_SUCCESS)
+        deviceHistogramOffsets = clCreateBuffer(oclContext, CL_MEM_READ_WRITE, histogramSize, NULL, &result);
+    if (result == CL_SUCCESS)
+        deviceSegmentSums = clCreateBuffer(oclContext, CL_MEM_READ_WRITE, oclScanKernels.localWorkSize * sizeof(cl_uint), NULL, &result);
+    if (result != CL_SUCCESS)
+    {
+        printf("error>> clCreateBuffer() Failed : %d. Terminating Now ...\n", result);
+        cleanup();
+        exit(EXIT_FAILURE);
+    }
+
+    // device sort, warm-up then the average of numberOfRuns
+    result = sortOnDevice(numberOfKeys, &outputIndex);
+    clFinish(oclCommandQueue);
+
+    StopWatchInterface *timer = NULL;
+    sdkCreateTimer(&timer);
+    sdkStartTimer(&timer);
+
+    for (int run = 0; (run < numberOfRuns) && (result == CL_SUCCESS); run++)
+        result = sortOnDevice(numberOfKeys, &outputIndex);
+    clFinish(oclCommandQueue);
+
+    sdkStopTimer(&timer);
+    timeOnGPU = sdkGetTimerValue(&timer) / numberOfRuns;
+
+    if (result == CL_SUCCESS)
+        result = clEnqueueReadBuffer(oclCommandQueue, deviceKeys[outputIndex], CL_TRUE, 0, numberOfKeys * keySize, hostSortedKeys, 0, NULL, NULL);
+    if ((result == CL_SUCCESS) && (bKeyValue == true))
+        result = clEnqueueReadBuffer(oclCommandQueue, deviceValues[outputIndex], CL_TRUE, 0, numberOfKeys * sizeof(cl_uint), hostSortedValues, 0, NULL, NULL);
+    if (result != CL_SUCCESS)
+    {
+        printf("error>> Device Sort Failed : %d. Terminating Now ...\n", result);
+        sdkDeleteTimer(&timer);
+        cleanup();
+        exit(EXIT_FAILURE);
+    }
+
+    // host sort
+    sdkResetTimer(&timer);
+    sdkStartTimer(&timer);
+
+    if (keyBits == 64)
+        sortOnHost((const cl_ulong *)hostKeys, (cl_ulong *)gold, numberOfKeys);
+    else
+        sortOnHost((const cl_uint *)hostKeys, (cl_uint *)gold, numberOfKeys);
+
+    sdkStopTimer(&timer);
+    timeOnCPU = sdkGetTimerValue(&timer);
+
+    sdkDeleteTimer(&timer);
+    timer = NULL;
+
+    if (keyBits == 64)
+        bAccuracy = checkSortedOnDevice((const cl_ulong *)hostKeys, (const cl_ulong *)hostSortedKeys, hostSortedValues, (const cl_ulong *)gold, numberOfKeys, &breakValue);
+    else
+        bAccuracy = checkSortedOnDevice((const cl_uint *)hostKeys, (const cl_uint *)hostSortedKeys, hostSortedValues, (const cl_uint *)gold, numberOfKeys, &breakValue);
+
+    printf("%12zu %14.3f %16.3f %16.3f %16.3f %9.2fx\n", numberOfKeys, timeOnGPU, (numberOfKeys / 1.0e6) / (timeOnGPU / 1000.0),
+           timeOnCPU, (numberOfKeys / 1.0e6) / (timeOnCPU / 1000.0), timeOnCPU / timeOnGPU);
+    if (bAccuracy == false)
+        printf("%12s   device sort differs at index %zu\n", "", breakValue);
+
+    releaseBenchmarkMemory();
+
+    return (bAccuracy);
+}
+
+// sortOnDevice() definition
+// *pOutputIndex gets the deviceKeys / deviceValues buffer holding the result
+cl_int sortOnDevice(size_t numberOfKeys, int *pOutputIndex)
+{
+    // local function declaration
+    cl_int scanHistogramsOnDevice(void);
+
+    // local variable declaration
+    cl_int length = (cl_int)numberOfKeys;
+    size_t keySize = keyBits / 8;
+    size_t blockSize = sortLocalWorkSize * ITEMS_PER_WORK_ITEM;
+    size_t globalWorkSize = numberOfBlocks * sortLocalWorkSize;
+    size_t valuesLocalSize = (bKeyValue == true) ? blockSize * sizeof(cl_uint) : sizeof(cl_uint);
+    cl_int result = CL_SUCCESS;
+
+    // code
+    for (cl_int shift = 0; (shift < keyBits) && (result == CL_SUCCESS); shift += RADIX_BITS)
+    {
+        int pass = shift / RADIX_BITS;
+        cl_mem keysIn = (pass == 0) ? deviceKeysInput : deviceKeys[(pass - 1) % 2];
+        cl_mem valuesIn = (pass == 0) ? deviceValuesInput : deviceValues[(pass - 1) % 2];
+
+        result = clSetKernelArg(oclHistogramKernel, 0, sizeof(cl_mem), (void *)&keysIn);
+        result |= clSetKernelArg(oclHistogramKernel, 1, sizeof(cl_int), (void *)&length);
+        result |= clSetKernelArg(oclHistogramKernel, 2, sizeof(cl_int), (void *)&shift);
+        result |= clSetKernelArg(oclHistogramKernel, 3, sizeof(cl_mem), (void *)&deviceHistograms);
+        if (result == CL_SUCCESS)
+            result = clEnqueueNDRangeKernel(oclCommandQueue, oclHistogramKernel, 1, NULL, &globalWorkSize, &sortLocalWorkSize, 0, NULL, NULL);
+
+        if (result == CL_SUCCESS)
+            result = scanHistogramsOnDevice();
+
+        if (result == CL_SUCCESS)
+        {
+            // key-only mode passes NULL value buffers, the kernel never touches them
+            result = clSetKernelArg(oclScatterKernel, 0, sizeof(cl_mem), (void *)&keysIn);
+            result |= clSetKernelArg(oclScatterKernel, 1, sizeof(cl_mem), (void *)&deviceKeys[pass % 2]);
+            result |= clSetKernelArg(oclScatterKernel, 2, sizeof(cl_mem), (void *)&valuesIn);
+            result |= clSetKernelArg(oclScatterKernel, 3, sizeof(cl_mem), (void *)&deviceValues[pass % 2]);
+            result |= clSetKernelArg(oclScatterKernel, 4, sizeof(cl_int), (void *)&length);
+            result |= clSetKernelArg(oclScatterKernel, 5, sizeof(cl_int), (void *)&shift);
+            result |= clSetKernelArg(oclScatterKernel, 6, sizeof(cl_mem), (void *)&deviceHistogramOffsets);
+            result |= clSetKernelArg(oclScatterKernel, 7, blockSize * keySize, NULL);
+            result |= clSetKernelArg(oclScatterKernel, 8, valuesLocalSize, NULL);
+            result |= clSetKernelArg(oclScatterKernel, 9, sortLocalWorkSize * sizeof(cl_uint), NULL);
+        }
+        if (result == CL_SUCCESS)
+            result = clEnqueueNDRangeKernel(oclCommandQueue, oclScatterKernel, 1, NULL, &globalWorkSize, &sortLocalWorkSize, 0, NULL, NULL);
+
+        *pOutputIndex = pass % 2;
+    }
+
+    return (result);
+}
+
+// scanHistogramsOnDevice() definition
+// exclusive scan of deviceHistograms into deviceHistogramOffsets
+cl_int scanHistogramsOnDevice(void)
+{
+    // code
+    return (enqueueScan(oclCommandQueue, &oclScanKernels, deviceHistograms, deviceHistogramOffsets, deviceSegmentSums, 0));
+}
+
+// releaseBenchmarkMemory() definition
+// host and device memory of one sortBenchmark() size
+void releaseBenchmarkMemory(void)
+{
+    // code
+    cl_mem *deviceBuffers[] = {&deviceSegmentSums, &deviceHistogramOffsets, &deviceHistograms, &deviceValues[1], &deviceValues[0],
+                               &deviceValuesInput, &deviceKeys[1], &deviceKeys[0], &deviceKeysInput};
+    for (int index = 0; index < 9; index++)
+    {
+        if (*deviceBuffers[index])
+        {
+            clReleaseMemObject(*deviceBuffers[index]);
+            *deviceBuffers[index] = NULL;
+        }
+    }
+
+    void **hostArrays[] = {(void **)&hostSortedValues, &gold, &hostSortedKeys, &hostKeys};
+    for (int index = 0; index < 4; index++)
+    {
+        if (*hostArrays[index])
+        {
+            free(*hostArrays[index]);
+            *hostArrays[index] = NULL;
+        }
+    }
+}
+
+// cleanup() definition
+void cleanup(void)
+{
+    // local function declaration
+    void releaseBenchmarkMemory(void);
+
+    // code
+    // free allocated host and device memory
+    releaseBenchmarkMemory();
+
+    // OpenCL cleanup
+    releaseScanKernels(&oclScanKernels);
+
+    cl_kernel *kernels[] = {&oclScatterKernel, &oclHistogramKernel};
+    for (int index = 0; index < 2; index++)
+    {
+        if (*kernels[index])
+        {
+            clReleaseKernel(*kernels[index]);
+            *kernels[index] = NULL;
+        }
+    }
+
+    cl_program *programs[] = {&oclScanProgram, &oclSortProgram};
+    for (int index = 0; index < 2; index++)
+    {
+        if (*programs[index])
+        {
+            clReleaseProgram(*programs[index]);
+            *programs[index] = NULL;
+        }
+    }
+
+    if (oclCommandQueue)
+    {
+        clReleaseCommandQueue(oclCommandQueue);
+        oclCommandQueue = NULL;
+    }
+
+    if (oclContext)
+    {
+        clReleaseContext(oclContext);
+        oclContext = NULL;
+    }
+}
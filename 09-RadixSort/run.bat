@@ -0,0 +1,12 @@
+cls
+
+del RadixSort.exe
+
+cl.exe RadixSort.cpp /c /EHsc /Fo".\RadixSort.obj" /I "C:\Program Files\NVIDIA GPU Computing Toolkit\CUDA\v11.1\include" 
+link.exe RadixSort.obj opencl.lib /LIBPATH:"C:\Program Files\NVIDIA GPU Computing Toolkit\CUDA\v11.1\lib\x64"
+
+RadixSort.exe
+RadixSort.exe -values
+RadixSort.exe -bits 64 -values
+
+del RadixSort.obj
@@ -0,0 +1,712 @@
+// headers
+#include <stdio.h>
+#include <stdlib.h> // exit()
+#include <string.h> // strcmp()
+#include <limits.h> // INT_MAX
+#include <vector>
+
+#include <CL/opencl.h> // standard OpenCL header
+
+#include "helper_timer.h"
+
+#define PROBLEM_FIELDS 6 // M, N, K, offsetA, offsetB, offsetC per problem, as in the kernels
+#define BATCH_LOCAL_SIZE 64
+#define MIN_VARIABLE_SIZE 8
+#define MAX_VARIABLE_SIZE 64
+
+// uniform batches of every sweep size, then a batch of sizes drawn from MIN_VARIABLE_SIZE to MAX_VARIABLE_SIZE
+#define NUMBER_OF_SWEEP_SIZES 4
+const int sweepSizes[NUMBER_OF_SWEEP_SIZES] = {8, 16, 32, 64};
+
+// global OpenCL variables
+int batchSize = 4096;
+int uniformSize = 0; // 0 runs the sweep
+bool bVariable = false;
+int problemsPerGroup = 1;
+int numberOfRuns = 5;
+
+cl_platform_id oclPlatformID;
+cl_device_id oclDeviceID;
+
+cl_context oclContext;
+cl_command_queue oclCommandQueue;
+
+cl_program oclBatchedProgram;
+cl_kernel oclBatchedKernel;
+cl_kernel oclSingleKernel;
+
+// specialized build of the current uniform batch
+cl_program oclSpecializedProgram;
+cl_kernel oclSpecializedKernel;
+
+std::vector<cl_int> hostProblems;
+float *hostA = NULL;
+float *hostB = NULL;
+float *hostC = NULL;
+float *gold = NULL;
+
+cl_mem deviceProblems = NULL;
+cl_mem deviceA = NULL;
+cl_mem deviceB = NULL;
+cl_mem deviceC = NULL;
+
+size_t batchLocalWorkSize = BATCH_LOCAL_SIZE;
+cl_ulong localMemSize = 0;
+
+// OpenCL kernels
+// batchedGemmGPU runs every problem of the batch in one NDRange from the problem table, gemmSingleGPU is the
+// one-launch-per-problem baseline it replaces
+const char *oclBatchedSourceCode =
+    "// a batch is a table of PROBLEM_FIELDS ints per problem (M, N, K and the offsets of its A, B and C in the shared           \n"
+    "// pools), every matrix row-major and packed (lda = K, ldb = ldc = N)                                                       \n"
+    "#define PROBLEM_FIELDS 6                                                                                                    \n"
+    "                                                                                                                            \n"
+    "// -D FIXED_M / FIXED_N / FIXED_K specialize a uniform batch : constant loop bounds the compiler unrolls, and with          \n"
+    "// STAGE_IN_LOCAL the A and B of each problem are copied to local memory once and read from there                           \n"
+    "#if defined(FIXED_M)                                                                                                        \n"
+    "#define PROBLEM_M(problem) FIXED_M                                                                                          \n"
+    "#define PROBLEM_N(problem) FIXED_N                                                                                          \n"
+    "#define PROBLEM_K(problem) FIXED_K                                                                                          \n"
+    "#else                                                                                                                       \n"
+    "#define PROBLEM_M(problem) (problem)[0]                                                                                     \n"
+    "#define PROBLEM_N(problem) (problem)[1]                                                                                     \n"
+    "#define PROBLEM_K(problem) (problem)[2]                                                                                     \n"
+    "#endif                                                                                                                      \n"
+    "                                                                                                                            \n"
+    "#if defined(STAGE_IN_LOCAL)                                                                                                 \n"
+    "#define A_ELEMENT(index) localA[index]                                                                                      \n"
+    "#define B_ELEMENT(index) localB[index]                                                                                      \n"
+    "#else                                                                                                                       \n"
+    "#define A_ELEMENT(index) a[index]                                                                                           \n"
+    "#define B_ELEMENT(index) b[index]                                                                                           \n"
+    "#endif                                                                                                                      \n"
+    "                                                                                                                            \n"
+    "// one launch for the whole batch : work-group g computes problems g * problemsPerGroup onwards, its work-items             \n"
+    "// striding over the elements of each C                                                                                     \n"
+    "__kernel void batchedGemmGPU(__global const int *problems, int numberOfProblems, int problemsPerGroup,                      \n"
+    "                             __global const float *A, __global const float *B, __global float *C)                           \n"
+    "{                                                                                                                           \n"
+    "    int localId = get_local_id(0);                                                                                          \n"
+    "    int localSize = get_local_size(0);                                                                                      \n"
+    "    int firstProblem = get_group_id(0) * problemsPerGroup;                                                                  \n"
+    "    int lastProblem = min(firstProblem + problemsPerGroup, numberOfProblems);                                               \n"
+    "                                                                                                                            \n"
+    "#if defined(STAGE_IN_LOCAL)                                                                                                 \n"
+    "    __local float localA[FIXED_M * FIXED_K];                                                                                \n"
+    "    __local float localB[FIXED_K * FIXED_N];                                                                                \n"
+    "#endif                                                                                                                      \n"
+    "                                                                                                                            \n"
+    "    for(int problemIndex = firstProblem; problemIndex < lastProblem; problemIndex++)                                        \n"
+    "    {                                                                                                                       \n"
+    "        __global const int *problem = problems + problemIndex * PROBLEM_FIELDS;                                             \n"
+    "        int M = PROBLEM_M(problem);                                                                                         \n"
+    "        int N = PROBLEM_N(problem);                                                                                         \n"
+    "        int K = PROBLEM_K(problem);                                                                                         \n"
+    "        __global const float *a = A + problem[3];                                                                           \n"
+    "        __global const float *b = B + problem[4];                                                                           \n"
+    "        __global float *c = C + problem[5];                                                                                 \n"
+    "                                                                                                                            \n"
+    "#if defined(STAGE_IN_LOCAL)                                                                                                 \n"
+    "        for(int index = localId; index < M * K; index += localSize)                                                         \n"
+    "        {                                                                                                                   \n"
+    "            localA[index] = a[index];                                                                                       \n"
+    "        }                                                                                                                   \n"
+    "        for(int index = localId; index < K * N; index += localSize)                                                         \n"
+    "        {                                                                                                                   \n"
+    "            localB[index] = b[index];                                                                                       \n"
+    "        }                                                                                                                   \n"
+    "        barrier(CLK_LOCAL_MEM_FENCE);                                                                                       \n"
+    "#endif                                                                                                                      \n"
+    "                                                                                                                            \n"
+    "        for(int element = localId; element < M * N; element += localSize)                                                   \n"
+    "        {                                                                                                                   \n"
+    "            int row = element / N;                                                                                          \n"
+    "            int column = element % N;                                                                                       \n"
+    "            float value = 0.0f;                                                                                             \n"
+    "                                                                                                                            \n"
+    "            for(int depth = 0; depth < K; depth++)                                                                          \n"
+    "            {                                                                                                               \n"
+    "                value += A_ELEMENT(row * K + depth) * B_ELEMENT(depth * N + column);                                        \n"
+    "            }                                                                                                               \n"
+    "            c[element] = value;                                                                                             \n"
+    "        }                                                                                                                   \n"
+    "                                                                                                                            \n"
+    "#if defined(STAGE_IN_LOCAL)                                                                                                 \n"
+    "        // the next problem overwrites the staged matrices                                                                  \n"
+    "        barrier(CLK_LOCAL_MEM_FENCE);                                                                                       \n"
+    "#endif                                                                                                                      \n"
+    "    }                                                                                                                       \n"
+    "}                                                                                                                           \n"
+    "                                                                                                                            \n"
+    "// the per-problem baseline : one launch per problem, one element of C per work-item                                        \n"
+    "__kernel void gemmSingleGPU(int M, int N, int K, __global const float *A, int offsetA, __global const float *B, int offsetB,\n"
+    "                            __global float *C, int offsetC)                                                                 \n"
+    "{                                                                                                                           \n"
+    "    int row = get_global_id(1);                                                                                             \n"
+    "    int column = get_global_id(0);                                                                                          \n"
+    "                                                                                                                            \n"
+    "    if((row < M) && (column < N))                                                                                           \n"
+    "    {                                                                                                                       \n"
+    "        float value = 0.0f;                                                                                                 \n"
+    "        for(int depth = 0; depth < K; depth++)                                                                              \n"
+    "        {                                                                                                                   \n"
+    "            value += A[offsetA + row * K + depth] * B[offsetB + depth * N + column];                                        \n"
+    "        }                                                                                                                   \n"
+    "        C[offsetC + row * N + column] = value;                                                                              \n"
+    "    }                                                                                                                       \n"
+    "}                                                                                                                           \n";
+
+// xorshift64() definition
+cl_ulong xorshift64(cl_ulong *pState)
+{
+    // code
+    cl_ulong x = *pState;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    *pState = x;
+    return (x);
+}
+
+// fillHostMatrices() definition
+// small integers, so every product and sum is exact in float and the device must match the host bit for bit
+void fillHostMatrices(float *data, size_t count, int modulo)
+{
+    // code
+    for (size_t index = 0; index < count; index++)
+        data[index] = (float)((int)(index % modulo) - modulo / 2);
+}
+
+// batchedGemmOnHost() definition
+// every product of the batch in the kernels' order of summation
+void batchedGemmOnHost(void)
+{
+    // code
+    for (size_t problem = 0; problem < hostProblems.size() / PROBLEM_FIELDS; problem++)
+    {
+        const cl_int *fields = &hostProblems[problem * PROBLEM_FIELDS];
+        int M = fields[0], N = fields[1], K = fields[2];
+        const float *a = hostA + fields[3];
+        const float *b = hostB + fields[4];
+        float *c = gold + fields[5];
+
+        for (int row = 0; row < M; row++)
+        {
+            for (int column = 0; column < N; column++)
+            {
+                float value = 0.0f;
+                for (int depth = 0; depth < K; depth++)
+                    value += a[row * K + depth] * b[depth * N + column];
+                c[row * N + column] = value;
+            }
+        }
+    }
+}
+
+// main() definition
+int main(int argc, char *argv[])
+{
+    // local function declaration
+    cl_program buildProgram(const char *, const char *);
+    bool batchBenchmark(int);
+    void cleanup(void);
+
+    // local variable declaration
+    cl_int result;
+    bool bAccuracy = true;
+
+    // code
+    // parse command line
+    for (int argIndex = 1; argIndex < argc; argIndex++)
+    {
+        if ((strcmp(argv[argIndex], "-batch") == 0) && (argIndex + 1 < argc))
+        {
+            batchSize = atoi(argv[++argIndex]);
+        }
+        else if ((strcmp(argv[argIndex], "-size") == 0) && (argIndex + 1 < argc))
+        {
+            uniformSize = atoi(argv[++argIndex]);
+            if (uniformSize < 1)
+            {
+                printf("error>> -size Needs Matrices Of At Least 1 x 1, Leave It Out To Run The Sweep. Terminating Now...\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+        else if (strcmp(argv[argIndex], "-variable") == 0)
+        {
+            bVariable = true;
+        }
+        else if ((strcmp(argv[argIndex], "-pergroup") == 0) && (argIndex + 1 < argc))
+        {
+            problemsPerGroup = atoi(argv[++argIndex]);
+        }
+        else if ((strcmp(argv[argIndex], "-runs") == 0) && (argIndex + 1 < argc))
+        {
+            numberOfRuns = atoi(argv[++argIndex]);
+        }
+        else
+        {
+            printf("usage : %s [-batch problems] [-size n | -variable] [-pergroup problems] [-runs count]\n", argv[0]);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    if ((batchSize < 1) || (problemsPerGroup < 1) || (numberOfRuns < 1) || ((uniformSize != 0) && (bVariable == true)))
+    {
+        printf("error>> Invalid Batch Size, Matrix Size, Problems Per Work-Group Or Run Count. Terminating Now...\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // get OpenCL supporting platform's ID
+    result = clGetPlatformIDs(1, &oclPlatformID, NULL);
+    if (result != CL_SUCCESS)
+    {
+        printf("error>> clGetPlatformIDs() Failed : %d. Terminating Now ...\n", result);
+        cleanup();
+        exit(EXIT_FAILURE);
+    }
+
+    // get OpenCL supporting GPU device's ID
+    result = clGetDeviceIDs(oclPlatformID, CL_DEVICE_TYPE_GPU, 1, &oclDeviceID, NULL);
+    if (result != CL_SUCCESS)
+    {
+        printf("error>> clGetDeviceIDs() Failed : %d. Terminating Now ...\n", result);
+        cleanup();
+        exit(EXIT_FAILURE);
+    }
+
+    // create OpenCL compute context
+    oclContext = clCreateContext(NULL, 1, &oclDeviceID, NULL, NULL, &result);
+    if (result != CL_SUCCESS)
+    {
+        printf("error>> clCreateContext() Failed : %d. Terminating Now ...\n", result);
+        cleanup();
+        exit(EXIT_FAILURE);
+    }
+
+    // create command queue
+    oclCommandQueue = clCreateCommandQueue(oclContext, oclDeviceID, 0, &result);
+    if (result != CL_SUCCESS)
+    {
+        printf("error>> clCreateCommandQueue() Failed : %d. Terminating Now ...\n", result);
+        cleanup();
+        exit(EXIT_FAILURE);
+    }
+
+    // build the generic program, any mix of sizes
+    oclBatchedProgram = buildProgram(oclBatchedSourceCode, "");
+
+    // create OpenCL kernels by passing kernel function names that we used in .cl file
+    oclBatchedKernel = clCreateKernel(oclBatchedProgram, "batchedGemmGPU", &result);
+    if (result == CL_SUCCESS)
+        oclSingleKernel = clCreateKernel(oclBatchedProgram, "gemmSingleGPU", &result);
+    if (result != CL_SUCCESS)
+    {
+        printf("error>> clCreateKernel() Failed : %d. Terminating Now ...\n", result);
+        cleanup();
+        exit(EXIT_FAILURE);
+    }
+
+    size_t kernelWorkGroupSize = batchLocalWorkSize;
+    clGetKernelWorkGroupInfo(oclBatchedKernel, oclDeviceID, CL_KERNEL_WORK_GROUP_SIZE, sizeof(kernelWorkGroupSize), &kernelWorkGroupSize, NULL);
+    while (batchLocalWorkSize > kernelWorkGroupSize)
+        batchLocalWorkSize /= 2;
+    clGetDeviceInfo(oclDeviceID, CL_DEVICE_LOCAL_MEM_SIZE, sizeof(localMemSize), &localMemSize, NULL);
+
+    printf("\n==================================================================================================\n");
+    printf("+ BATCHED GEMM OF %d PROBLEMS, %d PER WORK-GROUP OF %zu, AVERAGE OF %d RUNS +\n", batchSize, problemsPerGroup, batchLocalWorkSize, numberOfRuns);
+    printf("==================================================================================================\n");
+    printf("%12s %16s %14s %16s %10s %10s\n", "M x N x K", "Per-Problem (ms)", "Batched (ms)", "Specialized (ms)", "Speedup", "GFLOP/s");
+
+    if (uniformSize != 0)
+    {
+        bAccuracy = batchBenchmark(uniformSize);
+    }
+    else if (bVariable == true)
+    {
+        bAccuracy = batchBenchmark(0);
+    }
+    else
+    {
+        for (int sizeIndex = 0; sizeIndex < NUMBER_OF_SWEEP_SIZES; sizeIndex++)
+        {
+            if (batchBenchmark(sweepSizes[sizeIndex]) == false)
+                bAccuracy = false;
+        }
+        if (batchBenchmark(0) == false)
+            bAccuracy = false;
+    }
+
+    printf("==================================================================================================\n");
+    if (bAccuracy == true)
+        printf("# Every Product Of Every Batch Matches The Host.\n");
+    else
+        printf("# Batched Products Do Not Match The Host.\n");
+    printf("==================================================================================================\n");
+
+    // total cleanup
+    cleanup();
+
+    return (0);
+}
+
+// buildProgram() definition
+cl_program buildProgram(const char *sourceCode, const char *options)
+{
+    // local function declaration
+    void cleanup(void);
+
+    // local variable declaration
+    cl_program program;
+    cl_int result;
+
+    // code
+    // create OpenCL program from .cl
+    program = clCreateProgramWithSource(oclContext, 1, (const char **)&sourceCode, NULL, &result);
+    if (result != CL_SUCCESS)
+    {
+        printf("error>> clCreateProgramWithSource() Failed : %d. Terminating Now ...\n", result);
+        cleanup();
+        exit(EXIT_FAILURE);
+    }
+
+    // build OpenCL program
+    result = clBuildProgram(program, 0, NULL, options, NULL, NULL);
+    if (result != CL_SUCCESS)
+    {
+        size_t len;
+        char buffer[2048];
+        clGetProgramBuildInfo(program, oclDeviceID, CL_PROGRAM_BUILD_LOG, sizeof(buffer), buffer, &len);
+        printf("OpenCL Program Build Log : %s\n", buffer);
+        printf("error>> clBuildProgram() Failed : %d. Terminating Now ...\n", result);
+        clReleaseProgram(program);
+        cleanup();
+        exit(EXIT_FAILURE);
+    }
+
+    return (program);
+}
+
+// batchBenchmark() definition
+// batchSize problems of size x size x size (0 : sizes drawn per problem and per dimension), timed one launch per
+// problem, batched and, for a uniform batch, batched with the specialized build. Prints one table row
+bool batchBenchmark(int size)
+{
+    // local function declaration
+    cl_program buildProgram(const char *, const char *);
+    cl_int batchedGemmOnDevice(cl_kernel);
+    cl_int singleGemmsOnDevice(void);
+    float timeOnDevice(cl_int (*)(void), cl_kernel, cl_int *);
+    bool checkOnDevice(void);
+    void releaseBenchmarkMemory(void);
+    void cleanup(void);
+
+    // local variable declaration
+    cl_ulong state = 0x9e3779b97f4a7c15ULL;
+    size_t countA = 0, countB = 0, countC = 0;
+    double flop = 0.0;
+    float timePerProblem, timeBatched, timeSpecialized = -1.0f;
+    bool bAccuracy;
+    char shape[32];
+    cl_int result = CL_SUCCESS;
+
+    // code
+    // the kernels index the table and the pools with int, so the table and every pool must stay within INT_MAX
+    // elements, a batch past that is rejected before it silently wraps to other problems' matrices
+    if ((size_t)batchSize * PROBLEM_FIELDS > INT_MAX)
+    {
+        printf("error>> A Problem Table Of %d Problems Exceeds INT_MAX Entries. Terminating Now...\n", batchSize);
+        cleanup();
+        exit(EXIT_FAILURE);
+    }
+
+    // problem table, each matrix packed right after the previous one of its pool
+    hostProblems.resize((size_t)batchSize * PROBLEM_FIELDS);
+    for (int problem = 0; problem < batchSize; problem++)
+    {
+        cl_int *fields = &hostProblems[(size_t)problem * PROBLEM_FIELDS];
+        for (int dimension = 0; dimension < 3; dimension++)
+            fields[dimension] = (size != 0) ? size : MIN_VARIABLE_SIZE + (int)(xorshift64(&state) % (MAX_VARIABLE_SIZE - MIN_VARIABLE_SIZE + 1));
+
+        fields[3] = (cl_int)countA;
+        fields[4] = (cl_int)countB;
+        fields[5] = (cl_int)countC;
+        countA += (size_t)fields[0] * fields[2];
+        countB += (size_t)fields[2] * fields[1];
+        countC += (size_t)fields[0] * fields[1];
+        flop += 2.0 * fields[0] * fields[1] * fields[2];
+
+        if ((countA > INT_MAX) || (countB > INT_MAX) || (countC > INT_MAX))
+        {
+            printf("error>> The Matrices Of %d Problems Exceed INT_MAX Elements Per Pool At Problem %d, Use A Smaller -batch. Terminating Now...\n", batchSize, problem);
+            cleanup();
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    // host memory allocation
+    hostA = (float *)malloc(countA * sizeof(float));
+    hostB = (float *)malloc(countB * sizeof(float));
+    hostC = (float *)malloc(countC * sizeof(float));
+    gold = (float *)malloc(countC * sizeof(float));
+    if ((hostA == NULL) || (hostB == NULL) || (hostC == NULL) || (gold == NULL))
+    {
+        printf("error>> Host Memory Allocation Failed. Terminating Now...\n");
+        cleanup();
+        exit(EXIT_FAILURE);
+    }
+
+    fillHostMatrices(hostA, countA, 5);
+    fillHostMatrices(hostB, countB, 7);
+    batchedGemmOnHost();
+
+    // allocate device memory
+    deviceProblems = clCreateBuffer(oclContext, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, hostProblems.size() * sizeof(cl_int), hostProblems.data(), &result);
+    if (result == CL_SUCCESS)
+        deviceA = clCreateBuffer(oclContext, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, countA * sizeof(float), hostA, &result);
+    if (result == CL_SUCCESS)
+        deviceB = clCreateBuffer(oclContext, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, countB * sizeof(float), hostB, &result);
+    if (result == CL_SUCCESS)
+        deviceC = clCreateBuffer(oclContext, CL_MEM_WRITE_ONLY, countC * sizeof(float), NULL, &result);
+    if (result != CL_SUCCESS)
+    {
+        printf("error>> clCreateBuffer() Failed : %d. Terminating Now ...\n", result);
+        cleanup();
+        exit(EXIT_FAILURE);
+    }
+
+    // one launch and one clFinish per problem, the pattern batching replaces
+    timePerProblem = timeOnDevice(singleGemmsOnDevice, NULL, &result);
+    bAccuracy = (result == CL_SUCCESS) && checkOnDevice();
+
+    // every problem in one NDRange
+    timeBatched = timeOnDevice(NULL, oclBatchedKernel, &result);
+    bAccuracy = bAccuracy && (result == CL_SUCCESS) && checkOnDevice();
+
+    // a uniform batch gets sizes baked in, and its matrices staged in local memory when both fit in half of it
+    if (size != 0)
+    {
+        char options[256];
+        sprintf(options, "-D FIXED_M=%d -D FIXED_N=%d -D FIXED_K=%d", size, size, size);
+        if ((cl_ulong)2 * size * size * sizeof(float) <= localMemSize / 2)
+            strcat(options, " -D STAGE_IN_LOCAL");
+
+        oclSpecializedProgram = buildProgram(oclBatchedSourceCode, options);
+        oclSpecializedKernel = clCreateKernel(oclSpecializedProgram, "batchedGemmGPU", &result);
+        if (result == CL_SUCCESS)
+            timeSpecialized = timeOnDevice(NULL, oclSpecializedKernel, &result);
+        bAccuracy = bAccuracy && (result == CL_SUCCESS) && checkOnDevice();
+    }
+
+    if (result != CL_SUCCESS)
+    {
+        printf("error>> Batched GEMM Failed : %d. Terminating Now ...\n", result);
+        cleanup();
+        exit(EXIT_FAILURE);
+    }
+
+    float bestTime = ((timeSpecialized > 0.0f) && (timeSpecialized < timeBatched)) ? timeSpecialized : timeBatched;
+    if (size != 0)
+        sprintf(shape, "%d x %d x %d", size, size, size);
+    else
+        sprintf(shape, "%d..%d", MIN_VARIABLE_SIZE, MAX_VARIABLE_SIZE);
+
+    printf("%12s %16.3f %14.3f", shape, timePerProblem, timeBatched);
+    if (timeSpecialized > 0.0f)
+        printf(" %16.3f", timeSpecialized);
+    else
+        printf(" %16s", "-");
+    printf(" %9.2fx %10.2f\n", timePerProblem / bestTime, flop / (bestTime * 1.0e6));
+    if (bAccuracy == false)
+        printf("%12s   device products differ from the host\n", "");
+
+    releaseBenchmarkMemory();
+
+    return (bAccuracy);
+}
+
+// timeOnDevice() definition
+// average time (ms) of numberOfRuns calls of launch(), or of batchedGemmOnDevice(kernel) when launch is NULL,
+// after one warm-up call
+float timeOnDevice(cl_int (*launch)(void), cl_kernel kernel, cl_int *pResult)
+{
+    // local function declaration
+    cl_int batchedGemmOnDevice(cl_kernel);
+
+    // local variable declaration
+    cl_int result;
+    float time;
+
+    // code
+    result = (launch != NULL) ? launch() : batchedGemmOnDevice(kernel);
+    clFinish(oclCommandQueue);
+
+    StopWatchInterface *timer = NULL;
+    sdkCreateTimer(&timer);
+    sdkStartTimer(&timer);
+
+    for (int run = 0; (run < numberOfRuns) && (result == CL_SUCCESS); run++)
+        result = (launch != NULL) ? launch() : batchedGemmOnDevice(kernel);
+    clFinish(oclCommandQueue);
+
+    sdkStopTimer(&timer);
+    time = sdkGetTimerValue(&timer) / numberOfRuns;
+    sdkDeleteTimer(&timer);
+
+    *pResult = result;
+    return (time);
+}
+
+// batchedGemmOnDevice() definition
+cl_int batchedGemmOnDevice(cl_kernel kernel)
+{
+    // local variable declaration
+    size_t numberOfGroups = ((size_t)batchSize + problemsPerGroup - 1) / problemsPerGroup;
+    size_t globalWorkSize = numberOfGroups * batchLocalWorkSize;
+    cl_int result;
+
+    // code
+    result = clSetKernelArg(kernel, 0, sizeof(cl_mem), (void *)&deviceProblems);
+    result |= clSetKernelArg(kernel, 1, sizeof(cl_int), (void *)&batchSize);
+    result |= clSetKernelArg(kernel, 2, sizeof(cl_int), (void *)&problemsPerGroup);
+    result |= clSetKernelArg(kernel, 3, sizeof(cl_mem), (void *)&deviceA);
+    result |= clSetKernelArg(kernel, 4, sizeof(cl_mem), (void *)&deviceB);
+    result |= clSetKernelArg(kernel, 5, sizeof(cl_mem), (void *)&deviceC);
+    if (result != CL_SUCCESS)
+        return (result);
+
+    return (clEnqueueNDRangeKernel(oclCommandQueue, kernel, 1, NULL, &globalWorkSize, &batchLocalWorkSize, 0, NULL, NULL));
+}
+
+// singleGemmsOnDevice() definition
+// one 8 x 8 work-group tiling of C per problem, waiting for each before the next like a loop over matrixMultiplyGPU
+cl_int singleGemmsOnDevice(void)
+{
+    // local variable declaration
+    size_t localWorkSize[2] = {8, 8};
+    cl_int result = CL_SUCCESS;
+
+    // code
+    for (int problem = 0; (problem < batchSize) && (result == CL_SUCCESS); problem++)
+    {
+        const cl_int *fields = &hostProblems[(size_t)problem * PROBLEM_FIELDS];
+        size_t globalWorkSize[2] = {((size_t)fields[1] + 7) / 8 * 8, ((size_t)fields[0] + 7) / 8 * 8};
+
+        result = clSetKernelArg(oclSingleKernel, 0, sizeof(cl_int), (void *)&fields[0]);
+        result |= clSetKernelArg(oclSingleKernel, 1, sizeof(cl_int), (void *)&fields[1]);
+        result |= clSetKernelArg(oclSingleKernel, 2, sizeof(cl_int), (void *)&fields[2]);
+        result |= clSetKernelArg(oclSingleKernel, 3, sizeof(cl_mem), (void *)&deviceA);
+        result |= clSetKernelArg(oclSingleKernel, 4, sizeof(cl_int), (void *)&fields[3]);
+        result |= clSetKernelArg(oclSingleKernel, 5, sizeof(cl_mem), (void *)&deviceB);
+        result |= clSetKernelArg(oclSingleKernel, 6, sizeof(cl_int), (void *)&fields[4]);
+        result |= clSetKernelArg(oclSingleKernel, 7, sizeof(cl_mem), (void *)&deviceC);
+        result |= clSetKernelArg(oclSingleKernel, 8, sizeof(cl_int), (void *)&fields[5]);
+        if (result == CL_SUCCESS)
+            result = clEnqueueNDRangeKernel(oclCommandQueue, oclSingleKernel, 2, NULL, globalWorkSize, localWorkSize, 0, NULL, NULL);
+        if (result == CL_SUCCESS)
+            result = clFinish(oclCommandQueue);
+    }
+
+    return (result);
+}
+
+// checkOnDevice() definition
+// reads every C back, clears the device copy so the next variant cannot pass on stale results, and compares
+bool checkOnDevice(void)
+{
+    // local variable declaration
+    size_t countC = 0;
+    float zero = 0.0f;
+    cl_int result;
+
+    // code
+    for (int problem = 0; problem < batchSize; problem++)
+        countC += (size_t)hostProblems[(size_t)problem * PROBLEM_FIELDS] * hostProblems[(size_t)problem * PROBLEM_FIELDS + 1];
+
+    result = clEnqueueReadBuffer(oclCommandQueue, deviceC, CL_TRUE, 0, countC * sizeof(float), hostC, 0, NULL, NULL);
+    if (result == CL_SUCCESS)
+        result = clEnqueueFillBuffer(oclCommandQueue, deviceC, &zero, sizeof(zero), 0, countC * sizeof(float), 0, NULL, NULL);
+    if (result != CL_SUCCESS)
+        return (false);
+
+    return (memcmp(hostC, gold, countC * sizeof(float)) == 0);
+}
+
+// releaseBenchmarkMemory() definition
+// host and device memory and the specialized build of one batchBenchmark() batch
+void releaseBenchmarkMemory(void)
+{
+    // code
+    cl_mem *deviceBuffers[] = {&deviceC, &deviceB, &deviceA, &deviceProblems};
+    for (int index = 0; index < 4; index++)
+    {
+        if (*deviceBuffers[index])
+        {
+            clReleaseMemObject(*deviceBuffers[index]);
+            *deviceBuffers[index] = NULL;
+        }
+    }
+
+    if (oclSpecializedKernel)
+    {
+        clReleaseKernel(oclSpecializedKernel);
+        oclSpecializedKernel = NULL;
+    }
+
+    if (oclSpecializedProgram)
+    {
+        clReleaseProgram(oclSpecializedProgram);
+        oclSpecializedProgram = NULL;
+    }
+
+    float **hostArrays[] = {&gold, &hostC, &hostB, &hostA};
+    for (int index = 0; index < 4; index++)
+    {
+        if (*hostArrays[index])
+        {
+            free(*hostArrays[index]);
+            *hostArrays[index] = NULL;
+        }
+    }
+    hostProblems.clear();
+}
+
+// cleanup() definition
+void cleanup(void)
+{
+    // local function declaration
+    void releaseBenchmarkMemory(void);
+
+    // code
+    // free allocated host and device memory
+    releaseBenchmarkMemory();
+
+    // OpenCL cleanup
+    cl_kernel *kernels[] = {&oclSingleKernel, &oclBatchedKernel};
+    for (int index = 0; index < 2; index++)
+    {
+        if (*kernels[index])
+        {
+            clReleaseKernel(*kernels[index]);
+            *kernels[index] = NULL;
+        }
+    }
+
+    if (oclBatchedProgram)
+    {
+        clReleaseProgram(oclBatchedProgram);
+        oclBatchedProgram = NULL;
+    }
+
+    if (oclCommandQueue)
+    {
+        clReleaseCommandQueue(oclCommandQueue);
+        oclCommandQueue = NULL;
+    }
+
+    if (oclContext)
+    {
+        clReleaseContext(oclContext);
+        oclContext = NULL;
+    }
+}
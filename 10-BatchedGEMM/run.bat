@@ -0,0 +1,12 @@
+cls
+
+del BatchedGEMM.exe
+
+cl.exe BatchedGEMM.cpp /c /EHsc /Fo".\BatchedGEMM.obj" /I "C:\Program Files\NVIDIA GPU Computing Toolkit\CUDA\v11.1\include" 
+link.exe BatchedGEMM.obj opencl.lib /LIBPATH:"C:\Program Files\NVIDIA GPU Computing Toolkit\CUDA\v11.1\lib\x64"
+
+BatchedGEMM.exe
+BatchedGEMM.exe -batch 16384 -size 8
+BatchedGEMM.exe -variable -pergroup 4
+
+del BatchedGEMM.obj